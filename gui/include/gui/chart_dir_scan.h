@@ -0,0 +1,115 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Concurrent enumeration of chart directory trees.
+ */
+
+#ifndef CHART_DIR_SCAN_H_
+#define CHART_DIR_SCAN_H_
+
+#include <ctime>
+#include <functional>
+#include <vector>
+
+#include <wx/longlong.h>
+#include <wx/string.h>
+
+class WorkerPool;
+
+/** File found by ChartDirScan, with the data used to detect changes. */
+struct ChartDirFile {
+  wxString path;  ///< Full path
+  wxString name;  ///< File name without directory
+  wxULongLong size = 0;
+  time_t mtime = -1;  ///< Modification time, -1 if unknown
+};
+
+/**
+ * Single pass listing of a chart directory tree.
+ *
+ * The tree is listed once, recording size and modification time of all
+ * files. The listing is then used both to compute the directory magic
+ * number used to detect changes and to find the files matching each chart
+ * class search mask, instead of walking the tree once per chart class and
+ * file name case variant.
+ *
+ * Run() lists any number of trees concurrently, splitting each tree on its
+ * top level sub-directories.
+ */
+class ChartDirScan {
+public:
+  /**
+   * Create scan of given directory.
+   * @param dir_path  Directory tree root.
+   * @param enumerate If false, Run() leaves this tree alone, used for
+   *                  trees like cm93 which are not searched file by file.
+   */
+  explicit ChartDirScan(const wxString &dir_path, bool enumerate = true)
+      : m_dir_path(dir_path), m_enumerate(enumerate) {}
+
+  /** Progress callback: number of finished and total listing jobs. */
+  using Progress = std::function<void(size_t done, size_t total)>;
+
+  /**
+   * List all scans using pool and block until done. Progress is invoked
+   * on the calling thread about every 100 ms while waiting.
+   */
+  static void Run(std::vector<ChartDirScan> &scans, WorkerPool &pool,
+                  const Progress &progress = nullptr);
+
+  const wxString &GetPath() const { return m_dir_path; }
+
+  /** Return true if tree has been listed by Run(). */
+  bool IsListed() const { return m_listed; }
+
+  /** Return all files in tree, sorted on path. */
+  const std::vector<ChartDirFile> &GetFiles() const { return m_files; }
+
+  /**
+   * Return the directory magic number, a hash of path, size and
+   * modification time of all files in the tree.
+   */
+  wxString GetMagic() const;
+
+  /**
+   * Return files whose name matches any of the wildcard specs, sorted on
+   * path. Matching is case insensitive on Windows.
+   */
+  std::vector<const ChartDirFile *> GetMatchingFiles(
+      const std::vector<wxString> &specs) const;
+
+  /**
+   * Return path including trailing separator of first directory named
+   * GSHHG containing GSHHG polygon files, or empty string if none.
+   */
+  wxString FindGshhgDir() const;
+
+private:
+  static void ListFiles(const wxString &dir, int flags,
+                        std::vector<ChartDirFile> &files);
+  static void ListTree(const wxString &dir, std::vector<ChartDirFile> &files);
+
+  wxString m_dir_path;
+  bool m_enumerate;
+  bool m_listed = false;
+  std::vector<ChartDirFile> m_files;
+};
+
+#endif  // CHART_DIR_SCAN_H_
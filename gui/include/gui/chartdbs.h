@@ -25,6 +25,7 @@
 #ifndef __CHARTDBS_H__
 #define __CHARTDBS_H__
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <vector>
@@ -33,8 +34,11 @@
 #include <wx/progdlg.h>
 #include <wx/thread.h>
 
+#include "model/chart_spatial_index.h"
+#include "model/mapped_file.h"
 #include "model/ocpn_types.h"
 #include "bbox.h"
+#include "chart_dir_scan.h"
 #include "LLRegion.h"
 #include "chartdb_thread.h"
 
@@ -57,12 +61,65 @@ WX_DECLARE_STRING_HASH_MAP(int, ChartCollisionsHashMap);
 
 ///////////////////////////////////////////////////////////////////////
 
-static const int DB_VERSION_PREVIOUS = 17;
-static const int DB_VERSION_CURRENT = 18;
+static const int DB_VERSION_OLDEST = 17;  // Oldest version upgraded on read
+static const int DB_VERSION_PREVIOUS = 18;
+static const int DB_VERSION_CURRENT = 19;
 
 class ChartDatabase;
 class ChartGroupArray;
 
+/**
+ * File header, database version 19 and up. The file is memory mapped and
+ * made up of sections located by the offsets in this header:
+ *
+ *   - Directories: nDirEntries of int32 length + UTF-8 path.
+ *   - Entries: nTableEntries fixed size ChartTableEntry_onDisk_19.
+ *   - Paths: NUL terminated UTF-8 chart paths.
+ *   - Ply points: one block per entry holding the ply table, aux ply
+ *     counts, aux ply tables, no-coverage counts and no-coverage tables.
+ *
+ * All sections start on an 8-byte boundary. Like ChartTableHeader the
+ * header starts with the "Vnnn" version string.
+ * NOTE: on-disk structure - cannot add, remove, or reorder!
+ */
+struct ChartTableHeader_19 {
+  char dbVersion[4];
+  uint32_t nTableEntries;
+  uint32_t nDirEntries;
+  uint32_t entrySize;  ///< sizeof(ChartTableEntry_onDisk_19)
+  uint64_t dirOffset;
+  uint64_t entryOffset;
+  uint64_t pathOffset;
+  uint64_t plyOffset;
+  uint64_t fileSize;
+};
+static_assert(sizeof(ChartTableHeader_19) == 56, "Bad on-disk header");
+
+/** Fixed size entry, see ChartTableHeader_19. */
+struct ChartTableEntry_onDisk_19 {
+  int32_t EntryOffset;
+  int32_t ChartType;
+  int32_t ChartFamily;
+  float LatMax;
+  float LatMin;
+  float LonMax;
+  float LonMin;
+  int32_t Scale;
+  int64_t edition_date;
+  int64_t file_date;
+  float skew;
+  int32_t ProjectionType;
+  int32_t nPlyEntries;
+  int32_t nAuxPlyEntries;
+  int32_t nNoCovrPlyEntries;
+  uint32_t pathOffset;  ///< Relative to path section
+  uint32_t pathLength;  ///< Excluding terminating NUL
+  uint32_t bValid;
+  uint64_t plyOffset;  ///< Relative to ply point section
+  uint64_t plySize;
+};
+static_assert(sizeof(ChartTableEntry_onDisk_19) == 96, "Bad on-disk entry");
+
 struct ChartTableEntry_onDisk_18 {
   int EntryOffset;
   int ChartType;
@@ -195,7 +252,24 @@ struct ChartTableEntry {
   bool IsEqualTo(const ChartTableEntry &cte) const;
   bool IsEarlierThan(const ChartTableEntry &cte) const;
   bool Read(const ChartDatabase *pDb, wxInputStream &is);
-  bool Write(const ChartDatabase *pDb, wxOutputStream &os);
+
+  /**
+   * Set up entry from a version 19 memory mapped database. Ply points are
+   * referenced in place and only paged in when used.
+   */
+  bool Read(const ChartTableEntry_onDisk_19 &cte, const char *path,
+            std::shared_ptr<MappedFile> mapping, const uint8_t *ply_data);
+
+  /** Fill in on-disk entry, offsets as located by ChartDatabase::Write(). */
+  void GetOnDisk(ChartTableEntry_onDisk_19 &cte, uint32_t path_offset,
+                 uint64_t ply_offset) const;
+
+  /** Return size of on-disk ply point block written by WritePlyData(). */
+  uint64_t GetPlyDataSize() const;
+  bool WritePlyData(wxOutputStream &os) const;
+
+  /** Copy any ply points referenced in a mapped database into memory. */
+  void DetachMapping();
   void Clear();
   void Disable();
   void ReEnable();
@@ -254,6 +328,11 @@ struct ChartTableEntry {
   bool IsBasemap() const;
 
 private:
+  void SetPathMembers();
+  /** Set up aux and no-coverage tables pointing into a mapped block. */
+  void MapPlyTables(const uint8_t *data, uint64_t size);
+  void FreePlyTables();
+
   int EntryOffset;
   int ChartType;
   int ChartFamily;
@@ -278,6 +357,14 @@ private:
   int *pNoCovrCntTable;
   float **pNoCovrPlyTable;
 
+  /**
+   * Mapped database holding the ply points, if any. While set, ply tables
+   * and counts point into the mapping and are not owned by this entry.
+   */
+  std::shared_ptr<MappedFile> m_mapping;
+  /** Count tables are heap allocated despite m_mapping, see MapPlyTables(). */
+  bool m_ownsCounts;
+
   std::vector<int> m_GroupArray;
   wxString *m_pfilename;  // a helper member, not on disk
   wxString *m_psFullPath;
@@ -376,6 +463,23 @@ public:
   wxString GetDBChartFileName(int dbIndex);
   void ApplyGroupArray(ChartGroupArray *pGroupArray);
   bool IsChartAvailable(int dbIndex);
+
+  /**
+   * Return indexes of charts whose bounding box contains the position and
+   * which are members of group (all charts if group <= 0), in ascending
+   * order. Charts spanning or located beyond the antimeridian are handled.
+   * CM93 composite charts are always included. The result still needs to
+   * be checked against the chart coverage.
+   */
+  std::vector<int> GetChartsAtPosition(float lat, float lon, int group = 0);
+
+  /**
+   * Return indexes of charts whose bounding box intersects box and which
+   * are members of group (all charts if group <= 0), in ascending order.
+   * CM93 composite charts are always included.
+   */
+  std::vector<int> GetChartsInBBox(const LLBBox &box, int group = 0);
+
   std::map<wxString, int> active_chartTable_pathindex;
 
   std::vector<float> GetReducedPlyPoints(int dbIndex);
@@ -398,6 +502,9 @@ protected:
   int AddChartDirectory(const wxString &theDir, bool bshow_prog);
   void SetValid(bool valid) { bValid = valid; }
 
+  /** Return spatial index, rebuilt if out of sync with the chart table. */
+  ChartSpatialIndex &GetSpatialIndex();
+
   std::vector<ChartClassDescriptor> m_ChartClassDescriptorArray;
   ArrayOfCDI m_dir_array;
   bool m_b_busy;
@@ -405,11 +512,19 @@ protected:
 private:
   bool IsChartDirUsed(const wxString &theDir);
 
+  /**
+   * Queue parsing of the files in scan matching chart_desc. Files found
+   * in known_charts (path -> db index) with unchanged modification time
+   * are not parsed again, the existing entry is marked valid instead.
+   */
   int SearchDirAndAddCharts(wxString &dir_name_base,
                             ChartClassDescriptor &chart_desc,
+                            const ChartDirScan &scan,
+                            const std::map<wxString, int> &known_charts,
                             wxGenericProgressDialog *pprog);
 
-  int TraverseDirAndAddCharts(ChartDirInfo &dir_info,
+  int TraverseDirAndAddCharts(ChartDirInfo &dir_info, const ChartDirScan &scan,
+                              const std::map<wxString, int> &known_charts,
                               wxGenericProgressDialog *pprog,
                               wxString &dir_magic, bool bForce);
   bool DetectDirChange(const wxString &dir_path, const wxString &prog_label,
@@ -421,6 +536,8 @@ private:
                 bool bthis_dir_in_dB);
 
   bool Check_CM93_Structure(wxString dir_name);
+  bool ReadMapped(std::shared_ptr<MappedFile> mapping);
+  ChartIndexEntry MakeIndexEntry(const ChartTableEntry &cte) const;
   void OnProgessTimer(wxTimerEvent &event);
   void OnUpdateComplete(wxTimerEvent &event);
 
@@ -441,6 +558,7 @@ private:
   int m_nentries;
 
   LLBBox m_dummy_bbox;
+  ChartSpatialIndex m_spatial_index;
   std::atomic<int> m_jobsRemaining{0};
   JobQueueCTE m_pool;
   JobQueueCTE m_pool_deferred;
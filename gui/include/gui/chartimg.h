@@ -24,7 +24,13 @@
 #ifndef _CHARTIMG_H_
 #define _CHARTIMG_H_
 
+#include <memory>
+#include <vector>
+
+#include "model/bsb_row_decoder.h"
 #include "model/georef.h"  // for GeoRef type
+#include "model/mapped_file.h"
+#include "model/raster_tile_cache.h"
 
 #include "chartbase.h"
 #include "chartdb.h"
@@ -99,6 +105,14 @@ public:
   int size;
 };
 
+/** Compressed row and where to start decoding it, see GetRowSource(). */
+struct BsbRowSource {
+  const unsigned char *data;
+  size_t size;
+  size_t pos;  ///< Offset of the run starting at pixel ix
+  int ix;
+};
+
 class opncpnPalette {
 public:
   opncpnPalette();
@@ -237,6 +251,37 @@ protected:
   virtual int BSBGetScanline(unsigned char *pLineBuf, int y, int xs, int xl,
                              int sub_samp);
 
+  /** Return compressed line y from the line cache, loading it if needed. */
+  CachedLine *GetCachedLine(int y);
+
+  /**
+   * Locate compressed row y for decoding from pixel xs. Without line cache
+   * or mapped file the row is read into buffer.
+   */
+  bool GetRowSource(int y, int xs, BsbRowSource &row,
+                    std::vector<unsigned char> &buffer);
+
+  /** Return true if rows are decoded from the mapped file into tiles. */
+  bool UseTileCache() const { return m_mapped_file.IsOpen(); }
+
+  /**
+   * Unmap the chart file once the chart database has erased or replaced
+   * it, rows then being read from the stream. Requires m_critSect held.
+   */
+  void ValidateMapping();
+
+  /**
+   * Return color indices of tile (tx, ty) from the shared tile cache,
+   * decoding it if needed. Requires UseTileCache() and m_critSect held.
+   */
+  RasterTileCache::Tile GetTile(int tx, int ty);
+
+  /** GetChartBits() using the shared tile cache. */
+  bool GetTileBits(wxRect &source, unsigned char *pPix, int sub_samp);
+
+  /** Return decoder for current palette. */
+  const BsbRowDecoder &GetRowDecoder();
+
   bool GetViewUsingCache(wxRect &source, wxRect &dest, const OCPNRegion &Region,
                          ScaleTypeEnum scale_type);
   bool GetView(wxRect &source, wxRect &dest, ScaleTypeEnum scale_type);
@@ -345,6 +390,14 @@ protected:
 
   wxCriticalSection m_critSect;
   wxULongLong m_filesize;
+
+  std::unique_ptr<BsbRowDecoder> m_row_decoder;
+  int *m_row_decoder_palette;  ///< pPalette used by m_row_decoder
+
+  wxString m_bitmap_file;  ///< File holding the rows, mapped by PostInit()
+  wxString m_bitmap_source;  ///< Chart file m_bitmap_file was made from
+  MappedFile m_mapped_file;
+  uint32_t m_tile_chart;  ///< RasterTileCache chart id
 };
 
 /**
@@ -159,6 +159,9 @@ private:
 
   void DeleteSingleTexture(glTextureDescriptor *ptd);
 
+  /** Register or update texture of ptd in the GpuLedger. */
+  void AccountTexture(glTextureDescriptor *ptd);
+
   CatalogEntryValue *GetCacheEntryValue(int level, int x, int y,
                                         ColorScheme color_scheme);
   bool AddCacheEntryValue(const CatalogEntry &p);
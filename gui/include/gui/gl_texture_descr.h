@@ -33,6 +33,7 @@
 #include "gl_headers.h"
 
 #include "dychart.h"
+#include "model/gpu_ledger.h"
 #include "model/ocpn_types.h"
 #include "color_types.h"
 
@@ -68,6 +69,7 @@ public:
   ColorScheme m_colorscheme;
 
   int tex_mem_used;
+  GpuLedger::Handle gpu_handle;  ///< GpuLedger entry of tex_name, or 0
 
   unsigned char *map_array[10];
   unsigned char *comp_array[10];
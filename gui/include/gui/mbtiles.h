@@ -143,6 +143,14 @@ protected:
   void FlushTiles();
   bool RenderTile(SharedTilePtr tile, int zoom_level, const ViewPort& vpoint);
 
+  /**
+   * Request loading of the tiles at given zoom level covering region, in
+   * the background, provided they fit in the tile cache budget.
+   * @return Number of tiles covering box.
+   */
+  uint32_t PrefetchTiles(int zoom_level, const LLBBox& box,
+                         const LLRegion& region);
+
   //    Protected Data
 
   float m_lon_max;
@@ -173,20 +181,19 @@ protected:
 
   uint32_t m_tile_count;
   std::unique_ptr<MbtTilesThread> m_worker_thread;
-  std::thread m_thread;
 
 #ifdef ocpnUSE_GL
   GLShaderProgram* m_tile_shader_program;
 #endif
 
   /**
-   * Create and start the worker thread. This thread is dedicated at
+   * Create and start the worker threads. These threads are dedicated at
    * loading and decompressing chart tiles into memory, in the background. If
-   * for any reason the thread would fail to load, the method return false
+   * for any reason the threads would fail to load, the method return false
    */
   bool StartThread();
 
-  /** Stop and delete the worker thread. Called when OpenCPN is quitting. */
+  /** Stop and delete the worker threads. Called when OpenCPN is quitting. */
   void StopThread();
 
 private:
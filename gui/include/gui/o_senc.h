@@ -26,8 +26,12 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <atomic>
+#include <map>
 #include <vector>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 
 // For compilers that support precompilation, includes "wx.h".
@@ -44,6 +48,10 @@
 
 #include "gdal/cpl_csv.h"
 
+#include "model/arena.h"
+#include "model/mapped_file.h"
+#include "model/packed_rtree.h"
+
 #include "chartbase.h"
 #include "mygeom.h"
 #include "ogr_s57.h"
@@ -85,6 +93,20 @@
 #define CELL_NOCOVR_RECORD 99
 #define CELL_EXTENT_RECORD 100
 
+//  OSENC V3 (format version 300) records, see
+//  Osenc::CreateSENCVectorEdgeTableRecord300(),
+//  Osenc::CreateAreaFeatureGeometryRecord300() and
+//  Osenc::CreateSENCFeatureIndexRecords300()
+#define PADDING_RECORD 101
+#define VECTOR_EDGE_NODE_BLOCK_RECORD 102
+#define VECTOR_CONNECTED_NODE_BLOCK_RECORD 103
+#define FEATURE_GEOMETRY_RECORD_AREA_300 104
+#define CELL_CLASS_INDEX_RECORD 105
+#define CELL_SPATIAL_INDEX_RECORD 106
+
+/** Oldest SENC format version still read, older files are rebuilt. */
+#define OLDEST_SENC_FORMAT_VERSION 201
+
 #define ATTRIBUTE_ID_PRIM 50000
 
 WX_DEFINE_ARRAY_PTR(float *, SENCFloatPtrArray);
@@ -218,6 +240,34 @@ typedef struct _OSENC_AreaGeometry_Record_Payload {
   void *payLoad;
 } OSENC_AreaGeometry_Record_Payload;
 
+//  Followed by the columns: triangle primitive bounding boxes as four
+//  doubles each, the vertices as float pairs in the area vertex buffer
+//  layout, contour point counts, primitive vertex counts, the edge vector
+//  index table and last the primitive types as single bytes.
+typedef struct _OSENC_AreaGeometry300_Record_Base {
+  uint16_t record_type;
+  uint32_t record_length;
+  double extent_s_lat;
+  double extent_n_lat;
+  double extent_w_lon;
+  double extent_e_lon;
+  uint32_t contour_count;
+  uint32_t triprim_count;
+  uint32_t edgeVector_count;
+  uint32_t vertex_count;
+} OSENC_AreaGeometry300_Record_Base;
+
+typedef struct _OSENC_AreaGeometry300_Record_Payload {
+  double extent_s_lat;
+  double extent_n_lat;
+  double extent_w_lon;
+  double extent_e_lon;
+  uint32_t contour_count;
+  uint32_t triprim_count;
+  uint32_t edgeVector_count;
+  uint32_t vertex_count;
+} OSENC_AreaGeometry300_Record_Payload;
+
 typedef struct _OSENC_VET_Record {
   uint16_t record_type;
   uint32_t record_length;
@@ -351,6 +401,76 @@ private:
   bool m_ok;
 };
 
+//--------------------------------------------------------------------------
+//      Osenc_instreamMapped definition
+//      A memory mapped file stream, records can be used in place
+//--------------------------------------------------------------------------
+class Osenc_instreamMapped : public Osenc_instream {
+public:
+  Osenc_instreamMapped();
+  ~Osenc_instreamMapped();
+
+  bool Open(const wxString &senc_file_name);
+  void Close();
+
+  Osenc_instream &Read(void *buffer, size_t size);
+  bool IsOk();
+  bool isAvailable();
+  void Shutdown();
+
+  /**
+   * Return pointer to next size bytes in the mapped file and skip them.
+   * @return nullptr and not IsOk() if less than size bytes remain.
+   */
+  const unsigned char *Next(size_t size);
+
+  /** Return the mapped file, valid also after Close(). */
+  std::shared_ptr<MappedFile> GetFile() { return m_file; }
+
+private:
+  std::shared_ptr<MappedFile> m_file;
+  size_t m_pos;
+  bool m_ok;
+};
+
+/** Features of one object class, from a CELL_CLASS_INDEX_RECORD. */
+struct Osenc_class_range {
+  std::string acronym;
+  uint32_t first;  ///< First feature in Osenc_storage::class_features
+  uint32_t count;
+};
+
+/**
+ * Backing store of the edge and connected node points ingested from a
+ * SENC file by Osenc::ingest200(). Points are used in place in the mapped
+ * file when suitably aligned, else copied to the arena. All points are
+ * released at once when this is destroyed.
+ *
+ * Also returns the feature indexes of format 300 SENCs. Features are
+ * identified by their position in the file, feature_objects mapping them
+ * to the ingested objects.
+ */
+struct Osenc_storage {
+  std::shared_ptr<MappedFile> file;
+  Arena arena;
+  /**
+   * Points of all edges, contiguous and in the line vertex buffer layout,
+   * when read in place from a VECTOR_EDGE_NODE_BLOCK_RECORD.
+   */
+  const float *edge_points = nullptr;
+  size_t edge_point_count = 0;  ///< Number of points (float pairs)
+
+  /** Object vector position of each feature, -1 if not ingested. */
+  std::vector<int> feature_objects;
+  /** Object classes present, ranges in class_features. */
+  std::vector<Osenc_class_range> class_ranges;
+  /** Features sorted by object class, in file order for each class. */
+  std::vector<uint32_t> class_features;
+  /** Line and area features by bounding box, empty if not in the SENC. */
+  PackedRTree spatial_index;
+  std::vector<uint32_t> spatial_features;  ///< Feature of each index item
+};
+
 //--------------------------------------------------------------------------
 //      Osenc_outstream definition
 //--------------------------------------------------------------------------
@@ -364,6 +484,8 @@ public:
   virtual Osenc_outstream &Write(const void *buffer, size_t size) = 0;
   virtual void Close() = 0;
   virtual bool IsOk() = 0;
+  /** Return current write position, wxInvalidOffset if unknown. */
+  virtual wxFileOffset Tell() { return wxInvalidOffset; }
 };
 
 //--------------------------------------------------------------------------
@@ -380,6 +502,7 @@ public:
   Osenc_outstream &Write(const void *buffer, size_t size);
   void Close();
   bool IsOk();
+  wxFileOffset Tell();
 
 private:
   void Init();
@@ -405,8 +528,14 @@ public:
   int ingest(const wxString &senc_file_name, S57ObjVector *pObjectVector,
              VE_ElementVector *pVEArray, VC_ElementVector *pVCArray);
 
+  /**
+   * Read a SENC file.
+   * @param storage If not null, edge and node points are kept here
+   *     rather than allocated one by one using malloc().
+   */
   int ingest200(const wxString &senc_file_name, S57ObjVector *pObjectVector,
-                VE_ElementVector *pVEArray, VC_ElementVector *pVCArray);
+                VE_ElementVector *pVEArray, VC_ElementVector *pVCArray,
+                Osenc_storage *storage = nullptr);
 
   //  SENC creation, by Version desired...
   void SetLODMeters(double meters) { m_LOD_meters = meters; }
@@ -416,6 +545,8 @@ public:
     m_ref_lon = lon;
   }
   void setOutstream(Osenc_outstream *stream) { m_pauxOutstream = stream; }
+  /** createSenc200() aborts with ERROR_SENCFILE_ABORT when *flag is set. */
+  void setCancelFlag(const std::atomic<bool> *flag) { m_cancel = flag; }
   void setInstream(Osenc_instream *stream) { m_pauxInstream = stream; }
 
   wxString getUpdateDate() { return m_LastUpdateDate; }
@@ -441,13 +572,18 @@ public:
   int createSenc200(const wxString &FullPath000, const wxString &SENCFileName,
                     bool b_showProg = true);
 
-  void CreateSENCVectorEdgeTableRecord200(Osenc_outstream *stream,
+  void CreateSENCVectorEdgeTableRecord300(Osenc_outstream *stream,
                                           S57Reader *poReader);
-  void CreateSENCVectorConnectedTableRecord200(Osenc_outstream *stream,
+  void CreateSENCVectorConnectedTableRecord300(Osenc_outstream *stream,
                                                S57Reader *poReader);
+  bool CreateSENCFeatureIndexRecords300(Osenc_outstream *stream);
+  bool WritePaddingRecord(Osenc_outstream *stream);
 
   void InitializePersistentBuffer(void);
   unsigned char *getBuffer(size_t length);
+  unsigned char *getPayload(Osenc_instreamMapped &stream, size_t length);
+  float *getPoints(const unsigned char *src, size_t count,
+                   Osenc_storage *storage);
 
   int getNativeScale() { return m_native_scale; }
   int GetBaseFileInfo(const wxString &FullPath000,
@@ -489,7 +625,7 @@ private:
                             uint16_t value);
   bool WriteHeaderRecord200(Osenc_outstream *stream, int recordType,
                             uint32_t value);
-  bool CreateAreaFeatureGeometryRecord200(S57Reader *poReader,
+  bool CreateAreaFeatureGeometryRecord300(S57Reader *poReader,
                                           OGRFeature *pFeature,
                                           Osenc_outstream *stream);
   bool CreateLineFeatureGeometryRecord200(S57Reader *poReader,
@@ -503,6 +639,10 @@ private:
 
   PolyTessGeo *BuildPolyTessGeo(_OSENC_AreaGeometry_Record_Payload *record,
                                 unsigned char **bytes_consumed);
+  PolyTessGeo *BuildPolyTessGeo300(
+      const OSENC_AreaGeometry300_Record_Payload *record, size_t length,
+      const int **edge_index_table);
+  void AddFeatureBox(double s_lat, double n_lat, double w_lon, double e_lon);
   bool CalculateExtent(S57Reader *poReader, S57ClassRegistrar *poRegistrar);
 
   wxString errorMessage;
@@ -534,6 +674,11 @@ private:
   double m_ref_lat,
       m_ref_lon;  // Common reference point, derived from FullExtent
   std::unordered_map<int, int> m_vector_helper_hash;
+  //  Feature indexes collected while writing, by position in the file
+  uint32_t m_feature_count;
+  std::map<int, std::vector<uint32_t>> m_class_features;  ///< By OBJL
+  std::vector<PackedRTree::Box> m_feature_boxes;
+  std::vector<uint32_t> m_feature_box_ids;
   double m_LOD_meters;
   S57ClassRegistrar *m_poRegistrar;
   wxArrayString m_tmpup_array;
@@ -575,6 +720,7 @@ private:
   wxArrayString *m_UpFiles;
   bool m_bPrivateRegistrar;
   bool m_NoErrDialog;
+  const std::atomic<bool> *m_cancel;
 };
 
 #endif  // Guard
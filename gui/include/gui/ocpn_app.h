@@ -32,6 +32,7 @@
 #include <wx/app.h>
 #include <wx/cmdline.h>
 #include <wx/event.h>
+#include <wx/timer.h>
 #endif  // precompiled headers
 
 #include "model/comm_bridge.h"
@@ -95,6 +96,10 @@ private:
   ParsedCmdline m_parsed_cmdline;
   int m_exitcode;  ///< by default -2. Otherwise, forces exit(exit_code)
 
+  /** Polls the SENC builds when started with --exit_after_parse. */
+  wxTimer m_parse_done_timer;
+  void OnParseDoneTimer(wxTimerEvent& event);
+
   void InitRestListeners();
   ObsListener rest_activate_listener;
   ObsListener rest_reverse_listener;
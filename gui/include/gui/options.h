@@ -821,7 +821,9 @@ private:
   void Populate(void);
   void OnButtonRebuild(wxCommandEvent &event);
   void OnButtonClear(wxCommandEvent &event);
+  void OnButtonGpuMemory(wxCommandEvent &event);
   wxString GetTextureCacheSize(void);
+  wxString GetGpuMemoryUse(void);
 
   wxCheckBox *m_cbUseAcceleratedPanning, *m_cbTextureCompression;
   wxCheckBox *m_cbTextureCompressionCaching, *m_cbSoftwareGL,
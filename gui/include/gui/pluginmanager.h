@@ -282,7 +282,6 @@ public:
 private:
   bool CheckBlacklistedPlugin(wxString name, int major, int minor);
   bool CheckBlacklistedPlugin(opencpn_plugin* plugin);
-  void OnNewMessageType();
 
   ObservableListener evt_ais_json_listener;
   ObservableListener evt_blacklisted_plugin_listener;
@@ -299,11 +298,9 @@ private:
 
   ObservableListener m_listener_SignalK;
 
-  ObsListener m_new_msgtype_lstnr;
-
   ObsListener m_on_msg_sent_listener;
 
-  std::unordered_map<std::string, ObsListener> m_0183_listeners;
+  int m_n0183_listener;  ///< NavMsgBus batch listener handle
 
   wxBitmap* BuildDimmedToolBitmap(wxBitmap* pbmp_normal,
                                   unsigned char dim_ratio);
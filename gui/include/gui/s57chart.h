@@ -25,7 +25,10 @@
 #define S57CHART_H_
 
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <wx/wx.h>
 #include <wx/dir.h>
@@ -36,7 +39,9 @@
 
 #include "gdal/ogrsf_frmts.h"
 
+#include "model/gpu_ledger.h"
 #include "model/gui_vars.h"
+#include "model/pick_index.h"
 
 #include "chartbase.h"  // ChartBase
 #include "chartimg.h"
@@ -53,6 +58,7 @@
 extern bool chain_broken_mssage_shown; /**< Global instance */
 
 class ChartCanvas;  // circular
+struct Osenc_storage;
 
 enum {
   BUILD_SENC_OK,
@@ -253,6 +259,8 @@ public:
   int FindOrCreateSenc(const wxString &name, bool b_progress = true);
   void DisableBackgroundSENC() { m_disableBackgroundSENC = true; }
   void EnableBackgroundSENC() { m_disableBackgroundSENC = false; }
+  /** Set SENCJobPriority of background SENC builds, see senc_manager.h */
+  void SetSENCPriority(int priority) { m_SENCPriority = priority; }
 
 protected:
   void AssembleLineGeometry();
@@ -353,14 +361,51 @@ private:
   char m_usage_char;
 
   int m_LineVBO_name;
+  GpuLedger::Handle m_vbo_gpu_handle;  ///< GpuLedger entry of line VBO
 
   std::unordered_map<unsigned, VE_Element *> m_ve_hash;
   std::unordered_map<unsigned, VC_Element *> m_vc_hash;
   std::vector<connector_segment *> m_pcs_vector;
   std::vector<VE_Element *> m_pve_vector;
+  /** Edge and node points from SENC, held until AssembleLineGeometry(). */
+  std::unique_ptr<Osenc_storage> m_senc_storage;
+
+  /**
+   * Objects of class acronym from the SENC class index, in file order.
+   * @return false if the SENC has no class index.
+   */
+  bool GetClassObjects(const char *acronym,
+                       std::vector<S57Obj *> &objects) const;
+
+  /** Objects by SENC feature, nullptr if not ingested or dropped. */
+  std::vector<S57Obj *> m_features;
+  /** SENC class index, first and count in m_class_features by acronym. */
+  std::unordered_map<std::string, std::pair<uint32_t, uint32_t>>
+      m_class_ranges;
+  std::vector<uint32_t> m_class_features;
+
+  /** Area or line rules in pick index, in razRules traversal order. */
+  struct PickEntry {
+    ObjRazRules *rules;
+    uint8_t prio;  ///< razRules first index
+    uint8_t list;  ///< razRules second index
+  };
+
+  /**
+   * Index m_pick_entries by object bounding box, using the SENC spatial
+   * index when present.
+   */
+  void BuildPickIndex();
+
+  std::vector<PickEntry> m_pick_entries;
+  PickIndex m_pick_index;
+  /** SENC feature of each item of a SENC spatial index in m_pick_index. */
+  std::vector<uint32_t> m_pick_item_features;
+  bool m_pick_index_dirty;
 
   wxString m_TempFilePath;
   bool m_disableBackgroundSENC;
+  int m_SENCPriority;
 
 protected:
   sm_parms vp_transform;
@@ -24,9 +24,17 @@
 #ifndef SENCMGR_H_
 #define SENCMGR_H_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
 #include <vector>
 
 #include <wx/event.h>
+#include <wx/hashmap.h>
 #include <wx/string.h>
 #include <wx/thread.h>
 
@@ -54,6 +62,13 @@ typedef enum {
   SENC_BUILD_DONE_ERROR,
 } EVENTSENCResult;
 
+/** SENC build order, most urgent first. */
+typedef enum {
+  SENC_PRIORITY_VIEWPORT = 0,  ///< Cell needed for the current display
+  SENC_PRIORITY_ROUTE,         ///< Cell along the active route
+  SENC_PRIORITY_BACKGROUND     ///< Any other cell, e. g. when prebuilding
+} SENCJobPriority;
+
 //----------------------------------------------------------------------------
 // s57 Chart Thread based SENC job ticket
 //----------------------------------------------------------------------------
@@ -67,8 +82,9 @@ public:
   wxString m_SENCFileName;
   double ref_lat, ref_lon;
   double m_LOD_meters;
-
-  SENCBuildThread *m_thread;
+  SENCJobPriority m_priority;
+  uint64_t m_seq;        ///< Scheduling order within priority
+  bool m_remove_source;  ///< Remove temporary m_FullPath000 when done
 
   SENCThreadStatus m_status;
   EVENTSENCResult m_SENCResult;
@@ -92,44 +108,134 @@ public:
 private:
 };
 
+/** SENC build throughput, counted since the job queue was last empty. */
+struct SENCBuildStats {
+  int pending = 0;
+  int running = 0;
+  int done = 0;
+  int failed = 0;
+  int cancelled = 0;
+  double elapsed = 0;  ///< Seconds since first job of current batch
+
+  /** Return built cells per minute. */
+  double GetRate() const {
+    return elapsed > 0 ? (done + failed) * 60 / elapsed : 0;
+  }
+};
+
 /**
  * Manager for S57 chart SENC creation threads.
  * Manages the creation of SENC (Simplified Electronic Navigational Chart) files
  * from S57 charts using background threads. Handles scheduling and executing
  * SENC build jobs.
+ *
+ * Jobs are run by a fixed set of worker threads, started on first use, in
+ * SENCJobPriority order and then in scheduling order. Jobs are identified
+ * by their .000 path: scheduling a job already queued is a no-op, besides
+ * possibly raising its priority.
  */
 class SENCThreadManager : public wxEvtHandler {
 public:
   SENCThreadManager();
+
+  /**
+   * Cancel running builds, drop pending jobs and wait for the workers
+   * to exit.
+   */
   ~SENCThreadManager();
 
   void OnEvtThread(OCPN_BUILDSENC_ThreadEvent &event);
 
+  /**
+   * Queue a job. If a job for the same .000 file is already queued, ticket
+   * is deleted and the queued job gets the highest priority of the two.
+   * Ticket is also deleted if the manager is being destroyed.
+   */
   SENCThreadStatus ScheduleJob(SENCJobTicket *ticket);
+
+  /**
+   * Cancel a pending job no chart is waiting for.
+   * @return true if the job was found and removed.
+   */
+  bool CancelJob(const wxString &FullPath000);
+
+  /**
+   * Cancel all pending jobs no chart is waiting for, with given or lower
+   * priority.
+   * @return Number of cancelled jobs.
+   */
+  int CancelPending(SENCJobPriority priority);
+
   void FinishJob(SENCJobTicket *ticket);
-  void StartTopJob();
   bool IsChartInTicketlist(s57chart *chart);
   bool SetChartPointer(s57chart *chart, void *new_ptr);
+
+  /**
+   * Let the jobs of a chart being deleted run on without it.
+   * @param remove_source If true, the job removes its .000 file when done.
+   * @return true if chart had any job.
+   */
+  bool DetachChart(s57chart *chart, bool remove_source);
+
   int GetJobCount();
+  SENCBuildStats GetStats();
+
+  /**
+   * Block until a job is available and return the most urgent one, marked
+   * as started. Return nullptr when the manager is being destroyed.
+   */
+  SENCJobTicket *PopJob();
+
+  /** Account for a job done by a worker, in the worker thread. */
+  void JobDone(SENCJobTicket *ticket, bool ok);
+
+  /** Set when the manager is being destroyed, running builds abort. */
+  const std::atomic<bool> &GetCancelFlag() const { return m_stopping; }
 
   int m_max_jobs;
 
-  std::vector<SENCJobTicket *> ticket_list;
+private:
+  struct QueueEntry {
+    SENCJobPriority priority;
+    uint64_t seq;
+    wxString path;
+    bool operator<(const QueueEntry &other) const {
+      // std::priority_queue puts the largest on top.
+      if (priority != other.priority) return priority > other.priority;
+      return seq > other.seq;
+    }
+  };
+
+  void StartWorkers();
+  void UpdateAlert();
+  bool Cancel(SENCJobTicket *ticket);
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::unordered_map<wxString, SENCJobTicket *, wxStringHash, wxStringEqual>
+      m_tickets;
+  /** Pending jobs, with stale entries left by cancel and reprioritizing. */
+  std::priority_queue<QueueEntry> m_queue;
+  std::vector<SENCBuildThread *> m_workers;
+  uint64_t m_next_seq;
+  std::atomic<bool> m_stopping;
+  SENCBuildStats m_stats;
+  std::chrono::steady_clock::time_point m_batch_start;
 };
 
 //----------------------------------------------------------------------------
 // s57 Chart Thread based SENC creator
 //----------------------------------------------------------------------------
+/** Worker thread building SENCs until the manager is destroyed. */
 class SENCBuildThread : public wxThread {
 public:
-  SENCBuildThread(SENCJobTicket *ticket, SENCThreadManager *manager);
+  explicit SENCBuildThread(SENCThreadManager *manager);
   void *Entry();
 
-  wxString m_FullPath000;
-  wxString m_SENCFileName;
-  s57chart *m_chart;
+private:
+  void Build(SENCJobTicket *ticket);
+
   SENCThreadManager *m_manager;
-  SENCJobTicket *m_ticket;
 };
 
 #endif  // SENCMGR_H_
@@ -25,11 +25,18 @@
 #ifndef __TCMGR_H__
 #define __TCMGR_H__
 
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include <wx/datetime.h>
 
+#include "model/packed_rtree.h"
+#include "model/tide_series_cache.h"
+
+#include "bbox.h"
 #include "station_data.h"
 #include "idx_entry.h"
 #include "tc_error_code.h"
@@ -97,7 +104,39 @@ public:
   bool IsReady() { return bTCMReady; }
 
   bool GetTideOrCurrent(time_t t, int idx, float &value, float &dir);
+
+  /**
+   * Like GetTideOrCurrent(), but use the precomputed time series when
+   * available. Values are then interpolated between samples, see
+   * SetSeriesWindow().
+   */
+  bool GetTideOrCurrentCached(time_t t, int idx, float &value, float &dir);
+
+  /**
+   * Configure the precomputed time series used by GetTideOrCurrentCached()
+   * and to speed up event searches, dropping all samples.
+   * @param span Window half width, seconds.
+   * @param step Sample interval, seconds.
+   */
+  void SetSeriesWindow(int span, int step);
+
+  /** Move the time series windows of all stations to time t. */
+  void SetTimeSource(time_t t);
   bool GetTideOrCurrentMeters(time_t t, int idx, float &value, float &dir);
+
+  /**
+   * Evaluate a station at count times t0, t0 + step, ... with the same
+   * result as calling GetTideOrCurrent() for each time. For stations
+   * without offsets the harmonic constituents are summed for all times in
+   * one pass, rotating each constituent's phase by step rather than
+   * evaluating cos() per time.
+   * @param values Tide level or current speed, in station units.
+   * @param dirs Current direction, see GetTideOrCurrent().
+   * @return false if station data is unavailable.
+   */
+  bool GetTideOrCurrentSeries(time_t t0, int step, int count, int idx,
+                              std::vector<float> &values,
+                              std::vector<float> &dirs);
   bool GetTideOrCurrent15(time_t t, int idx, float &tcvalue, float &dir,
                           bool &bnew_val);
   bool GetTideFlowSens(time_t t, int sch_step, int idx, float &tcvalue_now,
@@ -117,8 +156,22 @@ public:
 
   int Get_max_IDX() const { return m_Combined_IDX_array.size() - 1; }
 
-  std::map<double, const IDX_entry *> GetStationsForLL(double xlat,
-                                                       double xlon) const;
+  /**
+   * Return tide stations closest to given position, keyed by distance.
+   * @param max_count Maximum number of stations returned.
+   */
+  std::map<double, const IDX_entry *> GetStationsForLL(
+      double xlat, double xlon,
+      size_t max_count = std::numeric_limits<size_t>::max()) const;
+
+  /**
+   * Return indexes of stations located in box, in ascending order.
+   * @param type 'T' for tide stations or 'C' for current stations, matching
+   *     both upper and lower case IDX_type.
+   * @param margin Box margin in degrees, see LLBBox::ContainsMarge().
+   */
+  std::vector<int> GetStationsInBBox(const LLBBox &box, char type,
+                                     double margin = 0) const;
 
   int GetStationIDXbyName(const wxString &prefix, double xlat,
                           double xlon) const;
@@ -134,6 +187,12 @@ private:
   void AddMRU(Station_Data *psd);
   void FreeMRU();
 
+  /** Look up level in the time series cache, never computing it. */
+  bool GetCachedLevel(time_t t, int idx, float &value);
+
+  /** Build m_tide_index and m_current_index from m_Combined_IDX_array. */
+  void BuildStationIndex();
+
   bool bTCMReady;
   wxString pmru_file_name;
 
@@ -141,6 +200,22 @@ private:
   std::vector<std::string> m_sourcefile_array;
 
   std::vector<IDX_entry *> m_Combined_IDX_array;
+
+  /** Station positions, x = longitude and y = latitude. */
+  PackedRTree m_tide_index;
+  PackedRTree m_current_index;
+  /** m_Combined_IDX_array index of each item in m_*_index. */
+  std::vector<int> m_tide_ids;
+  std::vector<int> m_current_ids;
+
+  /**
+   * Harmonics evaluation updates IDX_entry and static state, serialize
+   * the GUI thread and the series cache worker.
+   */
+  std::recursive_mutex m_mutex;
+  std::unique_ptr<TideSeriesCache> m_series_cache;
+  int m_series_span = 3 * 24 * 3600;
+  int m_series_step = 6 * 60;
 };
 
 /* $Id: tcd.h.in 3744 2010-08-17 22:34:46Z flaterco $ */
@@ -60,8 +60,12 @@ private:
   void Finalize();
   void Assemble(ChartCanvas *cc, std::list<std::list<wxPoint> > &pointlists,
                 const LLBBox &box, double scale, int &last, int level, int pos);
+  void AssembleLod(ChartCanvas *cc, std::list<std::list<wxPoint> > &pointlists,
+                   const LLBBox &box, const TrackLod &lod, int level);
   void AddPointToList(ChartCanvas *cc,
                       std::list<std::list<wxPoint> > &pointlists, int n);
+  void AddPixelToList(std::list<std::list<wxPoint> > &pointlists,
+                      const wxPoint &r);
   void AddPointToLists(ChartCanvas *cc,
                        std::list<std::list<wxPoint> > &pointlists, int &last,
                        int n);
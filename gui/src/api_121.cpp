@@ -840,7 +840,7 @@ bool GetNearestTideStation(double lat, double lon,
                            PlugIn_TideStation* station) {
   if (!ptcmgr || !ptcmgr->IsReady() || !station) return false;
 
-  auto stations = ptcmgr->GetStationsForLL(lat, lon);
+  auto stations = ptcmgr->GetStationsForLL(lat, lon, 1);
   for (auto& [dist, pIDX] : stations) {
     if (pIDX->IDX_type == 'T' || pIDX->IDX_type == 't') {
       // Find the array index for this IDX_entry pointer
@@ -0,0 +1,197 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement chart_dir_scan.h -- ChartDirScan
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <wx/arrstr.h>
+#include <wx/datetime.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+
+#include "model/worker_pool.h"
+
+#include "chart_dir_scan.h"
+#include "flex_hash.h"
+
+static ChartDirFile MakeFile(const wxString &path) {
+  wxFileName fn(path);
+  ChartDirFile file;
+  file.path = fn.GetFullPath();
+  file.name = fn.GetFullName();
+  wxULongLong size = fn.GetSize();
+  file.size = (size != wxInvalidSize) ? size : 0;
+  wxDateTime t = fn.GetModificationTime();
+  if (t.IsValid()) file.mtime = t.GetTicks();
+  return file;
+}
+
+void ChartDirScan::ListFiles(const wxString &dir_path, int flags,
+                             std::vector<ChartDirFile> &files) {
+  wxDir dir(dir_path);
+  if (!dir.IsOpened()) return;
+  wxString prefix = dir.GetName() + wxFILE_SEP_PATH;
+  wxString name;
+  for (bool cont = dir.GetFirst(&name, wxEmptyString, flags); cont;
+       cont = dir.GetNext(&name)) {
+    files.push_back(MakeFile(prefix + name));
+  }
+}
+
+void ChartDirScan::ListTree(const wxString &dir_path,
+                            std::vector<ChartDirFile> &files) {
+  wxArrayString paths;
+  wxDir::GetAllFiles(dir_path, &paths);
+  files.reserve(files.size() + paths.size());
+  for (const auto &path : paths) files.push_back(MakeFile(path));
+}
+
+void ChartDirScan::Run(std::vector<ChartDirScan> &scans, WorkerPool &pool,
+                       const Progress &progress) {
+  // One job for the top level files of each tree and one for each top
+  // level sub-directory, so that a single large tree is also split.
+  struct Job {
+    size_t scan;
+    wxString dir;
+    bool recurse;
+    std::vector<ChartDirFile> files;
+  };
+  std::vector<Job> jobs;
+  for (size_t i = 0; i < scans.size(); i++) {
+    ChartDirScan &scan = scans[i];
+    scan.m_files.clear();
+    scan.m_listed = false;
+    if (!scan.m_enumerate || !wxDir::Exists(scan.m_dir_path)) continue;
+    wxDir dir(scan.m_dir_path);
+    if (!dir.IsOpened()) continue;
+    scan.m_listed = true;
+    jobs.push_back({i, scan.m_dir_path, false, {}});
+    wxString prefix = dir.GetName() + wxFILE_SEP_PATH;
+    wxString name;
+    for (bool cont = dir.GetFirst(&name, wxEmptyString,
+                                  wxDIR_DIRS | wxDIR_HIDDEN);
+         cont; cont = dir.GetNext(&name)) {
+      jobs.push_back({i, prefix + name, true, {}});
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable done_cv;
+  size_t done = 0;
+  for (auto &job : jobs) {
+    pool.Post([&job, &mutex, &done_cv, &done] {
+      if (job.recurse)
+        ListTree(job.dir, job.files);
+      else
+        ListFiles(job.dir, wxDIR_FILES | wxDIR_HIDDEN, job.files);
+      std::lock_guard<std::mutex> lock(mutex);
+      done++;
+      done_cv.notify_all();
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (done < jobs.size()) {
+      done_cv.wait_for(lock, std::chrono::milliseconds(100));
+      if (progress) {
+        size_t n = done;
+        lock.unlock();
+        progress(n, jobs.size());
+        lock.lock();
+      }
+    }
+  }
+
+  for (auto &job : jobs) {
+    auto &files = scans[job.scan].m_files;
+    if (files.empty()) {
+      files.swap(job.files);
+    } else {
+      files.insert(files.end(), std::make_move_iterator(job.files.begin()),
+                   std::make_move_iterator(job.files.end()));
+    }
+  }
+  for (auto &scan : scans) {
+    std::sort(scan.m_files.begin(), scan.m_files.end(),
+              [](const ChartDirFile &a, const ChartDirFile &b) {
+                return a.path < b.path;
+              });
+  }
+}
+
+wxString ChartDirScan::GetMagic() const {
+  // Magic numbers are stored in the config file: changing the hash makes
+  // all chart directories look modified on next update.
+  wxULongLong nacc = 0;
+  FlexHash hash(sizeof nacc);
+  hash.Reset();
+  for (const auto &file : m_files) {
+    wxScopedCharBuffer path_utf8 = file.path.ToUTF8();
+    hash.Update(path_utf8.data(), path_utf8.length());
+    wxULongLong file_size = file.size;
+    hash.Update(&file_size, sizeof file_size);
+    wxULongLong file_time = file.mtime;
+    hash.Update(&file_time, sizeof file_time);
+  }
+  hash.Finish();
+  hash.Receive(&nacc);
+  return nacc.ToString();
+}
+
+std::vector<const ChartDirFile *> ChartDirScan::GetMatchingFiles(
+    const std::vector<wxString> &specs) const {
+  std::vector<const ChartDirFile *> result;
+#ifdef __WXMSW__
+  std::vector<wxString> upper_specs;
+  for (const auto &spec : specs) upper_specs.push_back(spec.Upper());
+#endif
+  for (const auto &file : m_files) {
+#ifdef __WXMSW__
+    wxString name = file.name.Upper();
+    const auto &match_specs = upper_specs;
+#else
+    const wxString &name = file.name;
+    const auto &match_specs = specs;
+#endif
+    for (const auto &spec : match_specs) {
+      if (name.Matches(spec)) {
+        result.push_back(&file);
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+wxString ChartDirScan::FindGshhgDir() const {
+  for (const auto &file : m_files) {
+    if (!file.name.Matches("poly-*-1.dat")) continue;
+    wxFileName fn(file.path);
+    wxFileName dir(fn.GetPath());
+    if (dir.GetFullName().IsSameAs("GSHHG", false))
+      return fn.GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR);
+  }
+  return wxEmptyString;
+}
@@ -481,27 +481,14 @@ int ChartDB::BuildChartStack(ChartStack *cstk, float lat, float lon,
 
   if (!cstk) return 0;  // Chartstack not ready yet
 
-  int nEntry = GetChartTableEntries();
-
-  for (int db_index = 0; db_index < nEntry; db_index++) {
+  //  Candidates are the charts in the currently active group whose bounding
+  //  box, possibly shifted across the dateline, contains the position.
+  for (int db_index : GetChartsAtPosition(lat, lon, groupIndex)) {
     const ChartTableEntry &cte = GetChartTableEntry(db_index);
 
     // Skip any charts in Exclude array
     if (IsChartDirectoryExcluded(cte.GetFullPath())) continue;
 
-    //    Check to see if the candidate chart is in the currently active group
-    bool b_group_add = false;
-    if (groupIndex > 0) {
-      const int ng = cte.GetGroupArray().size();
-      for (int ig = 0; ig < ng; ig++) {
-        if (groupIndex == cte.GetGroupArray()[ig]) {
-          b_group_add = true;
-          break;
-        }
-      }
-    } else
-      b_group_add = true;
-
     bool b_writable_add = true;
     //  On android, SDK > 29, we require that the directory of charts be
     //  "writable" as determined by Android Java file system
@@ -511,7 +498,7 @@ int ChartDB::BuildChartStack(ChartStack *cstk, float lat, float lon,
 #endif
 
     bool b_pos_add = false;
-    if (b_group_add && b_writable_add) {
+    if (b_writable_add) {
       //  Plugin loading is deferred, so the chart may have been disabled
       //  elsewhere. Tentatively reenable the chart so that it appears in the
       //  piano. It will get disabled later if really not useable
@@ -539,7 +526,7 @@ int ChartDB::BuildChartStack(ChartStack *cstk, float lat, float lon,
 
     bool b_available = true;
     //  Verify PlugIn charts are actually available
-    if (b_group_add && b_pos_add && (cte.GetChartType() == CHART_TYPE_PLUGIN)) {
+    if (b_pos_add && (cte.GetChartType() == CHART_TYPE_PLUGIN)) {
       ChartTableEntry *pcte = (ChartTableEntry *)&cte;
       if (!IsChartAvailable(db_index)) {
         pcte->SetAvailable(false);
@@ -550,7 +537,7 @@ int ChartDB::BuildChartStack(ChartStack *cstk, float lat, float lon,
       }
     }
 
-    if (b_group_add && b_pos_add && b_available) {  // add it
+    if (b_pos_add && b_available) {  // add it
       j++;
       cstk->nEntry = j;
       cstk->SetDBIndex(j - 1, db_index);
@@ -636,21 +623,8 @@ int ChartDB::BuildChartStack(ChartStack *cstk, float lat, float lon,
 }
 
 bool ChartDB::IsChartInGroup(const int db_index, const int group) {
-  ChartTableEntry *pt = (ChartTableEntry *)&GetChartTableEntry(db_index);
-
-  //    Check to see if the candidate chart is in the designated group
-  bool b_in_group = false;
-  if (group > 0) {
-    for (unsigned int ig = 0; ig < pt->GetGroupArray().size(); ig++) {
-      if (group == pt->GetGroupArray()[ig]) {
-        b_in_group = true;
-        break;
-      }
-    }
-  } else
-    b_in_group = true;
-
-  return b_in_group;
+  if (group <= 0) return true;
+  return GetSpatialIndex().IsInGroup(db_index, group);
 }
 
 bool ChartDB::IsENCInGroup(const int groupIndex) {
@@ -30,6 +30,9 @@
 #include <wx/wx.h>
 #endif
 
+#include <algorithm>
+#include <thread>
+
 #include <wx/arrimpl.cpp>
 #include <wx/dir.h>
 #include <wx/encconv.h>
@@ -39,10 +42,12 @@
 #include <wx/evtloop.h>
 
 #include "model/gui_events.h"
+#include "model/raster_tile_cache.h"
+#include "model/worker_pool.h"
 
+#include "chart_dir_scan.h"
 #include "chartbase.h"
 #include "chartdbs.h"
-#include "flex_hash.h"
 #include "LOD_reduce.h"
 #include "mbtiles.h"
 #include "navutil.h"
@@ -128,14 +133,12 @@ bool ChartTableHeader::CheckValid() {
 
     //          return false;       // no match....
 
-    // Try previous version....
-    sprintf(vb, "V%03d", DB_VERSION_PREVIOUS);
-    if (strncmp(vb, dbVersion, sizeof(dbVersion)))
+    // Try previous versions....
+    int version = dbVersion[0] == 'V' ? atoi(vbo + 1) : 0;
+    if (version < DB_VERSION_OLDEST || version > DB_VERSION_PREVIOUS)
       return false;
     else {
-      wxLogMessage(
-          "   Scheduling db upgrade to current db version on "
-          "Options->Charts page visit...");
+      wxLogMessage("   Upgrading db to current db version...");
       return true;
     }
 
@@ -382,20 +385,56 @@ ChartTableEntry::ChartTableEntry(ChartBase &theChart, wxString &utf8Path) {
 
 ChartTableEntry::~ChartTableEntry() {
   // free(pFullPath);
-  free(pPlyTable);
+  FreePlyTables();
 
-  for (int i = 0; i < nAuxPlyEntries; i++) free(pAuxPlyTable[i]);
-  free(pAuxPlyTable);
-  free(pAuxCntTable);
+  delete m_pfilename;
+  delete m_psFullPath;
+}
 
-  if (nNoCovrPlyEntries) {
-    for (int i = 0; i < nNoCovrPlyEntries; i++) free(pNoCovrPlyTable[i]);
+void ChartTableEntry::FreePlyTables() {
+  //  Tables referring to a mapped database are not ours, except for the
+  //  pointer arrays.
+  bool owned = !m_mapping;
+  bool owns_counts = owned || m_ownsCounts;
+
+  if (owned) free(pPlyTable);
+
+  if (pAuxPlyTable) {
+    if (owned)
+      for (int i = 0; i < nAuxPlyEntries; i++) free(pAuxPlyTable[i]);
+    free(pAuxPlyTable);
+  }
+  if (owns_counts) free(pAuxCntTable);
+
+  if (pNoCovrPlyTable) {
+    if (owned)
+      for (int i = 0; i < nNoCovrPlyEntries; i++) free(pNoCovrPlyTable[i]);
     free(pNoCovrPlyTable);
-    free(pNoCovrCntTable);
   }
+  if (owns_counts) free(pNoCovrCntTable);
 
-  delete m_pfilename;
-  delete m_psFullPath;
+  pPlyTable = NULL;
+  pAuxPlyTable = NULL;
+  pAuxCntTable = NULL;
+  pNoCovrPlyTable = NULL;
+  pNoCovrCntTable = NULL;
+  m_mapping.reset();
+  m_ownsCounts = false;
+}
+
+void ChartTableEntry::SetPathMembers() {
+  m_pfilename = new wxString;
+  wxString fullfilename(pFullPath, wxConvUTF8);
+  wxFileName fn(fullfilename);
+  *m_pfilename = fn.GetFullName();
+  m_psFullPath = new wxString;
+  *m_psFullPath = fullfilename;
+  m_fullSystemPath = fullfilename;
+  m_FullPath = std::string(pFullPath);
+
+#ifdef __ANDROID__
+  m_fullSystemPath = wxString(fullfilename.mb_str(wxConvUTF8));
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -488,18 +527,8 @@ bool ChartTableEntry::Read(const ChartDatabase *pDb, wxInputStream &is) {
     wxLogVerbose("  Chart %s", pFullPath);
 
     //  Create and populate the helper members
-    m_pfilename = new wxString;
-    wxString fullfilename(pFullPath, wxConvUTF8);
-    wxFileName fn(fullfilename);
-    *m_pfilename = fn.GetFullName();
-    m_psFullPath = new wxString;
-    *m_psFullPath = fullfilename;
-    m_fullSystemPath = fullfilename;
-    m_FullPath = std::string(pFullPath);
+    SetPathMembers();
 
-#ifdef __ANDROID__
-    m_fullSystemPath = wxString(fullfilename.mb_str(wxConvUTF8));
-#endif
     // Read the table entry
     ChartTableEntry_onDisk_18 cte;
     is.Read(&cte, sizeof(ChartTableEntry_onDisk_18));
@@ -811,12 +840,121 @@ bool ChartTableEntry::Read(const ChartDatabase *pDb, wxInputStream &is) {
 
 ///////////////////////////////////////////////////////////////////////
 
-bool ChartTableEntry::Write(const ChartDatabase *pDb, wxOutputStream &os) {
-  os.Write(pFullPath, strlen(pFullPath) + 1);
+bool ChartTableEntry::Read(const ChartTableEntry_onDisk_19 &cte,
+                           const char *path,
+                           std::shared_ptr<MappedFile> mapping,
+                           const uint8_t *ply_data) {
+  Clear();
+
+  pFullPath = (char *)malloc(cte.pathLength + 1);
+  memcpy(pFullPath, path, cte.pathLength);
+  pFullPath[cte.pathLength] = 0;
+  wxLogVerbose("  Chart %s", pFullPath);
+  SetPathMembers();
+
+  EntryOffset = cte.EntryOffset;
+  ChartType = cte.ChartType;
+  ChartFamily = cte.ChartFamily;
+  LatMax = cte.LatMax;
+  LatMin = cte.LatMin;
+  LonMax = cte.LonMax;
+  LonMin = cte.LonMin;
+
+  m_bbox.Set(LatMin, LonMin, LatMax, LonMax);
+
+  Skew = cte.skew;
+  ProjectionType = cte.ProjectionType;
+
+  SetScale(cte.Scale);
+  edition_date = cte.edition_date;
+  file_date = cte.file_date;
+
+  nPlyEntries = cte.nPlyEntries;
+  nAuxPlyEntries = cte.nAuxPlyEntries;
+  nNoCovrPlyEntries = cte.nNoCovrPlyEntries;
+  bValid = cte.bValid != 0;
+
+  //  Just set up the pointers, the OS loads the pages when actually used.
+  //  All tables are set up here rather than on first use, entries are read
+  //  concurrently by several threads.
+  if (nPlyEntries < 0 || nAuxPlyEntries < 0 || nNoCovrPlyEntries < 0 ||
+      (uint64_t)nPlyEntries * 2 * sizeof(float) > cte.plySize) {
+    free(pFullPath);
+    delete m_pfilename;
+    delete m_psFullPath;
+    Clear();
+    return false;
+  }
+  m_mapping = std::move(mapping);
+  pPlyTable = nPlyEntries ? (float *)ply_data : NULL;
+  if (nAuxPlyEntries || nNoCovrPlyEntries) MapPlyTables(ply_data, cte.plySize);
+  return true;
+}
+
+void ChartTableEntry::MapPlyTables(const uint8_t *data, uint64_t size) {
+  const uint8_t *p = data + nPlyEntries * 2 * sizeof(float);
+  const uint8_t *end = data + size;
+
+  if (nAuxPlyEntries)
+    pAuxPlyTable = (float **)calloc(nAuxPlyEntries, sizeof(float *));
+  if (nNoCovrPlyEntries)
+    pNoCovrPlyTable = (float **)calloc(nNoCovrPlyEntries, sizeof(float *));
+
+  //  Set up pointers for one set of tables, false if block is broken.
+  auto map_tables = [&](int n, int *&counts, float **tables) {
+    if (end - p < (ptrdiff_t)(n * sizeof(int))) return false;
+    counts = (int *)p;
+    p += n * sizeof(int);
+    for (int i = 0; i < n; i++) {
+      if (counts[i] < 0 ||
+          end - p < (ptrdiff_t)(counts[i] * 2 * sizeof(float)))
+        return false;
+      tables[i] = (float *)p;
+      p += counts[i] * 2 * sizeof(float);
+    }
+    return true;
+  };
+  if (map_tables(nAuxPlyEntries, pAuxCntTable, pAuxPlyTable) &&
+      map_tables(nNoCovrPlyEntries, pNoCovrCntTable, pNoCovrPlyTable))
+    return;
 
-  //      Write the current version type only
-  //      Create an on_disk table entry
-  ChartTableEntry_onDisk_18 cte;
+  //  Truncated or otherwise broken block, use empty tables instead.
+  wxLogMessage("Chartdb: bad ply point data for %s", pFullPath);
+  pAuxCntTable = (int *)calloc(nAuxPlyEntries, sizeof(int));
+  pNoCovrCntTable = (int *)calloc(nNoCovrPlyEntries, sizeof(int));
+  m_ownsCounts = true;
+}
+
+void ChartTableEntry::DetachMapping() {
+  if (!m_mapping) return;
+
+  auto copy = [](const void *src, size_t size) {
+    void *dest = malloc(size);
+    if (size) memcpy(dest, src, size);
+    return dest;
+  };
+  float *ply = (float *)copy(pPlyTable, nPlyEntries * 2 * sizeof(float));
+  int *aux_cnt = (int *)copy(pAuxCntTable, nAuxPlyEntries * sizeof(int));
+  float **aux = (float **)malloc(nAuxPlyEntries * sizeof(float *));
+  for (int i = 0; i < nAuxPlyEntries; i++)
+    aux[i] = (float *)copy(pAuxPlyTable[i], aux_cnt[i] * 2 * sizeof(float));
+  int *nc_cnt = (int *)copy(pNoCovrCntTable, nNoCovrPlyEntries * sizeof(int));
+  float **nc = (float **)malloc(nNoCovrPlyEntries * sizeof(float *));
+  for (int i = 0; i < nNoCovrPlyEntries; i++)
+    nc[i] = (float *)copy(pNoCovrPlyTable[i], nc_cnt[i] * 2 * sizeof(float));
+
+  FreePlyTables();
+  pPlyTable = ply;
+  pAuxCntTable = aux_cnt;
+  pAuxPlyTable = aux;
+  pNoCovrCntTable = nc_cnt;
+  pNoCovrPlyTable = nc;
+}
+
+void ChartTableEntry::GetOnDisk(ChartTableEntry_onDisk_19 &cte,
+                                uint32_t path_offset,
+                                uint64_t ply_offset) const {
+  memset(&cte, 0, sizeof(cte));
 
   //    Transcribe the elements....
   cte.EntryOffset = EntryOffset;
@@ -831,46 +969,48 @@ bool ChartTableEntry::Write(const ChartDatabase *pDb, wxOutputStream &os) {
   cte.edition_date = edition_date;
   cte.file_date = file_date;
 
-  cte.nPlyEntries = nPlyEntries;
-  cte.nAuxPlyEntries = nAuxPlyEntries;
-
   cte.skew = Skew;
   cte.ProjectionType = ProjectionType;
 
-  cte.bValid = bValid;
-
+  cte.nPlyEntries = nPlyEntries;
+  cte.nAuxPlyEntries = nAuxPlyEntries;
   cte.nNoCovrPlyEntries = nNoCovrPlyEntries;
 
-  os.Write(&cte, sizeof(ChartTableEntry_onDisk_18));
-  wxLogVerbose("  Wrote Chart %s", pFullPath);
+  cte.pathOffset = path_offset;
+  cte.pathLength = strlen(pFullPath);
+  cte.bValid = bValid;
+  cte.plyOffset = ply_offset;
+  cte.plySize = GetPlyDataSize();
+}
 
-  //      Write out the tables
-  if (nPlyEntries) {
-    int npeSize = nPlyEntries * 2 * sizeof(float);
-    os.Write(pPlyTable, npeSize);
-  }
+uint64_t ChartTableEntry::GetPlyDataSize() const {
+  uint64_t size = nPlyEntries * 2 * sizeof(float);
+  size += nAuxPlyEntries * sizeof(int);
+  for (int i = 0; i < nAuxPlyEntries; i++)
+    size += GetAuxCntTableEntry(i) * 2 * sizeof(float);
+  size += nNoCovrPlyEntries * sizeof(int);
+  for (int i = 0; i < nNoCovrPlyEntries; i++)
+    size += GetNoCovrCntTableEntry(i) * 2 * sizeof(float);
+  return size;
+}
 
-  if (nAuxPlyEntries) {
-    int napeSize = nAuxPlyEntries * sizeof(int);
-    os.Write(pAuxCntTable, napeSize);
+bool ChartTableEntry::WritePlyData(wxOutputStream &os) const {
+  if (nPlyEntries) os.Write(pPlyTable, nPlyEntries * 2 * sizeof(float));
 
-    for (int nAuxPlyEntry = 0; nAuxPlyEntry < nAuxPlyEntries; nAuxPlyEntry++) {
-      int nfSize = pAuxCntTable[nAuxPlyEntry] * 2 * sizeof(float);
-      os.Write(pAuxPlyTable[nAuxPlyEntry], nfSize);
-    }
+  if (nAuxPlyEntries) {
+    os.Write(pAuxCntTable, nAuxPlyEntries * sizeof(int));
+    for (int i = 0; i < nAuxPlyEntries; i++)
+      os.Write(pAuxPlyTable[i], pAuxCntTable[i] * 2 * sizeof(float));
   }
 
   if (nNoCovrPlyEntries) {
-    int ncSize = nNoCovrPlyEntries * sizeof(int);
-    os.Write(pNoCovrCntTable, ncSize);
-
-    for (int i = 0; i < nNoCovrPlyEntries; i++) {
-      int nctSize = pNoCovrCntTable[i] * 2 * sizeof(float);
-      os.Write(pNoCovrPlyTable[i], nctSize);
-    }
+    os.Write(pNoCovrCntTable, nNoCovrPlyEntries * sizeof(int));
+    for (int i = 0; i < nNoCovrPlyEntries; i++)
+      os.Write(pNoCovrPlyTable[i], pNoCovrCntTable[i] * 2 * sizeof(float));
   }
+  wxLogVerbose("  Wrote Chart %s", pFullPath);
 
-  return true;
+  return os.IsOk();
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -891,6 +1031,10 @@ void ChartTableEntry::Clear() {
   m_pfilename = NULL;  // a helper member, not on disk
   m_psFullPath = NULL;
   Scale = 1e8;  // Very small scale
+
+  //  Ownership of any tables has been passed on, just drop the references.
+  m_mapping.reset();
+  m_ownsCounts = false;
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -1197,17 +1341,11 @@ void ChartDatabase::OnEvtThread(OCPN_ChartTableEntryThreadEvent &event) {
     bool collision_found = false;
     if (ticket->b_thread_safe) {
       wxFileName fn(ticket->m_ChartPath);
-      ChartCollisionsHashMap::iterator it;
-      for (it = m_full_collision_map.begin(); it != m_full_collision_map.end();
-           ++it) {
-        if (it->first.IsSameAs(fn.GetFullName())) {
-          // Two files found with identical file name
-          // For now, just drop this ticket
-          // TODO Make an (expensive) test on file modification times
-          collision_found = true;
-          break;
-        }
-      }
+      // Two files found with identical file name
+      // For now, just drop this ticket
+      // TODO Make an (expensive) test on file modification times
+      collision_found = m_full_collision_map.find(fn.GetFullName()) !=
+                        m_full_collision_map.end();
       if (!collision_found) {
         m_full_collision_map[fn.GetFullName()] = 1;
       }
@@ -1238,6 +1376,11 @@ void ChartDatabase::OnEvtThread(OCPN_ChartTableEntryThreadEvent &event) {
 void ChartDatabase::FinalizeChartUpdate() {
   // Scrub CTE list, remove any invalid entries,
   //  as tagged by directory removal
+  for (const auto &cte : active_chartTable) {
+    if (!cte->GetbValid())
+      RasterTileCache::GetInstance().Erase(
+          cte->GetFullSystemPath().ToUTF8().data());
+  }
   active_chartTable.erase(
       std::remove_if(active_chartTable.begin(), active_chartTable.end(),
                      [](const auto &cte) { return !cte->GetbValid(); }),
@@ -1253,6 +1396,7 @@ void ChartDatabase::FinalizeChartUpdate() {
     cte->SetEntryOffset(i);
     i++;
   }
+  m_spatial_index.Invalidate();
 
   m_nentries = active_chartTable.size();
   bValid = true;
@@ -1400,6 +1544,58 @@ ChartTableEntry &ChartDatabase::GetChartTableEntry(int index) {
     return m_ChartTableEntryDummy;
 }
 
+ChartIndexEntry ChartDatabase::MakeIndexEntry(
+    const ChartTableEntry &cte) const {
+  ChartIndexEntry entry;
+  entry.lat_min = cte.GetLatMin();
+  entry.lat_max = cte.GetLatMax();
+  //  Index disabled charts as if enabled, see ChartTableEntry::ReEnable()
+  if (entry.lat_max > 90.) {
+    entry.lat_min -= 1000.;
+    entry.lat_max -= 1000.;
+  }
+  entry.lon_min = cte.GetLonMin();
+  entry.lon_max = cte.GetLonMax();
+
+  //  The LLBBox is used for viewport tests, make sure it is covered too.
+  const LLBBox &box = cte.GetBBox();
+  if (box.GetValid()) {
+    entry.lat_min = wxMin(entry.lat_min, box.GetMinLat());
+    entry.lat_max = wxMax(entry.lat_max, box.GetMaxLat());
+    entry.lon_min = wxMin(entry.lon_min, box.GetMinLon());
+    entry.lon_max = wxMax(entry.lon_max, box.GetMaxLon());
+  }
+  entry.always = cte.GetChartType() == CHART_TYPE_CM93COMP;
+  entry.groups = cte.GetGroupArray();
+  return entry;
+}
+
+ChartSpatialIndex &ChartDatabase::GetSpatialIndex() {
+  if (!m_spatial_index.IsValid() ||
+      m_spatial_index.Size() != active_chartTable.size()) {
+    std::vector<ChartIndexEntry> entries;
+    entries.reserve(active_chartTable.size());
+    for (const auto &cte : active_chartTable)
+      entries.push_back(MakeIndexEntry(*cte));
+    m_spatial_index.Build(std::move(entries));
+  }
+  return m_spatial_index;
+}
+
+std::vector<int> ChartDatabase::GetChartsAtPosition(float lat, float lon,
+                                                    int group) {
+  return GetSpatialIndex().QueryPoint(lat, lon, group);
+}
+
+std::vector<int> ChartDatabase::GetChartsInBBox(const LLBBox &box,
+                                                int group) {
+  //  Nothing intersects an invalid box, only CM93 composite is returned.
+  if (!box.GetValid())
+    return GetSpatialIndex().QueryBox(1., -1., 0., 0., group);
+  return GetSpatialIndex().QueryBox(box.GetMinLat(), box.GetMaxLat(),
+                                    box.GetMinLon(), box.GetMaxLon(), group);
+}
+
 bool ChartDatabase::CompareChartDirArray(ArrayOfCDI &test_array) {
   //  Compare the parameter "test_array" with this.m_dir_array
   //    Return true if functionally identical (order does not signify).
@@ -1446,6 +1642,17 @@ bool ChartDatabase::Read(const wxString &filePath) {
 
   m_DBFileName = filePath;
 
+  //  The current format is memory mapped, older ones are read as a stream
+  //  and upgraded.
+  auto mapping = std::make_shared<MappedFile>(filePath.ToUTF8().data());
+  if (mapping->IsOpen() && mapping->Size() >= 4) {
+    char vb[5];
+    sprintf(vb, "V%03d", DB_VERSION_CURRENT);
+    if (!strncmp(vb, (const char *)mapping->Data(), 4))
+      return ReadMapped(std::move(mapping));
+  }
+  mapping.reset();
+
   wxFFileInputStream ifs(filePath);
   if (!ifs.Ok()) return false;
 
@@ -1460,6 +1667,9 @@ bool ChartDatabase::Read(const wxString &filePath) {
   m_dbversion = atoi(&vbo[1]);
   s_dbVersion = m_dbversion;  // save the static copy
 
+  //  Current version is only read memory mapped, see above.
+  if (m_dbversion == DB_VERSION_CURRENT) return false;
+
   wxLogVerbose("Chartdb:Reading %d directory entries, %d table entries",
                cth.GetDirEntries(), cth.GetTableEntries());
   wxLogMessage("Chartdb: Chart directory list follows");
@@ -1497,18 +1707,109 @@ bool ChartDatabase::Read(const wxString &filePath) {
   entry.Clear();
   bValid = true;
   entry.SetAvailable(true);
+  m_spatial_index.Invalidate();
 
   m_nentries = active_chartTable.size();
+
+  //  Same contents, just a different layout: rewrite as current version.
+  //  Write() replaces the file, which fails on Windows while it is open.
+  ifs.GetFile()->Close();
+  wxLogMessage("Chartdb: upgrading chart db version %d to version %d",
+               m_dbversion, DB_VERSION_CURRENT);
+  if (Write(filePath)) s_dbVersion = DB_VERSION_CURRENT;
   return true;
 
 read_error:
   bValid = false;
+  m_spatial_index.Clear();
   m_nentries = active_chartTable.size();
   return false;
 }
 
 ///////////////////////////////////////////////////////////////////////
 
+bool ChartDatabase::ReadMapped(std::shared_ptr<MappedFile> mapping) {
+  const uint8_t *data = mapping->Data();
+  ChartTableHeader_19 cth;
+  if (!mapping->Contains(0, sizeof(cth))) return false;
+  memcpy(&cth, data, sizeof(cth));
+
+  if (cth.fileSize != mapping->Size() ||
+      cth.entrySize != sizeof(ChartTableEntry_onDisk_19) ||
+      cth.dirOffset > cth.entryOffset || cth.pathOffset > cth.plyOffset ||
+      !mapping->Contains(cth.entryOffset,
+                         (uint64_t)cth.nTableEntries * cth.entrySize) ||
+      !mapping->Contains(cth.plyOffset, 0)) {
+    wxLogMessage("Chartdb: corrupt chart db file %s", m_DBFileName);
+    return false;
+  }
+  m_dbversion = DB_VERSION_CURRENT;
+  s_dbVersion = m_dbversion;
+  wxLogMessage("Loading chart db version: V%03d", m_dbversion);
+
+  //  Ply points are accessed for charts in view, no point reading ahead.
+  mapping->Advise(MappedFile::Access::kRandom);
+
+  wxLogVerbose("Chartdb:Reading %d directory entries, %d table entries",
+               cth.nDirEntries, cth.nTableEntries);
+  wxLogMessage("Chartdb: Chart directory list follows");
+  if (0 == cth.nDirEntries) wxLogMessage("  Nil");
+
+  uint64_t pos = cth.dirOffset;
+  for (uint32_t iDir = 0; iDir < cth.nDirEntries; iDir++) {
+    int32_t dirlen;
+    if (!mapping->Contains(pos, sizeof(dirlen))) goto read_error;
+    memcpy(&dirlen, data + pos, sizeof(dirlen));
+    pos += sizeof(dirlen);
+    if (dirlen < 0 || !mapping->Contains(pos, dirlen)) goto read_error;
+    wxString dir = wxString::FromUTF8((const char *)data + pos, dirlen);
+    pos += dirlen;
+
+    wxString msg;
+    msg.Printf("  Chart directory #%d: ", iDir);
+    msg.Append(dir);
+    wxLogMessage(msg);
+    m_chartDirs.Add(dir);
+  }
+
+  {
+    uint64_t path_size = cth.plyOffset - cth.pathOffset;
+    uint64_t ply_size = cth.fileSize - cth.plyOffset;
+    ChartTableEntry entry;
+    active_chartTable.reserve(cth.nTableEntries);
+    active_chartTable_pathindex.clear();
+    for (uint32_t i = 0; i < cth.nTableEntries; i++) {
+      ChartTableEntry_onDisk_19 cte;
+      memcpy(&cte, data + cth.entryOffset + (uint64_t)i * cth.entrySize,
+             sizeof(cte));
+      if ((uint64_t)cte.pathOffset + cte.pathLength >= path_size ||
+          cte.plyOffset > ply_size || cte.plySize > ply_size - cte.plyOffset)
+        goto read_error;
+      const char *path = (const char *)data + cth.pathOffset + cte.pathOffset;
+      if (!entry.Read(cte, path, mapping,
+                      data + cth.plyOffset + cte.plyOffset))
+        goto read_error;
+      active_chartTable_pathindex[entry.GetFullSystemPath()] = i;
+      active_chartTable.push_back(std::make_shared<ChartTableEntry>(entry));
+    }
+    entry.Clear();
+  }
+
+  bValid = true;
+  m_spatial_index.Invalidate();
+  m_nentries = active_chartTable.size();
+  return true;
+
+read_error:
+  wxLogMessage("Chartdb: corrupt chart db file %s", m_DBFileName);
+  active_chartTable.clear();
+  active_chartTable_pathindex.clear();
+  m_chartDirs.Clear();
+  m_spatial_index.Clear();
+  m_nentries = 0;
+  return false;
+}
+
 bool ChartDatabase::Write(const wxString &filePath) {
   wxFileName file(filePath);
   wxFileName dir(
@@ -1516,27 +1817,87 @@ bool ChartDatabase::Write(const wxString &filePath) {
 
   if (!dir.DirExists() && !dir.Mkdir()) return false;
 
-  wxFFileOutputStream ofs(filePath);
-  if (!ofs.Ok()) return false;
-
-  ChartTableHeader cth(m_chartDirs.GetCount(), active_chartTable.size());
-  cth.Write(ofs);
+  //  Compute the layout, see ChartTableHeader_19
+  auto align8 = [](uint64_t v) { return (v + 7) & ~(uint64_t)7; };
 
-  for (int iDir = 0; iDir < cth.GetDirEntries(); iDir++) {
-    wxString dir1 = m_chartDirs[iDir];
-    int dirlen = dir1.length();
-    char s[200];
-    strncpy(s, dir1.mb_str(wxConvUTF8), 199);
-    s[199] = 0;
-    dirlen = strlen(s);
-    ofs.Write(&dirlen, sizeof(int));
-    //        ofs.Write(dir.fn_str(), dirlen);
-    ofs.Write(s, dirlen);
+  std::vector<std::string> dirs;
+  uint64_t dir_size = 0;
+  for (unsigned int iDir = 0; iDir < m_chartDirs.GetCount(); iDir++) {
+    dirs.push_back(std::string(m_chartDirs[iDir].ToUTF8().data()));
+    dir_size += sizeof(int32_t) + dirs.back().size();
   }
+  std::vector<uint32_t> path_offsets;
+  std::vector<uint64_t> ply_offsets;
+  uint64_t path_size = 0;
+  uint64_t ply_size = 0;
+  for (const auto &cte : active_chartTable) {
+    path_offsets.push_back(path_size);
+    path_size += strlen(cte->GetpFullPath()) + 1;
+    ply_offsets.push_back(ply_size);
+    ply_size += cte->GetPlyDataSize();
+  }
+
+  ChartTableHeader_19 cth;
+  memset(&cth, 0, sizeof(cth));
+  char vb[5];
+  sprintf(vb, "V%03d", DB_VERSION_CURRENT);
+  memcpy(cth.dbVersion, vb, 4);
+  cth.nTableEntries = active_chartTable.size();
+  cth.nDirEntries = dirs.size();
+  cth.entrySize = sizeof(ChartTableEntry_onDisk_19);
+  cth.dirOffset = align8(sizeof(cth));
+  cth.entryOffset = align8(cth.dirOffset + dir_size);
+  cth.pathOffset = cth.entryOffset + cth.nTableEntries * cth.entrySize;
+  cth.plyOffset = align8(cth.pathOffset + path_size);
+  cth.fileSize = cth.plyOffset + ply_size;
+
+  //  The current file may be mapped: write a new one and rename it.
+  wxString tmpPath = filePath + ".tmp";
+  {
+    wxFFileOutputStream ofs(tmpPath);
+    if (!ofs.Ok()) return false;
+
+    uint64_t pos = 0;
+    auto write = [&](const void *buf, size_t size) {
+      ofs.Write(buf, size);
+      pos += size;
+    };
+    auto pad_to = [&](uint64_t offset) {
+      static const char zeros[8] = {0};
+      write(zeros, offset - pos);
+    };
+
+    write(&cth, sizeof(cth));
+    pad_to(cth.dirOffset);
+    for (const auto &d : dirs) {
+      int32_t dirlen = d.size();
+      write(&dirlen, sizeof(dirlen));
+      write(d.c_str(), dirlen);
+    }
+    pad_to(cth.entryOffset);
+    for (size_t i = 0; i < active_chartTable.size(); i++) {
+      ChartTableEntry_onDisk_19 cte;
+      active_chartTable[i]->GetOnDisk(cte, path_offsets[i], ply_offsets[i]);
+      write(&cte, sizeof(cte));
+    }
+    for (const auto &cte : active_chartTable)
+      write(cte->GetpFullPath(), strlen(cte->GetpFullPath()) + 1);
+    pad_to(cth.plyOffset);
+    for (const auto &cte : active_chartTable) cte->WritePlyData(ofs);
 
-  for (UINT32 iTable = 0; iTable < active_chartTable.size(); iTable++) {
-    auto &cte = GetChartTableEntry(iTable);
-    cte.Write(this, ofs);
+    if (!ofs.IsOk() || !ofs.Close()) {
+      wxRemoveFile(tmpPath);
+      return false;
+    }
+  }
+  if (!wxRenameFile(tmpPath, filePath, true)) {
+    //  Windows refuses to replace a mapped file, drop the mapping and retry
+    for (const auto &cte : active_chartTable) cte->DetachMapping();
+    if (!wxRenameFile(tmpPath, filePath, true)) {
+      wxLogMessage("Chartdb: cannot write %s", filePath);
+      wxRemoveFile(tmpPath);
+      return false;
+    }
   }
 
   //      Explicitly set the version
@@ -1724,6 +2085,7 @@ bool ChartDatabase::Create(ArrayOfCDI &dir_array,
   m_chartDirs.Clear();
   active_chartTable.clear();
   active_chartTable_pathindex.clear();
+  m_spatial_index.Clear();
 
   Update(dir_array, true, pprog);  // force the update the reload everything
 
@@ -1823,6 +2185,7 @@ bool ChartDatabase::Update(ArrayOfCDI &dir_array, bool bForce,
   m_chartDirs.Clear();
 
   if (bForce) active_chartTable.clear();
+  m_spatial_index.Invalidate();
 
   bool lbForce = bForce;
 
@@ -1834,22 +2197,57 @@ bool ChartDatabase::Update(ArrayOfCDI &dir_array, bool bForce,
     m_dbversion = DB_VERSION_CURRENT;  // and the member
   }
 
-  //  Get the new charts
+  //  Charts already in the database, used to skip unchanged files.
+  std::map<wxString, int> known_charts;
+  if (!lbForce) {
+    for (unsigned int i = 0; i < active_chartTable.size(); i++)
+      known_charts[active_chartTable[i]->GetFullSystemPath()] = i;
+  }
 
+  //  List all directory trees concurrently, once for all chart classes.
+  //  cm93 trees are not searched file by file and thus not listed.
+  std::vector<ChartDirScan> scans;
+  std::vector<bool> skip_dir;
   for (unsigned int j = 0; j < dir_array.GetCount(); j++) {
-    ChartDirInfo dir_info = dir_array[j];
+    wxString dir_path = dir_array[j].fullpath;
+#ifdef __ANDROID__
+    dir_path = wxString(dir_array[j].fullpath.mb_str(wxConvUTF8));
+#endif
+    bool skip = false;
 
     // On Android, with SDK >= 30, traversal of a folder that is
     //  on within the "scoped storage" domain is very slow.
     //  Aviod it....
 #ifdef __ANDROID__
-    if (!androidIsDirWritable(dir_info.fullpath)) continue;
+    if (!androidIsDirWritable(dir_array[j].fullpath)) skip = true;
 #endif
+    bool enumerate = !skip && wxDir::Exists(dir_path) &&
+                     !Check_CM93_Structure(dir_path);
+    scans.emplace_back(dir_path, enumerate);
+    skip_dir.push_back(skip);
+  }
+
+  if (pprog) {
+    pprog->SetTitle(_("OpenCPN Directory Scan...."));
+    pprog->Update(0, _("Scanning chart directories"));
+  }
+  ChartDirScan::Run(scans, WorkerPool::GetShared(),
+                    [pprog](size_t done, size_t total) {
+                      if (pprog && total)
+                        pprog->Update(static_cast<int>(done * 100 / total));
+                    });
+
+  //  Get the new charts
+
+  for (unsigned int j = 0; j < dir_array.GetCount(); j++) {
+    if (skip_dir[j]) continue;
+    ChartDirInfo dir_info = dir_array[j];
 
     wxString dir_magic;
-    // Recursively search for a directory that contains GSHHG files starting
-    // from dir_info.
-    wxString gshhg_dir = findGshhgDirectory(dir_info.fullpath);
+    // Look for a directory that contains GSHHG files starting from dir_info.
+    wxString gshhg_dir = scans[j].IsListed()
+                             ? scans[j].FindGshhgDir()
+                             : findGshhgDirectory(dir_info.fullpath);
     if (!gshhg_dir.empty()) {
       // If some polygons exist in the directory, set it as the one to use for
       // GSHHG
@@ -1870,7 +2268,8 @@ bool ChartDatabase::Update(ArrayOfCDI &dir_array, bool bForce,
       }
     }
 
-    TraverseDirAndAddCharts(dir_info, pprog, dir_magic, lbForce);
+    TraverseDirAndAddCharts(dir_info, scans[j], known_charts, pprog,
+                            dir_magic, lbForce);
 
     //  Update the dir_list entry, even if the magic values are the same
     dir_info.magic_number = dir_magic;
@@ -1908,7 +2307,10 @@ bool ChartDatabase::Update(ArrayOfCDI &dir_array, bool bForce,
 
   // Start up the queued threads, if necessary
   if (m_jobsRemaining) {
-    int workerCount = 4;
+    // One header parser per core, but at least two since parsing is partly
+    // I/O bound and no more than eight which only adds disk contention.
+    int workerCount =
+        std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 2, 8);
 #ifdef __ANDROID__
     workerCount = 1;  // A little less stress on busy phones.
 #endif
@@ -1957,9 +2359,10 @@ int ChartDatabase::DisableChart(wxString &PathToDisable) {
 //  additional processing
 // ----------------------------------------------------------------------------
 
-int ChartDatabase::TraverseDirAndAddCharts(ChartDirInfo &dir_info,
-                                           wxGenericProgressDialog *pprog,
-                                           wxString &dir_magic, bool bForce) {
+int ChartDatabase::TraverseDirAndAddCharts(
+    ChartDirInfo &dir_info, const ChartDirScan &scan,
+    const std::map<wxString, int> &known_charts,
+    wxGenericProgressDialog *pprog, wxString &dir_magic, bool bForce) {
   //    Extract the true dir name and magic number from the compound string
   wxString dir_path = dir_info.fullpath;
 #ifdef __ANDROID__
@@ -1982,17 +2385,18 @@ int ChartDatabase::TraverseDirAndAddCharts(ChartDirInfo &dir_info,
   // If so, skip the DetectDirChange since it may be very slow
   // and give no information
   // Assume a change has happened, and process accordingly
-  bool b_cm93 = Check_CM93_Structure(dir_path);
+  bool b_cm93 = !scan.IsListed() && Check_CM93_Structure(dir_path);
   if (b_cm93) {
     b_skipDetectDirChange = true;
     b_dirchange = true;
   }
 
-  //    Quick scan the directory to see if it has changed
+  //    Check the directory listing to see if it has changed
   //    If not, there is no need to scan again.....
-  if (!b_skipDetectDirChange)
-    b_dirchange = DetectDirChange(dir_path, dir_info.fullpath, old_magic,
-                                  new_magic, pprog);
+  if (!b_skipDetectDirChange) {
+    new_magic = scan.GetMagic();
+    b_dirchange = new_magic != old_magic;
+  }
 
   if (!bForce && !b_dirchange) {
     wxString msg("   No change detected on directory ");
@@ -2036,7 +2440,8 @@ int ChartDatabase::TraverseDirAndAddCharts(ChartDirInfo &dir_info,
 
   //    Look for all possible defined chart classes
   for (auto &cd : m_ChartClassDescriptorArray) {
-    nAdd += SearchDirAndAddCharts(dir_info.fullpath, cd, pprog);
+    nAdd += SearchDirAndAddCharts(dir_info.fullpath, cd, scan, known_charts,
+                                  pprog);
   }
 
   return nAdd;
@@ -2047,52 +2452,14 @@ bool ChartDatabase::DetectDirChange(const wxString &dir_path,
                                     const wxString &magic, wxString &new_magic,
                                     wxGenericProgressDialog *pprog) {
   if (pprog) pprog->SetTitle(_("OpenCPN Directory Scan...."));
-
-  //    parse the magic number
-  long long unsigned int nmagic;
-  wxULongLong nacc = 0;
-
-  magic.ToULongLong(&nmagic, 10);
-
-  //    Get an arraystring of all files
-  wxArrayString FileList;
-  wxDir dir(dir_path);
-  int n_files = dir.GetAllFiles(dir_path, &FileList);
-  FileList.Sort();  // Ensure persistent order of items being hashed.
-
-  FlexHash hash(sizeof nacc);
-  hash.Reset();
-
   if (pprog) pprog->Update(0, prog_label);
 
-  // Traverse the list of files, getting their interesting stuff to add to
-  // accumulator
-  for (int ifile = 0; ifile < n_files; ifile++) {
-    wxFileName file(FileList[ifile]);
-
-    // NOTE. Do not ever try to optimize this code by combining `wxString`
-    // calls. Otherwise `fileNameUTF8` will point to a stale buffer overwritten
-    // by garbage.
-    wxString fileNameNative = file.GetFullPath();
-    wxScopedCharBuffer fileNameUTF8 = fileNameNative.ToUTF8();
-    hash.Update(fileNameUTF8.data(), fileNameUTF8.length());
-
-    //    File Size;
-    wxULongLong size = file.GetSize();
-    wxULongLong fileSize = ((size != wxInvalidSize) ? size : 0);
-    hash.Update(&fileSize, (sizeof fileSize));
-
-    //    Mod time, in ticks
-    wxDateTime t = file.GetModificationTime();
-    wxULongLong fileTime = t.GetTicks();
-    hash.Update(&fileTime, (sizeof fileTime));
-  }
-
-  hash.Finish();
-  hash.Receive(&nacc);
+  std::vector<ChartDirScan> scans;
+  scans.emplace_back(dir_path);
+  ChartDirScan::Run(scans, WorkerPool::GetShared());
 
   //    Return the calculated magic number
-  new_magic = nacc.ToString();
+  new_magic = scans.front().GetMagic();
 
   //    And do the test
   if (new_magic != magic)
@@ -2287,9 +2654,10 @@ one_file) find_unique = false;
 }
 */
 
-int ChartDatabase::SearchDirAndAddCharts(wxString &dir_name_base,
-                                         ChartClassDescriptor &chart_desc,
-                                         wxGenericProgressDialog *pprog) {
+int ChartDatabase::SearchDirAndAddCharts(
+    wxString &dir_name_base, ChartClassDescriptor &chart_desc,
+    const ChartDirScan &scan, const std::map<wxString, int> &known_charts,
+    wxGenericProgressDialog *pprog) {
   wxString msg("Searching directory: ");
   msg += dir_name_base;
   msg += " for ";
@@ -2310,9 +2678,9 @@ int ChartDatabase::SearchDirAndAddCharts(wxString &dir_name_base,
   wxString lowerFileSpecXZ = lowerFileSpec + ".xz";
   wxString filename;
 
-  //    Count the files
+  //    Collect the files from the directory listing
   wxArrayString FileList;
-  int gaf_flags = wxDIR_DEFAULT;  // as default, recurse into subdirs
+  std::vector<time_t> FileTimes;  // Modification times, -1 if unknown
 
   //    Here is an optimization for MSW/cm93 especially
   //    If this directory seems to be a cm93, and we are not explicitely looking
@@ -2320,7 +2688,7 @@ int ChartDatabase::SearchDirAndAddCharts(wxString &dir_name_base,
   //    for non-existent .KAP files, etc.
 
   bool b_found_cm93 = false;
-  bool b_cm93 = Check_CM93_Structure(dir_name);
+  bool b_cm93 = !scan.IsListed() && Check_CM93_Structure(dir_name);
   if (b_cm93) {
     if (filespec != "00300000.A")
       return false;
@@ -2331,51 +2699,41 @@ int ChartDatabase::SearchDirAndAddCharts(wxString &dir_name_base,
   }
 
   if (!b_found_cm93) {
-    wxDir dir(dir_name);
-    dir.GetAllFiles(dir_name, &FileList, filespec, gaf_flags);
+    std::vector<wxString> specs = {filespec};
+#ifndef __WXMSW__
+    if (filespec != lowerFileSpec) specs.push_back(lowerFileSpec);
+#endif
+#ifdef OCPN_USE_LZMA
+    // add xz compressed files;
+    specs.push_back(filespecXZ);
+    specs.push_back(lowerFileSpecXZ);
+#endif
+    // The listing is sorted. Sorted processing order makes the progress bar
+    // more meaningful to the user.
+    for (const auto *file : scan.GetMatchingFiles(specs)) {
+      FileList.Add(file->path);
+      FileTimes.push_back(file->mtime);
+    }
 
 #ifdef __ANDROID__
     if (!FileList.GetCount()) {
       wxArrayString afl = androidTraverseDir(dir_name, filespec);
-      for (wxArrayString::const_iterator item = afl.begin(); item != afl.end();
-           item++)
-        FileList.Add(*item);
-    }
-#endif
-
-#ifndef __WXMSW__
-    if (filespec != lowerFileSpec) {
-      // add lowercase filespec files too
-      wxArrayString lowerFileList;
-      dir.GetAllFiles(dir_name, &lowerFileList, lowerFileSpec, gaf_flags);
-
-#ifdef __ANDROID__
-      if (!lowerFileList.GetCount()) {
-        wxArrayString afl = androidTraverseDir(dir_name, lowerFileSpec);
-        for (wxArrayString::const_iterator item = afl.begin();
-             item != afl.end(); item++)
-          lowerFileList.Add(*item);
+      if (filespec != lowerFileSpec) {
+        wxArrayString lower_afl = androidTraverseDir(dir_name, lowerFileSpec);
+        for (const auto &item : lower_afl) afl.Add(item);
+      }
+      afl.Sort();
+      for (const auto &item : afl) {
+        FileList.Add(item);
+        FileTimes.push_back(-1);
       }
-#endif
-
-      for (wxArrayString::const_iterator item = lowerFileList.begin();
-           item != lowerFileList.end(); item++)
-        FileList.Add(*item);
     }
 #endif
-
-#ifdef OCPN_USE_LZMA
-    // add xz compressed files;
-    dir.GetAllFiles(dir_name, &FileList, filespecXZ, gaf_flags);
-    dir.GetAllFiles(dir_name, &FileList, lowerFileSpecXZ, gaf_flags);
-#endif
-
-    FileList.Sort();  // Sorted processing order makes the progress bar more
-                      // meaningful to the user.
-  } else {            // This is a cm93 dataset, specified as yada/yada/cm93
+  } else {  // This is a cm93 dataset, specified as yada/yada/cm93
     wxString dir_plus = dir_name;
     dir_plus += wxFileName::GetPathSeparator();
     FileList.Add(dir_plus);
+    FileTimes.push_back(-1);
   }
 
   int nFile = FileList.GetCount();
@@ -2383,6 +2741,7 @@ int ChartDatabase::SearchDirAndAddCharts(wxString &dir_name_base,
   if (!nFile) return false;
 
   int nDirEntry = 0;
+  int nUnchanged = 0;
 
   //    Check to see if there are any charts in the DB which refer to this
   //    directory If none at all, there is no need to scan the DB for fullpath
@@ -2487,19 +2846,32 @@ int ChartDatabase::SearchDirAndAddCharts(wxString &dir_name_base,
 #endif
 
     //  Check for duplicates within this directory
-    bool collision_found = false;
-    ChartCollisionsHashMap::iterator it;
-    for (it = collision_map.begin(); it != collision_map.end(); ++it) {
-      if (it->first.IsSameAs(file_name)) {
-        // Two files found with identical file name
-        // For now, just drop this ticket
-        // TODO Make an (expensive) test on file modification times
-        collision_found = true;
-        break;
-      }
-    }
+    // Two files found with identical file name
+    // For now, just drop this ticket
+    // TODO Make an (expensive) test on file modification times
+    bool collision_found = collision_map.find(file_name) != collision_map.end();
 
     if (!collision_found) {
+      collision_map[file_name] = ifile;
+
+      // A chart already in the database and not modified since needs no
+      // parsing, just keep the existing entry.
+      auto known = known_charts.find(full_path);
+      if (known != known_charts.end() && FileTimes[ifile] != -1) {
+        auto &cte_k = GetChartTableEntry(known->second);
+        if (cte_k.GetFileTime() == FileTimes[ifile]) {
+          cte_k.SetValid(true);
+          // Still the first holder of this file name, a parsed duplicate
+          // found later in another directory must be dropped.
+          m_full_collision_map[file_name] = 1;
+          nUnchanged++;
+          continue;
+        }
+      }
+      // Tiles decoded from an older version of the chart are stale.
+      if (known != known_charts.end())
+        RasterTileCache::GetInstance().Erase(full_path.ToUTF8().data());
+
       // Create a ticket for this chart
       auto ticket = std::make_shared<ChartTableEntryJobTicket>();
       ticket->m_ChartPath = full_path;
@@ -2507,11 +2879,15 @@ int ChartDatabase::SearchDirAndAddCharts(wxString &dir_name_base,
       ticket->chart_desc = chart_desc;
 
       ticket_vector.push_back(ticket);
-      collision_map[file_name] = ifile;
     }
 
   }  // the big loop
 
+  if (nUnchanged) {
+    wxLogMessage(wxString::Format("   %d unchanged %s charts kept", nUnchanged,
+                                  chart_desc.m_search_mask));
+  }
+
   // Built-in chart types are all thread-safe
   // Check plugin charts
   bool is_kap = false;  // chart_desc.m_class_name.IsSameAs("ChartKAP");
@@ -2708,7 +3084,12 @@ bool ChartDatabase::AddSingleChart(wxString &ChartFullPath,
   bool b_recurse = true;
   if (!b_force_full_search) b_recurse = IsChartDirUsed(dir_name);
 
+  size_t n_before = active_chartTable.size();
   bool rv = AddChart(ChartFullPath, desc, NULL, 0, b_recurse);
+  if (m_spatial_index.IsValid() && m_spatial_index.Size() == n_before) {
+    for (size_t i = n_before; i < active_chartTable.size(); i++)
+      m_spatial_index.Append(MakeIndexEntry(*active_chartTable[i]));
+  }
 
   //  remove duplicates marked in AddChart()
 
@@ -2784,6 +3165,8 @@ bool ChartDatabase::RemoveSingleChart(wxString &ChartFullPath) {
       // Fast remove element, order not preserved
       std::swap(active_chartTable[i], active_chartTable.back());
       active_chartTable.pop_back();
+      if (m_spatial_index.IsValid()) m_spatial_index.RemoveSwapBack(i);
+      RasterTileCache::GetInstance().Erase(ChartFullPath.ToUTF8().data());
       break;
     }
   }
@@ -3146,5 +3529,7 @@ void ChartDatabase::ApplyGroupArray(ChartGroupArray *pGroupArray) {
         }
       }
     }
+    if (m_spatial_index.IsValid())
+      m_spatial_index.SetGroups(ic, cte.GetGroupArray());
   }
 }
@@ -23,6 +23,10 @@
 
 #include <assert.h>
 
+#include <algorithm>
+#include <deque>
+#include <vector>
+
 // For compilers that support precompilation, includes "wx.h".
 #include <wx/wxprec.h>
 
@@ -40,6 +44,7 @@
 #include <wx/fileconf.h>
 
 #include "model/chartdata_input_stream.h"
+#include "model/worker_pool.h"
 
 #include "config.h"
 #include "chartimg.h"
@@ -547,6 +552,8 @@ InitReturn ChartGEO::Init(const wxString &name, ChartInitFlag init_flags) {
   ifss_bitmap =
       new wxFFileInputStream(*pBitmapFilePath);  // open the bitmap file
   ifs_bitmap = new wxBufferedInputStream(*ifss_bitmap);
+  m_bitmap_file = *pBitmapFilePath;
+  m_bitmap_source = m_bitmap_file;
 
   if (!ifss_bitmap->IsOk()) {
     free(pPlyTable);
@@ -1487,6 +1494,8 @@ InitReturn ChartKAP::Init(const wxString &name, ChartInitFlag init_flags) {
   tempfile = stream->TempFileName();
 #endif
   m_filesize = wxFileName::GetSize(tempfile.empty() ? name : tempfile);
+  m_bitmap_file = tempfile.empty() ? name : tempfile;
+  m_bitmap_source = name;
 
   ifss_bitmap = stream;
   ifs_bitmap = new wxBufferedInputStream(*ifss_bitmap);
@@ -1532,6 +1541,8 @@ ChartBaseBSB::ChartBaseBSB() {
   pPixCache = NULL;
 
   pLineCache = NULL;
+  m_row_decoder_palette = NULL;
+  m_tile_chart = 0;
 
   m_bilinear_limit = 8;  // bilinear scaling only up to n
 
@@ -1579,6 +1590,7 @@ ChartBaseBSB::~ChartBaseBSB() {
   free(pRefTable);
   //      free(pPlyTable);
 
+  m_mapped_file.Close();  // before a temporary file is removed
   delete ifs_bitmap;
   delete ifs_hdr;
   delete ifss_bitmap;
@@ -1917,8 +1929,26 @@ InitReturn ChartBaseBSB::PostInit() {
     }
   }
 
+  //    Map the bitmap file. Rows are then decoded straight from the mapping
+  //    into tiles shared by all charts, and the line cache is not needed.
+  if (m_mapped_file.Open(m_bitmap_file.ToUTF8().data()) &&
+      m_mapped_file.Contains(0, pline_table[Size_Y])) {
+    m_mapped_file.Advise(MappedFile::Access::kRandom);
+    // Key on the chart rather than the bitmap file which may be a temporary
+    // copy, and version on the modification times so a chart replaced in
+    // place does not find the tiles of the old one.
+    int64_t version = ::wxFileModificationTime(m_FullPath);
+    if (m_bitmap_source != m_FullPath)
+      version = version * 31 + ::wxFileModificationTime(m_bitmap_source);
+    version = version * 31 + m_filesize.GetValue();
+    m_tile_chart = RasterTileCache::GetInstance().GetChartId(
+        m_FullPath.ToUTF8().data(), version);
+  } else {
+    m_mapped_file.Close();
+  }
+
   //    Allocate the Line Cache
-  if (bUseLineCache) {
+  if (bUseLineCache && !UseTileCache()) {
     pLineCache = (CachedLine *)malloc(Size_Y * sizeof(CachedLine));
     CachedLine *pt;
 
@@ -2173,6 +2203,11 @@ void ChartBaseBSB::SetColorScheme(ColorScheme cs, bool bApplyImmediate) {
 }
 
 wxBitmap *ChartBaseBSB::CreateThumbnail(int tnx, int tny, ColorScheme cs) {
+  {
+    wxCriticalSectionLocker locker(m_critSect);
+    ValidateMapping();
+  }
+
   //    Calculate the size and divisors
 
   int divx = wxMax(1, Size_X / (4 * tnx));
@@ -3386,6 +3421,59 @@ bool ChartBaseBSB::GetView(wxRect &source, wxRect &dest,
   return TRUE;
 }
 
+// could use a larger value for slightly less ram but slower random access,
+// this is chosen as it is also the opengl tile size so should work well
+#define TILE_SIZE 512
+
+//    Requests smaller than this are decoded in the calling thread
+static const int kParallelDecodePixels = 1 << 16;
+
+/**
+ * Decoded tiles covering columns [x0, x1) of a band of rows, see
+ * ChartBaseBSB::GetTile().
+ */
+struct TileBand {
+  int tx0 = 0;
+  int ty0 = 0;
+  int columns = 0;
+  std::vector<RasterTileCache::Tile> tiles;  ///< Row major
+
+  /** Fetch tiles covering [x0, x1) x [y0, y1) using get_tile(tx, ty). */
+  template <typename GetTile>
+  void Load(int x0, int x1, int y0, int y1, GetTile get_tile) {
+    tiles.clear();
+    tx0 = x0 / TILE_SIZE;
+    ty0 = y0 / TILE_SIZE;
+    columns = (x1 - 1) / TILE_SIZE - tx0 + 1;
+    for (int ty = ty0; ty <= (y1 - 1) / TILE_SIZE; ty++) {
+      for (int tx = tx0; tx < tx0 + columns; tx++)
+        tiles.push_back(get_tile(tx, ty));
+    }
+  }
+
+  /** Invoke f(indices, x, count) for each tile segment of row y. */
+  template <typename F>
+  void ForEachSegment(int y, int x0, int x1, F f) const {
+    const size_t row = (y / TILE_SIZE - ty0) * columns;
+    const size_t offset = (y % TILE_SIZE) * TILE_SIZE;
+    for (int x = x0; x < x1;) {
+      int tx = x / TILE_SIZE;
+      int n = wxMin(x1, (tx + 1) * TILE_SIZE) - x;
+      f(tiles[row + tx - tx0]->data() + offset + x % TILE_SIZE, x, n);
+      x += n;
+    }
+  }
+};
+
+/**
+ * Pool decoding chart rows. Not the shared pool which might be busy with
+ * long running jobs like chart directory scans.
+ */
+static WorkerPool &GetDecodePool() {
+  static WorkerPool pool;
+  return pool;
+}
+
 bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size,
                                    wxRect &source, int source_stride,
                                    wxRect &dest, int dest_stride,
@@ -3417,66 +3505,105 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size,
   if (factor > 1)  // downsampling
   {
     if (scale_type == RENDER_HIDEF) {
-      //    Allocate a working buffer based on scale factor
-      int blur_factor = wxMax(2, Factor);
-      int wb_size = (source.width) * (blur_factor * 2) * BPP / 8;
-      s_data = (unsigned char *)malloc(wb_size);  // work buffer
-      unsigned char *pixel;
-      int y_offset;
+      //    Decode and box filter the target rows in parallel without an
+      //    intermediate RGB buffer. Using the tile cache, target rows are
+      //    scaled in groups whose boxes span about one tile row, so only a
+      //    few tiles are held at a time. Otherwise the compressed rows of
+      //    all boxes are read up front.
+      wxCriticalSectionLocker locker(m_critSect);
+      ValidateMapping();
 
-      for (int y = dest.y; y < (dest.y + dest.height); y++) {
-        //    Read "blur_factor" lines
+      int blur_factor = wxMax(2, Factor);
+      int x0 = wxMax(source.x, 0);
+      int x1 = wxMin(source.x + source.width, Size_X);
+      int group = UseTileCache() ? wxMax(1, (int)(TILE_SIZE / factor))
+                                 : dest.height;
+      std::vector<BsbRowSource> rows;
+      std::vector<bool> valid;
+      std::deque<std::vector<unsigned char>> buffers;
+      TileBand band;
+      const BsbRowDecoder &decoder = GetRowDecoder();
+
+      for (int g0 = 0; g0 < dest.height; g0 += group) {
+        int g1 = wxMin(g0 + group, dest.height);
+        if (UseTileCache()) {
+          int y0 = wxMax(source.y + (int)((dest.y + g0) * factor), 0);
+          int y1 = wxMin(
+              source.y + (int)((dest.y + g1 - 1) * factor) + blur_factor,
+              Size_Y);
+          if (y0 < y1 && x0 < x1) {
+            band.Load(x0, x1, y0, y1,
+                      [&](int tx, int ty) { return GetTile(tx, ty); });
+          }
+        } else {
+          rows.assign((g1 - g0) * blur_factor, BsbRowSource());
+          valid.assign(rows.size(), false);
+          buffers.clear();
+          for (int y = g0; y < g1; y++) {
+            for (int k = 0; k < blur_factor; k++) {
+              int iy = source.y + (int)((dest.y + y) * factor) + k;
+              if (iy < 0 || iy >= Size_Y || x0 >= x1) continue;
+              int i = (y - g0) * blur_factor + k;
+              buffers.emplace_back();
+              valid[i] = GetRowSource(iy, x0, rows[i], buffers.back());
+            }
+          }
+        }
 
-        wxRect s1;
-        s1.x = source.x;
-        s1.y = source.y + (int)(y * factor);
-        s1.width = source.width;
-        s1.height = blur_factor;
-        GetChartBits(s1, s_data, 1);
-
-        target_data = data + (y * dest_line_length /*dest_stride * BPP/8*/);
-
-        for (int x = 0; x < target_width; x++) {
-          unsigned int avgRed = 0;
-          unsigned int avgGreen = 0;
-          unsigned int avgBlue = 0;
-          unsigned int pixel_count = 0;
-          unsigned char *pix0 = s_data + BPP / 8 * ((int)(x * factor));
-          y_offset = 0;
-
-          if ((x * Factor) < (Size_X - source.x)) {
-            // determine average
-            for (int y1 = 0; y1 < blur_factor; ++y1) {
-              pixel = pix0 + (BPP / 8 * y_offset);
-              for (int x1 = 0; x1 < blur_factor; ++x1) {
-                avgRed += pixel[0];
-                avgGreen += pixel[1];
-                avgBlue += pixel[2];
-
-                pixel += BPP / 8;
-
-                pixel_count++;
+        auto scale_rows = [&](size_t begin, size_t end) {
+          std::vector<unsigned char> indices(source.width);
+          unsigned char *row = indices.data();
+          std::vector<uint32_t> sums(4 * target_width);
+          for (size_t r = begin; r < end; r++) {
+            int y = g0 + r;
+            std::fill(sums.begin(), sums.end(), 0);
+            for (int k = 0; k < blur_factor; k++) {
+              int iy = source.y + (int)((dest.y + y) * factor) + k;
+              size_t i = r * blur_factor + k;
+              if (iy < 0 || iy >= Size_Y || x0 >= x1) {
+                memset(row, BsbRowDecoder::kFillIndex, source.width);
+              } else {
+                memset(row, BsbRowDecoder::kFillIndex, x0 - source.x);
+                if (UseTileCache()) {
+                  band.ForEachSegment(
+                      iy, x0, x1,
+                      [&](const unsigned char *segment, int x, int count) {
+                        memcpy(row + x - source.x, segment, count);
+                      });
+                } else if (valid[i]) {
+                  decoder.ExpandIndices(rows[i].data, rows[i].size,
+                                        rows[i].pos, rows[i].ix, x0, x1,
+                                        row + x0 - source.x);
+                } else {
+                  memset(row + x0 - source.x, BsbRowDecoder::kFillIndex,
+                         x1 - x0);
+                }
+                memset(row + x1 - source.x, BsbRowDecoder::kFillIndex,
+                       source.x + source.width - x1);
               }
-              y_offset += source.width;
+              decoder.AccumulateBox(row, source.width, factor, blur_factor,
+                                    target_width, sums.data());
             }
 
-            if (0 == pixel_count)  // Protect
-              pixel_count = 1;
-
-            target_data[0] = avgRed / pixel_count;    // >> scounter;
-            target_data[1] = avgGreen / pixel_count;  // >> scounter;
-            target_data[2] = avgBlue / pixel_count;   // >> scounter;
-            target_data += BPP / 8;
-          } else {
-            target_data[0] = 0;
-            target_data[1] = 0;
-            target_data[2] = 0;
-            target_data += BPP / 8;
+            unsigned char *target = data + ((dest.y + y) * dest_line_length);
+            for (int x = 0; x < target_width; x++) {
+              const uint32_t *sum = &sums[4 * x];
+              if ((x * Factor) < (Size_X - source.x)) {
+                unsigned int pixel_count = wxMax(sum[3], 1u);  // Protect
+                target[0] = sum[0] / pixel_count;
+                target[1] = sum[1] / pixel_count;
+                target[2] = sum[2] / pixel_count;
+              } else {
+                target[0] = 0;
+                target[1] = 0;
+                target[2] = 0;
+              }
+              target += BPP / 8;
+            }
           }
-
-        }  // for x
-
-      }  // for y
+        };
+        GetDecodePool().ParallelFor(g1 - g0, scale_rows);
+      }
 
     }  // SCALE_BILINEAR
 
@@ -3678,10 +3805,35 @@ bool ChartBaseBSB::GetAndScaleData(unsigned char *ppn, size_t data_size,
 bool ChartBaseBSB::GetChartBits(wxRect &source, unsigned char *pPix,
                                 int sub_samp) {
   wxCriticalSectionLocker locker(m_critSect);
+  ValidateMapping();
+
+  if (UseTileCache()) return GetTileBits(source, pPix, sub_samp);
 
   int iy;
 #define FILL_BYTE 0
 
+  //    Large requests read the compressed rows sequentially and expand them
+  //    in parallel afterwards
+  struct RowJob {
+    BsbRowSource row;
+    int xs;
+    int xl;
+    unsigned char *dest;
+  };
+  const bool parallel =
+      sub_samp == 1 && source.width * source.height >= kParallelDecodePixels;
+  std::vector<RowJob> jobs;
+  std::deque<std::vector<unsigned char>> buffers;
+  auto get_scanline = [&](unsigned char *dest, int y, int xs, int xl) {
+    if (!parallel) {
+      BSBGetScanline(dest, y, xs, xl, sub_samp);
+      return;
+    }
+    RowJob job{{}, xs, wxMin(xl, Size_X), dest};
+    buffers.emplace_back();
+    if (GetRowSource(y, xs, job.row, buffers.back())) jobs.push_back(job);
+  };
+
   //    Decode the KAP file RLL stream into image pPix
 
   unsigned char *pCP;
@@ -3696,12 +3848,12 @@ bool ChartBaseBSB::GetChartBits(wxRect &source, unsigned char *pPix,
           if ((Size_X - source.x) < 0)
             memset(pCP, FILL_BYTE, source.width * BPP / 8);
           else {
-            BSBGetScanline(pCP, iy, source.x, Size_X, sub_samp);
+            get_scanline(pCP, iy, source.x, Size_X);
             memset(pCP + (Size_X - source.x) * BPP / 8, FILL_BYTE,
                    (source.x + source.width - Size_X) * BPP / 8);
           }
         } else
-          BSBGetScanline(pCP, iy, source.x, source.x + source.width, sub_samp);
+          get_scanline(pCP, iy, source.x, source.x + source.width);
       } else {
         if ((source.width + source.x) >= 0) {
           // Special case, black on left side
@@ -3709,8 +3861,8 @@ bool ChartBaseBSB::GetChartBits(wxRect &source, unsigned char *pPix,
 
           int xfill_corrected = -source.x + (source.x % sub_samp);  //+ve
           memset(pCP, FILL_BYTE, (xfill_corrected * BPP / 8));
-          BSBGetScanline(pCP + (xfill_corrected * BPP / 8), iy, 0,
-                         source.width + source.x, sub_samp);
+          get_scanline(pCP + (xfill_corrected * BPP / 8), iy, 0,
+                       source.width + source.x);
 
         } else {
           memset(pCP, FILL_BYTE, source.width * BPP / 8);
@@ -3728,6 +3880,17 @@ bool ChartBaseBSB::GetChartBits(wxRect &source, unsigned char *pPix,
     iy += sub_samp;
   }  // while iy
 
+  if (!jobs.empty()) {
+    const BsbRowDecoder &decoder = GetRowDecoder();
+    GetDecodePool().ParallelFor(jobs.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        const RowJob &job = jobs[i];
+        decoder.ExpandRgb(job.row.data, job.row.size, job.row.pos, job.row.ix,
+                          job.xs, job.xl, job.dest);
+      }
+    });
+  }
+
   return true;
 }
 
@@ -3857,51 +4020,6 @@ int ChartBaseBSB::BSBScanScanline(wxInputStream *pinStream) {
 
   return nLineMarker;
 }
-//      MSVC compiler makes a bad decision about when to inline (or not) some
-//      intrinsics, like memset(). So,... Here is a little hand-crafted memset()
-//      substitue for known short strings. It will be inlined by MSVC compiler
-//      using /02 settings
-
-inline void memset_short(unsigned char *dst, unsigned char cbyte, int count) {
-#if 0  // def __MSVC__
-  __asm {
-        pushf  // save Direction flag
-        cld  // set direction "up"
-        mov edi, dst
-        mov ecx, count
-        mov al, cbyte
-        rep stosb
-        popf
-  }
-#else
-  memset(dst, cbyte, count);
-#endif
-}
-// could use a larger value for slightly less ram but slower random access,
-// this is chosen as it is also the opengl tile size so should work well
-#define TILE_SIZE 512
-
-// #define USE_OLD_CACHE  // removed this (and simplify code below) once the new
-// method is verified #define PRINT_TIMINGS  // enable for profiling
-
-#ifdef PRINT_TIMINGS
-class OCPNStopWatch {
-public:
-  OCPNStopWatch() { Reset(); }
-  void Reset() { clock_gettime(CLOCK_REALTIME, &tp); }
-
-  double Time() {
-    timespec tp_end;
-    clock_gettime(CLOCK_REALTIME, &tp_end);
-    return (tp_end.tv_sec - tp.tv_sec) * 1.e3 +
-           (tp_end.tv_nsec - tp.tv_nsec) / 1.e6;
-  }
-
-private:
-  timespec tp;
-};
-#endif
-
 #define FAIL                \
   do {                      \
     free(pt->pTileOffset);  \
@@ -3909,431 +4027,215 @@ class OCPNStopWatch {
     free(pt->pPix);         \
     pt->pPix = NULL;        \
     pt->bValid = false;     \
-    return 0;               \
+    return NULL;            \
   } while (0)
 
 //-----------------------------------------------------------------------
-//    Get a BSB Scan Line Using Cache and scan line index if available
+//    Read a compressed line into the line cache, indexing tile offsets
 //-----------------------------------------------------------------------
-int ChartBaseBSB::BSBGetScanline(unsigned char *pLineBuf, int y, int xs, int xl,
-                                 int sub_samp)
-
-{
-  unsigned char *prgb = pLineBuf;
-  int nValueShift;
-  unsigned char byValueMask, byCountMask;
-  unsigned char byNext;
-  CachedLine *pt = NULL, cached_line;
-  unsigned char *pCL;
-  int rgbval;
-  unsigned char *lp;
-  int ix = xs;
-  int pos = 0;
-
-  if (bUseLineCache && pLineCache) {
-    //    Is the requested line in the cache, and valid?
-    pt = &pLineCache[y];
-  } else {
-    pt = &cached_line;
-    pt->bValid = false;
-  }
-
-#ifdef PRINT_TIMINGS
-  OCPNStopWatch sw;
-  static double ttime;
-  static int cnt;
-  cnt++;
-#endif
-
-  if (!pt->bValid)  // not valid, allocate
-  {
-    pt->size = pline_table[y + 1] - pline_table[y];
-
-#ifdef USE_OLD_CACHE
-    pt->pPix = (unsigned char *)malloc(Size_X);
-#else
-    pt->pTileOffset = (TileOffsetCache *)calloc(
-        sizeof(TileOffsetCache) * (Size_X / TILE_SIZE + 1), 1);
-    pt->pPix = (unsigned char *)malloc(pt->size);
-#endif
-    if (pline_table[y] == 0 || pline_table[y + 1] == 0) FAIL;
-
-    // as of 2015, in wxWidgets buffered streams don't test for a zero seek
-    // so we check here to possibly avoid this seek with a measured performance
-    // gain
-    if (ifs_bitmap->TellI() != pline_table[y] &&
-        wxInvalidOffset == ifs_bitmap->SeekI(pline_table[y], wxFromStart))
-      FAIL;
-
-#ifdef USE_OLD_CACHE
-    if (pt->size > ifs_bufsize) {
-      unsigned char *tmp = ifs_buf;
-      if (!(ifs_buf = (unsigned char *)realloc(ifs_buf, pt->size))) {
-        free(tmp);
-        FAIL;
+CachedLine *ChartBaseBSB::GetCachedLine(int y) {
+  CachedLine *pt = &pLineCache[y];
+  if (pt->bValid) return pt;
+
+  pt->size = pline_table[y + 1] - pline_table[y];
+  pt->pTileOffset = (TileOffsetCache *)calloc(
+      sizeof(TileOffsetCache) * (Size_X / TILE_SIZE + 1), 1);
+  pt->pPix = (unsigned char *)malloc(pt->size);
+  if (pline_table[y] == 0 || pline_table[y + 1] == 0) FAIL;
+
+  // as of 2015, in wxWidgets buffered streams don't test for a zero seek
+  // so we check here to possibly avoid this seek with a measured performance
+  // gain
+  if (ifs_bitmap->TellI() != pline_table[y] &&
+      wxInvalidOffset == ifs_bitmap->SeekI(pline_table[y], wxFromStart))
+    FAIL;
+  ifs_bitmap->Read(pt->pPix, pt->size);
+
+  //      skip the line number.
+  const BsbRowDecoder &decoder = GetRowDecoder();
+  unsigned char *lp = pt->pPix + decoder.SkipLineNumber(pt->pPix, pt->size);
+  unsigned char *end = pt->pPix + pt->size;
+  unsigned char byCountMask = (1 << (7 - nColorSize)) - 1;
+
+  // build tile offset table for faster random access
+  pt->pTileOffset[0].offset = lp - pt->pPix;
+  pt->pTileOffset[0].pixel = 0;
+  unsigned int tileindex = 1, nextTile = TILE_SIZE;
+  unsigned int iPixel = 0;
+  while (iPixel < (unsigned int)Size_X) {
+    unsigned char *offset = lp;
+    unsigned char byNext = lp < end ? *lp++ : 0;
+    if (byNext == 0 || lp == end) {
+      // finished early...corrupt?
+      while (tileindex < (unsigned int)Size_X / TILE_SIZE + 1) {
+        pt->pTileOffset[tileindex].offset = pt->pTileOffset[0].offset;
+        pt->pTileOffset[tileindex].pixel = 0;
+        tileindex++;
       }
-      ifs_bufsize = pt->size;
-    }
-
-    lp = ifs_buf;
-#else
-    lp = pt->pPix;
-#endif
-    ifs_bitmap->Read(lp, pt->size);
-
-#ifdef USE_OLD_CACHE
-    pCL = pt->pPix;
-#else
-    if (!bUseLineCache) {
-      ix = 0;
-      //      skip the line number.
-      do {
-        if (pos < pt->size) {
-          byNext = *lp++;
-          pos++;
-        } else {
-          byNext = 0;
-        }
-      } while ((byNext & 0x80) != 0);
-      goto nocachestart;
+      break;
     }
-    pCL = ifs_buf;
 
-    if (Size_X > ifs_bufsize) {
-      unsigned char *tmp = ifs_buf;
-      if (!(ifs_buf = (unsigned char *)realloc(ifs_buf, Size_X))) {
-        free(tmp);
-        FAIL;
-      }
-      ifs_bufsize = Size_X;
+    unsigned int nRunCount = byNext & byCountMask;
+    while ((byNext & 0x80) != 0) {
+      byNext = lp < end ? *lp++ : 0;
+      nRunCount = nRunCount * 128 + (byNext & 0x7f);
     }
-#endif
-    //    At this point, the unexpanded, raw line is at *lp, and the expansion
-    //    destination is pCL
+    nRunCount++;
 
-    //      skip the line number.
-    do {
-      if (pos < pt->size) {
-        byNext = *lp++;
-        pos++;
-      } else {
-        byNext = 0;
-      }
-    } while ((byNext & 0x80) != 0);
-
-    //      Setup masking values.
-    nValueShift = 7 - nColorSize;
-    byValueMask = (((1 << nColorSize)) - 1) << nValueShift;
-    byCountMask = (1 << (7 - nColorSize)) - 1;
-
-    //      Read and expand runs.
-    unsigned int iPixel = 0;
-
-#ifndef USE_OLD_CACHE
-    pt->pTileOffset[0].offset = lp - pt->pPix;
-    pt->pTileOffset[0].pixel = 0;
-    unsigned int tileindex = 1, nextTile = TILE_SIZE;
-#endif
-    unsigned int nRunCount;
-    unsigned char *end = pt->pPix + pt->size;
-    while (iPixel < (unsigned int)Size_X)
-#ifdef USE_OLD_CACHE
-    {
-      nPixValue = (byNext & byValueMask) >> nValueShift;
+    if (iPixel + nRunCount >
+        (unsigned int)Size_X)  // protection against corrupt data
+      nRunCount = Size_X - iPixel;
 
-      nRunCount = byNext & byCountMask;
-
-      while ((byNext & 0x80) != 0) {
-        byNext = *lp++;
-        nRunCount = nRunCount * 128 + (byNext & 0x7f);
-      }
-
-      nRunCount++;
-
-      if (iPixel + nRunCount >
-          (unsigned int)Size_X)  // protection against corrupt data
-        nRunCount = nRunCount - iPixel;
-
-      //          Store nPixValue in the destination
-      memset_short(pCL + iPixel, nPixValue, nRunCount);
-      iPixel += nRunCount;
+    while (iPixel + nRunCount > nextTile) {
+      pt->pTileOffset[tileindex].offset = offset - pt->pPix;
+      pt->pTileOffset[tileindex].pixel = iPixel;
+      tileindex++;
+      nextTile += TILE_SIZE;
     }
-#else
-    // build tile offset table for faster random access
-    {
-      if (pos < pt->size) {
-        byNext = *lp++;
-        pos++;
-      } else {
-        byNext = 0;
-      }
-      unsigned char *offset = lp - 1;
-      if (byNext == 0 || lp == end) {
-        // finished early...corrupt?
-        while (tileindex < (unsigned int)Size_X / TILE_SIZE + 1) {
-          pt->pTileOffset[tileindex].offset = pt->pTileOffset[0].offset;
-          pt->pTileOffset[tileindex].pixel = 0;
-          tileindex++;
-        }
-        break;
-      }
-
-      nRunCount = byNext & byCountMask;
-
-      while ((byNext & 0x80) != 0) {
-        if (pos < pt->size) {
-          byNext = *lp++;
-          pos++;
-        } else {
-          byNext = 0;
-        }
-        nRunCount = nRunCount * 128 + (byNext & 0x7f);
-      }
-
-      nRunCount++;
-
-      if (iPixel + nRunCount >
-          (unsigned int)Size_X)  // protection against corrupt data
-        nRunCount = Size_X - iPixel;
-
-      while (iPixel + nRunCount > nextTile) {
-        pt->pTileOffset[tileindex].offset = offset - pt->pPix;
-        pt->pTileOffset[tileindex].pixel = iPixel;
-        tileindex++;
-        nextTile += TILE_SIZE;
-      }
-      iPixel += nRunCount;
-    }
-#endif
-
-    pt->bValid = true;
+    iPixel += nRunCount;
   }
 
-  //          Line is valid, de-reference thru proper pallete directly to target
-
-  if (xl > Size_X) xl = Size_X;
+  pt->bValid = true;
+  return pt;
+}
 
-#ifdef USE_OLD_CACHE
-  pCL = pt->pPix + xs;
-
-  //    Optimization for most usual case
-  if ((BPP == 24) && (1 == sub_samp)) {
-    ix = xs;
-    while (ix < xl - 1) {
-      unsigned char cur_by = *pCL;
-      rgbval = (int)(pPalette[cur_by]);
-      while ((ix < xl - 1)) {
-        if (cur_by != *pCL) break;
-        *((int *)prgb) = rgbval;
-        prgb += 3;
-        pCL++;
-        ix++;
-      }
-    }
-  } else {
-    int dest_inc_val_bytes = (BPP / 8) * sub_samp;
-    ix = xs;
-    while (ix < xl - 1) {
-      unsigned char cur_by = *pCL;
-      rgbval = (int)(pPalette[cur_by]);
-      while ((ix < xl - 1)) {
-        if (cur_by != *pCL) break;
-        *((int *)prgb) = rgbval;
-        prgb += dest_inc_val_bytes;
-        pCL += sub_samp;
-        ix += sub_samp;
-      }
-    }
+bool ChartBaseBSB::GetRowSource(int y, int xs, BsbRowSource &row,
+                                std::vector<unsigned char> &buffer) {
+  if (UseTileCache()) {
+    if (pline_table[y] == 0 || pline_table[y + 1] < pline_table[y] ||
+        !m_mapped_file.Contains(pline_table[y],
+                                pline_table[y + 1] - pline_table[y]))
+      return false;
+    const unsigned char *data = m_mapped_file.Data() + pline_table[y];
+    size_t size = pline_table[y + 1] - pline_table[y];
+    row = {data, size, BsbRowDecoder::SkipLineNumber(data, size), 0};
+    return true;
   }
-
-  // Get the last pixel explicitely
-  //  irrespective of the sub_sampling factor
-
-  if (xs < xl - 1) {
-    unsigned char *pCLast = pt->pPix + (xl - 1);
-    unsigned char *prgb_last = pLineBuf + ((xl - 1) - xs) * BPP / 8;
-
-    rgbval = (int)(pPalette[*pCLast]);  // last pixel
-    unsigned char a = rgbval & 0xff;
-    *prgb_last++ = a;
-    a = (rgbval >> 8) & 0xff;
-    *prgb_last++ = a;
-    a = (rgbval >> 16) & 0xff;
-    *prgb_last = a;
+  if (bUseLineCache && pLineCache) {
+    CachedLine *pt = GetCachedLine(y);
+    if (!pt) return false;
+    const TileOffsetCache &tile = pt->pTileOffset[xs / TILE_SIZE];
+    row = {pt->pPix, (size_t)pt->size, (size_t)tile.offset, tile.pixel};
+    return true;
   }
-#else
-  {
-    int tileindex = xs / TILE_SIZE;
-    int tileoffset = pt->pTileOffset[tileindex].offset;
+  if (pline_table[y] == 0 || pline_table[y + 1] == 0) return false;
+  buffer.resize(pline_table[y + 1] - pline_table[y]);
+  if (ifs_bitmap->TellI() != pline_table[y] &&
+      wxInvalidOffset == ifs_bitmap->SeekI(pline_table[y], wxFromStart))
+    return false;
+  ifs_bitmap->Read(buffer.data(), buffer.size());
+  size_t pos = GetRowDecoder().SkipLineNumber(buffer.data(), buffer.size());
+  row = {buffer.data(), buffer.size(), pos, 0};
+  return true;
+}
 
-    lp = pt->pPix + tileoffset;
-    pos = tileoffset;
-    ix = pt->pTileOffset[tileindex].pixel;
+const BsbRowDecoder &ChartBaseBSB::GetRowDecoder() {
+  if (!m_row_decoder || m_row_decoder_palette != pPalette) {
+    opncpnPalette *palette = pPalettes[m_mapped_color_index];
+    int size = palette && pPalette ? palette->nFwd : 0;
+    m_row_decoder =
+        std::make_unique<BsbRowDecoder>(nColorSize, pPalette, size);
+    m_row_decoder_palette = pPalette;
   }
+  return *m_row_decoder;
+}
 
-nocachestart:
-  nValueShift = 7 - nColorSize;
-  byValueMask = (((1 << nColorSize)) - 1) << nValueShift;
-  byCountMask = (1 << (7 - nColorSize)) - 1;
-  int nPixValue = 0;  // satisfy stupid compiler warning
-  bool bLastPixValueValid = false;
-  while (ix < xl - 1) {
-    if (pos < pt->size) {
-      byNext = *lp++;
-      pos++;
-    } else {
-      break;
-    }
-
-    nPixValue = (byNext & byValueMask) >> nValueShift;
-    unsigned int nRunCount;
-
-    if (byNext == 0)
-      nRunCount = xl - ix;  // corrupted chart, just run to the end
-    else {
-      nRunCount = byNext & byCountMask;
-      while ((byNext & 0x80) != 0) {
-        if (pos < pt->size) {
-          byNext = *lp++;
-          pos++;
-        } else {
-          nRunCount = xl - ix;  // corrupted chart, just run to the end
-          break;
-        }
-        nRunCount = nRunCount * 128 + (byNext & 0x7f);
-      }
-
-      nRunCount++;
-    }
+void ChartBaseBSB::ValidateMapping() {
+  //    The mapping would fault if the file is truncated or rewritten
+  if (!m_mapped_file.IsOpen() ||
+      RasterTileCache::GetInstance().IsCurrent(m_tile_chart))
+    return;
+  wxString msg("   Chart file removed from database, unmapping ");
+  msg.Append(m_FullPath);
+  wxLogMessage(msg);
+  m_mapped_file.Close();
+}
 
-    if (ix < xs) {
-      if (ix + nRunCount <= (unsigned int)xs) {
-        ix += nRunCount;
-        continue;
-      }
-      nRunCount -= xs - ix;
-      ix = xs;
+RasterTileCache::Tile ChartBaseBSB::GetTile(int tx, int ty) {
+  RasterTileCache &cache = RasterTileCache::GetInstance();
+  RasterTileCache::Tile tile = cache.Get(m_tile_chart, tx, ty);
+  if (tile) return tile;
+
+  //    Decode the rows of the tile in parallel, straight from the mapping
+  int x0 = tx * TILE_SIZE;
+  int x1 = wxMin(x0 + TILE_SIZE, Size_X);
+  int y0 = ty * TILE_SIZE;
+  int y1 = wxMin(y0 + TILE_SIZE, Size_Y);
+  std::vector<uint8_t> data(TILE_SIZE * TILE_SIZE, BsbRowDecoder::kFillIndex);
+  const BsbRowDecoder &decoder = GetRowDecoder();
+  GetDecodePool().ParallelFor(y1 - y0, [&](size_t begin, size_t end) {
+    std::vector<unsigned char> unused;
+    for (size_t r = begin; r < end; r++) {
+      BsbRowSource row;
+      if (!GetRowSource(y0 + r, x0, row, unused)) continue;
+      decoder.ExpandIndices(row.data, row.size, row.pos, row.ix, x0, x1,
+                            &data[r * TILE_SIZE]);
     }
+  });
+  return cache.Put(m_tile_chart, tx, ty, std::move(data));
+}
 
-    if (ix + nRunCount >= (unsigned int)xl) {
-      nRunCount = xl - 1 - ix;
-      bLastPixValueValid = true;
+bool ChartBaseBSB::GetTileBits(wxRect &source, unsigned char *pPix,
+                               int sub_samp) {
+  const int line = source.width * BPP / 8;
+  const int x0 = wxMax(source.x, 0);
+  const int x1 = wxMin(source.x + source.width, Size_X);
+  const int y_end = source.y + source.height;
+  const BsbRowDecoder &decoder = GetRowDecoder();
+  TileBand band;
+
+  //    Rows are converted one tile row at a time, holding its tiles
+  int iy = source.y;
+  while (iy < y_end) {
+    bool on_chart = iy >= 0 && iy < Size_Y && x0 < x1;
+    int band_end = iy < 0 ? 0 : iy < Size_Y ? (iy / TILE_SIZE + 1) * TILE_SIZE
+                                            : y_end;
+    band_end = wxMin(wxMin(band_end, y_end), on_chart ? Size_Y : y_end);
+    int count = (band_end - iy + sub_samp - 1) / sub_samp;
+    if (on_chart) {
+      band.Load(x0, x1, iy, band_end,
+                [&](int tx, int ty) { return GetTile(tx, ty); });
     }
 
-    rgbval = (int)(pPalette[nPixValue]);
-
-    //    Optimization for most usual case
-    // currently this is the only case possible...
-    //          if((BPP == 24) && (1 == sub_samp))
-    {
-      int count = nRunCount;
-      if (count < 16) {
-        // for short runs, use simple loop
-        while (count--) {
-          *(uint32_t *)prgb = rgbval;
-          prgb += 3;
-        }
-      } else if (rgbval == 0 || rgbval == 0xffffff) {
-        // optimization for black or white (could work for any gray too)
-        memset(prgb, rgbval, nRunCount * 3);
-        prgb += nRunCount * 3;
-      } else {
-        // note: this may not be optimal for all processors and compilers
-        // I optimized for x86_64 using gcc with -O3
-        // it is probably possible to gain even faster performance by ensuring
-        // alignment to 16 or 32byte boundary (depending on processor) then
-        // using inline assembly
-
-#ifdef __ARM_ARCH
-        //  ARM needs 8 byte alignment for *(uint64_T *x) = *(uint64_T *y)
-        //  because the compiler will (probably) use the ldrd/strd instuction
-        //  pair. So, advance the prgb pointer until it is 8-byte aligned, and
-        //  then carry on if enough bytes are left to process as 64 bit elements
-
-        if ((long)prgb & 7) {
-          while (count--) {
-            *(uint32_t *)prgb = rgbval;
-            prgb += 3;
-            if (!((long)prgb & 7)) {
-              if (count >= 8) break;
-            }
-          }
-        }
-#endif
-
-        // fill first 24 bytes
-        uint64_t *b = (uint64_t *)prgb;
-        for (int i = 0; i < 8; i++) {
-          *(uint32_t *)prgb = rgbval;
-          prgb += 3;
-        }
-        count -= 8;
-
-        // fill in blocks of 24 bytes
-        uint64_t *y = (uint64_t *)prgb;
-        int count_d8 = count >> 3;
-        prgb += 24 * count_d8;
-        while (count_d8--) {
-          *y++ = b[0];
-          *y++ = b[1];
-          *y++ = b[2];
-        }
-
-        // fill remaining bytes
-        int rcount = count & 0x7;
-        while (rcount--) {
-          *(uint32_t *)prgb = rgbval;
-          prgb += 3;
+    const int band_start = iy;
+    auto convert = [&](size_t begin, size_t end) {
+      for (size_t r = begin; r < end; r++) {
+        int y = band_start + r * sub_samp;
+        unsigned char *pCP = pPix + (y - source.y) * line;
+        if (!on_chart) {
+          memset(pCP, 0, line);
+          continue;
         }
+        memset(pCP, 0, (x0 - source.x) * BPP / 8);
+        band.ForEachSegment(
+            y, x0, x1, [&](const unsigned char *indices, int x, int n) {
+              decoder.IndicesToRgb(indices, n,
+                                   pCP + (x - source.x) * BPP / 8);
+            });
+        memset(pCP + (x1 - source.x) * BPP / 8, 0,
+               (source.x + source.width - x1) * BPP / 8);
       }
-    }
-
-    ix += nRunCount;
-  }
-
-  // Get the last pixel explicitely
-  //  irrespective of the sub_sampling factor
-
-  if (ix < xl) {
-    if (!bLastPixValueValid) {
-      if (pos < pt->size) {
-        byNext = *lp++;
-        pos++;
-      } else {
-        byNext = 0;
-      }
-      nPixValue = (byNext & byValueMask) >> nValueShift;
-    }
-    rgbval = (int)(pPalette[nPixValue]);  // last pixel
-    unsigned char a = rgbval & 0xff;
-
-    *prgb++ = a;
-    a = (rgbval >> 8) & 0xff;
-    *prgb++ = a;
-    a = (rgbval >> 16) & 0xff;
-    *prgb = a;
-  }
-#endif
-
-#ifdef PRINT_TIMINGS
-  ttime += sw.Time();
-
-  if (cnt == 500000) {
-    static int d;
-    printf("cache time: %d %f\n", d, ttime / 1000.0);
-    cnt = 0;
-    d++;
-    //        ttime = 0;
-  }
-#endif
-
-  if (!bUseLineCache) {
-#ifndef USE_OLD_CACHE
-    free(pt->pTileOffset);
-#endif
-    free(pt->pPix);
+    };
+    if (on_chart && count * source.width >= kParallelDecodePixels)
+      GetDecodePool().ParallelFor(count, convert);
+    else
+      convert(0, count);
+    iy += count * sub_samp;
   }
+  return true;
+}
 
+//-----------------------------------------------------------------------
+//    Get a BSB Scan Line Using Cache and scan line index if available
+//-----------------------------------------------------------------------
+int ChartBaseBSB::BSBGetScanline(unsigned char *pLineBuf, int y, int xs, int xl,
+                                 int sub_samp) {
+  BsbRowSource row;
+  std::vector<unsigned char> buffer;
+  if (!GetRowSource(y, xs, row, buffer)) return 0;
+  if (xl > Size_X) xl = Size_X;
+  GetRowDecoder().ExpandRgb(row.data, row.size, row.pos, row.ix, xs, xl,
+                            pLineBuf);
   return 1;
 }
 
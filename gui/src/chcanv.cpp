@@ -9035,17 +9035,18 @@ bool ChartCanvas::MouseEventProcessObjects(wxMouseEvent &event) {
           pSelect->ModifySelectablePoint(new_cursor_lat, new_cursor_lon,
                                          m_pRoutePointEditTarget,
                                          SELTYPE_DRAGHANDLE);
-          m_pFoundPoint->m_slat =
-              m_pRoutePointEditTarget->m_lat;  // update the SelectList entry
-          m_pFoundPoint->m_slon = m_pRoutePointEditTarget->m_lon;
+          // update the SelectList entry
+          pSelect->ModifySelectableItem(m_pFoundPoint,
+                                        m_pRoutePointEditTarget->m_lat,
+                                        m_pRoutePointEditTarget->m_lon);
         } else {
           m_pRoutePointEditTarget->m_lat =
               new_cursor_lat;  // update the RoutePoint entry
           m_pRoutePointEditTarget->m_lon = new_cursor_lon;
           m_pRoutePointEditTarget->m_wpBBox.Invalidate();
-          m_pFoundPoint->m_slat =
-              new_cursor_lat;  // update the SelectList entry
-          m_pFoundPoint->m_slon = new_cursor_lon;
+          // update the SelectList entry
+          pSelect->ModifySelectableItem(m_pFoundPoint, new_cursor_lat,
+                                        new_cursor_lon);
         }
 
         //    Update the MarkProperties Dialog, if currently shown
@@ -9136,16 +9137,18 @@ bool ChartCanvas::MouseEventProcessObjects(wxMouseEvent &event) {
           pSelect->ModifySelectablePoint(m_cursor_lat, m_cursor_lon,
                                          m_pRoutePointEditTarget,
                                          SELTYPE_DRAGHANDLE);
-          m_pFoundPoint->m_slat =
-              m_pRoutePointEditTarget->m_lat;  // update the SelectList entry
-          m_pFoundPoint->m_slon = m_pRoutePointEditTarget->m_lon;
+          // update the SelectList entry
+          pSelect->ModifySelectableItem(m_pFoundPoint,
+                                        m_pRoutePointEditTarget->m_lat,
+                                        m_pRoutePointEditTarget->m_lon);
         } else {
           m_pRoutePointEditTarget->m_lat =
               m_cursor_lat;  // update the RoutePoint entry
           m_pRoutePointEditTarget->m_lon = m_cursor_lon;
           m_pRoutePointEditTarget->m_wpBBox.Invalidate();
-          m_pFoundPoint->m_slat = m_cursor_lat;  // update the SelectList entry
-          m_pFoundPoint->m_slon = m_cursor_lon;
+          // update the SelectList entry
+          pSelect->ModifySelectableItem(m_pFoundPoint, m_cursor_lat,
+                                        m_cursor_lon);
         }
 
         //    Update the MarkProperties Dialog, if currently shown
@@ -13164,6 +13167,7 @@ void ChartCanvas::DrawAllTracksInBBox(ocpnDC &dc, LLBBox &BltBBox) {
   }
 
   if (active_track) TrackGui(*active_track).Draw(this, dc, GetVP(), BltBBox);
+  Track::EnforcePageBudget();
 }
 
 void ChartCanvas::DrawActiveTrackInBBox(ocpnDC &dc, LLBBox &BltBBox) {
@@ -13348,7 +13352,7 @@ void ChartCanvas::RebuildTideSelectList(LLBBox &BBox) {
 
   pSelectTC->DeleteAllSelectableTypePoints(SELTYPE_TIDEPOINT);
 
-  for (int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++) {
+  for (int i : ptcmgr->GetStationsInBBox(BBox, 'T')) {
     const IDX_entry *pIDX = ptcmgr->GetIDX_entry(i);
     double lon = pIDX->IDX_lon;
     double lat = pIDX->IDX_lat;
@@ -13441,7 +13445,7 @@ void ChartCanvas::DrawAllTidesInBBox(ocpnDC &dc, LLBBox &BBox) {
   {
     double marge = 0.05;
     std::vector<LLBBox> drawn_boxes;
-    for (int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++) {
+    for (int i : ptcmgr->GetStationsInBBox(BBox, 'T', marge)) {
       const IDX_entry *pIDX = ptcmgr->GetIDX_entry(i);
 
       char type = pIDX->IDX_type;          // Entry "TCtcIUu" identifier
@@ -13644,7 +13648,7 @@ void ChartCanvas::RebuildCurrentSelectList(LLBBox &BBox) {
 
   pSelectTC->DeleteAllSelectableTypePoints(SELTYPE_CURRENTPOINT);
 
-  for (int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++) {
+  for (int i : ptcmgr->GetStationsInBBox(BBox, 'C')) {
     const IDX_entry *pIDX = ptcmgr->GetIDX_entry(i);
     double lon = pIDX->IDX_lon;
     double lat = pIDX->IDX_lat;
@@ -13719,7 +13723,7 @@ void ChartCanvas::DrawAllCurrentsInBBox(ocpnDC &dc, LLBBox &BBox) {
   scale_factor *= GetContentScaleFactor();
 
   {
-    for (int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++) {
+    for (int i : ptcmgr->GetStationsInBBox(BBox, 'C', marge)) {
       const IDX_entry *pIDX = ptcmgr->GetIDX_entry(i);
       double lon = pIDX->IDX_lon;
       double lat = pIDX->IDX_lat;
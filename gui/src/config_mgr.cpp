@@ -1040,6 +1040,8 @@ bool ConfigMgr::CheckTemplate(wxString fileName) {
   CHECK_STR("TalkerIdText", g_TalkerIdText);
   CHECK_INT("MaxWaypointNameLength", &g_maxWPNameLength);
   CHECK_INT("MbtilesMaxLayers", &g_mbtilesMaxLayers);
+  CHECK_INT("MbtilesCacheMB", &g_mbtilesCacheMB);
+  CHECK_INT("MbtilesPrefetch", &g_bMbtilesPrefetch);
 
   /* opengl options */
 #ifdef ocpnUSE_GL
@@ -56,6 +56,7 @@
 
 #include "model/base_platform.h"
 #include "model/config_vars.h"
+#include "model/gpu_ledger.h"
 #include "model/gui_vars.h"
 #include "model/own_ship.h"
 #include "model/plugin_comm.h"
@@ -1499,6 +1500,7 @@ void glChartCanvas::DrawStaticRoutesTracksAndWaypoints(ViewPort &vp) {
 
     TrackGui(*pTrackDraw).Draw(m_pParentCanvas, dc, vp, vp.GetBBox());
   }
+  Track::EnforcePageBudget();
 
   for (Route *pRouteDraw : *pRouteList) {
     if (!pRouteDraw) continue;
@@ -3048,8 +3050,8 @@ void glChartCanvas::RenderRasterChartRegionGL(ChartBase *chart, ViewPort &vp,
     glTexTile *tile = tiles[i];
     if (region.IntersectOut(tile->box)) {
       /*   user setting is in MB while we count exact bytes */
-      bool bGLMemCrunch =
-          g_tex_mem_used > g_GLOptions.m_iTextureMemorySize * 1024 * 1024;
+      bool bGLMemCrunch = GpuLedger::GetInstance().GetUsed() >
+                          g_GLOptions.m_iTextureMemorySize * 1024.0 * 1024.0;
       if (bGLMemCrunch) pTexFact->DeleteTexture(tile->rect);
     } else {
       bool texture = pTexFact->PrepareTexture(base_level, tile->rect,
@@ -3826,6 +3828,7 @@ void glChartCanvas::Render() {
   m_pParentCanvas->VPoint.SetPixelScale(m_displayScale);
 
   m_last_render_time = wxDateTime::Now().GetTicks();
+  GpuLedger::GetInstance().NextFrame();
 
   // we don't care about jobs that are now off screen
   // clear out and it will be repopulated during render
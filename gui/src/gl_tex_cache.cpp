@@ -34,6 +34,7 @@
 #include "mipmap/mipmap.h"
 #include "model/base_platform.h"
 #include "model/config_vars.h"
+#include "model/gpu_ledger.h"
 #include "model/gui_vars.h"
 
 #include "chartbase.h"
@@ -401,6 +402,8 @@ void glTexFactory::DeleteSingleTexture(glTextureDescriptor *ptd) {
   if (!ptd->tex_name) return;
 
   g_tex_mem_used -= ptd->tex_mem_used;
+  GpuLedger::GetInstance().Release(ptd->gpu_handle);
+  ptd->gpu_handle = 0;
   ptd->level_min = g_mipmap_max_level + 1;  // default, nothing loaded
 
   glDeleteTextures(1, &ptd->tex_name);
@@ -409,6 +412,18 @@ void glTexFactory::DeleteSingleTexture(glTextureDescriptor *ptd) {
   ptd->nGPU_compressed = GPU_TEXTURE_UNKNOWN;
 }
 
+void glTexFactory::AccountTexture(glTextureDescriptor *ptd) {
+  auto &ledger = GpuLedger::GetInstance();
+  if (ptd->gpu_handle) {
+    ledger.Resize(ptd->gpu_handle, ptd->tex_mem_used);
+  } else {
+    // Evicted textures are rebuilt by the next PrepareTexture() call.
+    ptd->gpu_handle = ledger.Register(
+        m_ChartPath.ToStdString(), GpuLedger::Kind::kRasterTexture,
+        ptd->tex_mem_used, [this, ptd] { DeleteSingleTexture(ptd); });
+  }
+}
+
 void glTexFactory::ArrayXY(wxRect *r, int index) const {
   r->y = (index / m_stride) * m_tex_dim;
   r->x = (index - ((r->y / m_tex_dim) * m_stride)) * m_tex_dim;
@@ -614,6 +629,7 @@ bool glTexFactory::BuildTexture(glTextureDescriptor *ptd, int base_level,
   }
 
   ptd->level_min = base_level;
+  AccountTexture(ptd);
 
   // free all mipmaps more than a level less than this
   for (int i = 0; i < base_level - 1; i++) {
@@ -639,6 +655,7 @@ bool glTexFactory::PrepareTexture(int base_level, const wxRect &rect,
 
     if (!BuildTexture(ptd, base_level, rect))
       glBindTexture(GL_TEXTURE_2D, ptd->tex_name);
+    GpuLedger::GetInstance().Touch(ptd->gpu_handle);
 
     // should we schedule compression?
     if (g_GLOptions.m_bTextureCompression &&
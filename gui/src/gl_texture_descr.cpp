@@ -44,6 +44,7 @@ glTextureDescriptor::glTextureDescriptor() {
   tex_name = 0;
   nGPU_compressed = GPU_TEXTURE_UNKNOWN;
   tex_mem_used = 0;
+  gpu_handle = 0;
   compdata_ticks = 0;
 }
 
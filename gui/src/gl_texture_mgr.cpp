@@ -57,6 +57,7 @@
 
 #include "model/base_platform.h"
 #include "model/config_vars.h"
+#include "model/gpu_ledger.h"
 #include "model/gui_vars.h"
 #include "model/own_ship.h"
 
@@ -1176,46 +1177,20 @@ bool glTextureManager::PurgeChartTextures(ChartBase *pc, bool b_purge_factory) {
 }
 
 bool glTextureManager::TextureCrunch(double factor) {
+  // Raster textures, MBTiles textures and S57 vertex buffers share the
+  // texture memory budget. Free what was rendered least recently,
+  // whatever the chart type.
   double hysteresis = 0.90;
+  double budget = g_GLOptions.m_iTextureMemorySize * 1024.0 * 1024.0;
 
-  bool bGLMemCrunch =
-      g_tex_mem_used >
-      (double)(g_GLOptions.m_iTextureMemorySize * 1024 * 1024) * factor;
+  auto &ledger = GpuLedger::GetInstance();
+  bool bGLMemCrunch = ledger.GetUsed() > budget * factor;
   if (!bGLMemCrunch) return false;
 
-  ChartPathHashTexfactType::iterator it0;
-  for (it0 = m_chart_texfactory_hash.begin();
-       it0 != m_chart_texfactory_hash.end(); ++it0) {
-    glTexFactory *ptf = it0->second;
-    if (!ptf) continue;
-    wxString chart_full_path = ptf->GetChartPath();
-
-    bGLMemCrunch = g_tex_mem_used >
-                   (double)(g_GLOptions.m_iTextureMemorySize * 1024 * 1024) *
-                       factor * hysteresis;
-    if (!bGLMemCrunch) break;
-
-    // For each canvas
-    for (unsigned int i = 0; i < g_canvasArray.GetCount(); i++) {
-      ChartCanvas *cc = g_canvasArray.Item(i);
-      if (cc) {
-        if (cc->GetVP().b_quilt)  // quilted
-        {
-          if (cc->m_pQuilt && cc->m_pQuilt->IsComposed() &&
-              !cc->m_pQuilt->IsChartInQuilt(chart_full_path)) {
-            ptf->DeleteSomeTextures(g_GLOptions.m_iTextureMemorySize * 1024 *
-                                    1024 * factor * hysteresis);
-          }
-        } else  // not quilted
-        {
-          if (!cc->m_singleChart->GetFullPath().IsSameAs(chart_full_path)) {
-            ptf->DeleteSomeTextures(g_GLOptions.m_iTextureMemorySize * 1024 *
-                                    1024 * factor * hysteresis);
-          }
-        }
-      }
-    }
-  }
+  // Keep everything used in the last render of each canvas.
+  unsigned keep_frames = g_canvasArray.GetCount() + 1;
+  ledger.Enforce(static_cast<size_t>(budget * factor * hysteresis),
+                 keep_frames);
 
   return true;
 }
@@ -74,6 +74,9 @@ static const long long lNaN = 0xfff8000000000000;
 #define LON_UNDEF NAN
 #define LAT_UNDEF NAN
 
+// Upper limit of tiles requested by one ChartMbTiles::PrefetchTiles() call.
+static const uint32_t kMaxPrefetchTiles = 256;
+
 // A "nominal" scale value, by zoom factor.  Estimated at equator, with monitor
 // pixel size of 0.3mm
 static double osm_zoom_scale[22];
@@ -177,6 +180,18 @@ ChartMbTiles::~ChartMbTiles() {
   // Stop the worker thread before destroying this instance
   StopThread();
   FlushTiles();
+
+  if (m_b_cdebug) {
+    TileCacheStats stats = TileCache::GetStats();
+    wxLogMessage(
+        "MBTiles cache: %llu hits, %llu misses, %llu evictions, %d tiles, "
+        "%d of %d MB used",
+        static_cast<unsigned long long>(stats.hits),
+        static_cast<unsigned long long>(stats.misses),
+        static_cast<unsigned long long>(stats.evictions),
+        static_cast<int>(stats.tiles), static_cast<int>(stats.bytes >> 20),
+        static_cast<int>(stats.budget >> 20));
+  }
 }
 
 ThumbData* ChartMbTiles::GetThumbData() { return NULL; }
@@ -390,6 +405,8 @@ InitReturn ChartMbTiles::Init(const wxString& name, ChartInitFlag init_flags) {
   // Initialize the tile data structures
   m_tile_cache = std::make_unique<TileCache>(m_min_zoom, m_max_zoom, m_lon_min,
                                              m_lat_min, m_lon_max, m_lat_max);
+  TileCache::SetBudget(static_cast<size_t>(wxMax(g_mbtilesCacheMB, 0))
+                       << 20);
 
   LLRegion covr_region;
 
@@ -608,6 +625,7 @@ bool ChartMbTiles::GetTileTexture(SharedTilePtr tile) {
   if (tile->m_gl_texture_name > 0) {
     // Yes : bind the texture and return to the caller
     glBindTexture(GL_TEXTURE_2D, tile->m_gl_texture_name);
+    GpuLedger::GetInstance().Touch(tile->m_gpu_handle);
     return true;
   } else if (!tile->m_is_available) {
     // Tile is not in MbTiles file : no texture to render
@@ -645,6 +663,21 @@ bool ChartMbTiles::GetTileTexture(SharedTilePtr tile) {
     free(tile->m_teximage);
     tile->m_teximage = nullptr;
 
+    // When evicted, the tile is loaded again from the database when next
+    // rendered.
+    auto evict = [weak_tile = std::weak_ptr<MbTileDescriptor>(tile)] {
+      SharedTilePtr tile = weak_tile.lock();
+      if (!tile) return;
+      std::lock_guard lock(TileCache::GetMutex(tile));
+      glDeleteTextures(1, &tile->m_gl_texture_name);
+      tile->m_gl_texture_name = 0;
+      tile->m_gpu_handle = 0;
+      tile->m_requested = false;
+    };
+    tile->m_gpu_handle = GpuLedger::GetInstance().Register(
+        m_FullPath.ToStdString(), GpuLedger::Kind::kTileTexture,
+        MbTileDescriptor::kImageBytes, evict);
+
     return true;
   }
 
@@ -895,6 +928,12 @@ bool ChartMbTiles::RenderRegionViewOnGL(const wxGLContext& glc,
   // corresponds to the currently viewed zoom level
   if (m_tile_type == MbTilesType::OVERLAY) zoomFactor = viewZoom;
 
+  // Load pending tiles closest to the view centre first, and drop requests
+  // for tiles which are no longer in view.
+  bool prefetch = g_bMbtilesPrefetch && viewZoom < m_max_zoom;
+  m_worker_thread->SetViewport(screenBox, vpoint.clat, vpoint.clon, zoomFactor,
+                               prefetch ? viewZoom + 1 : viewZoom);
+
   while (zoomFactor <= viewZoom) {
     // Get the tile numbers of the box corners of this render region, at this
     // zoom level
@@ -966,6 +1005,11 @@ bool ChartMbTiles::RenderRegionViewOnGL(const wxGLContext& glc,
 
   glDisable(GL_TEXTURE_2D);
 
+  // Prefetch the next zoom level once all visible tiles are loaded.
+  uint32_t prefetched = 0;
+  if (prefetch && !is_two_pass && m_worker_thread->GetQueueSize() == 0)
+    prefetched = PrefetchTiles(viewZoom + 1, box, region);
+
   m_zoom_scale_factor =
       2 * osm_zoom_mpp[maxren_zoom] * vpoint.view_scale_ppm / zoom_mod;
 
@@ -975,7 +1019,7 @@ bool ChartMbTiles::RenderRegionViewOnGL(const wxGLContext& glc,
   // viewport. This dynamic limit allows to automatically adapt to the actual
   // resolution of the screen and to handle tricky configuration with multiple
   // screens or hdpi displays
-  m_tile_cache->CleanCache(m_tile_count * 3);
+  m_tile_cache->CleanCache((m_tile_count + prefetched) * 3);
 
   if (m_last_clean_zoom != viewZoom) {
     m_tile_cache->DeepCleanCache();
@@ -986,6 +1030,37 @@ bool ChartMbTiles::RenderRegionViewOnGL(const wxGLContext& glc,
   return true;
 }
 
+uint32_t ChartMbTiles::PrefetchTiles(int zoom_level, const LLBBox& box,
+                                     const LLRegion& region) {
+  int top_tile =
+      wxMin(m_tile_cache->GetNorthLimit(zoom_level),
+            MbTileDescriptor::Lat2tiley(box.GetMaxLat(), zoom_level));
+  int bot_tile =
+      wxMax(m_tile_cache->GetSouthLimit(zoom_level),
+            MbTileDescriptor::Lat2tiley(box.GetMinLat(), zoom_level));
+  int left_tile = MbTileDescriptor::Long2tilex(box.GetMinLon(), zoom_level);
+  int right_tile = MbTileDescriptor::Long2tilex(box.GetMaxLon(), zoom_level);
+  if (top_tile < bot_tile || right_tile < left_tile) return 0;
+
+  // Only prefetch if the decoded tiles fit comfortably in the cache budget.
+  auto count = static_cast<uint32_t>((top_tile - bot_tile + 1) *
+                                     (right_tile - left_tile + 1));
+  if (count > kMaxPrefetchTiles ||
+      !TileCache::HasRoomFor(count * MbTileDescriptor::kImageBytes))
+    return 0;
+
+  for (int iy = bot_tile; iy <= top_tile; iy++) {
+    for (int ix = left_tile; ix <= right_tile; ix++) {
+      SharedTilePtr tile = m_tile_cache->GetTile(zoom_level, ix, iy);
+      if (region.IntersectOut(tile->m_box)) continue;
+      if (tile->m_is_available && !tile->m_requested && !tile->m_teximage &&
+          !tile->m_gl_texture_name)
+        m_worker_thread->RequestTile(tile);
+    }
+  }
+  return count;
+}
+
 bool ChartMbTiles::RenderRegionViewOnDC(wxMemoryDC& dc, const ViewPort& VPoint,
                                         const OCPNRegion& Region) {
   top_frame::Get()->SetAlertString(_("MBTile requires OpenGL to be enabled"));
@@ -993,10 +1068,9 @@ bool ChartMbTiles::RenderRegionViewOnDC(wxMemoryDC& dc, const ViewPort& VPoint,
 }
 
 bool ChartMbTiles::StartThread() {
-  // Create the worker thread
+  // Create the worker threads
   m_worker_thread = std::make_unique<MbtTilesThread>(m_db);
-  m_thread = std::thread([&] { m_worker_thread->Run(); });
-  m_thread.detach();
+  m_worker_thread->Start();
   return true;
 }
 
@@ -1,9 +1,48 @@
 #include "tile_cache.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
 
+#ifdef __ANDROID__
+static const size_t kDefaultBudget = 128 << 20;
+#else
+static const size_t kDefaultBudget = 256 << 20;
+#endif
+
+/** Tiles used more recently than this are never evicted. */
+static const std::chrono::milliseconds kMinAge(1000);
+
+namespace {
+
+/** State shared by all TileCache instances. */
+struct SharedState {
+  std::mutex mutex;  ///< Guards caches
+  std::vector<TileCache*> caches;
+  std::atomic<size_t> bytes{0};
+  std::atomic<size_t> budget{kDefaultBudget};
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> evictions{0};
+};
+
+SharedState& Shared() {
+  static SharedState shared;
+  return shared;
+}
+
+std::chrono::milliseconds Now() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch());
+}
+
+}  // namespace
+
 TileCache::TileCache(int min_zoom, int max_zoom, float Lon_min, float Lat_min,
                      float lon_max, float lat_max)
-    : m_min_zoom(min_zoom),
+    : m_bytes(0),
+      m_min_zoom(min_zoom),
       m_max_zoom(max_zoom),
       m_nb_zoom(max_zoom - min_zoom + 1),
       zoom_table([&] {
@@ -27,6 +66,20 @@ TileCache::TileCache(int min_zoom, int max_zoom, float Lon_min, float Lat_min,
     if (gl_texture_name) glDeleteTextures(1, &gl_texture_name);
   };
   delete_listener.Init(on_delete, action);
+
+  auto& shared = Shared();
+  std::lock_guard lock(shared.mutex);
+  shared.caches.push_back(this);
+}
+
+TileCache::~TileCache() {
+  {
+    auto& shared = Shared();
+    std::lock_guard lock(shared.mutex);
+    auto& caches = shared.caches;
+    caches.erase(std::remove(caches.begin(), caches.end(), this), caches.end());
+  }
+  Flush();
 }
 
 std::mutex& TileCache::GetMutex(uint64_t tile_id) {
@@ -41,62 +94,125 @@ std::mutex& TileCache::GetMutex(const SharedTilePtr& tile) {
   return TileCache::GetMutex(key);
 }
 
+void TileCache::SetBudget(size_t bytes) {
+  Shared().budget = bytes ? bytes : kDefaultBudget;
+}
+
+TileCacheStats TileCache::GetStats() {
+  auto& shared = Shared();
+  TileCacheStats stats;
+  stats.hits = shared.hits;
+  stats.misses = shared.misses;
+  stats.evictions = shared.evictions;
+  stats.bytes = shared.bytes;
+  stats.budget = shared.budget;
+  std::lock_guard lock(shared.mutex);
+  for (auto* cache : shared.caches) stats.tiles += cache->m_tile_map.size();
+  return stats;
+}
+
+bool TileCache::HasRoomFor(size_t bytes) {
+  auto& shared = Shared();
+  return shared.bytes + bytes <= shared.budget / 2;
+}
+
+void TileCache::Flush() {
+  Shared().bytes -= m_bytes;
+  m_bytes = 0;
+  m_lru.clear();
+  m_tile_map.clear();
+}
+
 SharedTilePtr TileCache::GetTile(int z, int x, int y) {
   uint64_t index = MbTileDescriptor::GetMapKey(z, x, y);
   auto ref = m_tile_map.find(index);
   if (ref != m_tile_map.end()) {
     // The tile is in the cache
-    ref->second->SetTimestamp();
-    return ref->second;
+    Entry& entry = ref->second;
+    entry.tile->SetTimestamp();
+    m_lru.splice(m_lru.begin(), m_lru, entry.lru);
+    Shared().hits++;
+    return entry.tile;
   }
 
   // The tile is not in the cache : create an empty one and add it to the tile
   // map and list
   auto tile = std::make_shared<MbTileDescriptor>(z, x, y, on_delete);
-  m_tile_map[index] = tile;
+  m_lru.push_front(index);
+  Entry& entry = m_tile_map[index];
+  entry.tile = tile;
+  entry.lru = m_lru.begin();
+  Shared().misses++;
   return tile;
 }
 
-void TileCache::CleanCache(uint32_t max_tiles) {
-  if (m_tile_map.size() <= max_tiles) return;
+void TileCache::Account() {
+  // Images are decoded by the worker threads and uploaded to textures by
+  // the rendering thread, so sizes change behind our back: recount.
+  size_t bytes = 0;
+  for (auto& kv : m_tile_map) {
+    kv.second.bytes = kv.second.tile->GetMemorySize();
+    bytes += kv.second.bytes;
+  }
+  auto& shared = Shared();
+  shared.bytes -= m_bytes;
+  shared.bytes += bytes;
+  m_bytes = bytes;
+}
 
-  // Create a sorted list of keys, oldest first.
-  std::vector<uint64_t> keys;
-  for (auto& kv : m_tile_map) keys.push_back(kv.first);
-  auto compare = [&](const uint64_t lhs, const uint64_t rhs) {
-    return m_tile_map[lhs]->m_last_used < m_tile_map[rhs]->m_last_used;
-  };
-  std::sort(keys.begin(), keys.end(), compare);
+const SharedTilePtr* TileCache::GetEvictable() const {
+  if (m_lru.empty()) return nullptr;
+  const SharedTilePtr& tile = m_tile_map.at(m_lru.back()).tile;
+  if (Now() - tile->m_last_used < kMinAge) return nullptr;
+  return &tile;
+}
+
+void TileCache::Evict(uint64_t key) {
+  auto it = m_tile_map.find(key);
+  if (it == m_tile_map.end()) return;
+  std::lock_guard lock(TileCache::GetMutex(it->second.tile));
+  m_bytes -= it->second.bytes;
+  Shared().bytes -= it->second.bytes;
+  m_lru.erase(it->second.lru);
+  m_tile_map.erase(it);
+  Shared().evictions++;
+}
 
-  for (size_t i = 0; i < m_tile_map.size() - max_tiles; i += 1) {
-    std::lock_guard lock(TileCache::GetMutex(m_tile_map[keys[i]]));
-    auto tile = m_tile_map[keys[i]];
-    m_tile_map.erase(keys[i]);
+void TileCache::EnforceBudget() {
+  auto& shared = Shared();
+  std::lock_guard lock(shared.mutex);
+  while (shared.bytes > shared.budget) {
+    // Evict the least recently used tile of all caches.
+    TileCache* oldest_cache = nullptr;
+    const SharedTilePtr* oldest = nullptr;
+    for (auto* cache : shared.caches) {
+      const SharedTilePtr* tile = cache->GetEvictable();
+      if (tile && (!oldest || (*tile)->m_last_used < (*oldest)->m_last_used)) {
+        oldest = tile;
+        oldest_cache = cache;
+      }
+    }
+    if (!oldest_cache) break;
+    oldest_cache->Evict(oldest_cache->m_lru.back());
   }
 }
 
-void TileCache::DeepCleanCache() {
-  using namespace std::chrono;
-  auto time_now =
-      duration_cast<milliseconds>(system_clock::now().time_since_epoch());
+void TileCache::CleanCache(uint32_t max_tiles) {
+  Account();
+  while (m_tile_map.size() > max_tiles && GetEvictable()) Evict(m_lru.back());
+  EnforceBudget();
+}
 
+void TileCache::DeepCleanCache() {
+  //  Looking for tiles that have been fetched from sql,
+  //  but not yet rendered.  Such tiles contain a large bitmap allocation.
+  //  After some time, it is likely they never will be needed in short term.
+  //  So safe to delete, and reload as necessary.
   auto age_limit = std::chrono::duration<int>(5);  // 5 seconds
-
-  std::vector<uint64_t> keys;
-  for (auto& kv : m_tile_map) keys.push_back(kv.first);
-
-  for (size_t i = 0; i < keys.size(); i += 1) {
-    std::lock_guard lock(TileCache::GetMutex(m_tile_map[keys[i]]));
-    auto tile = m_tile_map[keys[i]];
-    const std::chrono::duration<double> elapsed_seconds{time_now -
-                                                        tile->m_last_used};
-
-    //  Looking for tiles that have been fetched from sql,
-    //  but not yet rendered.  Such tiles contain a large bitmap allocation.
-    //  After some time, it is likely they never will be needed in short term.
-    //  So safe to delete, and reload as necessary.
-    if (elapsed_seconds > age_limit) {
-      m_tile_map.erase(keys[i]);
-    }
+  auto time_now = Now();
+  while (!m_lru.empty()) {
+    const auto& tile = m_tile_map.at(m_lru.back()).tile;
+    if (time_now - tile->m_last_used <= age_limit) break;
+    Evict(m_lru.back());
   }
 }
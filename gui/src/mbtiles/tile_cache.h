@@ -1,12 +1,35 @@
 #ifndef _TILECACHE_H_
 #define _TILECACHE_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <list>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "tile_descr.h"
 #include "observable_evtvar.h"
 
-/** Manage the tiles of a mbtiles file. */
+/** Tile cache statistics, summed over all TileCache instances. */
+struct TileCacheStats {
+  uint64_t hits = 0;       ///< GetTile() calls finding the tile
+  uint64_t misses = 0;     ///< GetTile() calls creating a new tile
+  uint64_t evictions = 0;  ///< Tiles dropped by CleanCache()
+  size_t bytes = 0;        ///< Image and texture bytes held by tiles
+  size_t budget = 0;       ///< Byte budget, see TileCache::SetBudget()
+  size_t tiles = 0;        ///< Number of cached tiles
+};
+
+/**
+ * Manage the tiles of a mbtiles file.
+ *
+ * Tiles are kept in least recently used order. Decoded images and OpenGL
+ * textures held by the tiles are accounted for in a byte budget shared by
+ * all instances: when exceeded, CleanCache() evicts the least recently
+ * used tiles from any instance. Tiles used during the last second are
+ * never evicted, so a view needing more than the budget does not thrash.
+ */
 class TileCache {
   //  Per zoomlevel descriptor of tile array for that zoomlevel
   class ZoomDescriptor {
@@ -17,19 +40,44 @@ class TileCache {
     int m_tile_y_max;
   };
 
+  struct Entry {
+    SharedTilePtr tile;
+    std::list<uint64_t>::iterator lru;  ///< Position in m_lru
+    size_t bytes = 0;  ///< GetMemorySize() as of last accounting
+  };
+
 private:
   const double kEps = 6e-6;  // about 1cm on earth's surface at equator
-  std::unordered_map<uint64_t, SharedTilePtr> m_tile_map;
+  std::unordered_map<uint64_t, Entry> m_tile_map;
+  std::list<uint64_t> m_lru;  ///< Tile keys, most recently used first
+  size_t m_bytes;             ///< Sum of Entry::bytes
   const int m_min_zoom;
   const int m_max_zoom;
   const int m_nb_zoom;
   const std::vector<ZoomDescriptor> zoom_table;
   ObsListener delete_listener;
 
+  /** Refresh byte accounting of all tiles. */
+  void Account();
+
+  /** Return the least recently used tile if evictable, else nullptr. */
+  const SharedTilePtr* GetEvictable() const;
+
+  /** Remove tile with given key, counting it as an eviction. */
+  void Evict(uint64_t key);
+
+  /** Evict tiles from all instances until within the byte budget. */
+  static void EnforceBudget();
+
 public:
   TileCache(int min_zoom, int max_zoom, float Lon_min, float Lat_min,
             float lon_max, float lat_max);
 
+  ~TileCache();
+
+  TileCache(const TileCache&) = delete;
+  TileCache& operator=(const TileCache&) = delete;
+
   /** Notified with a GLUint and const char* when a tile goes out of scope. */
   EventVar on_delete;
 
@@ -47,8 +95,23 @@ public:
    */
   static std::mutex& GetMutex(const SharedTilePtr& tile);
 
+  /**
+   * Set byte budget shared by all instances.
+   * @param bytes Budget, 0 restores the default.
+   */
+  static void SetBudget(size_t bytes);
+
+  /** Return statistics summed over all instances. */
+  static TileCacheStats GetStats();
+
+  /**
+   * Return true if given number of additional bytes fits in the first
+   * half of the budget, used to decide whether to prefetch tiles.
+   */
+  static bool HasRoomFor(size_t bytes);
+
   /** Flush the tile cache, including OpenGL texture memory if needed */
-  void Flush() { m_tile_map.clear(); }
+  void Flush();
 
   /**
    * Get the north limit of the cache area for a given zoom in WMTS coordinates.
@@ -81,8 +144,9 @@ public:
   SharedTilePtr GetTile(int z, int x, int y);
 
   /**
-   *  Reduce the size of the cache if it exceeds the given limit. Must
-   *  only be called by rendering thread since it uses OpenGL calls.
+   *  Reduce the size of the cache if it exceeds the given limit or the
+   *  byte budget. Must only be called by rendering thread since it uses
+   *  OpenGL calls.
    *  @param max_tiles Maximum number of tiles to be kept in the cache.
    */
   void CleanCache(uint32_t max_tiles);
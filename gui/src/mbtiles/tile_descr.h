@@ -7,6 +7,8 @@
 #include <cstdint>
 #include <memory>
 
+#include "model/gpu_ledger.h"
+
 #include "chartbase.h"
 #include "gl_chart_canvas.h"
 #include "observable_evtvar.h"
@@ -19,6 +21,9 @@ static const double kEps = 6e-6;  // about 1cm on earth's surface at equator
 
 class MbTileDescriptor {
 public:
+  /** Size of a decoded tile image, and of its texture. */
+  static const size_t kImageBytes = 256 * 256 * 4;
+
   int m_tile_x;
   int m_tile_y;
   int m_zoom_level;
@@ -31,7 +36,7 @@ public:
 
   /// Set to true if a load request from main thread is already pending for this
   /// tile
-  bool m_requested;
+  std::atomic<bool> m_requested;
 
   /// Pointer to the decompressed tile image
   unsigned char* m_teximage;
@@ -39,6 +44,9 @@ public:
   /// Identifier of the tile texture in OpenGL memory
   GLuint m_gl_texture_name;
 
+  /// GpuLedger entry of the texture, 0 if none
+  GpuLedger::Handle m_gpu_handle;
+
   /// Set to true if the tile has not been found into the SQL database.
   std::atomic<bool> m_is_available;
 
@@ -65,6 +73,7 @@ public:
         m_requested(false),
         m_teximage(nullptr),
         m_gl_texture_name(0),
+        m_gpu_handle(0),
         m_is_available(true),
         m_on_delete(on_delete) {
     m_box.Set(m_latmin, m_lonmin, m_latmax, m_lonmax);
@@ -72,6 +81,7 @@ public:
   }
 
   virtual ~MbTileDescriptor() {
+    GpuLedger::GetInstance().Release(m_gpu_handle);
     if (m_gl_texture_name || m_teximage) {
       // Message to main thread: Deallocate GL buffers.
       m_on_delete.Notify(static_cast<int>(m_gl_texture_name), m_teximage);
@@ -130,6 +140,12 @@ public:
     return 180.0 / M_PI * lat_rad;
   }
 
+  /** Return bytes of decoded image and texture memory held by tile. */
+  size_t GetMemorySize() const {
+    return (m_teximage ? kImageBytes : 0) +
+           (m_gl_texture_name ? kImageBytes : 0);
+  }
+
   /** Update m_last_used to current time. */
   void SetTimestamp() {
     using namespace std::chrono;
@@ -1,13 +1,34 @@
 #ifndef _MBTILESTILEQUEUE_H_
 #define _MBTILESTILEQUEUE_H_
 
+#include <algorithm>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <vector>
 
 #include "tile_descr.h"
 
-/** A thread safe tile queue between two threads. */
+/**
+ * Load order of a queued tile: lower zoom levels first since these give
+ * a coarse coverage of the view using few tiles, then closest to the
+ * viewport centre.
+ */
+struct TilePriority {
+  int zoom_level = 0;
+  /** Distance to viewport centre, in tiles at tile's zoom level */
+  double distance = 0;
+
+  bool operator<(const TilePriority& other) const {
+    if (zoom_level != other.zoom_level) return zoom_level < other.zoom_level;
+    return distance < other.distance;
+  }
+};
+
+/**
+ * A thread safe tile priority queue between the main thread and the
+ * worker threads.
+ */
 class TileQueue {
 public:
   TileQueue() {}
@@ -15,37 +36,82 @@ public:
   /**
    *  Push a tile to the queue.
    *  @param tile Pointer to tile descriptor to be pushed.
+   *  @param priority Tile load order, see TilePriority
    */
-  void Push(SharedTilePtr tile) {
+  void Push(SharedTilePtr tile, TilePriority priority = {}) {
     {
       std::lock_guard lock(m_mutex);
-      m_tile_list.push_back(tile);
+      m_heap.push_back({std::move(tile), priority});
+      std::push_heap(m_heap.begin(), m_heap.end(), Later);
     }
-    m_cv.notify_all();
+    m_cv.notify_one();
   }
 
   /**
-   *  Retrieve a tile from the queue. If there is no tile in the queue,
-   *  calling thread is blocked until a tile is available.
+   *  Retrieve the tile with highest priority from the queue. If there is no
+   *  tile in the queue, calling thread is blocked until a tile is available
+   *  or Stop() is invoked.
    *
-   *  @return Pointer to tile descriptor
+   *  @return Pointer to tile descriptor, nullptr after Stop().
    */
   SharedTilePtr Pop() {
     std::unique_lock lock(m_mutex);
-    m_cv.wait(lock, [&] { return m_tile_list.size() > 0; });
-    auto tile = m_tile_list.at(0);
-    m_tile_list.erase(m_tile_list.cbegin());
+    m_cv.wait(lock, [&] { return m_heap.size() > 0 || m_stopped; });
+    if (m_stopped) return nullptr;
+    std::pop_heap(m_heap.begin(), m_heap.end(), Later);
+    auto tile = std::move(m_heap.back().tile);
+    m_heap.pop_back();
     return tile;
   }
 
+  /**
+   * Update priority of all queued tiles, removing tiles for which
+   * update returns false.
+   * @return Removed tiles.
+   */
+  std::vector<SharedTilePtr> Update(
+      const std::function<bool(const SharedTilePtr&, TilePriority&)>& update) {
+    std::vector<SharedTilePtr> removed;
+    std::lock_guard lock(m_mutex);
+    auto remove = [&](Entry& entry) {
+      if (update(entry.tile, entry.priority)) return false;
+      removed.push_back(std::move(entry.tile));
+      return true;
+    };
+    m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(), remove),
+                 m_heap.end());
+    std::make_heap(m_heap.begin(), m_heap.end(), Later);
+    return removed;
+  }
+
+  /** Wake up all threads blocked in Pop(), making it return nullptr. */
+  void Stop() {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stopped = true;
+    }
+    m_cv.notify_all();
+  }
+
   /**  Retrieve current size of queue. */
   uint32_t GetSize() {
     std::lock_guard lock(m_mutex);
-    return m_tile_list.size();
+    return m_heap.size();
   }
 
 private:
-  std::vector<SharedTilePtr> m_tile_list;
+  struct Entry {
+    SharedTilePtr tile;
+    TilePriority priority;
+  };
+
+  /** Heap ordering, putting the tile to load first on top. */
+  static bool Later(const Entry& lhs, const Entry& rhs) {
+    return rhs.priority < lhs.priority;
+  }
+
+  std::vector<Entry> m_heap;
+  bool m_stopped = false;
   std::mutex m_mutex;
   std::condition_variable m_cv;
 };
@@ -1,4 +1,7 @@
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <mutex>
 
 #include <wx/app.h>
@@ -15,6 +18,30 @@ void my_translate_mbtile(unsigned int code, _EXCEPTION_POINTERS* ep) {
 }
 #endif
 
+/** Minimum interval between display refreshes while loading tiles, ms. */
+static const long long kRefreshInterval = 250;
+
+MbtTilesThread::MbtTilesThread(std::shared_ptr<SQLite::Database> db,
+                               unsigned workers)
+    : m_db(db),
+      m_worker_count(workers),
+      m_last_refresh(0),
+      m_view_clat(0),
+      m_view_clon(0),
+      m_view_min_zoom(0),
+      m_view_max_zoom(0) {
+  if (m_worker_count == 0) {
+    m_worker_count = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+  }
+}
+
+MbtTilesThread::~MbtTilesThread() { RequestStop(); }
+
+void MbtTilesThread::Start() {
+  for (unsigned i = 0; i < m_worker_count; i++)
+    m_threads.emplace_back([this] { Run(); });
+}
+
 /**
  * Request a tile to be loaded by the thread. This method is thread
  * safe.
@@ -22,23 +49,84 @@ void my_translate_mbtile(unsigned int code, _EXCEPTION_POINTERS* ep) {
  */
 void MbtTilesThread::RequestTile(SharedTilePtr tile) {
   tile->m_requested = true;
-  m_tile_queue.Push(tile);
+  TilePriority priority = GetPriority(*tile);
+  m_tile_queue.Push(tile, priority);
+}
+
+void MbtTilesThread::SetViewport(const LLBBox& box, double clat, double clon,
+                                 int min_zoom, int max_zoom) {
+  if (!box.GetValid()) return;
+  if (box.GetMinLat() == m_view_box.GetMinLat() &&
+      box.GetMaxLat() == m_view_box.GetMaxLat() &&
+      box.GetMinLon() == m_view_box.GetMinLon() &&
+      box.GetMaxLon() == m_view_box.GetMaxLon() && clat == m_view_clat &&
+      clon == m_view_clon && min_zoom == m_view_min_zoom &&
+      max_zoom == m_view_max_zoom)
+    return;
+
+  m_view_box = box;
+  m_view_clat = clat;
+  m_view_clon = clon;
+  m_view_min_zoom = min_zoom;
+  m_view_max_zoom = max_zoom;
+
+  auto update = [&](const SharedTilePtr& tile, TilePriority& priority) {
+    // Tiles only referenced by the queue have been dropped from the cache.
+    if (tile.use_count() == 1) return false;
+    if (tile->m_zoom_level < min_zoom || tile->m_zoom_level > max_zoom)
+      return false;
+    if (box.IntersectOut(tile->m_box)) return false;
+    priority = GetPriority(*tile);
+    return true;
+  };
+  auto cancelled = m_tile_queue.Update(update);
+
+  // Cancelled tiles are requested again if they come back into view.
+  for (auto& tile : cancelled) tile->m_requested = false;
+}
+
+TilePriority MbtTilesThread::GetPriority(const MbTileDescriptor& tile) const {
+  double n = 1 << tile.m_zoom_level;
+  double lat = std::clamp(m_view_clat, -85.0511, 85.0511) * M_PI / 180.0;
+
+  // Viewport centre in fractional tile coordinates at the tile zoom level,
+  // using the same row numbering as Lat2tiley()
+  double cx = (m_view_clon + 180.0) / 360.0 * n;
+  double cy = n - (1.0 - log(tan(lat) + 1.0 / cos(lat)) / M_PI) / 2.0 * n;
+
+  double dx = std::fmod(std::fabs(tile.m_tile_x + 0.5 - cx), n);
+  dx = std::min(dx, n - dx);  // Closest way around the antimeridian
+  double dy = tile.m_tile_y + 0.5 - cy;
+  return {tile.m_zoom_level, std::hypot(dx, dy)};
 }
 
 void MbtTilesThread::RequestStop() {
-  m_exit_thread = true;
-  m_tile_queue.Push(nullptr);
-  int tsec = 10;
-  wxMilliSleep(10);
-
-  while ((!m_finished) && (tsec--)) {
-    wxYield();
-    wxMilliSleep(10);
+  m_tile_queue.Stop();
+  for (auto& thread : m_threads) {
+    if (thread.joinable()) thread.join();
   }
+  m_threads.clear();
 }
 
 size_t MbtTilesThread::GetQueueSize() { return m_tile_queue.GetSize(); }
 
+void MbtTilesThread::RequestRefresh(bool force) {
+  using namespace std::chrono;
+  long long now =
+      duration_cast<milliseconds>(steady_clock::now().time_since_epoch())
+          .count();
+  long long last = m_last_refresh.load();
+  if (!force && now - last < kRefreshInterval) return;
+  // Another worker might just have refreshed, no need to do it twice.
+  if (!m_last_refresh.compare_exchange_strong(last, now) && !force) return;
+
+  wxWeakRef<wxWindow> frame(wxTheApp->GetTopWindow());
+  if (!frame) return;
+  frame->CallAfter([frame]() {
+    if (frame) frame->Refresh();
+  });
+}
+
 void MbtTilesThread::Run() {
 #ifdef __MSVC__
   _set_se_translator(my_translate_mbtile);
@@ -49,34 +137,44 @@ void MbtTilesThread::Run() {
   //  got done, and maybe try again later.
 
 #endif
+  if (!m_db) return;
 
-  SharedTilePtr tile;
-  do {
-    // Wait for the next job
-    tile = m_tile_queue.Pop();
-    // Only process non null tiles. A null pointer can be sent to force the
-    // thread to check for a deletion request
-    if (tile != nullptr) {
-      LoadTile(tile);
-    }
-    // Only request a refresh of the display when there is no more tiles in
-    // the queue.
-    if (m_tile_queue.GetSize() == 0) {
-      wxWeakRef<wxWindow> frame(wxTheApp->GetTopWindow());
-      frame->CallAfter([frame]() {
-        if (frame) frame->Refresh();
-      });
-    }
+  // Each worker uses a connection of its own so that reads are not
+  // serialized on the connection mutex. Fall back to the shared one.
+  std::shared_ptr<SQLite::Database> db = m_db;
+  try {
+    db = std::make_shared<SQLite::Database>(m_db->getFilename(),
+                                            SQLite::OPEN_READONLY);
+  } catch (std::exception& e) {
+    wxLogMessage("mbtiles worker connection: %s", e.what());
+  }
 
-    // Check if the thread has been requested to be destroyed
-  } while (!m_exit_thread);
+  std::unique_ptr<SQLite::Statement> query;
+  try {
+    query = std::make_unique<SQLite::Statement>(
+        *db,
+        "select tile_data from tiles where zoom_level = ? AND "
+        "tile_column = ? AND tile_row = ?");
+  } catch (std::exception& e) {
+    wxLogMessage("mbtiles std::exception: %s", e.what());
+    return;
+  }
 
-  // Since the worker is a detached thread, we need a special mecanism to
-  // allow the main thread to wait for its deletion
-  m_finished = true;
+  // Pop() returns nullptr when the thread has been requested to stop.
+  while (SharedTilePtr tile = m_tile_queue.Pop()) {
+    // Tiles dropped from the cache while queued are not needed anymore.
+    if (tile.use_count() == 1) {
+      tile->m_requested = false;
+      continue;
+    }
+    LoadTile(tile, *query);
+    // Request a refresh of the display when there is no more tiles in the
+    // queue, and now and then while loading many tiles.
+    RequestRefresh(m_tile_queue.GetSize() == 0);
+  }
 }
 
-void MbtTilesThread::LoadTile(SharedTilePtr tile) {
+void MbtTilesThread::LoadTile(SharedTilePtr tile, SQLite::Statement& query) {
   std::lock_guard lock(TileCache::GetMutex(tile));
 
   // If the tile has not been found in the SQL database in a previous attempt,
@@ -90,14 +188,10 @@ void MbtTilesThread::LoadTile(SharedTilePtr tile) {
 
   // Fetch the tile data from the mbtile database
   try {
-    char qrs[2100];
-
-    // Compile a SQL query, getting the specific blob
-    sprintf(qrs,
-            "select tile_data, length(tile_data) from tiles where zoom_level "
-            "= %d AND tile_column=%d AND tile_row=%d",
-            tile->m_zoom_level, tile->m_tile_x, tile->m_tile_y);
-    SQLite::Statement query(*m_db, qrs);
+    query.reset();
+    query.bind(1, tile->m_zoom_level);
+    query.bind(2, tile->m_tile_x);
+    query.bind(3, tile->m_tile_y);
 
     int queryResult = query.tryExecuteStep();
     if (SQLITE_DONE == queryResult) {
@@ -105,17 +199,23 @@ void MbtTilesThread::LoadTile(SharedTilePtr tile) {
       // that we won't try to find it again later
       tile->m_is_available = false;
       return;
+    } else if (SQLITE_ROW != queryResult) {
+      // Transient error, allow the tile to be requested again.
+      tile->m_requested = false;
+      return;
     } else {
       // Get the blob
       SQLite::Column blobColumn = query.getColumn(0);
       const void* blob = blobColumn.getBlob();
       // Get the length
-      int length = query.getColumn(1);
+      int length = blobColumn.getBytes();
 
       // Uncompress the tile
       wxMemoryInputStream blobStream(blob, length);
       wxImage blobImage;
       blobImage = wxImage(blobStream, wxBITMAP_TYPE_ANY);
+      // Done with the blob, end the read transaction.
+      query.reset();
       int blobWidth, blobHeight;
       unsigned char* imgdata;
 
@@ -2,7 +2,10 @@
 #ifndef _MBTILESTHREAD_H_
 #define _MBTILESTHREAD_H_
 
+#include <atomic>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include <wx/event.h>
 #include <wx/mstream.h>
@@ -28,20 +31,29 @@ public:
 #endif
 
 /**
- *  MbTiles chart decoder worker thread. Receives requests from
+ *  MbTiles chart decoder worker threads. Receives requests from
  *  the MbTile front-end to load and uncompress tiles from an MbTiles file. Once
  *  done, the tile list in memory is updated and a refresh of the map triggered.
+ *
+ *  Each worker uses its own database connection and prepared statement.
+ *  Requests are served in TilePriority order relative to the viewport set
+ *  using SetViewport(), which also cancels requests for tiles no longer in
+ *  view.
  */
 class MbtTilesThread {
 public:
   /**
    * Create worker thread instance.
-   * @param pDB Pointer to SQL database handler.
+   * @param db Pointer to SQL database handler.
+   * @param workers Number of worker threads, 0 means one per hardware
+   *        thread but at most four.
    */
-  MbtTilesThread(std::shared_ptr<SQLite::Database> db)
-      : m_exit_thread(false), m_finished(false), m_db(db) {}
+  MbtTilesThread(std::shared_ptr<SQLite::Database> db, unsigned workers = 0);
 
-  virtual ~MbtTilesThread() {}
+  virtual ~MbtTilesThread();
+
+  /** Start the worker threads. */
+  void Start();
 
   /**
    * Request a tile to be loaded by the thread. This method is thread
@@ -50,7 +62,20 @@ public:
    */
   void RequestTile(SharedTilePtr tile);
 
-  /** Request the thread to stop/delete itself. */
+  /**
+   * Set the current viewport. Queued requests are reordered, and requests
+   * for tiles outside box or the zoom level range are cancelled. Must be
+   * called from the main thread, like RequestTile().
+   * @param box Viewport extent
+   * @param clat Viewport centre latitude
+   * @param clon Viewport centre longitude
+   * @param min_zoom Lowest zoom level rendered
+   * @param max_zoom Highest zoom level rendered
+   */
+  void SetViewport(const LLBBox& box, double clat, double clon, int min_zoom,
+                   int max_zoom);
+
+  /** Request the threads to stop and wait for them to exit. */
   void RequestStop();
 
   /** Return number of tiles in worker thread queue. */
@@ -60,23 +85,37 @@ public:
   virtual void Run();
 
 private:
-  /// Set to true to tell the main loop to stop execution
-  bool m_exit_thread;
-
-  /// Set to true when the thread has finished
-  bool m_finished;
-
   /// The queue storing all the tile requests
   TileQueue m_tile_queue;
 
   /// Pointer to SQL object managing the MbTiles file
   std::shared_ptr<SQLite::Database> m_db;
 
+  std::vector<std::thread> m_threads;
+  unsigned m_worker_count;
+
+  /// Time of last display refresh request, ms since epoch
+  std::atomic<long long> m_last_refresh;
+
+  /// Current viewport, only accessed by main thread
+  LLBBox m_view_box;
+  double m_view_clat;
+  double m_view_clon;
+  int m_view_min_zoom;
+  int m_view_max_zoom;
+
+  /** Return load order of tile relative to current viewport. */
+  TilePriority GetPriority(const MbTileDescriptor& tile) const;
+
+  /** Request a display refresh, rate limited unless forced. */
+  void RequestRefresh(bool force);
+
   /**
    * Load bitmap data of a tile from the MbTiles file to the tile cache
    * @param tile Pointer to the tile to be loaded
+   * @param query Prepared tile query, parameters zoom level, column and row.
    */
-  void LoadTile(SharedTilePtr tile);
+  void LoadTile(SharedTilePtr tile, SQLite::Statement& query);
 };
 
 #endif /* _MBTILESTHREAD_H_ */
@@ -540,6 +540,10 @@ int MyConfig::LoadMyConfigRaw(bool bAsTemplate) {
   Read("TalkerIdText", &g_TalkerIdText);
   Read("MaxWaypointNameLength", &g_maxWPNameLength);
   Read("MbtilesMaxLayers", &g_mbtilesMaxLayers);
+  Read("MbtilesCacheMB", &g_mbtilesCacheMB);
+  Read("MbtilesPrefetch", &g_bMbtilesPrefetch);
+  Read("LazyTrackLoading", &g_bLazyTrackLoad);
+  Read("LazyTrackPoints", &g_lazyTrackPoints);
 
   Read("ShowTrackPointTime", &g_bShowTrackPointTime, true);
   /* opengl options */
@@ -23,6 +23,7 @@
 
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <setjmp.h>
 
@@ -139,6 +140,49 @@ void Osenc_instreamFile::Init() {
   m_ok = false;
 }
 
+//--------------------------------------------------------------------------
+//      Osenc_instreamMapped implementation
+//      A memory mapped file stream
+//--------------------------------------------------------------------------
+Osenc_instreamMapped::Osenc_instreamMapped() : m_pos(0), m_ok(false) {}
+
+Osenc_instreamMapped::~Osenc_instreamMapped() {}
+
+bool Osenc_instreamMapped::Open(const wxString &senc_file_name) {
+  m_file = std::make_shared<MappedFile>(senc_file_name.ToUTF8().data());
+  m_pos = 0;
+  m_ok = m_file->IsOpen();
+  if (m_ok) m_file->Advise(MappedFile::Access::kSequential);
+  return m_ok;
+}
+
+void Osenc_instreamMapped::Close() {
+  m_pos = 0;
+  m_ok = false;
+}
+
+const unsigned char *Osenc_instreamMapped::Next(size_t size) {
+  if (!m_ok || !m_file->Contains(m_pos, size)) {
+    m_ok = false;
+    return NULL;
+  }
+  const unsigned char *p = m_file->Data() + m_pos;
+  m_pos += size;
+  return p;
+}
+
+Osenc_instream &Osenc_instreamMapped::Read(void *buffer, size_t size) {
+  const unsigned char *p = Next(size);
+  if (p) memcpy(buffer, p, size);
+  return *this;
+}
+
+bool Osenc_instreamMapped::IsOk() { return m_ok; }
+
+bool Osenc_instreamMapped::isAvailable() { return true; }
+
+void Osenc_instreamMapped::Shutdown() {}
+
 //--------------------------------------------------------------------------
 //      Osenc_outstreamFile implementation
 //      A simple file stream implementation based on wxFFileOutStream
@@ -155,6 +199,10 @@ bool Osenc_outstreamFile::Open(const wxString &file) {
   return m_ok;
 }
 
+wxFileOffset Osenc_outstreamFile::Tell() {
+  return m_outstream ? m_outstream->TellO() : wxInvalidOffset;
+}
+
 void Osenc_outstreamFile::Close() {
   if (m_outstream) m_ok = m_outstream->Close();
 }
@@ -245,6 +293,8 @@ void Osenc::init() {
   m_bVerbose = true;
   g_OsencVerbose = true;
   m_NoErrDialog = false;
+  m_cancel = nullptr;
+  m_feature_count = 0;
 
   //      Insert my local error handler to catch OGR errors,
   //      Especially CE_Fatal type errors
@@ -519,7 +569,7 @@ std::string Osenc::GetAttributeAcronymFromTypecode(int typeCode) {
 
 int Osenc::ingest200(const wxString &senc_file_name,
                      S57ObjVector *pObjectVector, VE_ElementVector *pVEArray,
-                     VC_ElementVector *pVCArray) {
+                     VC_ElementVector *pVCArray, Osenc_storage *storage) {
   int ret_val = SENC_NO_ERROR;  // default is OK
 
   //    wxFileName fn(senc_file_name);
@@ -537,9 +587,10 @@ int Osenc::ingest200(const wxString &senc_file_name,
   //     wxBufferedInputStream fpx( fpx_u );
 
   //    Sanity check for existence of file
-  Osenc_instreamFile fpx;
+  Osenc_instreamMapped fpx;
   fpx.Open(senc_file_name);
   if (!fpx.IsOk()) return ERROR_SENCFILE_NOT_FOUND;
+  if (storage) storage->file = fpx.GetFile();
 
   S57Obj *obj = 0;
   int featureID;
@@ -553,7 +604,16 @@ int Osenc::ingest200(const wxString &senc_file_name,
     //        long off = fpx.TellI();
 
     fpx.Read(&record, sizeof(OSENC_Record_Base));
-    if (!fpx.IsOk()) {
+    if (!fpx.IsOk() || record.record_length < sizeof(OSENC_Record_Base)) {
+      dun = 1;
+      break;
+    }
+
+    //  Get the record payload, in place in the mapped file if possible.
+    //  Unknown records are skipped as a whole.
+    unsigned char *buf =
+        getPayload(fpx, record.record_length - sizeof(OSENC_Record_Base));
+    if (!buf) {
       dun = 1;
       break;
     }
@@ -561,48 +621,20 @@ int Osenc::ingest200(const wxString &senc_file_name,
     // Process Records
     switch (record.record_type) {
       case HEADER_SENC_VERSION: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
         uint16_t *pint = (uint16_t *)buf;
         m_senc_file_read_version = *pint;
         break;
       }
       case HEADER_CELL_NAME: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
         m_Name = wxString(buf, wxConvUTF8);
         break;
       }
       case HEADER_CELL_PUBLISHDATE: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
         m_sdate000 = wxString(buf, wxConvUTF8);
         break;
       }
 
       case HEADER_CELL_EDITION: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
         uint16_t *pint = (uint16_t *)buf;
         m_read_base_edtn.Printf("%d", *pint);
 
@@ -610,25 +642,11 @@ int Osenc::ingest200(const wxString &senc_file_name,
       }
 
       case HEADER_CELL_UPDATEDATE: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
         m_LastUpdateDate = wxString(buf, wxConvUTF8);
         break;
       }
 
       case HEADER_CELL_UPDATE: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
         uint16_t *pint = (uint16_t *)buf;
         m_read_last_applied_update = *pint;
 
@@ -636,37 +654,16 @@ int Osenc::ingest200(const wxString &senc_file_name,
       }
 
       case HEADER_CELL_NATIVESCALE: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
         uint32_t *pint = (uint32_t *)buf;
         m_Chart_Scale = *pint;
         break;
       }
 
       case HEADER_CELL_SENCCREATEDATE: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
         break;
       }
 
       case CELL_EXTENT_RECORD: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
         _OSENC_EXTENT_Record_Payload *pPayload =
             (_OSENC_EXTENT_Record_Payload *)buf;
         m_extent.NLAT = pPayload->extent_nw_lat;
@@ -683,38 +680,14 @@ int Osenc::ingest200(const wxString &senc_file_name,
       }
 
       case CELL_COVR_RECORD: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
-
         break;
       }
 
       case CELL_NOCOVR_RECORD: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
-
         break;
       }
 
       case FEATURE_ID_RECORD: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
-
         // Starting definition of a new feature
         _OSENC_Feature_Identification_Record_Payload *pPayload =
             (_OSENC_Feature_Identification_Record_Payload *)buf;
@@ -742,19 +715,15 @@ int Osenc::ingest200(const wxString &senc_file_name,
 
           pObjectVector->push_back(obj);
         }
+        if (storage) {
+          storage->feature_objects.push_back(
+              acronym.length() ? pObjectVector->size() - 1 : -1);
+        }
 
         break;
       }
 
       case FEATURE_ATTRIBUTE_RECORD: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
-
         // Get the payload
         OSENC_Attribute_Record_Payload *pPayload =
             (OSENC_Attribute_Record_Payload *)buf;
@@ -823,14 +792,6 @@ int Osenc::ingest200(const wxString &senc_file_name,
       }
 
       case FEATURE_GEOMETRY_RECORD_POINT: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
-
         // Get the payload
         _OSENC_PointGeometry_Record_Payload *pPayload =
             (_OSENC_PointGeometry_Record_Payload *)buf;
@@ -844,14 +805,6 @@ int Osenc::ingest200(const wxString &senc_file_name,
       }
 
       case FEATURE_GEOMETRY_RECORD_AREA: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
-
         // Get the payload
         _OSENC_AreaGeometry_Record_Payload *pPayload =
             (_OSENC_AreaGeometry_Record_Payload *)buf;
@@ -886,15 +839,35 @@ int Osenc::ingest200(const wxString &senc_file_name,
         break;
       }
 
-      case FEATURE_GEOMETRY_RECORD_LINE: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
+      case FEATURE_GEOMETRY_RECORD_AREA_300: {
+        const OSENC_AreaGeometry300_Record_Payload *pPayload =
+            (const OSENC_AreaGeometry300_Record_Payload *)buf;
+        size_t payload_size = record.record_length - sizeof(OSENC_Record_Base);
+        if (!obj || payload_size < sizeof(*pPayload)) break;
 
+        const int *edge_index_table;
+        PolyTessGeo *pPTG =
+            BuildPolyTessGeo300(pPayload, payload_size, &edge_index_table);
+        if (!pPTG) break;
+        obj->SetAreaGeometry(pPTG, m_ref_lat, m_ref_lon);
+
+        LineGeometryDescriptor Descriptor;
+        Descriptor.extent_e_lon = pPayload->extent_e_lon;
+        Descriptor.extent_w_lon = pPayload->extent_w_lon;
+        Descriptor.extent_s_lat = pPayload->extent_s_lat;
+        Descriptor.extent_n_lat = pPayload->extent_n_lat;
+        Descriptor.indexCount = pPayload->edgeVector_count;
+        Descriptor.indexTable =
+            (int *)malloc(pPayload->edgeVector_count * 3 * sizeof(int));
+        memcpy(Descriptor.indexTable, edge_index_table,
+               pPayload->edgeVector_count * 3 * sizeof(int));
+
+        obj->SetLineGeometry(&Descriptor, GEO_AREA, m_ref_lat, m_ref_lon);
+
+        break;
+      }
+
+      case FEATURE_GEOMETRY_RECORD_LINE: {
         // Get the payload & parse it
         _OSENC_LineGeometry_Record_Payload *pPayload =
             (_OSENC_LineGeometry_Record_Payload *)buf;
@@ -920,14 +893,6 @@ int Osenc::ingest200(const wxString &senc_file_name,
       }
 
       case FEATURE_GEOMETRY_RECORD_MULTIPOINT: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
-
         // Get the payload & parse it
         OSENC_MultipointGeometry_Record_Payload *pPayload =
             (OSENC_MultipointGeometry_Record_Payload *)buf;
@@ -950,14 +915,6 @@ int Osenc::ingest200(const wxString &senc_file_name,
       }
 
       case VECTOR_EDGE_NODE_TABLE_RECORD: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
-
         //  Parse the buffer
         uint8_t *pRun = (uint8_t *)buf;
 
@@ -974,10 +931,7 @@ int Osenc::ingest200(const wxString &senc_file_name,
           pRun += sizeof(int);
 
           float *pPoints = NULL;
-          if (pointCount) {
-            pPoints = (float *)malloc(pointCount * 2 * sizeof(float));
-            memcpy(pPoints, pRun, pointCount * 2 * sizeof(float));
-          }
+          if (pointCount) pPoints = getPoints(pRun, pointCount * 2, storage);
           pRun += pointCount * 2 * sizeof(float);
 
           VE_Element *pvee = new VE_Element;
@@ -993,14 +947,6 @@ int Osenc::ingest200(const wxString &senc_file_name,
       }
 
       case VECTOR_CONNECTED_NODE_TABLE_RECORD: {
-        unsigned char *buf =
-            getBuffer(record.record_length - sizeof(OSENC_Record_Base));
-        if (!fpx.Read(buf, record.record_length - sizeof(OSENC_Record_Base))
-                 .IsOk()) {
-          dun = 1;
-          break;
-        }
-
         //  Parse the buffer
         uint8_t *pRun = (uint8_t *)buf;
 
@@ -1012,8 +958,7 @@ int Osenc::ingest200(const wxString &senc_file_name,
           int featureIndex = *(int *)pRun;
           pRun += sizeof(int);
 
-          float *pPoint = (float *)malloc(2 * sizeof(float));
-          memcpy(pPoint, pRun, 2 * sizeof(float));
+          float *pPoint = getPoints(pRun, 2, storage);
           pRun += 2 * sizeof(float);
 
           VC_Element *pvce = new VC_Element;
@@ -1026,6 +971,138 @@ int Osenc::ingest200(const wxString &senc_file_name,
         break;
       }
 
+      case VECTOR_EDGE_NODE_BLOCK_RECORD: {
+        //  Columns: count, total point count, record ids, point counts and
+        //  the points of all edges
+        size_t payload_size = record.record_length - sizeof(OSENC_Record_Base);
+        uint32_t header[2];
+        if (payload_size < sizeof(header)) break;
+        memcpy(header, buf, sizeof(header));
+        size_t nCount = header[0];
+        size_t nPoints = header[1];
+        if (payload_size != sizeof(header) + nCount * 2 * sizeof(uint32_t) +
+                                nPoints * 2 * sizeof(float))
+          break;
+
+        const int *ids = (const int *)(buf + sizeof(header));
+        const uint32_t *counts = (const uint32_t *)(ids + nCount);
+        const unsigned char *points = (const unsigned char *)(counts + nCount);
+
+        //  With storage, all edges share the block, used in place if
+        //  possible. Otherwise each edge gets its own allocation.
+        float *block = NULL;
+        if (storage) {
+          block = getPoints(points, nPoints * 2, storage);
+          if (block == (const float *)points) {
+            storage->edge_points = block;
+            storage->edge_point_count = nPoints;
+          }
+        }
+
+        size_t offset = 0;
+        for (size_t i = 0; i < nCount; i++) {
+          if (offset + counts[i] > nPoints) break;
+          float *pPoints = NULL;
+          if (counts[i]) {
+            pPoints = block ? block + offset * 2
+                            : getPoints(points + offset * 2 * sizeof(float),
+                                        counts[i] * 2, NULL);
+          }
+          offset += counts[i];
+
+          VE_Element *pvee = new VE_Element;
+          pvee->index = ids[i];
+          pvee->nCount = counts[i];
+          pvee->pPoints = pPoints;
+          pvee->max_priority = 0;  // Default
+
+          pVEArray->push_back(pvee);
+        }
+
+        break;
+      }
+
+      case VECTOR_CONNECTED_NODE_BLOCK_RECORD: {
+        //  Columns: count, record ids and points
+        size_t payload_size = record.record_length - sizeof(OSENC_Record_Base);
+        uint32_t nCount;
+        if (payload_size < sizeof(nCount)) break;
+        memcpy(&nCount, buf, sizeof(nCount));
+        if (payload_size !=
+            sizeof(nCount) + nCount * (sizeof(int) + 2 * sizeof(float)))
+          break;
+
+        const int *ids = (const int *)(buf + sizeof(nCount));
+        const unsigned char *points = (const unsigned char *)(ids + nCount);
+        float *block =
+            storage ? getPoints(points, nCount * 2, storage) : NULL;
+
+        for (size_t i = 0; i < nCount; i++) {
+          VC_Element *pvce = new VC_Element;
+          pvce->index = ids[i];
+          pvce->pPoint =
+              block ? block + i * 2
+                    : getPoints(points + i * 2 * sizeof(float), 2, NULL);
+
+          pVCArray->push_back(pvce);
+        }
+
+        break;
+      }
+
+      case CELL_CLASS_INDEX_RECORD: {
+        //  Columns: class count, feature count, class codes, first feature
+        //  and feature count of each class, features.
+        if (!storage) break;
+        size_t payload_size = record.record_length - sizeof(OSENC_Record_Base);
+        uint32_t header[2];
+        if (payload_size < sizeof(header)) break;
+        memcpy(header, buf, sizeof(header));
+        size_t nClasses = header[0];
+        size_t nFeatures = header[1];
+        if (payload_size !=
+            sizeof(header) + (3 * nClasses + nFeatures) * sizeof(uint32_t))
+          break;
+
+        const uint32_t *codes = (const uint32_t *)(buf + sizeof(header));
+        const uint32_t *first = codes + nClasses;
+        const uint32_t *counts = first + nClasses;
+        const uint32_t *features = counts + nClasses;
+        storage->class_ranges.clear();
+        for (size_t i = 0; i < nClasses; i++) {
+          if (first[i] > nFeatures || counts[i] > nFeatures - first[i]) break;
+          std::string acronym = GetFeatureAcronymFromTypecode(codes[i]);
+          if (acronym.empty()) continue;
+          storage->class_ranges.push_back({acronym, first[i], counts[i]});
+        }
+        storage->class_features.assign(features, features + nFeatures);
+
+        break;
+      }
+
+      case CELL_SPATIAL_INDEX_RECORD: {
+        //  Item count, feature of each item, then the PackedRTree
+        if (!storage) break;
+        size_t payload_size = record.record_length - sizeof(OSENC_Record_Base);
+        uint32_t nItems;
+        if (payload_size < sizeof(nItems)) break;
+        memcpy(&nItems, buf, sizeof(nItems));
+        if (payload_size < sizeof(nItems) + nItems * sizeof(uint32_t)) break;
+
+        const uint32_t *features = (const uint32_t *)(buf + sizeof(nItems));
+        const uint8_t *tree = (const uint8_t *)(features + nItems);
+        size_t tree_size =
+            payload_size - sizeof(nItems) - nItems * sizeof(uint32_t);
+        if (storage->spatial_index.Load(tree, tree_size) &&
+            storage->spatial_index.Size() == nItems) {
+          storage->spatial_features.assign(features, features + nItems);
+        } else {
+          storage->spatial_index.Clear();
+        }
+
+        break;
+      }
+
       default:
         break;
 
@@ -1471,7 +1548,7 @@ int Osenc::createSenc200(const wxString &FullPath000,
 
   m_FullPath000 = FullPath000;
 
-  m_senc_file_create_version = 201;
+  m_senc_file_create_version = CURRENT_SENC_FORMAT_VERSION;
 
   if (!m_poRegistrar) {
     m_poRegistrar = new S57ClassRegistrar();
@@ -1693,6 +1770,10 @@ int Osenc::createSenc200(const wxString &FullPath000,
   int iObj = 0;
 
   while (bcont) {
+    if (m_cancel && *m_cancel) {
+      bcont = false;
+      break;
+    }
     objectDef = poReader->ReadNextFeature();
 
     if (objectDef != NULL) {
@@ -1741,10 +1822,13 @@ int Osenc::createSenc200(const wxString &FullPath000,
 
   if (bcont) {
     //      Create and write the Vector Edge Table
-    CreateSENCVectorEdgeTableRecord200(stream, poReader);
+    CreateSENCVectorEdgeTableRecord300(stream, poReader);
 
     //      Create and write the Connected NodeTable
-    CreateSENCVectorConnectedTableRecord200(stream, poReader);
+    CreateSENCVectorConnectedTableRecord300(stream, poReader);
+
+    //      And the class and spatial indexes of all features
+    CreateSENCFeatureIndexRecords300(stream);
   }
 
   //          All done, so clean up
@@ -1928,6 +2012,8 @@ bool Osenc::WriteFIDRecord200(Osenc_outstream *stream, int nOBJL, int featureID,
   record.feature_type_code = nOBJL;
   record.feature_primitive = prim;
 
+  m_class_features[nOBJL].push_back(m_feature_count++);
+
   size_t targetCount = sizeof(record);
   if (!stream->Write(&record, targetCount).IsOk())
     return false;
@@ -2217,6 +2303,8 @@ bool Osenc::CreateLineFeatureGeometryRecord200(S57Reader *poReader,
   record.extent_s_lat = latmin;
   record.edgeVector_count = nEdgeVectorRecords;
 
+  AddFeatureBox(latmin, latmax, lonmin, lonmax);
+
   //  Write the base record
   size_t targetCount = sizeof(record);
   if (!stream->Write(&record, targetCount).IsOk()) return false;
@@ -2233,25 +2321,20 @@ bool Osenc::CreateLineFeatureGeometryRecord200(S57Reader *poReader,
   return true;
 }
 
-bool Osenc::CreateAreaFeatureGeometryRecord200(S57Reader *poReader,
+bool Osenc::CreateAreaFeatureGeometryRecord300(S57Reader *poReader,
                                                OGRFeature *pFeature,
                                                Osenc_outstream *stream) {
-  int error_code;
-
-  PolyTessGeo *ppg = NULL;
-
   OGRGeometry *pGeo = pFeature->GetGeometryRef();
   OGRPolygon *poly = (OGRPolygon *)(pGeo);
 
   if (!poly->getExteriorRing()) return false;
 
   lockCR.unlock();
-  ppg = new PolyTessGeo(poly, true, m_ref_lat, m_ref_lon, m_LOD_meters);
+  PolyTessGeo *ppg =
+      new PolyTessGeo(poly, true, m_ref_lat, m_ref_lon, m_LOD_meters);
   lockCR.lock();
 
-  error_code = ppg->ErrorCode;
-
-  if (error_code) {
+  if (ppg->ErrorCode) {
     wxLogMessage(
         "   Warning: S57 SENC Geometry Error %d, Some Features ignored.",
         ppg->ErrorCode);
@@ -2260,207 +2343,80 @@ bool Osenc::CreateAreaFeatureGeometryRecord200(S57Reader *poReader,
     return false;
   }
 
-  //  Ready to create the record
-
-  //  The base record, with writing deferred until length is known
-  OSENC_AreaGeometry_Record_Base baseRecord;
-  memset(&baseRecord, 0, sizeof(baseRecord));
-
-  baseRecord.record_type = FEATURE_GEOMETRY_RECORD_AREA;
-
-  //  Length calculation is deferred...
-
-  baseRecord.extent_s_lat = ppg->Get_ymin();
-  baseRecord.extent_n_lat = ppg->Get_ymax();
-  baseRecord.extent_e_lon = ppg->Get_xmax();
-  baseRecord.extent_w_lon = ppg->Get_xmin();
-
-  baseRecord.contour_count = ppg->GetnContours();
-
-  //  Create the array of contour point counts
-
-  int contourPointCountArraySize = ppg->GetnContours() * sizeof(uint32_t);
-  uint32_t *contourPointCountArray =
-      (uint32_t *)malloc(contourPointCountArraySize);
-
-  uint32_t *pr = contourPointCountArray;
-
-  for (int i = 0; i < ppg->GetnContours(); i++) {
-    *pr++ = ppg->Get_PolyTriGroup_head()->pn_vertex[i];
-  }
-
-  //  All that is left is the tesselation result Triangle lists...
-  //  This could be a large array, and we don't want to use a buffer.
-  //  Rather, we want to write directly to the output file.
-
-  //  So, we
-  //  a  walk the TriPrim chain once to get it's length,
-  //  b update the total record length,
-  //  c write everything before the TriPrim chain,
-  //  d and then directly write the TriPrim chain.
-
-  //  Walk the TriPrim chain
-  int geoLength = 0;
-
-  TriPrim *pTP = ppg->Get_PolyTriGroup_head()
-                     ->tri_prim_head;  // head of linked list of TriPrims
-
-  int n_TriPrims = 0;
-  while (pTP) {
-    geoLength += sizeof(uint8_t) + sizeof(uint32_t);  // type, nvert
-    geoLength += pTP->nVert * 2 * sizeof(float);      // vertices
-    geoLength += 4 * sizeof(double);                  // Primitive bounding box
-    pTP = pTP->p_next;
-
-    n_TriPrims++;
+  //  Gather the tesselation as columns. The vertices of all triangle
+  //  primitives are stored contiguous, in the layout of the single buffer
+  //  uploaded as the area's vertex buffer object.
+  PolyTriGroup *group = ppg->Get_PolyTriGroup_head();
+  std::vector<uint32_t> contour_counts(group->pn_vertex,
+                                       group->pn_vertex + group->nContours);
+  std::vector<double> boxes;
+  std::vector<float> vertices;
+  std::vector<uint32_t> vertex_counts;
+  std::vector<uint8_t> types;
+  for (TriPrim *pTP = group->tri_prim_head; pTP; pTP = pTP->p_next) {
+    boxes.push_back(pTP->tri_box.GetMinLon());
+    boxes.push_back(pTP->tri_box.GetMaxLon());
+    boxes.push_back(pTP->tri_box.GetMinLat());
+    boxes.push_back(pTP->tri_box.GetMaxLat());
+    const float *pv = (const float *)pTP->p_vertex;
+    vertices.insert(vertices.end(), pv, pv + pTP->nVert * 2);
+    vertex_counts.push_back(pTP->nVert);
+    types.push_back(pTP->type);
   }
 
-  baseRecord.triprim_count = n_TriPrims;  //  Set the number of TriPrims
-
   int nEdgeVectorRecords = 0;
   unsigned char *pvec_buffer =
       getObjectVectorIndexTable(poReader, pFeature, nEdgeVectorRecords);
 
-#if 0
-     //  Create the Vector Edge Index table into a memory buffer
-     //  This buffer will follow the triangle buffer in the output stream
-    int *pNAME_RCID;
-    int *pORNT;
-    int nEdgeVectorRecords;
-    OGRFeature *pEdgeVectorRecordFeature;
-
-    pNAME_RCID = (int *) pFeature->GetFieldAsIntegerList( "NAME_RCID", &nEdgeVectorRecords );
-    pORNT = (int *) pFeature->GetFieldAsIntegerList( "ORNT", NULL );
-
-    baseRecord.edgeVector_count = nEdgeVectorRecords;
-
-    unsigned char *pvec_buffer = (unsigned char *)malloc(nEdgeVectorRecords * 3 * sizeof(int));
-    unsigned char *pvRun = pvec_buffer;
-
-    //  Set up the options, adding RETURN_PRIMITIVES
-    char ** papszReaderOptions = NULL;
-    papszReaderOptions = CSLSetNameValue( papszReaderOptions, S57O_UPDATES, "ON" );
-    papszReaderOptions = CSLSetNameValue( papszReaderOptions, S57O_RETURN_LINKAGES,"ON" );
-    papszReaderOptions = CSLSetNameValue( papszReaderOptions, S57O_RETURN_PRIMITIVES,"ON" );
-    poReader->SetOptions( papszReaderOptions );
-
-    //    Capture the beginning and end point connected nodes for each edge vector record
-    for( int i = 0; i < nEdgeVectorRecords; i++ ) {
-
-        int *pI = (int *)pvRun;
-
-        int start_rcid, end_rcid;
-        int target_record_feid = m_vector_helper_hash[pNAME_RCID[i]];
-        pEdgeVectorRecordFeature = poReader->ReadVector( target_record_feid, RCNM_VE );
-
-        int edge_rcid = pNAME_RCID[i];
-
-        if( NULL != pEdgeVectorRecordFeature ) {
-            start_rcid = pEdgeVectorRecordFeature->GetFieldAsInteger( "NAME_RCID_0" );
-            end_rcid = pEdgeVectorRecordFeature->GetFieldAsInteger( "NAME_RCID_1" );
-            //    Make sure the start and end points exist....
-            //    Note this poReader method was converted to Public access to
-            //     facilitate this test.  There might be another clean way....
-            //    Problem first found on Holand ENC 1R5YM009.000
-            if( !poReader->FetchPoint( RCNM_VC, start_rcid, NULL, NULL, NULL, NULL ) )
-                start_rcid = -1;
-            if( !poReader->FetchPoint( RCNM_VC, end_rcid, NULL, NULL, NULL, NULL ) )
-                end_rcid = -2;
-
-            int edge_ornt = 1;
-            //  Allocate some storage for converted points
-
-            if( edge_ornt == 1 ){                                    // forward
-                *pI++ = start_rcid;
-                *pI++ = edge_rcid;
-                *pI++ = end_rcid;
-            } else {                                                  // reverse
-                *pI++ = end_rcid;
-                *pI++ = edge_rcid;
-                *pI++ = start_rcid;
-            }
-
-            delete pEdgeVectorRecordFeature;
-        } else {
-            start_rcid = -1;                                    // error indication
-            end_rcid = -2;
-
-            *pI++ = start_rcid;
-            *pI++ = edge_rcid;
-            *pI++ = end_rcid;
-        }
-
-        pvRun += 3 * sizeof(int);
-    }
-
-
-    //  Reset the options
-    papszReaderOptions = CSLSetNameValue( papszReaderOptions, S57O_RETURN_PRIMITIVES,"OFF" );
-    poReader->SetOptions( papszReaderOptions );
-    CSLDestroy( papszReaderOptions );
-
-#endif
-
-  baseRecord.edgeVector_count = nEdgeVectorRecords;
-
-  //  Calculate the total record length
-  int recordLength = sizeof(OSENC_AreaGeometry_Record_Base);
-  recordLength += contourPointCountArraySize;
-  recordLength += geoLength;
-  recordLength += nEdgeVectorRecords * 3 * sizeof(int);
-  baseRecord.record_length = recordLength;
-
-  //  Write the base record
-  size_t targetCount = sizeof(baseRecord);
-  if (!stream->Write(&baseRecord, targetCount).IsOk()) return false;
-
-  //  Write the contour point count array
-  targetCount = contourPointCountArraySize;
-  if (!stream->Write(contourPointCountArray, targetCount).IsOk()) return false;
-
-  //  Walk and transcribe the TriPrim chain
-  pTP = ppg->Get_PolyTriGroup_head()
-            ->tri_prim_head;  // head of linked list of TriPrims
-  while (pTP) {
-    if (!stream->Write(&pTP->type, sizeof(uint8_t)).IsOk()) return false;
-    if (!stream->Write(&pTP->nVert, sizeof(uint32_t)).IsOk()) return false;
-
-    //         fwrite (&pTP->minxt , sizeof(double), 1, fpOut);
-    //         fwrite (&pTP->maxxt , sizeof(double), 1, fpOut);
-    //         fwrite (&pTP->minyt , sizeof(double), 1, fpOut);
-    //         fwrite (&pTP->maxyt , sizeof(double), 1, fpOut);
-
-    double minlat, minlon, maxlat, maxlon;
-    minlat = pTP->tri_box.GetMinLat();
-    minlon = pTP->tri_box.GetMinLon();
-    maxlat = pTP->tri_box.GetMaxLat();
-    maxlon = pTP->tri_box.GetMaxLon();
-
-    if (!stream->Write(&minlon, sizeof(double)).IsOk()) return false;
-    if (!stream->Write(&maxlon, sizeof(double)).IsOk()) return false;
-    if (!stream->Write(&minlat, sizeof(double)).IsOk()) return false;
-    if (!stream->Write(&maxlat, sizeof(double)).IsOk()) return false;
-
-    // Testing TODO
-    //         float *pf = (float *)pTP->p_vertex;
-    //         float a = *pf++;
-    //         float b = *pf;
-
-    if (!stream->Write(pTP->p_vertex, pTP->nVert * 2 * sizeof(float)).IsOk())
-      return false;
-
-    pTP = pTP->p_next;
-  }
-
-  //  Write the Edge Vector index table
-  targetCount = nEdgeVectorRecords * 3 * sizeof(int);
-  if (!stream->Write(pvec_buffer, targetCount).IsOk()) return false;
-
+  OSENC_AreaGeometry300_Record_Base record;
+  memset(&record, 0, sizeof(record));
+  record.record_type = FEATURE_GEOMETRY_RECORD_AREA_300;
+  record.record_length =
+      sizeof(record) + boxes.size() * sizeof(double) +
+      vertices.size() * sizeof(float) +
+      contour_counts.size() * sizeof(uint32_t) +
+      vertex_counts.size() * sizeof(uint32_t) +
+      nEdgeVectorRecords * 3 * sizeof(int) + types.size();
+  record.extent_s_lat = ppg->Get_ymin();
+  record.extent_n_lat = ppg->Get_ymax();
+  record.extent_e_lon = ppg->Get_xmax();
+  record.extent_w_lon = ppg->Get_xmin();
+  record.contour_count = contour_counts.size();
+  record.triprim_count = types.size();
+  record.edgeVector_count = nEdgeVectorRecords;
+  record.vertex_count = vertices.size() / 2;
   delete ppg;
-  free(contourPointCountArray);
+
+  AddFeatureBox(record.extent_s_lat, record.extent_n_lat, record.extent_w_lon,
+                record.extent_e_lon);
+
+  auto write = [stream](const void *data, size_t size) {
+    return size == 0 || stream->Write(data, size).IsOk();
+  };
+  bool ok = WritePaddingRecord(stream) && write(&record, sizeof(record)) &&
+            write(boxes.data(), boxes.size() * sizeof(double)) &&
+            write(vertices.data(), vertices.size() * sizeof(float)) &&
+            write(contour_counts.data(),
+                  contour_counts.size() * sizeof(uint32_t)) &&
+            write(vertex_counts.data(),
+                  vertex_counts.size() * sizeof(uint32_t)) &&
+            write(pvec_buffer, nEdgeVectorRecords * 3 * sizeof(int)) &&
+            write(types.data(), types.size());
   free(pvec_buffer);
 
-  return true;
+  return ok;
+}
+
+void Osenc::AddFeatureBox(double s_lat, double n_lat, double w_lon,
+                          double e_lon) {
+  //  Same boxes as S57Obj::BBObj, and same restrictions as the pick index
+  //  built from them in s57chart.
+  if (s_lat > n_lat || w_lon > e_lon || w_lon < -180. || e_lon > 180.) return;
+  m_feature_boxes.push_back({static_cast<float>(w_lon),
+                             static_cast<float>(s_lat),
+                             static_cast<float>(e_lon),
+                             static_cast<float>(n_lat)});
+  m_feature_box_ids.push_back(m_feature_count - 1);
 }
 
 unsigned char *Osenc::getObjectVectorIndexTable(S57Reader *poReader,
@@ -2558,12 +2514,32 @@ unsigned char *Osenc::getObjectVectorIndexTable(S57Reader *poReader,
   return pvec_buffer;
 }
 
-void Osenc::CreateSENCVectorEdgeTableRecord200(Osenc_outstream *stream,
+bool Osenc::WritePaddingRecord(Osenc_outstream *stream) {
+  //  Pad so the payload of next record starts at a multiple of 8 bytes in the
+  //  file, allowing readers to use it in place. No-op if position unknown.
+  wxFileOffset pos = stream->Tell();
+  if (pos == wxInvalidOffset) return true;
+  size_t header = sizeof(OSENC_Record_Base);
+  if ((pos + header) % 8 == 0) return true;
+  size_t fill = (8 - (pos + 2 * header) % 8) % 8;
+
+  OSENC_Record_Base record;
+  record.record_type = PADDING_RECORD;
+  record.record_length = header + fill;
+  static const unsigned char zeros[8] = {0};
+  if (!stream->Write(&record, header).IsOk()) return false;
+  return stream->Write(zeros, fill).IsOk();
+}
+
+void Osenc::CreateSENCVectorEdgeTableRecord300(Osenc_outstream *stream,
                                                S57Reader *poReader) {
-  //  We create the payload first, so we can calculate the total record length
-  uint8_t *pPayload = NULL;
-  int payloadSize = 0;
-  uint8_t *pRun = pPayload;
+  //  The edges are stored as columns: the record ids, the point counts and
+  //  then the points of all edges, contiguous and in the line vertex buffer
+  //  layout. A reader can thus use the points in place and copy them to the
+  //  vertex buffer in one go.
+  std::vector<int> record_ids;
+  std::vector<uint32_t> point_counts;
+  std::vector<float> points;
 
   //  Set up the S57Reader options, adding RETURN_PRIMITIVES
   char **papszReaderOptions = NULL;
@@ -2579,8 +2555,6 @@ void Osenc::CreateSENCVectorEdgeTableRecord200(Osenc_outstream *stream,
   OGRGeometry *pGeo;
   OGRFeature *pEdgeVectorRecordFeature = poReader->ReadVector(feid, RCNM_VE);
 
-  int nFeatures = 0;
-
   //  Read all the EdgeVector Features
   while (NULL != pEdgeVectorRecordFeature) {
     //  Check for a zero point count.  Dunno why this should happen, other than
@@ -2597,16 +2571,8 @@ void Osenc::CreateSENCVectorEdgeTableRecord200(Osenc_outstream *stream,
     }
 
     if (nPoints) {
-      int new_size = payloadSize + (2 * sizeof(int));
-      pPayload = (uint8_t *)realloc(pPayload, new_size);
-      pRun = pPayload + payloadSize;  //  recalculate the running pointer,
-                                      //  since realloc may have moved memory
-      payloadSize = new_size;
-
       //  Fetch and store the Record ID
-      int record_id = pEdgeVectorRecordFeature->GetFieldAsInteger("RCID");
-      *(int *)pRun = record_id;
-      pRun += sizeof(int);
+      record_ids.push_back(pEdgeVectorRecordFeature->GetFieldAsInteger("RCID"));
 
       //  Transcribe points to a buffer
       // We reduce the maximum number of points in the table to
@@ -2643,30 +2609,15 @@ void Osenc::CreateSENCVectorEdgeTableRecord200(Osenc_outstream *stream,
         index_keep.push_back(nPoints - 1);
 
         DouglasPeucker(ppd, 0, nPoints - 1, m_LOD_meters, &index_keep);
-        //               printf("DP Reduction: %d/%d\n", index_keep.GetCount(),
-        //               nPoints);
 
       } else {
         index_keep.resize(nPoints);
         for (int i = 0; i < nPoints; i++) index_keep[i] = i;
       }
 
-      //  Store the point count in the payload
-      int nPointReduced = index_keep.size();
-      *(int *)pRun = nPointReduced;
-      pRun += sizeof(int);
-
-      //  transcribe the (possibly) reduced linestring to the payload
+      //  Store the point count and the (possibly) reduced linestring
+      point_counts.push_back(index_keep.size());
 
-      //  Grow the payload buffer
-      int new_size_red = payloadSize + (nPointReduced * 2 * sizeof(float));
-      pPayload = (uint8_t *)realloc(pPayload, new_size_red);
-      pRun = pPayload + payloadSize;  //  recalculate the running pointer,
-                                      //  since realloc may have moved memory
-      payloadSize = new_size_red;
-
-      float *npp = (float *)pRun;
-      float *npp_run = npp;
       ppr = ppd;
       for (int ip = 0; ip < nPoints; ip++) {
         double x = *ppr++;
@@ -2674,16 +2625,13 @@ void Osenc::CreateSENCVectorEdgeTableRecord200(Osenc_outstream *stream,
 
         for (unsigned int j = 0; j < index_keep.size(); j++) {
           if (index_keep[j] == ip) {
-            *npp_run++ = x;
-            *npp_run++ = y;
-            pRun += 2 * sizeof(float);
+            points.push_back(x);
+            points.push_back(y);
             break;
           }
         }
       }
 
-      nFeatures++;
-
       free(ppd);
     }
 
@@ -2695,25 +2643,26 @@ void Osenc::CreateSENCVectorEdgeTableRecord200(Osenc_outstream *stream,
   }  // while
 
   // Now we know the payload length and the Feature count
-  if (nFeatures) {
-    //  Now write the record out
-    OSENC_VET_Record record;
+  if (record_ids.size()) {
+    uint32_t nFeatures = record_ids.size();
+    uint32_t nPoints = points.size() / 2;
 
-    record.record_type = VECTOR_EDGE_NODE_TABLE_RECORD;
-    record.record_length =
-        sizeof(OSENC_VET_Record_Base) + payloadSize + sizeof(uint32_t);
+    WritePaddingRecord(stream);
 
-    // Write out the record
-    stream->Write(&record, sizeof(OSENC_VET_Record_Base));
+    OSENC_VET_Record_Base record;
+    record.record_type = VECTOR_EDGE_NODE_BLOCK_RECORD;
+    record.record_length = sizeof(OSENC_VET_Record_Base) +
+                           2 * sizeof(uint32_t) +
+                           nFeatures * (sizeof(int) + sizeof(uint32_t)) +
+                           points.size() * sizeof(float);
 
-    //  Write out the Feature(Object) count
+    stream->Write(&record, sizeof(OSENC_VET_Record_Base));
     stream->Write(&nFeatures, sizeof(uint32_t));
-
-    //  Write out the payload
-    stream->Write(pPayload, payloadSize);
+    stream->Write(&nPoints, sizeof(uint32_t));
+    stream->Write(record_ids.data(), nFeatures * sizeof(int));
+    stream->Write(point_counts.data(), nFeatures * sizeof(uint32_t));
+    stream->Write(points.data(), points.size() * sizeof(float));
   }
-  //  All done with buffer
-  free(pPayload);
 
   //  Reset the S57Reader options
   papszReaderOptions =
@@ -2722,12 +2671,11 @@ void Osenc::CreateSENCVectorEdgeTableRecord200(Osenc_outstream *stream,
   CSLDestroy(papszReaderOptions);
 }
 
-void Osenc::CreateSENCVectorConnectedTableRecord200(Osenc_outstream *stream,
+void Osenc::CreateSENCVectorConnectedTableRecord300(Osenc_outstream *stream,
                                                     S57Reader *poReader) {
-  //  We create the payload first, so we can calculate the total record length
-  uint8_t *pPayload = NULL;
-  int payloadSize = 0;
-  uint8_t *pRun = pPayload;
+  //  Stored as columns like the edges: record ids, then points.
+  std::vector<int> record_ids;
+  std::vector<float> points;
 
   //  Set up the S57Reader options, adding RETURN_PRIMITIVES
   char **papszReaderOptions = NULL;
@@ -2742,39 +2690,22 @@ void Osenc::CreateSENCVectorConnectedTableRecord200(Osenc_outstream *stream,
   OGRPoint *pP;
   OGRGeometry *pGeo;
   OGRFeature *pConnNodeRecordFeature = poReader->ReadVector(feid, RCNM_VC);
-  int featureCount = 0;
 
   //  Read all the ConnectedVector Features
   while (NULL != pConnNodeRecordFeature) {
     if (pConnNodeRecordFeature->GetGeometryRef() != NULL) {
       pGeo = pConnNodeRecordFeature->GetGeometryRef();
       if (pGeo->getGeometryType() == wkbPoint) {
-        int new_size = payloadSize + sizeof(int) + (2 * sizeof(float));
-        pPayload = (uint8_t *)realloc(pPayload, new_size);
-        pRun = pPayload + payloadSize;  //  recalculate the running pointer,
-                                        //  since realloc may have moved memory
-        payloadSize = new_size;
-
         //  Fetch and store the Record ID
-        int record_id = pConnNodeRecordFeature->GetFieldAsInteger("RCID");
-        *(int *)pRun = record_id;
-        pRun += sizeof(int);
+        record_ids.push_back(pConnNodeRecordFeature->GetFieldAsInteger("RCID"));
 
         pP = (OGRPoint *)pGeo;
 
         //  Calculate SM from chart common reference point
         double easting, northing;
         toSM(pP->getY(), pP->getX(), m_ref_lat, m_ref_lon, &easting, &northing);
-
-        //                 MyPoint pd;
-        //                 pd.x = easting;
-        //                 pd.y = northing;
-        //                 memcpy(pRun, &pd, sizeof(MyPoint));
-        float *ps = (float *)pRun;
-        *ps++ = easting;
-        *ps = northing;
-
-        featureCount++;
+        points.push_back(easting);
+        points.push_back(northing);
       }
     }
 
@@ -2784,29 +2715,24 @@ void Osenc::CreateSENCVectorConnectedTableRecord200(Osenc_outstream *stream,
     pConnNodeRecordFeature = poReader->ReadVector(feid, RCNM_VC);
   }  // while
 
-  // Now we know the payload length and the Feature count
-
   //  Now write the record out
-  if (featureCount) {
-    OSENC_VCT_Record record;
+  if (record_ids.size()) {
+    uint32_t featureCount = record_ids.size();
 
-    record.record_type = VECTOR_CONNECTED_NODE_TABLE_RECORD;
-    record.record_length =
-        sizeof(OSENC_VCT_Record_Base) + payloadSize + sizeof(int);
+    WritePaddingRecord(stream);
 
-    // Write out the record
-    stream->Write(&record, sizeof(OSENC_VCT_Record_Base));
+    OSENC_VCT_Record_Base record;
+    record.record_type = VECTOR_CONNECTED_NODE_BLOCK_RECORD;
+    record.record_length = sizeof(OSENC_VCT_Record_Base) + sizeof(uint32_t) +
+                           featureCount * sizeof(int) +
+                           points.size() * sizeof(float);
 
-    //  Write out the Feature(Object) count
+    stream->Write(&record, sizeof(OSENC_VCT_Record_Base));
     stream->Write(&featureCount, sizeof(uint32_t));
-
-    //  Write out the payload
-    stream->Write(pPayload, payloadSize);
+    stream->Write(record_ids.data(), featureCount * sizeof(int));
+    stream->Write(points.data(), points.size() * sizeof(float));
   }
 
-  //  All done with buffer
-  free(pPayload);
-
   //  Reset the S57Reader options
   papszReaderOptions =
       CSLSetNameValue(papszReaderOptions, S57O_RETURN_PRIMITIVES, "OFF");
@@ -2814,6 +2740,56 @@ void Osenc::CreateSENCVectorConnectedTableRecord200(Osenc_outstream *stream,
   CSLDestroy(papszReaderOptions);
 }
 
+bool Osenc::CreateSENCFeatureIndexRecords300(Osenc_outstream *stream) {
+  //  Features are identified by their position in the file. The class
+  //  index lists the features of each class as a range in one column.
+  std::vector<uint32_t> class_codes;
+  std::vector<uint32_t> class_first;
+  std::vector<uint32_t> class_counts;
+  std::vector<uint32_t> features;
+  for (const auto &kv : m_class_features) {
+    class_codes.push_back(kv.first);
+    class_first.push_back(features.size());
+    class_counts.push_back(kv.second.size());
+    features.insert(features.end(), kv.second.begin(), kv.second.end());
+  }
+
+  //  The spatial index is a PackedRTree over the line and area features,
+  //  its items mapped to features by a column.
+  PackedRTree tree;
+  tree.Build(m_feature_boxes);
+  std::vector<uint8_t> tree_data;
+  tree.Save(tree_data);
+
+  uint32_t nClasses = class_codes.size();
+  uint32_t nFeatures = features.size();
+  uint32_t nItems = m_feature_box_ids.size();
+
+  if (!WritePaddingRecord(stream)) return false;
+  OSENC_Record_Base record;
+  record.record_type = CELL_CLASS_INDEX_RECORD;
+  record.record_length = sizeof(OSENC_Record_Base) + 2 * sizeof(uint32_t) +
+                         (3 * nClasses + nFeatures) * sizeof(uint32_t);
+  stream->Write(&record, sizeof(OSENC_Record_Base));
+  stream->Write(&nClasses, sizeof(uint32_t));
+  stream->Write(&nFeatures, sizeof(uint32_t));
+  stream->Write(class_codes.data(), nClasses * sizeof(uint32_t));
+  stream->Write(class_first.data(), nClasses * sizeof(uint32_t));
+  stream->Write(class_counts.data(), nClasses * sizeof(uint32_t));
+  stream->Write(features.data(), nFeatures * sizeof(uint32_t));
+
+  if (!WritePaddingRecord(stream)) return false;
+  record.record_type = CELL_SPATIAL_INDEX_RECORD;
+  record.record_length = sizeof(OSENC_Record_Base) + sizeof(uint32_t) +
+                         nItems * sizeof(uint32_t) + tree_data.size();
+  stream->Write(&record, sizeof(OSENC_Record_Base));
+  stream->Write(&nItems, sizeof(uint32_t));
+  stream->Write(m_feature_box_ids.data(), nItems * sizeof(uint32_t));
+  stream->Write(tree_data.data(), tree_data.size());
+
+  return stream->IsOk();
+}
+
 bool Osenc::CreateSENCRecord200(OGRFeature *pFeature, Osenc_outstream *stream,
                                 int mode, S57Reader *poReader) {
   // TODO
@@ -3206,7 +3182,7 @@ bool Osenc::CreateSENCRecord200(OGRFeature *pFeature, Osenc_outstream *stream,
 
       //      Special case, polygons are handled separately
       case wkbPolygon: {
-        if (!CreateAreaFeatureGeometryRecord200(poReader, pFeature, stream)) {
+        if (!CreateAreaFeatureGeometryRecord300(poReader, pFeature, stream)) {
           wxString msga;
           msga.Printf("Error in S57 cell file: %s\n",
                       m_FullPath000.ToStdString().c_str());
@@ -3355,6 +3331,89 @@ PolyTessGeo *Osenc::BuildPolyTessGeo(_OSENC_AreaGeometry_Record_Payload *record,
   return pPTG;
 }
 
+//      Build PolyGeo Object from a FEATURE_GEOMETRY_RECORD_AREA_300 record
+//      of length bytes, return NULL if malformed.
+PolyTessGeo *Osenc::BuildPolyTessGeo300(
+    const OSENC_AreaGeometry300_Record_Payload *record, size_t length,
+    const int **edge_index_table) {
+  size_t nTriPrim = record->triprim_count;
+  size_t nContours = record->contour_count;
+  size_t nVertex = record->vertex_count;
+  size_t nEdge = record->edgeVector_count;
+  if (length != sizeof(*record) +
+                    nTriPrim * (4 * sizeof(double) + sizeof(uint32_t) + 1) +
+                    nVertex * 2 * sizeof(float) +
+                    nContours * sizeof(uint32_t) + nEdge * 3 * sizeof(int))
+    return NULL;
+
+  //  The columns, see CreateAreaFeatureGeometryRecord300()
+  const unsigned char *run = (const unsigned char *)(record + 1);
+  const double *boxes = (const double *)run;
+  run += nTriPrim * 4 * sizeof(double);
+  const unsigned char *vertices = run;
+  run += nVertex * 2 * sizeof(float);
+  const uint32_t *contour_counts = (const uint32_t *)run;
+  run += nContours * sizeof(uint32_t);
+  const uint32_t *vertex_counts = (const uint32_t *)run;
+  run += nTriPrim * sizeof(uint32_t);
+  *edge_index_table = (const int *)run;
+  run += nEdge * 3 * sizeof(int);
+  const uint8_t *types = run;
+
+  size_t total = 0;
+  for (size_t i = 0; i < nTriPrim; i++) total += vertex_counts[i];
+  if (total != nVertex) return NULL;
+
+  PolyTessGeo *pPTG = new PolyTessGeo();
+  pPTG->SetExtents(record->extent_w_lon, record->extent_s_lat,
+                   record->extent_e_lon, record->extent_n_lat);
+
+  PolyTriGroup *ppg = new PolyTriGroup;
+  ppg->m_bSMSENC = true;
+  ppg->nContours = nContours;
+  ppg->pn_vertex = (int *)malloc(nContours * sizeof(int));
+  for (size_t i = 0; i < nContours; i++) ppg->pn_vertex[i] = contour_counts[i];
+  ppg->pgroup_geom = NULL;
+
+  //  The vertices are already in the single buffer layout, copy them out of
+  //  the mapping in one go. As in BuildPolyTessGeo(), the buffer has room for
+  //  one more point.
+  size_t vertex_bytes = nVertex * 2 * sizeof(float);
+  int total_byte_size = vertex_bytes + 2 * sizeof(float);
+  unsigned char *vbuf = (unsigned char *)calloc(1, total_byte_size);
+  memcpy(vbuf, vertices, vertex_bytes);
+
+  TriPrim **p_prev_triprim = &(ppg->tri_prim_head);
+  int nvert_max = 0;
+  size_t offset = 0;
+  for (size_t i = 0; i < nTriPrim; i++) {
+    TriPrim *tp = new TriPrim;
+    *p_prev_triprim = tp;  // make the link
+    p_prev_triprim = &(tp->p_next);
+    tp->p_next = NULL;
+
+    tp->type = types[i];
+    tp->nVert = vertex_counts[i];
+    tp->tri_box.Set(boxes[4 * i + 2], boxes[4 * i], boxes[4 * i + 3],
+                    boxes[4 * i + 1]);
+    tp->p_vertex = (double *)(vbuf + offset * 2 * sizeof(float));
+    offset += tp->nVert;
+    nvert_max = wxMax(nvert_max, tp->nVert);
+  }
+
+  ppg->bsingle_alloc = true;
+  ppg->single_buffer = vbuf;
+  ppg->single_buffer_size = total_byte_size;
+  ppg->data_type = DATA_TYPE_FLOAT;
+
+  pPTG->SetPPGHead(ppg);
+  pPTG->SetnVertexMax(nvert_max);
+
+  pPTG->Set_OK(true);
+
+  return pPTG;
+}
+
 bool Osenc::CreateCOVRTables(S57Reader *poReader,
                              S57ClassRegistrar *poRegistrar) {
   poReader->Rewind();
@@ -3710,3 +3769,33 @@ unsigned char *Osenc::getBuffer(size_t length) {
 
   return pBuffer;
 }
+
+unsigned char *Osenc::getPayload(Osenc_instreamMapped &stream, size_t length) {
+  const unsigned char *p = stream.Next(length);
+  if (!p) return NULL;
+  // Use the record in place when aligned as a malloc'ed buffer would be. The
+  // mapping is read-only, record parsing never writes to the payload.
+  if (length == 0 || reinterpret_cast<uintptr_t>(p) % alignof(double) == 0)
+    return const_cast<unsigned char *>(p);
+  unsigned char *buf = getBuffer(length);
+  memcpy(buf, p, length);
+  return buf;
+}
+
+float *Osenc::getPoints(const unsigned char *src, size_t count,
+                        Osenc_storage *storage) {
+  if (!storage) {
+    float *points = (float *)malloc(count * sizeof(float));
+    memcpy(points, src, count * sizeof(float));
+    return points;
+  }
+  // Points in the mapped file can be referenced directly, points in the
+  // copy buffer of an unaligned record must be copied.
+  const unsigned char *base = storage->file ? storage->file->Data() : NULL;
+  bool in_file = base && src >= base && src < base + storage->file->Size();
+  if (in_file && reinterpret_cast<uintptr_t>(src) % alignof(float) == 0)
+    return const_cast<float *>(reinterpret_cast<const float *>(src));
+  float *points = storage->arena.AllocateArray<float>(count);
+  memcpy(points, src, count * sizeof(float));
+  return points;
+}
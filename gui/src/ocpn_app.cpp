@@ -166,6 +166,7 @@
 #include "s57chart.h"
 #include "s57_query_dlg.h"
 #include "safe_mode_gui.h"
+#include "senc_manager.h"
 #include "std_filesystem.h"
 #include "styles.h"
 #include "tcmgr.h"
@@ -207,7 +208,7 @@ using namespace std::literals::chrono_literals;
 const char *const kUsage =
     R"(Usage:
   opencpn -h | --help
-  opencpn [-p] [-f] [-G] [-g] [-P] [-l <str>] [-u <num>] [-U] [-s] [GPX file ...]
+  opencpn [-p] [-f] [-G] [-g] [-P [-X]] [-l <str>] [-u <num>] [-U] [-s] [GPX file ...]
   opencpn --remote [-R] | -q] | -e] |-o <str>]
 
 Options for starting opencpn
@@ -220,6 +221,8 @@ Options for starting opencpn
   -g, --rebuild_gl_raster_cache	Rebuild OpenGL raster cache on start.
   -D, --rebuild_chart_db        Rescan chart directories and rebuild the chart database
   -P, --parse_all_enc          	Convert all S-57 charts to OpenCPN's internal format on start.
+  -X, --exit_after_parse        With -P: print a summary and exit when all charts are
+                                converted. Exit status is 1 if any conversion failed.
   -l, --loglevel=<str>         	Amount of logging: error, warning, message, info, debug or trace
   -u, --unit_test_1=<num>      	Display a slideshow of <num> charts and then exit.
                                 Zero or negative <num> specifies no limit.
@@ -545,6 +548,7 @@ void MyApp::OnInitCmdLine(wxCmdLineParser &parser) {
   parser.AddSwitch("g", "rebuild_gl_raster_cache");
   parser.AddSwitch("D", "rebuild_chart_db");
   parser.AddSwitch("P", "parse_all_enc");
+  parser.AddSwitch("X", "exit_after_parse");
   parser.AddOption("l", "loglevel");
   parser.AddOption("u", "unit_test_1", "", wxCMD_LINE_VAL_NUMBER);
   parser.AddSwitch("U", "unit_test_2");
@@ -602,6 +606,11 @@ bool MyApp::OnCmdLineParsed(wxCmdLineParser &parser) {
   g_rebuild_gl_cache = parser.Found("rebuild_gl_raster_cache");
   g_NeedDBUpdate = parser.Found("rebuild_chart_db") ? 2 : 0;
   g_parse_all_enc = parser.Found("parse_all_enc");
+  g_exit_after_parse = parser.Found("exit_after_parse");
+  if (g_exit_after_parse && !g_parse_all_enc) {
+    std::cerr << "--exit_after_parse requires --parse_all_enc\n";
+    return false;
+  }
   g_config_wizard = parser.Found("config_wizard");
   if (parser.Found("unit_test_1", &number)) {
     g_unit_test_1 = static_cast<int>(number);
@@ -628,6 +637,7 @@ bool MyApp::OnCmdLineParsed(wxCmdLineParser &parser) {
       "rebuild_gl_raster_cache",
       "rebuild_chart_db",
       "parse_all_enc",
+      "exit_after_parse",
       "unit_test_1",
       "safe_mode",
       "loglevel"};
@@ -691,7 +701,27 @@ static wxStopWatch init_sw;
 
 int MyApp::OnRun() {
   if (m_exitcode != -2) return m_exitcode;
-  return wxAppConsole::OnRun();
+  int rv = wxAppConsole::OnRun();
+  return m_exitcode != -2 ? m_exitcode : rv;
+}
+
+void MyApp::OnParseDoneTimer(wxTimerEvent &event) {
+  if (g_SencThreadManager && g_SencThreadManager->GetJobCount()) return;
+  m_parse_done_timer.Stop();
+
+  if (!g_SencThreadManager || !ps52plib) {
+    std::cout << "ENC conversion failed: S-57 support not available\n";
+    m_exitcode = 1;
+  } else {
+    SENCBuildStats stats = g_SencThreadManager->GetStats();
+    std::cout << "ENC conversion done: " << stats.done << " converted, "
+              << stats.failed << " failed, " << stats.cancelled
+              << " cancelled in " << static_cast<int>(stats.elapsed)
+              << " s\n";
+    m_exitcode = stats.failed || stats.cancelled ? 1 : 0;
+  }
+  wxLogMessage("ParseAllENC() done, exiting with status %d", m_exitcode);
+  quitflag++;  // signal to the frame timer loop
 }
 
 MyApp::MyApp()
@@ -700,6 +730,9 @@ MyApp::MyApp()
                     g_bportable),
       m_usb_watcher(UsbWatchDaemon::GetInstance()),
       m_exitcode(-2) {
+  m_parse_done_timer.SetOwner(this);
+  Bind(wxEVT_TIMER, &MyApp::OnParseDoneTimer, this,
+       m_parse_done_timer.GetId());
 #ifdef __linux__
   // Handle e. g., wayland default display -- see #1166.
   if (!wxGetEnv("OCPN_DISABLE_X11_GDK_BACKEND", NULL)) {
@@ -1518,9 +1551,16 @@ void MyApp::BuildMainFrame() {
   }
 #endif
 
-  // FIXME (dave)
-  //  move method to frame
-  // if (g_parse_all_enc) ParseAllENC(gFrame);
+  //  Queue the SENC builds once the frame and canvases are in place; these
+  //  run in background, summary is logged when done. With
+  //  --exit_after_parse poll for completion and quit.
+  if (g_parse_all_enc) {
+    extern void ParseAllENC(wxWindow * parent);
+    gFrame->CallAfter([this] {
+      ParseAllENC(nullptr);
+      if (g_exit_after_parse) m_parse_done_timer.Start(500);
+    });
+  }
 
   //      establish GPS timeout value as multiple of frame timer
   //      This will override any nonsense or unset value from the config file
@@ -636,6 +636,10 @@ MyFrame::MyFrame(const wxString &title, const wxPoint &pos, const wxSize &size,
   m_ChartUpdatePeriod = 1;  // set the default (1 sec.) period
   initIXNetSystem();
 
+  // Deliver incoming messages in batches once per tick instead of one main
+  // loop event each.
+  NavMsgBus::GetInstance().SetBatchMode(true);
+
   //    Establish my children
   struct MuxLogCallbacks log_callbacks;
   log_callbacks.log_is_active = [&]() {
@@ -819,13 +823,14 @@ void MyFrame::OnSENCEvtThread(OCPN_BUILDSENC_ThreadEvent &event) {
           ChartCanvas *cc = g_canvasArray.Item(i);
           if (cc) cc->ClearS52PLIBStateHash();  // Force a S52 PLIB re-configure
         }
+        ReloadAllVP();
       }
-
-      ReloadAllVP();
+      // Background jobs, e. g. from ParseAllENC(), have no chart.
       delete event.m_ticket;
       break;
     case SENC_BUILD_DONE_ERROR:
       // printf("Myframe SENC build done ERROR\n");
+      delete event.m_ticket;
       break;
     default:
       break;
@@ -1768,6 +1773,7 @@ void MyFrame::OnCloseWindow(wxCloseEvent &event) {
   // Close and delete all comm drivers
   auto &registry = CommDriverRegistry::GetInstance();
   registry.CloseAllDrivers();
+  NavMsgBus::GetInstance().SetBatchMode(false);
 
   //  Clear some global arrays, lists, and hash maps...
   for (auto *cp : TheConnectionParams()) {
@@ -6209,6 +6215,13 @@ void MyFrame::OnEvtPlugInMessage(OCPN_MsgEvent &event) {
 
     // Refresh tide displays if time source changed
     if (oldTimeSource != gTimeSource) {
+      // Move the precomputed tide and current series to the new time
+      if (ptcmgr) {
+        wxDateTime now =
+            gTimeSource.IsValid() ? gTimeSource : wxDateTime::Now();
+        ptcmgr->SetTimeSource(now.GetTicks());
+      }
+
       // Refresh all canvases that might show tide info
       for (unsigned int i = 0; i < g_canvasArray.GetCount(); i++) {
         ChartCanvas *cc = g_canvasArray.Item(i);
@@ -6238,6 +6251,8 @@ void MyFrame::OnEvtPlugInMessage(OCPN_MsgEvent &event) {
     for (Track *ptrack : g_TrackList) {
       wxString name = wxEmptyString;
       if (ptrack->m_GUID == trk_id) {
+        //  Points are loaded for sending, do not keep them.
+        bool paged_out = ptrack->IsPagedOut();
         name = ptrack->GetName();
         if (name.IsEmpty()) {
           TrackPoint *rp = ptrack->GetPoint(0);
@@ -6252,7 +6267,7 @@ void MyFrame::OnEvtPlugInMessage(OCPN_MsgEvent &event) {
          * It's up to the plugin to collect the data. */
         int i = 1;
         v["error"] = false;
-        v["TotalNodes"] = ptrack->GetnPoints();
+        v["TotalNodes"] = ptrack->GetPointCount();
         for (int j = 0; j < ptrack->GetnPoints(); j++) {
           TrackPoint *tp = ptrack->GetPoint(j);
           v["lat"] = tp->m_lat;
@@ -6262,6 +6277,7 @@ void MyFrame::OnEvtPlugInMessage(OCPN_MsgEvent &event) {
           wxString msg_id("OCPN_TRACKPOINTS_COORDS");
           SendJSONMessageToAllPlugins(msg_id, v);
         }
+        if (paged_out) ptrack->PageOut();
         return;
       }
       v["error"] = true;
@@ -7281,34 +7297,6 @@ void ApplyLocale() {
   }
 }
 
-class ParseENCWorkerThread : public wxThread {
-public:
-  ParseENCWorkerThread(wxString filename, Extent &ext, int scale)
-      : wxThread(wxTHREAD_JOINABLE) {
-    m_filename = filename;
-    m_ext = ext;
-    m_scale = scale;
-    Create();
-  }
-
-  void *Entry() {
-    //         ChartBase *pchart = ChartData->OpenChartFromDB(m_filename,
-    //         FULL_INIT); ChartData->DeleteCacheChart(pchart);
-    s57chart *newChart = new s57chart;
-
-    newChart->SetNativeScale(m_scale);
-    newChart->SetFullExtent(m_ext);
-
-    newChart->FindOrCreateSenc(m_filename);
-    delete newChart;
-    return 0;
-  }
-
-  wxString m_filename;
-  Extent m_ext;
-  int m_scale;
-};
-
 // begin duplicated code
 static double chart_dist(int index) {
   double d;
@@ -7354,7 +7342,29 @@ WX_DEFINE_OBJARRAY(ArrayOfCompressTargets);
 #include <wx/arrimpl.cpp>
 // end duplicated code
 
+/** Return SENC build priority of chart, see SENCJobPriority. */
+static SENCJobPriority ParsePriority(const ChartTableEntry &cte,
+                                     const LLBBox &view_box,
+                                     const std::vector<LLBBox> &route_legs) {
+  const LLBBox &box = cte.GetBBox();
+  if (view_box.GetValid() && !box.IntersectOut(view_box))
+    return SENC_PRIORITY_VIEWPORT;
+  for (const auto &leg : route_legs) {
+    if (!box.IntersectOut(leg)) return SENC_PRIORITY_ROUTE;
+  }
+  return SENC_PRIORITY_BACKGROUND;
+}
+
+/**
+ * Build the SENC of all S57 charts needing it: charts in view first, then
+ * charts along the active route, then the rest nearest ownship first.
+ * The builds run in the SENCThreadManager workers. With a parent a
+ * progress dialog is shown until done or skipped, which cancels the
+ * remaining jobs. Without parent, return as soon as the jobs are queued.
+ */
 void ParseAllENC(wxWindow *parent) {
+  if (!g_SencThreadManager || !ps52plib) return;
+
   MySortedArrayInt idx_sorted_by_distance(CompareInts);
 
   // Building the cache may take a long time....
@@ -7376,51 +7386,25 @@ void ParseAllENC(wxWindow *parent) {
 
   wxLogMessage(wxString::Format("ParseAllENC() count = %d", count));
 
-  //  Build another array of sorted compression targets.
-  //  We need to do this, as the chart table will not be invariant
-  //  after the compression threads start, so our index array will be invalid.
+  LLBBox view_box;
+  if (gFrame && gFrame->GetPrimaryCanvas() &&
+      gFrame->GetPrimaryCanvas()->GetVP().IsValid())
+    view_box = gFrame->GetPrimaryCanvas()->GetVP().GetBBox();
 
-  ArrayOfCompressTargets ct_array;
-  for (unsigned int j = 0; j < idx_sorted_by_distance.GetCount(); j++) {
-    int i = idx_sorted_by_distance[j];
-
-    const ChartTableEntry &cte = ChartData->GetChartTableEntry(i);
-    double distance = chart_dist(i);
-
-    wxString filename(cte.GetpFullPath(), wxConvUTF8);
-
-    compress_target *pct = new compress_target;
-    pct->distance = distance;
-    pct->chart_path = filename;
-
-    ct_array.push_back(pct);
-  }
-
-  int thread_count = 0;
-  ParseENCWorkerThread **workers = NULL;
-
-  if (g_nCPUCount > 0)
-    thread_count = g_nCPUCount;
-  else
-    thread_count = wxThread::GetCPUCount();
-
-  if (thread_count < 1) {
-    // obviously there's at least one CPU!
-    thread_count = 1;
+  std::vector<LLBBox> route_legs;
+  Route *route = g_pRouteMan ? g_pRouteMan->GetpActiveRoute() : nullptr;
+  if (route) {
+    const RoutePointList &points = *route->pRoutePointList;
+    for (size_t i = 1; i < points.size(); i++) {
+      LLBBox leg;
+      leg.SetFromSegment(points[i - 1]->m_lat, points[i - 1]->m_lon,
+                         points[i]->m_lat, points[i]->m_lon);
+      route_legs.push_back(leg);
+    }
   }
 
-  // thread_count = 1; // for now because there is a problem with more than 1
-
-#if 0
-    workers = new ParseENCWorkerThread*[thread_count];
-    for(int t = 0; t < thread_count; t++)
-        workers[t] = NULL;
-#endif
-
   wxGenericProgressDialog *prog = nullptr;
-  wxSize csz = GetOCPNCanvasWindow()->GetClientSize();
-
-  if (1) {
+  if (parent) {
     long style = wxPD_SMOOTH | wxPD_ELAPSED_TIME | wxPD_ESTIMATED_TIME |
                  wxPD_REMAINING_TIME | wxPD_CAN_SKIP;
 
@@ -7431,11 +7415,6 @@ void ParseAllENC(wxWindow *parent) {
     prog->Create(_("OpenCPN ENC Prepare"), "Longgggggggggggggggggggggggggggg",
                  count + 1, parent, style);
 
-    // make wider to show long filenames
-    // wxSize sz = prog->GetSize();
-    // sz.x = csz.x * 8 / 10;
-    // prog->SetSize( sz );
-
     DimeControl(prog);
 #ifdef __WXOSX__
     prog->ShowWindowModal();
@@ -7444,102 +7423,63 @@ void ParseAllENC(wxWindow *parent) {
 #endif
   }
 
-  // parse targets
+  //  Check all charts and queue the ones needing a new SENC. The chart
+  //  objects are only needed for the check: queued jobs carry on without
+  //  them.
   bool skip = false;
-  count = 0;
-  for (unsigned int j = 0; j < ct_array.size(); j++) {
-    wxString filename = ct_array[j].chart_path;
-    double distance = ct_array[j].distance;
-    int index = ChartData->FinddbIndex(filename);
-    if (index < 0) continue;
-    const ChartTableEntry &cte = ChartData->GetChartTableEntry(index);
+  int checked = 0;
+  for (unsigned int j = 0; j < idx_sorted_by_distance.GetCount(); j++) {
+    const ChartTableEntry &cte =
+        ChartData->GetChartTableEntry(idx_sorted_by_distance[j]);
+    wxString filename(cte.GetpFullPath(), wxConvUTF8);
     Extent ext;
     ext.NLAT = cte.GetLatMax();
     ext.SLAT = cte.GetLatMin();
     ext.WLON = cte.GetLonMin();
     ext.ELON = cte.GetLonMax();
 
-    int scale = cte.GetScale();
-
-    wxString msg;
-    msg.Printf(_("Distance from Ownship:  %4.0f NMi"), distance);
+    s57chart *newChart = new s57chart;
+    newChart->SetNativeScale(cte.GetScale());
+    newChart->SetFullExtent(ext);
+    newChart->SetSENCPriority(ParsePriority(cte, view_box, route_legs));
+    newChart->FindOrCreateSenc(filename, false);
+    delete newChart;
 
-    count++;
-    if (wxThread::IsMain()) {
-      if (prog) {
-        wxSize sz = prog->GetSize();
-        if (sz.x > 600) {
-          msg += "   Chart:";
-          msg += filename;
-        }
-        prog->Update(count, msg, &skip);
-#ifndef __WXMSW__
-        prog->Raise();
-#endif
-      }
+    checked++;
+    if (prog && wxThread::IsMain()) {
+      prog->Update(checked / 10, _("Checking ENC: ") + filename, &skip);
       if (skip) break;
     }
+  }
 
-#if 1
-    if (ps52plib) {
-      s57chart *newChart = new s57chart;
-
-      newChart->SetNativeScale(scale);
-      newChart->SetFullExtent(ext);
-      newChart->DisableBackgroundSENC();
-
-      newChart->FindOrCreateSenc(filename,
-                                 false);  // no progress dialog required
-      delete newChart;
+  if (!prog) {
+    SENCBuildStats stats = g_SencThreadManager->GetStats();
+    wxLogMessage("ParseAllENC() queued %d SENC builds", stats.pending);
+    return;
+  }
 
-      if (wxThread::IsMain()) {
-        msg.Printf(_("ENC Completed."));
-        if (prog) {
-          prog->Update(count, msg, &skip);
+  //  Wait for the workers, the progress bar counting built charts after
+  //  the first tenth used by the checks.
+  SENCBuildStats stats = g_SencThreadManager->GetStats();
+  int total = stats.pending + stats.running + stats.done + stats.failed;
+  while (!skip && g_SencThreadManager->GetJobCount()) {
+    stats = g_SencThreadManager->GetStats();
+    int built = stats.done + stats.failed;
+    wxString msg;
+    msg.Printf(_("Built %d of %d ENC, %.1f per minute"), built, total,
+               stats.GetRate());
+    int value = count / 10 + (total ? built * (count - count / 10) / total : 0);
+    prog->Update(wxMin(value, count), msg, &skip);
 #ifndef __WXMSW__
-          prog->Raise();
-#endif
-        }
-        if (skip) break;
-      }
-    }
-
-#else
-    for (int t = 0;; t = (t + 1) % thread_count) {
-      if (!workers[t]) {
-        workers[t] = new ParseENCWorkerThread(filename);
-        workers[t]->Run();
-        break;
-      }
-
-      if (!workers[t]->IsAlive()) {
-        workers[t]->Wait();
-        delete workers[t];
-        workers[t] = NULL;
-      }
-      if (t == 0) {
-        //                ::wxYield();                // allow ChartCanvas main
-        //                message loop to run
-        wxThread::Sleep(1); /* wait for a worker to finish */
-      }
-    }
-#endif
-
-#if defined(__WXMSW__) || defined(__WXOSX__)
-    ::wxSafeYield();
+    prog->Raise();
 #endif
+    wxMilliSleep(100);
+  }
+  if (skip) {
+    int cancelled = g_SencThreadManager->CancelPending(SENC_PRIORITY_ROUTE);
+    wxLogMessage("ParseAllENC() skipped, %d SENC builds cancelled",
+                 cancelled);
   }
-
-#if 0
-        /* wait for workers to finish, and clean up after then */
-        for(int t = 0; t<thread_count; t++) {
-                        if(workers[t]) {
-                            workers[t]->Wait();
-                            delete workers[t];
-                        }
-        }
-        delete [] workers;
-#endif
 
   delete prog;
 }
@@ -938,8 +938,8 @@ bool UpdateSingleWaypoint(PlugIn_Waypoint* pwaypoint) {
     SelectItem* pFind =
         pSelect->FindSelection(ctx, lat_save, lon_save, SELTYPE_ROUTEPOINT);
     if (pFind) {
-      pFind->m_slat = pwaypoint->m_lat;  // update the SelectList entry
-      pFind->m_slon = pwaypoint->m_lon;
+      // update the SelectList entry
+      pSelect->ModifySelectableItem(pFind, pwaypoint->m_lat, pwaypoint->m_lon);
     }
 
     if (!prp->m_btemp) {
@@ -2123,8 +2123,8 @@ bool UpdateSingleWaypointExV2(PlugIn_Waypoint_ExV2* pwaypoint) {
     SelectItem* pFind =
         pSelect->FindSelection(ctx, lat_save, lon_save, SELTYPE_ROUTEPOINT);
     if (pFind) {
-      pFind->m_slat = pwaypoint->m_lat;  // update the SelectList entry
-      pFind->m_slon = pwaypoint->m_lon;
+      // update the SelectList entry
+      pSelect->ModifySelectableItem(pFind, pwaypoint->m_lat, pwaypoint->m_lon);
     }
 
     if (!prp->m_btemp) {
@@ -2466,8 +2466,8 @@ bool UpdateSingleWaypointEx(PlugIn_Waypoint_Ex* pwaypoint) {
     SelectItem* pFind =
         pSelect->FindSelection(ctx, lat_save, lon_save, SELTYPE_ROUTEPOINT);
     if (pFind) {
-      pFind->m_slat = pwaypoint->m_lat;  // update the SelectList entry
-      pFind->m_slon = pwaypoint->m_lon;
+      // update the SelectList entry
+      pSelect->ModifySelectableItem(pFind, pwaypoint->m_lat, pwaypoint->m_lon);
     }
 
     if (!prp->m_btemp) {
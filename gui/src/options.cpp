@@ -87,6 +87,7 @@
 #include "model/comm_drv_factory.h"
 #include "model/comm_util.h"
 #include "model/config_vars.h"
+#include "model/gpu_ledger.h"
 #include "model/gui_events.h"
 #include "model/gui_vars.h"
 #include "model/idents.h"
@@ -9468,12 +9469,13 @@ void options::OnRemoveTideDataLocation(wxCommandEvent& event) {
 }
 
 // OpenGLOptionsDlg
-enum { ID_BUTTON_REBUILD, ID_BUTTON_CLEAR };
+enum { ID_BUTTON_REBUILD, ID_BUTTON_CLEAR, ID_BUTTON_GPU_MEMORY };
 
 #ifdef ocpnUSE_GL
 BEGIN_EVENT_TABLE(OpenGLOptionsDlg, wxDialog)
 EVT_BUTTON(ID_BUTTON_REBUILD, OpenGLOptionsDlg::OnButtonRebuild)
 EVT_BUTTON(ID_BUTTON_CLEAR, OpenGLOptionsDlg::OnButtonClear)
+EVT_BUTTON(ID_BUTTON_GPU_MEMORY, OpenGLOptionsDlg::OnButtonGpuMemory)
 END_EVENT_TABLE()
 
 OpenGLOptionsDlg::OpenGLOptionsDlg(wxWindow* parent)
@@ -9511,6 +9513,8 @@ OpenGLOptionsDlg::OpenGLOptionsDlg(wxWindow* parent)
   btnRebuild->Enable(g_GLOptions.m_bTextureCompressionCaching);
   if (!g_bopengl || g_raster_format == GL_RGB) btnRebuild->Disable();
   btnClear->Enable(g_GLOptions.m_bTextureCompressionCaching);
+  wxButton* btnGpuMemory = new wxButton(this, ID_BUTTON_GPU_MEMORY,
+                                        _("GPU Memory: ") + GetGpuMemoryUse());
   m_cbPolygonSmoothing = new wxCheckBox(this, wxID_ANY, _("Polygon Smoothing"));
   m_cbLineSmoothing = new wxCheckBox(this, wxID_ANY, _("Line Smoothing"));
   m_cbSoftwareGL =
@@ -9532,6 +9536,8 @@ OpenGLOptionsDlg::OpenGLOptionsDlg(wxWindow* parent)
   flexSizer->Add(btnRebuild, 0, wxALL | wxEXPAND, 5);
   flexSizer->AddSpacer(0);
   flexSizer->Add(btnClear, 0, wxALL | wxEXPAND, 5);
+  flexSizer->AddSpacer(0);
+  flexSizer->Add(btnGpuMemory, 0, wxALL | wxEXPAND, 5);
   flexSizer->Add(new wxStaticText(this, wxID_ANY, _("Miscellaneous")), 0,
                  wxALIGN_RIGHT | wxALIGN_CENTER_VERTICAL, 5);
   flexSizer->Add(m_cbPolygonSmoothing, 0, wxALL | wxEXPAND, 5);
@@ -9672,6 +9678,37 @@ void OpenGLOptionsDlg::OnButtonClear(wxCommandEvent& event) {
   }
 }
 
+void OpenGLOptionsDlg::OnButtonGpuMemory(wxCommandEvent& event) {
+  // Per chart breakdown of GPU memory, largest users first.
+  const double mb = 1024.0 * 1024.0;
+  auto stats = GpuLedger::GetInstance().GetStats();
+  wxString msg = _("GPU memory: ") + GetGpuMemoryUse() + "\n\n";
+  const size_t kMaxCharts = 20;
+  for (size_t i = 0; i < stats.size() && i < kMaxCharts; i++) {
+    const auto& owner = stats[i];
+    auto by_kind = [&](GpuLedger::Kind kind) {
+      return owner.bytes_by_kind[static_cast<size_t>(kind)] / mb;
+    };
+    wxFileName fn(wxString(owner.owner));
+    msg << wxString::Format(
+        "%s: %.1f MB (%s %.1f, %s %.1f, %s %.1f)\n", fn.GetFullName(),
+        owner.bytes / mb, _("raster"),
+        by_kind(GpuLedger::Kind::kRasterTexture), _("tiles"),
+        by_kind(GpuLedger::Kind::kTileTexture), _("vector"),
+        by_kind(GpuLedger::Kind::kVertexBuffer));
+  }
+  if (stats.size() > kMaxCharts)
+    msg << wxString::Format(_("and %d more charts"),
+                            static_cast<int>(stats.size() - kMaxCharts));
+  OCPNMessageBox(this, msg, _("OpenCPN Info"), wxICON_INFORMATION | wxOK);
+}
+
+wxString OpenGLOptionsDlg::GetGpuMemoryUse() {
+  double used = GpuLedger::GetInstance().GetUsed() / (1024.0 * 1024.0);
+  return wxString::Format(_("%.1f of %d MB used"), used,
+                          g_GLOptions.m_iTextureMemorySize);
+}
+
 wxString OpenGLOptionsDlg::GetTextureCacheSize() {
   wxString path = g_Platform->GetPrivateDataDir();
   appendOSDirSlash(&path);
@@ -928,10 +928,9 @@ PlugInManager::PlugInManager(AbstractTopFrame* parent) {
     SendNMEASentenceToAllPlugIns(ev.GetString());
   };
   m_on_msg_sent_listener.Init(g_pRouteMan->on_message_sent, msg_sent_action);
-  m_new_msgtype_lstnr.Init(NavMsgBus::GetInstance().new_msg_event,
-                           [&](ObservedEvt&) { OnNewMessageType(); });
 }
 PlugInManager::~PlugInManager() {
+  NavMsgBus::GetInstance().RemoveBatchListener(m_n0183_listener);
 #if !defined(__ANDROID__) && defined(OCPN_USE_CURL)
   wxCurlBase::Shutdown();
 #endif
@@ -950,22 +949,18 @@ void PlugInManager::InitCommListeners() {
   Bind(EVT_SIGNALK, [&](ObservedEvt ev) {
     HandleSignalK(UnpackEvtPointer<SignalkMsg>(ev));
   });
-}
 
-void PlugInManager::OnNewMessageType() {
-  for (auto msg_key : NavMsgBus::GetInstance().GetActiveMessages()) {
-    if (m_0183_listeners.find(msg_key) != m_0183_listeners.end()) continue;
-    if (msg_key.find("::") == std::string::npos) continue;
-    auto key_parts = ocpn::split(msg_key, "::");
-    if (key_parts.size() < 2) continue;
-    if (NavMsg::GetBusByKey(msg_key) == NavAddr::Bus::N0183) {
-      ObsListener ol(RawKey(key_parts[1]), [&](ObservedEvt& ev) {
-        HandleN0183(UnpackEvtPointer<Nmea0183Msg>(ev));
-      });
-      m_0183_listeners[msg_key] = std::move(ol);
-    }
-  }
+  // All N0183 messages in one main loop call per batch.
+  m_n0183_listener = msgbus.AddBatchListener(
+      [&](const NavMsgBatch& batch) {
+        for (const auto& msg : batch) {
+          if (msg->bus != NavAddr::Bus::N0183) continue;
+          HandleN0183(std::static_pointer_cast<const Nmea0183Msg>(msg));
+        }
+      },
+      NavMsgDelivery::kGuiThread);
 }
+
 void PlugInManager::HandleN0183(std::shared_ptr<const Nmea0183Msg> n0183_msg) {
   assert(n0183_msg->bus == NavAddr::Bus::N0183);
   const std::string& payload = n0183_msg->payload;
@@ -247,6 +247,7 @@ s57chart::s57chart() {
 
   m_next_safe_cnt = 1e6;
   m_LineVBO_name = -1;
+  m_vbo_gpu_handle = 0;
   m_line_vertex_buffer = 0;
   m_this_chart_context = 0;
   m_Chart_Skew = 0;
@@ -254,6 +255,8 @@ s57chart::s57chart() {
   bReadyToRender = false;
   m_RAZBuilt = false;
   m_disableBackgroundSENC = false;
+  m_SENCPriority = SENC_PRIORITY_VIEWPORT;
+  m_pick_index_dirty = true;
 }
 
 s57chart::~s57chart() {
@@ -282,10 +285,11 @@ s57chart::~s57chart() {
   m_pcs_vector.clear();
   m_pve_vector.clear();
 
+  //  Points ingested from SENC are released with m_senc_storage
   for (const auto &it : m_ve_hash) {
     VE_Element *pedge = it.second;
     if (pedge) {
-      free(pedge->pPoints);
+      if (!m_senc_storage) free(pedge->pPoints);
       delete pedge;
     }
   }
@@ -294,26 +298,26 @@ s57chart::~s57chart() {
   for (const auto &it : m_vc_hash) {
     VC_Element *pcs = it.second;
     if (pcs) {
-      free(pcs->pPoint);
+      if (!m_senc_storage) free(pcs->pPoint);
       delete pcs;
     }
   }
   m_vc_hash.clear();
 
 #ifdef ocpnUSE_GL
+  GpuLedger::GetInstance().Release(m_vbo_gpu_handle);
   if ((m_LineVBO_name > 0)) glDeleteBuffers(1, (GLuint *)&m_LineVBO_name);
 #endif
   free(m_this_chart_context);
 
-  if (m_TempFilePath.Length() && (m_FullPath != m_TempFilePath)) {
-    if (::wxFileExists(m_TempFilePath)) wxRemoveFile(m_TempFilePath);
-  }
+  //  A queued or active SENC build for this chart runs on without it, and
+  //  then removes the decompressed temporary file if any.
+  bool b_temp = m_TempFilePath.Length() && (m_FullPath != m_TempFilePath);
+  if (g_SencThreadManager && g_SencThreadManager->DetachChart(this, b_temp))
+    b_temp = false;
 
-  //  Check the SENCThreadManager to see if this chart is queued or active
-  if (g_SencThreadManager) {
-    if (g_SencThreadManager->IsChartInTicketlist(this)) {
-      g_SencThreadManager->SetChartPointer(this, NULL);
-    }
+  if (b_temp) {
+    if (::wxFileExists(m_TempFilePath)) wxRemoveFile(m_TempFilePath);
   }
 }
 
@@ -478,6 +482,13 @@ void s57chart::FreeObjectsAndRules() {
       }
     }
   }
+  m_pick_entries.clear();
+  m_pick_item_features.clear();
+  m_pick_index.Clear();
+  m_pick_index_dirty = true;
+  m_features.clear();
+  m_class_ranges.clear();
+  m_class_features.clear();
 }
 
 void s57chart::ClearRenderedTextCache() {
@@ -1265,20 +1276,49 @@ void s57chart::AssembleLineGeometry() {
 
   float *lvr = (float *)buffer_offset;
 
-  //      Copy and edge points as floats,
-  //      and recording each segment's offset in the array
-  for (const auto &it : m_ve_hash) {
-    VE_Element *pedge = it.second;
-    if (pedge) {
-      memcpy(lvr, pedge->pPoints, pedge->nCount * 2 * sizeof(float));
-      lvr += pedge->nCount * 2;
+  //  Edge points of a format 300 SENC are already contiguous and in the
+  //  buffer layout: copy them at once, the offset of each edge follows
+  //  from its position in the block.
+  const float *edge_block = NULL;
+  size_t edge_block_points = 0;
+  if (m_senc_storage && m_senc_storage->edge_points) {
+    size_t hash_points = 0;
+    for (const auto &it : m_ve_hash) {
+      if (it.second) hash_points += it.second->nCount;
+    }
+    if (hash_points == m_senc_storage->edge_point_count) {
+      edge_block = m_senc_storage->edge_points;
+      edge_block_points = hash_points;
+    }
+  }
 
-      pedge->vbo_offset = offset;
-      offset += pedge->nCount * 2 * sizeof(float);
+  if (edge_block) {
+    memcpy(lvr, edge_block, edge_block_points * 2 * sizeof(float));
+    lvr += edge_block_points * 2;
+    for (const auto &it : m_ve_hash) {
+      VE_Element *pedge = it.second;
+      if (pedge && pedge->pPoints) {
+        pedge->vbo_offset =
+            offset + (pedge->pPoints - edge_block) * sizeof(float);
+      }
+    }
+    offset += edge_block_points * 2 * sizeof(float);
+  } else {
+    //      Copy and edge points as floats,
+    //      and recording each segment's offset in the array
+    for (const auto &it : m_ve_hash) {
+      VE_Element *pedge = it.second;
+      if (pedge) {
+        memcpy(lvr, pedge->pPoints, pedge->nCount * 2 * sizeof(float));
+        lvr += pedge->nCount * 2;
+
+        pedge->vbo_offset = offset;
+        offset += pedge->nCount * 2 * sizeof(float);
+      }
+      //         else
+      //             int yyp = 4;        //TODO Why are zero elements being
+      //             inserted into m_ve_hash?
     }
-    //         else
-    //             int yyp = 4;        //TODO Why are zero elements being
-    //             inserted into m_ve_hash?
   }
 
   //      Now iterate on the hashmaps, adding the connector segments in the
@@ -1342,7 +1382,8 @@ void s57chart::AssembleLineGeometry() {
     VE_Element *pedge = it.second;
     if (pedge) {
       m_pve_vector.push_back(pedge);
-      free(pedge->pPoints);
+      if (!m_senc_storage) free(pedge->pPoints);
+      pedge->pPoints = NULL;
     }
   }
   m_ve_hash.clear();
@@ -1352,15 +1393,20 @@ void s57chart::AssembleLineGeometry() {
   // all the points are now in the VBO buffer
   for (const auto &it : m_vc_hash) {
     VC_Element *pcs = it.second;
-    if (pcs) free(pcs->pPoint);
+    if (pcs && !m_senc_storage) free(pcs->pPoint);
     delete pcs;
   }
   m_vc_hash.clear();
 
+  //  Points from SENC are all released at once, including the file mapping
+  m_senc_storage.reset();
+
 #ifdef ocpnUSE_GL
   if (g_b_EnableVBO) {
     if (grow_buffer) {
       if (m_LineVBO_name > 0) {
+        GpuLedger::GetInstance().Release(m_vbo_gpu_handle);
+        m_vbo_gpu_handle = 0;
         glDeleteBuffers(1, (GLuint *)&m_LineVBO_name);
         m_LineVBO_name = -1;
       }
@@ -1495,6 +1541,19 @@ void s57chart::BuildLineVBO() {
 
     m_LineVBO_name = vboId;
     m_this_chart_context->vboID = vboId;
+
+    // The vertex data is kept in m_line_vertex_buffer, so an evicted VBO is
+    // simply built again on next render.
+    auto evict = [this] {
+      glDeleteBuffers(1, (GLuint *)&m_LineVBO_name);
+      m_LineVBO_name = -1;
+      m_vbo_gpu_handle = 0;
+    };
+    m_vbo_gpu_handle = GpuLedger::GetInstance().Register(
+        m_FullPath.ToStdString(), GpuLedger::Kind::kVertexBuffer,
+        m_vbo_byte_length, evict);
+  } else {
+    GpuLedger::GetInstance().Touch(m_vbo_gpu_handle);
   }
 
 #endif
@@ -2719,8 +2778,10 @@ int s57chart::FindOrCreateSenc(const wxString &name, bool b_progress) {
 
         //              Anything to do?
         // force_make_senc = 1;
-        //  SENC file version has to be correct for other tests to make sense
-        if (senc_file_version != CURRENT_SENC_FORMAT_VERSION) {
+        //  SENC file version has to be correct for other tests to make sense.
+        //  Older, still readable versions are kept until the cell changes.
+        if (senc_file_version < OLDEST_SENC_FORMAT_VERSION ||
+            senc_file_version > CURRENT_SENC_FORMAT_VERSION) {
           bbuild_new_senc = true;
           wxLogMessage("    Rebuilding SENC due to SENC format update.");
         }
@@ -2880,33 +2941,36 @@ void s57chart::BuildDepthContourArray() {
     m_pvaldco_array = (double *)calloc(m_nvaldco_alloc, sizeof(double));
   }
 
-  ObjRazRules *top;
+  //  Use the SENC class index if present, else walk all rules
+  std::vector<S57Obj *> contours;
+  if (!GetClassObjects("DEPCNT", contours)) {
+    for (int i = 0; i < PRIO_NUM; ++i) {
+      for (int j = 0; j < LUPNAME_NUM; j++) {
+        for (ObjRazRules *top = razRules[i][j]; top; top = top->next) {
+          if (!strncmp(top->obj->FeatureName, "DEPCNT", 6))
+            contours.push_back(top->obj);
+        }
+      }
+    }
+  }
+
   // some ENC have a lot of DEPCNT objects but they seem to store them
   // in VALDCO order, try to take advantage of that.
   double prev_valdco = 0.0;
 
-  for (int i = 0; i < PRIO_NUM; ++i) {
-    for (int j = 0; j < LUPNAME_NUM; j++) {
-      top = razRules[i][j];
-      while (top != NULL) {
-        if (!strncmp(top->obj->FeatureName, "DEPCNT", 6)) {
-          double valdco = 0.0;
-          if (GetDoubleAttr(top->obj, "VALDCO", valdco)) {
-            if (valdco != prev_valdco) {
-              prev_valdco = valdco;
-              m_nvaldco++;
-              if (m_nvaldco > m_nvaldco_alloc) {
-                void *tr = realloc((void *)m_pvaldco_array,
-                                   m_nvaldco_alloc * 2 * sizeof(double));
-                m_pvaldco_array = (double *)tr;
-                m_nvaldco_alloc *= 2;
-              }
-              m_pvaldco_array[m_nvaldco - 1] = valdco;
-            }
-          }
+  for (S57Obj *obj : contours) {
+    double valdco = 0.0;
+    if (GetDoubleAttr(obj, "VALDCO", valdco)) {
+      if (valdco != prev_valdco) {
+        prev_valdco = valdco;
+        m_nvaldco++;
+        if (m_nvaldco > m_nvaldco_alloc) {
+          void *tr = realloc((void *)m_pvaldco_array,
+                             m_nvaldco_alloc * 2 * sizeof(double));
+          m_pvaldco_array = (double *)tr;
+          m_nvaldco_alloc *= 2;
         }
-        ObjRazRules *nxx = top->next;
-        top = nxx;
+        m_pvaldco_array[m_nvaldco - 1] = valdco;
       }
     }
   }
@@ -2914,6 +2978,18 @@ void s57chart::BuildDepthContourArray() {
   SetSafetyContour();
 }
 
+bool s57chart::GetClassObjects(const char *acronym,
+                               std::vector<S57Obj *> &objects) const {
+  if (m_class_ranges.empty()) return false;
+  auto range = m_class_ranges.find(acronym);
+  if (range == m_class_ranges.end()) return true;
+  for (uint32_t i = 0; i < range->second.second; i++) {
+    S57Obj *obj = m_features[m_class_features[range->second.first + i]];
+    if (obj) objects.push_back(obj);
+  }
+  return true;
+}
+
 void s57chart::SetSafetyContour() {
   // Iterate through the array of contours in this cell, choosing the best one
   // to render as a bold "safety contour" in the PLIB.
@@ -4061,6 +4137,7 @@ int s57chart::BuildSENCFile(const wxString &FullPath000,
       ticket->m_FullPath000 = FullPath000;
       ticket->m_SENCFileName = SENCFileName;
       ticket->m_chart = this;
+      ticket->m_priority = static_cast<SENCJobPriority>(m_SENCPriority);
 
       g_SencThreadManager->ScheduleJob(ticket);
       bReadyToRender = true;
@@ -4102,7 +4179,9 @@ int s57chart::BuildRAZFromSENCFile(const wxString &FullPath) {
 
   sencfile.setRefLocn(ref_lat, ref_lon);
 
-  int srv = sencfile.ingest200(FullPath, &Objects, &VEs, &VCs);
+  m_senc_storage = std::make_unique<Osenc_storage>();
+  int srv =
+      sencfile.ingest200(FullPath, &Objects, &VEs, &VCs, m_senc_storage.get());
 
   if (srv != SENC_NO_ERROR) {
     wxLogMessage(sencfile.getLastError());
@@ -4279,6 +4358,31 @@ int s57chart::BuildRAZFromSENCFile(const wxString &FullPath) {
 
   }  // Objects iterator
 
+  //  Keep the feature indexes of format 300 SENCs, see Osenc_storage.
+  //  Objects dropped above for lacking a LUP are nullptr.
+  size_t n_features = m_senc_storage->feature_objects.size();
+  m_features.assign(n_features, nullptr);
+  for (size_t i = 0; i < n_features; i++) {
+    int index = m_senc_storage->feature_objects[i];
+    if (index >= 0 && static_cast<size_t>(index) < Objects.size())
+      m_features[i] = Objects[index];
+  }
+  auto valid_features = [n_features](const std::vector<uint32_t> &features) {
+    return std::all_of(features.begin(), features.end(),
+                       [n_features](uint32_t f) { return f < n_features; });
+  };
+  if (valid_features(m_senc_storage->class_features)) {
+    m_class_features = std::move(m_senc_storage->class_features);
+    for (const auto &range : m_senc_storage->class_ranges)
+      m_class_ranges[range.acronym] = {range.first, range.count};
+  }
+  if (!m_senc_storage->spatial_features.empty() &&
+      valid_features(m_senc_storage->spatial_features)) {
+    m_pick_index.SetTree(std::move(m_senc_storage->spatial_index));
+    m_pick_item_features = std::move(m_senc_storage->spatial_features);
+    m_pick_index_dirty = true;
+  }
+
   //   Decide on pub date to show
 
   wxDateTime d000;
@@ -4420,6 +4524,7 @@ int s57chart::_insertRules(S57Obj *obj, LUPrec *LUP, s57chart *pOwner) {
     razRules[disPrioIdx][LUPtypeIdx] = rzRules;
 
 #endif
+  m_pick_index_dirty = true;
 
   return 1;
 }
@@ -4720,6 +4825,53 @@ ListOfObjRazRules *s57chart::GetLightsObjRuleListVisibleAtLatLon(
   return ret_ptr;
 }
 
+void s57chart::BuildPickIndex() {
+  //  Point objects are not indexed since their boxes are expanded while
+  //  rendering symbols and text, see s52plib.
+  m_pick_entries.clear();
+  m_pick_index.ClearEntries();
+
+  //  The SENC spatial index is used as is, entries attached to the items
+  //  of their objects. An area may have entries in both boundary lists.
+  std::unordered_map<const S57Obj *, uint32_t> object_items;
+  for (uint32_t item = 0; item < m_pick_item_features.size(); item++) {
+    const S57Obj *obj = m_features[m_pick_item_features[item]];
+    if (obj) object_items[obj] = item;
+  }
+
+  for (int i = 0; i < PRIO_NUM; ++i) {
+    for (int j : {3, 4, 2}) {
+      for (ObjRazRules *top = razRules[i][j]; top; top = top->next) {
+        m_pick_entries.push_back({top, static_cast<uint8_t>(i),
+                                  static_cast<uint8_t>(j)});
+        const S57Obj *obj = top->obj;
+        const LLBBox &box = obj->BBObj;
+        //  Boxes crossing the IDL are handled by LLBBox::ContainsMarge()
+        bool indexable = (obj->Primitive_type == GEO_AREA ||
+                          obj->Primitive_type == GEO_LINE) &&
+                         box.GetValid() && box.GetMinLon() >= -180. &&
+                         box.GetMaxLon() <= 180.;
+        if (!indexable) {
+          m_pick_index.AddUnindexed();
+        } else if (m_pick_index.HasTree()) {
+          auto item = object_items.find(obj);
+          if (item != object_items.end())
+            m_pick_index.AddToItem(item->second);
+          else
+            m_pick_index.AddUnindexed();
+        } else {
+          m_pick_index.AddBox({static_cast<float>(box.GetMinLon()),
+                               static_cast<float>(box.GetMinLat()),
+                               static_cast<float>(box.GetMaxLon()),
+                               static_cast<float>(box.GetMaxLat())});
+        }
+      }
+    }
+  }
+  m_pick_index.Finish();
+  m_pick_index_dirty = false;
+}
+
 ListOfObjRazRules *s57chart::GetObjRuleListAtLatLon(float lat, float lon,
                                                     float select_radius,
                                                     ViewPort *VPoint,
@@ -4729,6 +4881,15 @@ ListOfObjRazRules *s57chart::GetObjRuleListAtLatLon(float lat, float lon,
 
   PrepareForRender(VPoint, ps52plib);
 
+  //  Areas and lines which may be hit, by index in m_pick_entries. The
+  //  geometric tests below are still authoritative.
+  if (m_pick_index_dirty) BuildPickIndex();
+  //  Margin covers float rounding of the indexed boxes.
+  const float margin = select_radius + 1e-4;
+  std::vector<uint32_t> candidates = m_pick_index.Search(
+      {lon - margin, lat - margin, lon + margin, lat + margin});
+  size_t next_candidate = 0;
+
   //    Iterate thru the razRules array, by object/rule type
 
   ObjRazRules *top;
@@ -4769,33 +4930,24 @@ ListOfObjRazRules *s57chart::GetObjRuleListAtLatLon(float lat, float lon,
       }
     }
 
-    if (selection_mask & MASK_AREA) {
-      // Areas by boundary type, array indices [3..4]
-
-      int area_boundary_type =
-          (ps52plib->m_nBoundaryStyle == PLAIN_BOUNDARIES) ? 3 : 4;
-      top = razRules[i][area_boundary_type];  // Area nnn Boundaries
-      while (top != NULL) {
-        if (ps52plib->ObjectRenderCheck(top)) {
-          if (DoesLatLonSelectObject(lat, lon, select_radius, top->obj))
-            selected_rules.push_back(top);
-        }
-
-        top = top->next;
-      }  // while
-    }
-
-    if (selection_mask & MASK_LINE) {
-      // Finally, lines
-      top = razRules[i][2];  // Lines
-
-      while (top != NULL) {
-        if (ps52plib->ObjectRenderCheck(top)) {
-          if (DoesLatLonSelectObject(lat, lon, select_radius, top->obj))
-            selected_rules.push_back(top);
-        }
-
-        top = top->next;
+    // Areas by boundary type, array indices [3..4], then lines [2]. The
+    // candidates are sorted in razRules order, that is by priority and for
+    // each priority areas before lines.
+    int area_boundary_type =
+        (ps52plib->m_nBoundaryStyle == PLAIN_BOUNDARIES) ? 3 : 4;
+    for (; next_candidate < candidates.size(); ++next_candidate) {
+      const PickEntry &entry = m_pick_entries[candidates[next_candidate]];
+      if (entry.prio != i) break;
+      if (entry.list == 2) {
+        if (!(selection_mask & MASK_LINE)) continue;
+      } else if (entry.list != area_boundary_type ||
+                 !(selection_mask & MASK_AREA)) {
+        continue;
+      }
+      top = entry.rules;
+      if (ps52plib->ObjectRenderCheck(top)) {
+        if (DoesLatLonSelectObject(lat, lon, select_radius, top->obj))
+          selected_rules.push_back(top);
       }
     }
   }
@@ -44,6 +44,10 @@ SENCThreadManager *g_SencThreadManager;
 //      SENCJobTicket Implementation
 //----------------------------------------------------------------------------------
 SENCJobTicket::SENCJobTicket() {
+  m_chart = nullptr;
+  m_priority = SENC_PRIORITY_VIEWPORT;
+  m_seq = 0;
+  m_remove_source = false;
   m_SENCResult = SENC_BUILD_INACTIVE;
   m_status = THREAD_INACTIVE;
 }
@@ -73,7 +77,7 @@ wxEvent *OCPN_BUILDSENC_ThreadEvent::Clone() const {
 //----------------------------------------------------------------------------------
 //      SENCThreadManager Implementation
 //----------------------------------------------------------------------------------
-SENCThreadManager::SENCThreadManager() {
+SENCThreadManager::SENCThreadManager() : m_next_seq(0), m_stopping(false) {
   // ideally we would use the cpu count -1, and only launch jobs
   // when the idle load average is sufficient (greater than 1)
   int nCPU = wxMax(1, wxThread::GetCPUCount());
@@ -92,125 +96,255 @@ SENCThreadManager::SENCThreadManager() {
   Connect(
       wxEVT_OCPN_BUILDSENCTHREAD,
       (wxObjectEventFunction)(wxEventFunction)&SENCThreadManager::OnEvtThread);
-
-  //     m_timer.Connect(wxEVT_TIMER, wxTimerEventHandler(
-  //     glTextureManager::OnTimer ), NULL, this); m_timer.Start(500);
 }
 
 SENCThreadManager::~SENCThreadManager() {
-  //    ClearJobList();
-}
-
-SENCThreadStatus SENCThreadManager::ScheduleJob(SENCJobTicket *ticket) {
-  //  Do not add a job if there is already a job pending for this chart, by name
-  for (size_t i = 0; i < ticket_list.size(); i++) {
-    if (ticket_list[i]->m_FullPath000 == ticket->m_FullPath000)
-      return THREAD_PENDING;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;  // Also makes running builds abort
+    for (auto it = m_tickets.begin(); it != m_tickets.end();) {
+      SENCJobTicket *ticket = it->second;
+      if (ticket->m_status == THREAD_PENDING) {
+        if (ticket->m_remove_source && ::wxFileExists(ticket->m_FullPath000))
+          wxRemoveFile(ticket->m_FullPath000);
+        it = m_tickets.erase(it);
+        delete ticket;
+      } else {
+        ++it;
+      }
+    }
+    m_queue = std::priority_queue<QueueEntry>();
   }
+  m_cv.notify_all();
 
-  ticket->m_status = THREAD_PENDING;
-  ticket_list.push_back(ticket);
+  // Idle workers exit right away, running ones after aborting their build.
+  for (auto worker : m_workers) {
+    worker->Wait();
+    delete worker;
+  }
 
-  // printf("Scheduling job:  %s\n", (const
-  // char*)ticket->m_FullPath000.mb_str()); printf("Job count:  %d\n",
-  // ticket_list.size());
-  StartTopJob();
-  return THREAD_PENDING;
+  // Jobs whose completion event was not yet handled, and never will be.
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto &kv : m_tickets) delete kv.second;
+  m_tickets.clear();
 }
 
-void SENCThreadManager::StartTopJob() {
-  SENCJobTicket *startCandidate;
-  // Get the running job count
-  int nRunning = 0;
-  for (size_t i = 0; i < ticket_list.size(); i++) {
-    if (ticket_list[i]->m_status == THREAD_STARTED) nRunning++;
+void SENCThreadManager::StartWorkers() {
+  if (!m_workers.empty() || m_stopping) return;
+  for (int i = 0; i < m_max_jobs; i++) {
+    auto worker = new SENCBuildThread(this);
+    worker->SetPriority(20);
+    if (worker->Run() != wxTHREAD_NO_ERROR) {
+      delete worker;
+      continue;
+    }
+    m_workers.push_back(worker);
   }
+}
 
-  // OK to start one?
-  if (nRunning < m_max_jobs) {
-    // Find the first eligible
-    startCandidate = NULL;
-    for (size_t i = 0; i < ticket_list.size(); i++) {
-      if (ticket_list[i]->m_status == THREAD_PENDING) {
-        startCandidate = ticket_list[i];
-        break;
-      }
+SENCThreadStatus SENCThreadManager::ScheduleJob(SENCJobTicket *ticket) {
+  StartWorkers();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping) {
+      delete ticket;
+      return THREAD_INACTIVE;
+    }
+    if (m_tickets.empty()) {
+      m_stats = SENCBuildStats();
+      m_batch_start = std::chrono::steady_clock::now();
     }
 
-    // Found one?
-    if (startCandidate) {
-      // printf("Starting job:  %s\n", (const
-      // char*)startCandidate->m_FullPath000.mb_str());
-
-      SENCBuildThread *thread = new SENCBuildThread(startCandidate, this);
-      startCandidate->m_thread = thread;
-      startCandidate->m_status = THREAD_STARTED;
-      thread->SetPriority(20);
-      thread->Run();
-      nRunning++;
+    //  Do not add a job if there is already a job pending for this chart, by
+    //  name, but make sure it is built soon enough.
+    auto found = m_tickets.find(ticket->m_FullPath000);
+    if (found != m_tickets.end()) {
+      SENCJobTicket *queued = found->second;
+      if (!queued->m_chart && ticket->m_chart) {
+        // The new chart owns the .000 file from now on.
+        queued->m_chart = ticket->m_chart;
+        queued->m_remove_source = false;
+      }
+      if (queued->m_status == THREAD_PENDING &&
+          ticket->m_priority < queued->m_priority) {
+        queued->m_priority = ticket->m_priority;
+        m_queue.push({queued->m_priority, queued->m_seq, queued->m_FullPath000});
+        m_cv.notify_one();
+      }
+      delete ticket;
+      return THREAD_PENDING;
     }
-  }
 
-  if (nRunning) {
-    wxString count;
-    count.Printf("  %ld", ticket_list.size());
-    top_frame::Get()->SetAlertString(_("Preparing vector chart ") + count);
+    ticket->m_status = THREAD_PENDING;
+    ticket->m_seq = m_next_seq++;
+    m_tickets[ticket->m_FullPath000] = ticket;
+    m_queue.push({ticket->m_priority, ticket->m_seq, ticket->m_FullPath000});
+    m_stats.pending++;
   }
+  m_cv.notify_one();
+
+  UpdateAlert();
+  return THREAD_PENDING;
 }
 
-void SENCThreadManager::FinishJob(SENCJobTicket *ticket) {
-  // printf("Finishing job:  %s\n", (const
-  // char*)ticket->m_FullPath000.mb_str());
+SENCJobTicket *SENCThreadManager::PopJob() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_cv.wait(lock, [&] { return m_stopping || !m_queue.empty(); });
+    if (m_stopping) return nullptr;
+
+    QueueEntry entry = m_queue.top();
+    m_queue.pop();
+    // Skip entries of cancelled, started and reprioritized jobs.
+    auto found = m_tickets.find(entry.path);
+    if (found == m_tickets.end()) continue;
+    SENCJobTicket *ticket = found->second;
+    if (ticket->m_status != THREAD_PENDING) continue;
+    if (ticket->m_priority != entry.priority) continue;
+
+    ticket->m_status = THREAD_STARTED;
+    m_stats.pending--;
+    m_stats.running++;
+    return ticket;
+  }
+}
 
-  // Find and remove the ticket from the list
-  for (size_t i = 0; i < ticket_list.size(); i++) {
-    if (ticket_list[i] == ticket) {
-      // printf("   Removing job:  %s\n", (const
-      // char*)ticket->m_FullPath000.mb_str());
+void SENCThreadManager::JobDone(SENCJobTicket *ticket, bool ok) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ticket->m_status = THREAD_FINISHED;
+  m_stats.running--;
+  if (ok)
+    m_stats.done++;
+  else
+    m_stats.failed++;
+  if (ticket->m_remove_source && ::wxFileExists(ticket->m_FullPath000))
+    wxRemoveFile(ticket->m_FullPath000);
+}
 
-      ticket_list.erase(ticket_list.begin() + i);
-      // printf("Job count:  %d\n", ticket_list.size());
+bool SENCThreadManager::Cancel(SENCJobTicket *ticket) {
+  if (ticket->m_status != THREAD_PENDING || ticket->m_chart) return false;
+  // The queue entry is left in place, and skipped by PopJob().
+  m_tickets.erase(ticket->m_FullPath000);
+  if (ticket->m_remove_source && ::wxFileExists(ticket->m_FullPath000))
+    wxRemoveFile(ticket->m_FullPath000);
+  delete ticket;
+  m_stats.pending--;
+  m_stats.cancelled++;
+  return true;
+}
 
-      break;
-    }
+bool SENCThreadManager::CancelJob(const wxString &FullPath000) {
+  bool cancelled = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_tickets.find(FullPath000);
+    if (found != m_tickets.end()) cancelled = Cancel(found->second);
   }
+  if (cancelled) UpdateAlert();
+  return cancelled;
+}
 
-#if 1
-  int nRunning = 0;
-  for (size_t i = 0; i < ticket_list.size(); i++) {
-    if (ticket_list[i]->m_status == THREAD_STARTED) nRunning++;
+int SENCThreadManager::CancelPending(SENCJobPriority priority) {
+  int count = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<SENCJobTicket *> candidates;
+    for (auto &kv : m_tickets) {
+      if (kv.second->m_priority >= priority) candidates.push_back(kv.second);
+    }
+    for (auto ticket : candidates) {
+      if (Cancel(ticket)) count++;
+    }
   }
+  if (count) UpdateAlert();
+  return count;
+}
 
-  if (nRunning) {
-    wxString count;
-    count.Printf("  %ld", ticket_list.size());
-    top_frame::Get()->SetAlertString(_("Preparing vector chart ") + count);
+void SENCThreadManager::UpdateAlert() {
+  if (!top_frame::Get()) return;
+  int count = GetJobCount();
+  if (count) {
+    wxString msg;
+    msg.Printf("  %d", count);
+    top_frame::Get()->SetAlertString(_("Preparing vector chart ") + msg);
   } else {
     top_frame::Get()->SetAlertString("");
   }
-#endif
 }
 
-int SENCThreadManager::GetJobCount() { return ticket_list.size(); }
+void SENCThreadManager::FinishJob(SENCJobTicket *ticket) {
+  bool idle;
+  SENCBuildStats stats;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_tickets.find(ticket->m_FullPath000);
+    if (found != m_tickets.end() && found->second == ticket)
+      m_tickets.erase(found);
+    idle = m_tickets.empty();
+    stats = m_stats;
+  }
+  if (idle && stats.done + stats.failed > 1) {
+    stats.elapsed = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - m_batch_start)
+                        .count();
+    wxLogMessage(
+        "SENC: built %d cells, %d errors, %d cancelled in %.0f s, %.1f "
+        "cells/min",
+        stats.done, stats.failed, stats.cancelled, stats.elapsed,
+        stats.GetRate());
+  }
+  UpdateAlert();
+}
+
+int SENCThreadManager::GetJobCount() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_tickets.size();
+}
+
+SENCBuildStats SENCThreadManager::GetStats() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  SENCBuildStats stats = m_stats;
+  if (!m_tickets.empty() || stats.done + stats.failed > 0) {
+    stats.elapsed = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - m_batch_start)
+                        .count();
+  }
+  return stats;
+}
 
 bool SENCThreadManager::IsChartInTicketlist(s57chart *chart) {
-  for (size_t i = 0; i < ticket_list.size(); i++) {
-    if (ticket_list[i]->m_chart == chart) return true;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto &kv : m_tickets) {
+    if (kv.second->m_chart == chart) return true;
   }
   return false;
 }
 
 bool SENCThreadManager::SetChartPointer(s57chart *chart, void *new_ptr) {
   // Find the ticket
-  for (size_t i = 0; i < ticket_list.size(); i++) {
-    if (ticket_list[i]->m_chart == chart) {
-      ticket_list[i]->m_chart = (s57chart *)new_ptr;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto &kv : m_tickets) {
+    if (kv.second->m_chart == chart) {
+      kv.second->m_chart = (s57chart *)new_ptr;
       return true;
     }
   }
   return false;
 }
 
+bool SENCThreadManager::DetachChart(s57chart *chart, bool remove_source) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  bool found = false;
+  for (auto &kv : m_tickets) {
+    if (kv.second->m_chart == chart) {
+      kv.second->m_chart = nullptr;
+      kv.second->m_remove_source |= remove_source;
+      found = true;
+    }
+  }
+  return found;
+}
+
 #define NBAR_LENGTH 40
 
 void SENCThreadManager::OnEvtThread(OCPN_BUILDSENC_ThreadEvent &event) {
@@ -228,7 +362,6 @@ void SENCThreadManager::OnEvtThread(OCPN_BUILDSENC_ThreadEvent &event) {
       Sevent.type = SENC_BUILD_DONE_NOERROR;
       Sevent.m_ticket = event.m_ticket;
       FinishJob(event.m_ticket);
-      StartTopJob();
 
       break;
     case SENC_BUILD_DONE_ERROR:
@@ -236,7 +369,6 @@ void SENCThreadManager::OnEvtThread(OCPN_BUILDSENC_ThreadEvent &event) {
       Sevent.type = SENC_BUILD_DONE_ERROR;
       Sevent.m_ticket = event.m_ticket;
       FinishJob(event.m_ticket);
-      StartTopJob();
 
       break;
     default:
@@ -250,25 +382,28 @@ void SENCThreadManager::OnEvtThread(OCPN_BUILDSENC_ThreadEvent &event) {
 //      SENCBuildThread Implementation
 //----------------------------------------------------------------------------------
 
-SENCBuildThread::SENCBuildThread(SENCJobTicket *ticket,
-                                 SENCThreadManager *manager) {
-  m_FullPath000 = ticket->m_FullPath000;
-  m_SENCFileName = ticket->m_SENCFileName;
-  m_manager = manager;
-  m_ticket = ticket;
-
+SENCBuildThread::SENCBuildThread(SENCThreadManager *manager)
+    : wxThread(wxTHREAD_JOINABLE), m_manager(manager) {
   Create();
 }
 
 void *SENCBuildThread::Entry() {
+  while (SENCJobTicket *ticket = m_manager->PopJob()) Build(ticket);
+  return 0;
+}
+
+void SENCBuildThread::Build(SENCJobTicket *ticket) {
   // #ifdef __MSVC__
   //   _set_se_translator(my_translate);
 
   //  On Windows, if anything in this thread produces a SEH exception (like
-  //  access violation) we handle the exception locally, and simply alow the
-  //  thread to exit smoothly with no results. Upstream will notice that nothing
-  //  got done, and maybe try again later.
+  //  access violation) we handle the exception locally, and simply report
+  //  the job as failed. Upstream will notice that nothing got done, and
+  //  maybe try again later.
 
+  OCPN_BUILDSENC_ThreadEvent Nevent(wxEVT_OCPN_BUILDSENCTHREAD, 0);
+  Nevent.m_ticket = ticket;
+  Nevent.type = SENC_BUILD_DONE_ERROR;
   try
   // #endif
   {
@@ -276,51 +411,35 @@ void *SENCBuildThread::Entry() {
     Osenc senc;
 
     senc.setRegistrar(g_poRegistrar);
-    senc.setRefLocn(m_ticket->ref_lat, m_ticket->ref_lon);
-    senc.SetLODMeters(m_ticket->m_LOD_meters);
+    senc.setRefLocn(ticket->ref_lat, ticket->ref_lon);
+    senc.SetLODMeters(ticket->m_LOD_meters);
     senc.setNoErrDialog(true);
+    senc.setCancelFlag(&m_manager->GetCancelFlag());
 
-    m_ticket->m_SENCResult = SENC_BUILD_STARTED;
+    ticket->m_SENCResult = SENC_BUILD_STARTED;
     OCPN_BUILDSENC_ThreadEvent Sevent(wxEVT_OCPN_BUILDSENCTHREAD, 0);
     Sevent.stat = 0;
     Sevent.type = SENC_BUILD_STARTED;
-    Sevent.m_ticket = m_ticket;
-    if (m_manager) m_manager->QueueEvent(Sevent.Clone());
+    Sevent.m_ticket = ticket;
+    m_manager->QueueEvent(Sevent.Clone());
 
-    int ret = senc.createSenc200(m_FullPath000, m_SENCFileName, false);
+    int ret = senc.createSenc200(ticket->m_FullPath000, ticket->m_SENCFileName,
+                                 false);
 
-    OCPN_BUILDSENC_ThreadEvent Nevent(wxEVT_OCPN_BUILDSENCTHREAD, 0);
     Nevent.stat = ret;
-    Nevent.m_ticket = m_ticket;
-    if (ret == ERROR_INGESTING000)
-      Nevent.type = SENC_BUILD_DONE_ERROR;
-    else
+    bool cancelled = ret == ERROR_SENCFILE_ABORT && m_manager->GetCancelFlag();
+    if (ret != ERROR_INGESTING000 && !cancelled)
       Nevent.type = SENC_BUILD_DONE_NOERROR;
-
-    m_ticket->m_SENCResult = Sevent.type;
-    if (m_manager) m_manager->QueueEvent(Nevent.Clone());
-
-    // if(ret == ERROR_INGESTING000)
-    //  return BUILD_SENC_NOK_PERMANENT;
-    // else
-    //  return ret;
-
-    return 0;
   }  // try
 
   // #ifdef __MSVC__
   catch (const std::exception &e /*SE_Exception e*/) {
-    const char *msg = e.what();
-    if (m_manager) {
-      //             OCPN_CompressionThreadEvent
-      //             Nevent(wxEVT_OCPN_COMPRESSIONTHREAD, 0);
-      //             m_ticket->b_isaborted = true;
-      //             Nevent.SetTicket(m_ticket);
-      //             Nevent.type = 0;
-      //             m_manager->QueueEvent(Nevent.Clone());
-    }
-
-    return 0;
+    wxLogMessage("SENC: build of %s failed: %s", ticket->m_FullPath000,
+                 e.what());
   }
   // #endif
+
+  ticket->m_SENCResult = Nevent.type;
+  m_manager->JobDone(ticket, Nevent.type == SENC_BUILD_DONE_NOERROR);
+  m_manager->QueueEvent(Nevent.Clone());
 }
@@ -571,9 +571,14 @@ void TCWin::PaintChart(wxDC &dc, const wxRect &chartRect) {
     ptcmgr->GetTideFlowSens(tt_localtz, BACKWARD_TEN_MINUTES_STEP,
                             pIDX->IDX_rec_num, tcv[0], val, wt);
 
+    std::vector<float> values;
+    std::vector<float> dirs;
+    ptcmgr->GetTideOrCurrentSeries(tt_localtz, FORWARD_ONE_HOUR_STEP, 26,
+                                   pIDX->IDX_rec_num, values, dirs);
     for (i = 0; i < 26; i++) {
       int tt = tt_localtz + (i * FORWARD_ONE_HOUR_STEP);
-      ptcmgr->GetTideOrCurrent(tt, pIDX->IDX_rec_num, tcv[i], dir);
+      tcv[i] = values[i];
+      dir = dirs[i];
       tt_tcv[i] = tt;  // store the corresponding time_t value
 
       // Convert tide values from station units to user's height units
@@ -31,6 +31,8 @@
 #include <math.h>
 #include <time.h>
 
+#include <algorithm>
+
 #include "model/georef.h"
 #include "model/logger.h"
 
@@ -614,14 +616,19 @@ time_t tm2gmt(struct tm *ht) {
 
 static int yearoftimet(time_t t) { return ((gmtime(&t))->tm_year) + 1900; }
 
-/* Calculate time_t of the epoch. */
-static void set_epoch(IDX_entry *pIDX, int year) {
+/* Calculate time_t of new year. */
+static time_t year_epoch(int year) {
   struct tm ht;
 
   ht.tm_year = year - 1900;
   ht.tm_sec = ht.tm_min = ht.tm_hour = ht.tm_mon = 0;
   ht.tm_mday = 1;
-  pIDX->epoch = tm2gmt(&ht);
+  return tm2gmt(&ht);
+}
+
+/* Calculate time_t of the epoch. */
+static void set_epoch(IDX_entry *pIDX, int year) {
+  pIDX->epoch = year_epoch(year);
 }
 
 /* Re-initialize for a different year */
@@ -631,13 +638,60 @@ static void happy_new_year(IDX_entry *pIDX, int new_year) {
   set_epoch(pIDX, new_year);
 }
 
+/* Normalized tide at count times dt, dt + step, ... seconds after the
+ * epoch, as computed by _time2dt_tide(t, 0) for the current epoch_year.
+ *
+ * Each constituent's phase is advanced by rotating its (cos, sin) pair
+ * instead of calling cos() per time. The loops over the constituents have
+ * no dependencies between iterations and are vectorized by the compiler.
+ * Phases are recomputed every kReseed times to bound rounding drift. */
+static void sum_harmonics(IDX_entry *pIDX, time_t dt, int step, int count,
+                          double *out) {
+  const int kReseed = 256;
+  int n = pIDX->num_csts;
+  int year_index = pIDX->epoch_year - pIDX->first_year;
+  std::vector<double> c(n), s(n), cd(n), sd(n);
+  const double *amp = pIDX->m_work_buffer;
+
+  for (int k0 = 0; k0 < count; k0 += kReseed) {
+    double t =
+        (double)(dt + (time_t)k0 * step) + pIDX->pref_sta_data->meridian;
+    for (int a = 0; a < n; a++) {
+      double speed = pIDX->m_cst_speeds[a];
+      double phase = speed * t + pIDX->m_cst_epochs[a][year_index] -
+                     pIDX->pref_sta_data->epoch[a];
+      c[a] = cos(phase);
+      s[a] = sin(phase);
+      cd[a] = cos(speed * step);
+      sd[a] = sin(speed * step);
+    }
+    int k_end = std::min(count, k0 + kReseed);
+    for (int k = k0; k < k_end; k++) {
+      double sum = 0.0;
+      for (int a = 0; a < n; a++) sum += amp[a] * c[a];
+      out[k] = sum;
+      for (int a = 0; a < n; a++) {
+        double cn = c[a] * cd[a] - s[a] * sd[a];
+        s[a] = s[a] * cd[a] + c[a] * sd[a];
+        c[a] = cn;
+      }
+    }
+  }
+}
+
 //      TCMgr Implementation
 TCMgr::TCMgr() {}
 
 TCMgr::~TCMgr() { PurgeData(); }
 
 void TCMgr::PurgeData() {
+  //  Stop the series worker before the data it uses goes away
+  m_series_cache.reset();
   m_Combined_IDX_array.clear();
+  m_tide_index.Clear();
+  m_current_index.Clear();
+  m_tide_ids.clear();
+  m_current_ids.clear();
 
   //  Delete all the data sources
   m_source_array.Clear();
@@ -687,9 +741,70 @@ TC_Error_Code TCMgr::LoadDataSources(std::vector<std::string> &sources) {
         _("OpenCPN Info"), wxOK | wxCENTER);
 
   ScrubCurrentDepths();
+  BuildStationIndex();
+  SetSeriesWindow(m_series_span, m_series_step);
   return TC_NO_ERROR;
 }
 
+void TCMgr::SetSeriesWindow(int span, int step) {
+  m_series_cache.reset();
+  m_series_span = span;
+  m_series_step = step;
+  auto evaluate = [this](time_t t0, int step, int count, int idx,
+                         std::vector<float> &values) {
+    std::vector<float> dirs;
+    return GetTideOrCurrentSeries(t0, step, count, idx, values, dirs);
+  };
+  m_series_cache = std::make_unique<TideSeriesCache>(evaluate, span, step);
+}
+
+void TCMgr::SetTimeSource(time_t t) {
+  if (m_series_cache) m_series_cache->SetCentre(t);
+}
+
+bool TCMgr::GetCachedLevel(time_t t, int idx, float &value) {
+  if (!m_series_cache) return false;
+  //  Load harmonics here rather than in the cache worker: IDX_entry data
+  //  like pref_sta_data is read without locking all over the place.
+  IDX_entry *pIDX = m_Combined_IDX_array[idx];
+  if (!pIDX || !pIDX->IDX_Useable) return false;
+  if (pIDX->pDataSource) {
+    if (pIDX->pDataSource->LoadHarmonicData(pIDX) != TC_NO_ERROR) return false;
+  }
+  return m_series_cache->Get(idx, t, value);
+}
+
+bool TCMgr::GetTideOrCurrentCached(time_t t, int idx, float &tcvalue,
+                                   float &dir) {
+  if (!GetCachedLevel(t, idx, tcvalue))
+    return GetTideOrCurrent(t, idx, tcvalue, dir);
+  const IDX_entry *pIDX = m_Combined_IDX_array[idx];
+  dir = tcvalue >= 0 ? pIDX->IDX_flood_dir : pIDX->IDX_ebb_dir;
+  return true;
+}
+
+void TCMgr::BuildStationIndex() {
+  std::vector<PackedRTree::Box> tides;
+  std::vector<PackedRTree::Box> currents;
+  m_tide_ids.clear();
+  m_current_ids.clear();
+  for (int i = 1; i < Get_max_IDX() + 1; i++) {
+    const IDX_entry *pIDX = GetIDX_entry(i);
+    float lat = pIDX->IDX_lat;
+    float lon = pIDX->IDX_lon;
+    char type = pIDX->IDX_type;
+    if (type == 't' || type == 'T') {
+      tides.push_back({lon, lat, lon, lat});
+      m_tide_ids.push_back(i);
+    } else if (type == 'c' || type == 'C') {
+      currents.push_back({lon, lat, lon, lat});
+      m_current_ids.push_back(i);
+    }
+  }
+  m_tide_index.Build(tides);
+  m_current_index.Build(currents);
+}
+
 void TCMgr::ScrubCurrentDepths() {
   //  Process Current stations reporting values at multiple depths
   //  Identify and mark the shallowest record, as being most usable to OCPN
@@ -744,6 +859,7 @@ const IDX_entry *TCMgr::GetIDX_entry(int index) const {
 }
 
 bool TCMgr::GetTideOrCurrent(time_t t, int idx, float &tcvalue, float &dir) {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   //    Return a sensible value of 0,0 by default
   dir = 0;
   tcvalue = 0;
@@ -806,10 +922,72 @@ bool TCMgr::GetTideOrCurrentMeters(time_t t, int idx, float &tcvalue,
     return false;
 }
 
+bool TCMgr::GetTideOrCurrentSeries(time_t t0, int step, int count, int idx,
+                                   std::vector<float> &values,
+                                   std::vector<float> &dirs) {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
+  values.assign(count, 0);
+  dirs.assign(count, 0);
+
+  IDX_entry *pIDX = m_Combined_IDX_array[idx];  // point to the index entry
+  if (!pIDX || !pIDX->IDX_Useable) return false;
+  if (pIDX->pDataSource) {
+    if (pIDX->pDataSource->LoadHarmonicData(pIDX) != TC_NO_ERROR) return false;
+  }
+
+  //  Secondary stations need the stateful time2asecondary() interpolation
+  if (pIDX->have_offsets || step <= 0) {
+    for (int i = 0; i < count; i++) {
+      if (!GetTideOrCurrent(t0 + (time_t)i * step, idx, values[i], dirs[i]))
+        return false;
+    }
+    return true;
+  }
+
+  std::vector<double> sums;
+  int i = 0;
+  while (i < count) {
+    time_t t = t0 + (time_t)i * step;
+    time_t tadj = t + pIDX->station_tz_offset;
+    int year = yearoftimet(tadj);
+    time_t this_epoch = year_epoch(year);
+    time_t next_epoch = year_epoch(year + 1);
+
+    //  Times close to new year are blended by time2dt_tide()
+    if (year < pIDX->first_year ||
+        year >= pIDX->first_year + pIDX->num_epochs ||
+        tadj - this_epoch <= TIDE_BLEND_TIME ||
+        next_epoch - tadj <= TIDE_BLEND_TIME) {
+      if (!GetTideOrCurrent(t, idx, values[i], dirs[i])) return false;
+      i++;
+      continue;
+    }
+
+    int n = 1;
+    while (i + n < count &&
+           next_epoch - (tadj + (time_t)n * step) > TIDE_BLEND_TIME)
+      n++;
+
+    pIDX->max_amplitude = 0.0;  // Force multiplier re-compute
+    happy_new_year(pIDX, year);
+    sums.resize(n);
+    sum_harmonics(pIDX, tadj - pIDX->epoch, step, n, sums.data());
+    for (int k = 0; k < n; k++) {
+      double level =
+          BOGUS_amplitude(sums[k], pIDX) + pIDX->pref_sta_data->DATUM;
+      values[i + k] = level;
+      dirs[i + k] = level >= 0 ? pIDX->IDX_flood_dir : pIDX->IDX_ebb_dir;
+    }
+    i += n;
+  }
+  return true;
+}
+
 extern wxDateTime gTimeSource;
 
 bool TCMgr::GetTideOrCurrent15(time_t t_d, int idx, float &tcvalue, float &dir,
                                bool &bnew_val) {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   int ret;
   IDX_entry *pIDX = m_Combined_IDX_array[idx];  // point to the index entry
 
@@ -851,7 +1029,7 @@ bool TCMgr::GetTideOrCurrent15(time_t t_d, int idx, float &tcvalue, float &dir,
       return pIDX->Ret15;
     } else {
       int tref = t_today_00_at_station + t_15s * 15 * 60;
-      ret = GetTideOrCurrent(tref, idx, tcvalue, dir);
+      ret = GetTideOrCurrentCached(tref, idx, tcvalue, dir);
 
       pIDX->Valid15 = tref;
       pIDX->Value15 = tcvalue;
@@ -865,7 +1043,7 @@ bool TCMgr::GetTideOrCurrent15(time_t t_d, int idx, float &tcvalue, float &dir,
 
   else {
     int tref = t_today_00_at_station + t_15s * 15 * 60;
-    ret = GetTideOrCurrent(tref, idx, tcvalue, dir);
+    ret = GetTideOrCurrentCached(tref, idx, tcvalue, dir);
 
     pIDX->Valid15 = tref;
     pIDX->Value15 = tcvalue;
@@ -879,6 +1057,7 @@ bool TCMgr::GetTideOrCurrent15(time_t t_d, int idx, float &tcvalue, float &dir,
 
 bool TCMgr::GetTideFlowSens(time_t t, int sch_step, int idx, float &tcvalue_now,
                             float &tcvalue_prev, bool &w_t) {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   //    Return a sensible value of 0 by default
   tcvalue_now = 0;
   tcvalue_prev = 0;
@@ -901,8 +1080,11 @@ bool TCMgr::GetTideFlowSens(time_t t, int sch_step, int idx, float &tcvalue_now,
 
   //    Finally, process the tide flow sens
 
-  tcvalue_now = time2asecondary(t, pIDX);
-  tcvalue_prev = time2asecondary(t + sch_step, pIDX);
+  if (!GetCachedLevel(t, idx, tcvalue_now) ||
+      !GetCachedLevel(t + sch_step, idx, tcvalue_prev)) {
+    tcvalue_now = time2asecondary(t, pIDX);
+    tcvalue_prev = time2asecondary(t + sch_step, pIDX);
+  }
 
   w_t =
       tcvalue_now > tcvalue_prev;  // w_t = true --> flood , w_t = false --> ebb
@@ -913,6 +1095,7 @@ bool TCMgr::GetTideFlowSens(time_t t, int sch_step, int idx, float &tcvalue_now,
 void TCMgr::GetHightOrLowTide(time_t t, int sch_step_1, int sch_step_2,
                               float tide_val, bool w_t, int idx, float &tcvalue,
                               time_t &tctime) {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   //    Return a sensible value of 0,0 by default
   tcvalue = 0;
   tctime = t;
@@ -950,11 +1133,25 @@ void TCMgr::GetHightOrLowTide(time_t t, int sch_step_1, int sch_step_2,
   int j = 0;
   int k = 0;
   int ttt = 0;
+  bool approximate = false;
   while ((newval > oldval) == w_t)  // searching each ten minute
   {
     j++;
     oldval = newval;
     ttt = t + (sch_step_1 * j);
+    float cached;
+    if (GetCachedLevel(ttt, idx, cached)) {
+      newval = cached;
+      approximate = true;
+    } else {
+      newval = time2asecondary(ttt, pIDX);
+    }
+  }
+  //  Interpolated values may find the turn a step early or late, search
+  //  back from one step further using exact values.
+  if (approximate) {
+    j++;
+    ttt = t + (sch_step_1 * j);
     newval = time2asecondary(ttt, pIDX);
   }
   oldval = (w_t) ? newval - 1 : newval + 1;
@@ -986,11 +1183,28 @@ double TCMgr::GetStationLat(IDX_entry *pIDX) { return pIDX->IDX_lat; }
 double TCMgr::GetStationLon(IDX_entry *pIDX) { return pIDX->IDX_lon; }
 
 int TCMgr::GetNextBigEvent(time_t *tm, int idx) {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   float tcvalue[1];
   float dir;
   bool ret;
   double p, q;
   int flags = 0, slope = 0;
+
+  //  Skip ahead while the precomputed samples are monotonic, leaving the
+  //  exact search below to find the event close to the first turn.
+  if (m_series_cache) {
+    const int step = m_series_cache->GetStep();
+    float a, b, c;
+    time_t t = *tm;
+    if (GetCachedLevel(t, idx, a) && GetCachedLevel(t + step, idx, b)) {
+      while (GetCachedLevel(t + 2 * step, idx, c) && (b - a) * (c - b) > 0) {
+        t += step;
+        a = b;
+        b = c;
+      }
+      *tm = std::max(*tm, t - step);
+    }
+  }
   ret = GetTideOrCurrent(*tm, idx, tcvalue[0], dir);
   p = tcvalue[0];
   *tm += 60;
@@ -1041,27 +1255,70 @@ std::wstring TCMgr::GetTidalEventStr(int station_id, wxDateTime ref_dt,
   return event_str;
 }
 
-std::map<double, const IDX_entry *> TCMgr::GetStationsForLL(double xlat,
-                                                            double xlon) const {
+std::map<double, const IDX_entry *> TCMgr::GetStationsForLL(
+    double xlat, double xlon, size_t max_count) const {
   std::map<double, const IDX_entry *> x;
-  const IDX_entry *lpIDX;
-
-  for (int j = 1; j < Get_max_IDX() + 1; j++) {
-    lpIDX = GetIDX_entry(j);
-    char type = lpIDX->IDX_type;
-    wxString locnx(lpIDX->IDX_station_name, wxConvUTF8);
 
-    if (type == 't' || type == 'T') {
-      double brg, dist;
-      DistanceBearingMercator(xlat, xlon, lpIDX->IDX_lat, lpIDX->IDX_lon, &brg,
-                              &dist);
-      x.emplace(std::make_pair(dist, lpIDX));
-    }
-  }
+  //  Lower bound of the distance in degrees, exact for boxes which are
+  //  points. Uses the smallest longitude scale within the box and handles
+  //  the antimeridian.
+  auto distance = [xlat, xlon](const PackedRTree::Box &b) {
+    double dlat = std::max({b.y_min - xlat, 0.0, xlat - b.y_max});
+    double dlon = 180.;
+    for (double lon : {xlon - 360., xlon, xlon + 360.})
+      dlon = std::min(dlon, std::max({b.x_min - lon, 0.0, lon - b.x_max}));
+    double max_lat = std::max({fabs(xlat), fabs(b.y_min), fabs(b.y_max)});
+    double scale = cos(std::min(max_lat, 89.0) * M_PI / 180.);
+    return sqrt(dlat * dlat + dlon * dlon * scale * scale);
+  };
+
+  //  The index orders by an approximation of the Mercator distance, fetch
+  //  some extra stations to settle the order of the last ones.
+  size_t fetch = max_count;
+  if (fetch < m_tide_ids.size() / 2) fetch = std::max(2 * fetch, fetch + 8);
+  std::vector<uint32_t> items;
+  m_tide_index.Nearest(fetch, distance, items);
+
+  for (uint32_t item : items) {
+    const IDX_entry *lpIDX = GetIDX_entry(m_tide_ids[item]);
+    double brg, dist;
+    DistanceBearingMercator(xlat, xlon, lpIDX->IDX_lat, lpIDX->IDX_lon, &brg,
+                            &dist);
+    x.emplace(std::make_pair(dist, lpIDX));
+  }
+  while (x.size() > max_count) x.erase(std::prev(x.end()));
 
   return x;
 }
 
+std::vector<int> TCMgr::GetStationsInBBox(const LLBBox &box, char type,
+                                          double margin) const {
+  const bool tide = (type == 't' || type == 'T');
+  const PackedRTree &index = tide ? m_tide_index : m_current_index;
+  const std::vector<int> &ids = tide ? m_tide_ids : m_current_ids;
+
+  //  Query the box and its copies shifted across the antimeridian, the
+  //  exact test is done by LLBBox.
+  std::vector<uint32_t> items;
+  for (double shift : {-360., 0., 360.}) {
+    index.Search({float(box.GetMinLon() - margin + shift),
+                  float(box.GetMinLat() - margin),
+                  float(box.GetMaxLon() + margin + shift),
+                  float(box.GetMaxLat() + margin)},
+                 items);
+  }
+
+  std::vector<int> result;
+  for (uint32_t item : items) {
+    const IDX_entry *pIDX = GetIDX_entry(ids[item]);
+    if (box.ContainsMarge(pIDX->IDX_lat, pIDX->IDX_lon, margin))
+      result.push_back(ids[item]);
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
 int TCMgr::GetStationIDXbyName(const wxString &prefix, double xlat,
                                double xlon) const {
   const IDX_entry *lpIDX;
@@ -34,6 +34,7 @@
 #include "model/gui_vars.h"
 #include "model/own_ship.h"
 #include "model/routeman.h"
+#include "model/track_page_cache.h"
 
 #include "color_handler.h"
 #include "gl_chart_canvas.h"
@@ -117,10 +118,23 @@ void TrackGui::Finalize() {
 void TrackGui::GetPointLists(ChartCanvas *cc,
                              std::list<std::list<wxPoint> > &pointlists,
                              ViewPort &VP, const LLBBox &box) {
-  if (!m_track.IsVisible() || m_track.GetnPoints() == 0) return;
-  Finalize();
-  //    OCPNStopWatch sw;
-  Segments(cc, pointlists, box, VP.view_scale_ppm);
+  if (!m_track.IsVisible()) return;
+  // Do not page in tracks outside the view.
+  if (m_track.IsPageable() && box.IntersectOut(m_track.GetExtent())) return;
+
+  // Long tracks at small scales are drawn using the simplified pyramid,
+  // with an error below one pixel. This also avoids paging in points.
+  const TrackLod *lod = m_track.GetLod();
+  int level = lod ? lod->SelectLevel(1 / VP.view_scale_ppm) : -1;
+  if (level >= 0) {
+    AssembleLod(cc, pointlists, box, *lod, level);
+  } else {
+    if (m_track.IsPageable()) TrackPageCache::GetInstance().Touch(&m_track);
+    if (m_track.GetnPoints() == 0) return;
+    Finalize();
+    //    OCPNStopWatch sw;
+    Segments(cc, pointlists, box, VP.view_scale_ppm);
+  }
 #if 0
     if(GetnPoints() > 40000) {
         double t = sw.GetTime();
@@ -276,6 +290,22 @@ void TrackGui::Assemble(ChartCanvas *cc,
   }
 }
 
+void TrackGui::AssembleLod(ChartCanvas *cc,
+                           std::list<std::list<wxPoint> > &pointlists,
+                           const LLBBox &box, const TrackLod &lod, int level) {
+  auto visible = [&box](const TrackLod::Extent &e) {
+    LLBBox extent;
+    extent.Set(e.lat_min, e.lon_min, e.lat_max, e.lon_max);
+    return !box.IntersectOut(extent);
+  };
+  lod.Visit(level, visible, [&](const TrackLod::Point &p, bool first) {
+    if (first) pointlists.push_back(std::list<wxPoint>());
+    wxPoint r(INVALID_COORD, INVALID_COORD);
+    cc->GetCanvasPointPix(p.lat, p.lon, &r);
+    AddPixelToList(pointlists, r);
+  });
+}
+
 void TrackGui::AddPointToList(ChartCanvas *cc,
                               std::list<std::list<wxPoint> > &pointlists,
                               int n) {
@@ -283,7 +313,11 @@ void TrackGui::AddPointToList(ChartCanvas *cc,
   if ((size_t)n < m_track.TrackPoints.size())
     cc->GetCanvasPointPix(m_track.TrackPoints[n]->m_lat,
                           m_track.TrackPoints[n]->m_lon, &r);
+  AddPixelToList(pointlists, r);
+}
 
+void TrackGui::AddPixelToList(std::list<std::list<wxPoint> > &pointlists,
+                              const wxPoint &r) {
   std::list<wxPoint> &pointlist = pointlists.back();
   if (r.x == INVALID_COORD) {
     if (pointlist.size()) {
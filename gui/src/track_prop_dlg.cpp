@@ -36,6 +36,7 @@
 #include "model/routeman.h"
 #include "model/select.h"
 #include "model/track.h"
+#include "model/track_page_cache.h"
 
 #include "chcanv.h"
 #include "displays.h"
@@ -1035,7 +1036,11 @@ void TrackPropDlg::CreateControls() {
 }
 
 void TrackPropDlg::SetTrackAndUpdate(Track* pt) {
+  // Keep points of the shown track loaded.
+  auto& page_cache = TrackPageCache::GetInstance();
+  if (m_pTrack) page_cache.SetPinned(m_pTrack, false);
   m_pTrack = pt;
+  page_cache.SetPinned(m_pTrack, true);
 
   m_lcPoints->DeleteAllItems();
 
@@ -1751,6 +1756,7 @@ void TrackPropDlg::OnOKBtnClick(wxCommandEvent& event) {
     SaveChanges();  // write changes to globals and update config
     m_pTrack->ClearHighlights();
   }
+  TrackPageCache::GetInstance().SetPinned(m_pTrack, false);
 
   m_bStartNow = false;
 
@@ -1769,6 +1775,7 @@ void TrackPropDlg::OnCancelBtnClick(wxCommandEvent& event) {
                                  m_pTrack) != g_TrackList.end();
 
   if (b_found_track) m_pTrack->ClearHighlights();
+  TrackPageCache::GetInstance().SetPinned(m_pTrack, false);
 
   Hide();
   top_frame::Get()->InvalidateAllGL();
@@ -97,8 +97,8 @@ void doUndoMoveWaypoint(UndoAction* action, ChartCanvas* cc) {
   lastPoint->y = lat;
   lastPoint->x = lon;
   SelectItem* selectable = (SelectItem*)action->selectable[0];
-  selectable->m_slat = currentPoint->m_lat;
-  selectable->m_slon = currentPoint->m_lon;
+  pSelect->ModifySelectableItem(selectable, currentPoint->m_lat,
+                                currentPoint->m_lon);
 
   if ((NULL != g_pMarkInfoDialog) && (g_pMarkInfoDialog->IsShown())) {
     if (currentPoint == g_pMarkInfoDialog->GetRoutePoint())
@@ -35,7 +35,7 @@
 #include <vector>
 #include <list>
 
-#define CURRENT_SENC_FORMAT_VERSION 201
+#define CURRENT_SENC_FORMAT_VERSION 300
 
 #define OBJL_NAME_LEN 6
 
@@ -24,11 +24,24 @@
 #ifndef AIS_BITSTRING_H_
 #define AIS_BITSTRING_H_
 
+#include <cstddef>
+
 #define AIS_MAX_MESSAGE_LEN \
   (10 * 82)  // AIS Spec allows up to 9 sentences per message, 82 bytes each
+
+/**
+ * The 6-bit armoured payload of an AIS message, bit addressable.
+ *
+ * Construction de-armours the payload using a lookup table into a fixed
+ * buffer and thus never allocates. Bits beyond the payload read as zero.
+ */
 class AisBitstring {
 public:
   AisBitstring(const char *str);
+
+  /** Create bitstring from a payload which does not need to be 0-terminated. */
+  AisBitstring(const char *str, size_t len);
+
   unsigned char to_6bit(const char c);
 
   /// sp is starting bit, 1-based
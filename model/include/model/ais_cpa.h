@@ -0,0 +1,139 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * AIS target CPA/TCPA computation, single and batched.
+ */
+
+#ifndef AIS_CPA_H_
+#define AIS_CPA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class WorkerPool;
+
+/** Own ship state used when computing CPA. */
+struct CpaOwnShip {
+  double lat;
+  double lon;
+  double cog;
+  double sog;
+  bool valid;  ///< Position is valid, see bGPSValid
+};
+
+/** Target kinematics flags. */
+enum CpaFlags : uint8_t {
+  kCpaPositionValid = 1,  ///< Target has had a valid position
+  kCpaMeteo = 2,          ///< Meteo station, never a collision hazard
+  kCpaOwnShip = 4,        ///< Own ship reported over VDO
+};
+
+/** Result of ComputeCpa(). */
+struct CpaResult {
+  double range_nm = -1;
+  double brg = -1;
+  double cpa = 0;
+  double tcpa = 0;       ///< Minutes
+  bool has_cpa = false;  ///< cpa and tcpa are set, else left unchanged
+  bool valid = false;    ///< bCPA_Valid
+  bool exact = false;    ///< Target within reach, CPA is exact
+};
+
+/**
+ * Limits outside of which a target cannot raise a CPA alarm. Such targets
+ * get a cheaper CPA computed on the same plane sheet as TCPA instead of
+ * using great circle positions at TCPA. The default reach covers all
+ * targets.
+ */
+struct CpaReach {
+  static constexpr double kNone = std::numeric_limits<double>::infinity();
+
+  double warn_nm = 0;           ///< CPA alarm distance
+  double range_max_nm = kNone;  ///< Targets further away never alarm
+  double tcpa_max_h = kNone;    ///< Targets with larger TCPA never alarm
+
+  /** Return true if target at range with given speeds might alarm. */
+  bool Contains(double range_nm, double own_sog, double sog) const;
+};
+
+/** Compute range, bearing, CPA and TCPA of a target. */
+void ComputeCpa(const CpaOwnShip& own, double lat, double lon, double cog,
+                double sog, uint8_t flags, const CpaReach& reach,
+                CpaResult& result);
+
+/** Timing and pruning figures of AisDecoder::UpdateAllCPA(). */
+struct CpaStats {
+  size_t targets = 0;
+  size_t exact = 0;        ///< Targets within reach
+  double snapshot_ms = 0;  ///< Copying target data into the batch
+  double compute_ms = 0;
+  double commit_ms = 0;  ///< Copying results back to the targets
+};
+
+/**
+ * Struct of arrays snapshot of target kinematics and the computed
+ * results. Memory is kept between runs.
+ */
+class AisCpaBatch {
+public:
+  void Clear();
+
+  /** Add a target, returning its index. */
+  size_t Add(double lat, double lon, double cog, double sog, uint8_t flags);
+
+  size_t Size() const { return m_lat.size(); }
+
+  /**
+   * Run ComputeCpa() on all targets, in parallel using given pool. Runs
+   * in the calling thread if pool is nullptr or there are few targets.
+   * Must not be called from a job running in the pool.
+   */
+  void Compute(const CpaOwnShip& own, const CpaReach& reach,
+               WorkerPool* pool);
+
+  /** Return result for target at index. */
+  CpaResult GetResult(size_t index) const;
+
+  /** Return number of targets within reach in last Compute(). */
+  size_t GetExactCount() const;
+
+private:
+  /** Below this number of targets threads are not worth it. */
+  static const size_t kMinParallel = 256;
+
+  void ComputeRange(const CpaOwnShip& own, const CpaReach& reach,
+                    size_t begin, size_t end);
+
+  std::vector<double> m_lat;
+  std::vector<double> m_lon;
+  std::vector<double> m_cog;
+  std::vector<double> m_sog;
+  std::vector<uint8_t> m_flags;
+
+  std::vector<double> m_range;
+  std::vector<double> m_brg;
+  std::vector<double> m_cpa;
+  std::vector<double> m_tcpa;
+  std::vector<uint8_t> m_state;  ///< Result flags, see ais_cpa.cpp
+};
+
+#endif  // AIS_CPA_H_
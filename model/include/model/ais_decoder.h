@@ -27,6 +27,7 @@
 #include <map>
 #include <unordered_map>
 #include <memory>
+#include <string_view>
 #include <vector>
 
 #include <wx/datetime.h>
@@ -35,8 +36,10 @@
 
 #include "rapidjson/fwd.h"
 #include "model/ais_bitstring.h"
+#include "model/ais_cpa.h"
 #include "model/ais_defs.h"
 #include "model/ais_target_data.h"
+#include "model/ais_vdm.h"
 #include "model/comm_navmsg.h"
 #include "model/ocpn_types.h"
 #include "model/select.h"
@@ -113,6 +116,15 @@ public:
   ~AisDecoder() override;
 
   AisError DecodeN0183(const wxString &str);
+
+  /**
+   * Decode a VDM or VDO sentence. Gives the same result as DecodeN0183()
+   * but parses the sentence in place and reassembles multi-sentence
+   * messages in fixed buffers keyed by sequence id and channel, so no
+   * memory is allocated besides what updating the target needs.
+   */
+  AisError DecodeVdm(std::string_view sentence);
+
   std::unordered_map<int, std::shared_ptr<AisTargetData>> &GetTargetList() {
     return AISTargetList;
   }
@@ -122,6 +134,10 @@ public:
   }
   std::shared_ptr<AisTargetData> Get_Target_Data_From_MMSI(unsigned mmsi);
   int GetNumTargets() const { return m_n_targets; }
+
+  /** Return timing and pruning figures of last CPA update of all targets. */
+  const CpaStats &GetCpaStats() const { return m_cpa_stats; }
+
   bool IsAISSuppressed() const { return m_bSuppressed; }
   bool IsAISAlertGeneral() const { return m_bGeneralAlert; }
   void UpdateMMSItoNameFile(const wxString &mmsi, const wxString &name);
@@ -174,6 +190,20 @@ private:
   void updateItem(const std::shared_ptr<AisTargetData> &pTargetData,
                   bool bnewtarget, const rapidjson::Value &item,
                   wxString &sfixtime) const;
+  /**
+   * Find or create the target of a decoded message, shared by
+   * DecodeN0183() and DecodeVdm(). Remaps meteo station MMSIs and applies
+   * the MMSI properties, forwarding VDM own ship reports as VDO.
+   * @param sentence Complete sentence, for the VDO translation.
+   * @param mmsi Message MMSI, updated for meteo stations.
+   * @return false if the message is not to be decoded further, result
+   *   then being the value to return.
+   */
+  bool PrepareAisTarget(AisBitstring &strbit, std::string_view sentence,
+                        unsigned &mmsi,
+                        std::shared_ptr<AisTargetData> &pTargetData,
+                        std::shared_ptr<AisTargetData> &pStaleTarget,
+                        bool &bnewtarget, AisError &result);
   void CommitAISTarget(const std::shared_ptr<AisTargetData> &pTargetData,
                        const wxString &str, bool message_valid,
                        bool new_target);
@@ -196,7 +226,7 @@ private:
   AIS_Target_Name_Hash *AISTargetNamesC;
   AIS_Target_Name_Hash *AISTargetNamesNC;
 
-  ObservableListener listener_N0183_VDM;
+  int m_vdm_listener;  ///< NavMsgBus batch listener handle for VDM
   ObservableListener listener_N0183_FRPOS;
   ObservableListener listener_N0183_CDDSC;
   ObservableListener listener_N0183_CDDSE;
@@ -222,6 +252,10 @@ private:
   int nsentences;
   int isentence;
   wxString sentence_accumulator;
+  AisVdmAssembler m_vdm_assembler;
+  AisCpaBatch m_cpa_batch;
+  std::vector<AisTargetData *> m_cpa_targets;  ///< Indexed as m_cpa_batch
+  CpaStats m_cpa_stats;
   bool m_OK;
 
   std::shared_ptr<AisTargetData> m_pLatestTargetData;
@@ -0,0 +1,87 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Allocation free parsing and reassembly of AIS VDM/VDO sentences.
+ */
+
+#ifndef AIS_VDM_H_
+#define AIS_VDM_H_
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#include "model/ais_bitstring.h"
+
+/** Fields of a !xxVDM or !xxVDO sentence, views into the sentence. */
+struct AisVdmSentence {
+  int count = 0;             ///< Number of sentences in message
+  int index = 0;             ///< 1-based sentence number
+  int sequence_id = -1;      ///< Multi-sentence message id 0-9, -1 if missing
+  char channel = 0;          ///< Radio channel 'A' or 'B', 0 if missing
+  bool own_ship = false;     ///< VDO sentence
+  std::string_view payload;  ///< 6-bit armoured data
+};
+
+/**
+ * Verify the *hh checksum of a NMEA0183 sentence. Sentences without
+ * checksum are rejected.
+ */
+bool VdmChecksumOk(std::string_view sentence);
+
+/**
+ * Split a VDM or VDO sentence into fields. Missing fields are left at
+ * their defaults, no checksum or length checks are done.
+ * @return false unless sentence is a VDM or VDO sentence.
+ */
+bool ParseVdmSentence(std::string_view sentence, AisVdmSentence& vdm);
+
+/**
+ * Reassembles multi-sentence messages using fixed buffers, one for each
+ * sequence id and channel so interleaved messages are handled. Parts
+ * received out of order drop the message.
+ */
+class AisVdmAssembler {
+public:
+  /**
+   * Add a sentence.
+   * @return Complete payload, valid until next Add() for the same sequence
+   *   id and channel, or an empty view if message is incomplete or broken.
+   */
+  std::string_view Add(const AisVdmSentence& vdm);
+
+  /** Drop all partial messages. */
+  void Clear();
+
+private:
+  struct Part {
+    int count = 0;
+    int next = 0;  ///< Next expected sentence, 0 when idle
+    size_t length = 0;
+    char data[AIS_MAX_MESSAGE_LEN];
+  };
+
+  /** Sequence ids 0-9 and missing, times channel A, B and other. */
+  static const size_t kParts = 11 * 3;
+
+  std::array<Part, kParts> m_parts;
+};
+
+#endif  // AIS_VDM_H_
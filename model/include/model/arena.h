@@ -0,0 +1,80 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Bump allocator for objects sharing a common lifetime.
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Allocate many small, trivially destructible objects from a few large
+ * blocks. There is no per object deallocation: all memory is released at
+ * once by Release() or the destructor.
+ *
+ * Not thread safe.
+ */
+class Arena {
+public:
+  /** @param block_size Size of regular blocks. */
+  explicit Arena(size_t block_size = 64 * 1024);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * Return size bytes of uninitialized memory aligned to align, which must
+   * be a power of two. Requests larger than a quarter of the block size
+   * get a block of their own.
+   */
+  void* Allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+  /** Return uninitialized storage for count objects of type T. */
+  template <typename T>
+  T* AllocateArray(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Arena never runs destructors");
+    return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  /** Release all memory, invalidating all pointers returned. */
+  void Release();
+
+  /** Return number of bytes handed out since last Release(). */
+  size_t GetUsed() const { return m_used; }
+
+  /** Return total size of allocated blocks. */
+  size_t GetCapacity() const { return m_capacity; }
+
+private:
+  const size_t m_block_size;
+  std::vector<std::unique_ptr<unsigned char[]>> m_blocks;
+  unsigned char* m_next = nullptr;  ///< Free space in current block
+  size_t m_available = 0;           ///< Bytes left after m_next
+  size_t m_used = 0;
+  size_t m_capacity = 0;
+};
+
+#endif  // ARENA_H_
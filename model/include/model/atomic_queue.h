@@ -19,11 +19,23 @@
 /**
  * \file
  *
- * General purpose fifo queue template
+ * General purpose fifo queue templates.
+ *
+ * atomic_queue is the original, unbounded mutex based queue. SpscQueue
+ * and MpmcQueue are bounded, lock-free ring buffers intended for the
+ * driver threads where contention on a single mutex is measurable.
  */
 
+#ifndef ATOMIC_QUEUE_H_
+#define ATOMIC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <utility>
 
 template <typename T>
 class atomic_queue {
@@ -53,7 +65,343 @@ public:
     m_queue.pop();
   }
 
+  /** Combined front() + pop(), return false if queue is empty. */
+  bool try_pop(T& value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_queue.empty()) return false;
+    value = std::move(m_queue.front());
+    m_queue.pop();
+    return true;
+  }
+
 private:
   std::queue<T> m_queue;
   mutable std::mutex m_mutex;
 };
+
+/** Counters maintained by the lock-free queues. */
+struct QueueStats {
+  uint64_t pushed;  ///< Items successfully inserted.
+  uint64_t popped;  ///< Items successfully removed.
+  uint64_t dropped;  ///< Items rejected since the queue was full.
+  uint64_t overruns;  ///< Number of push calls which found the queue full.
+};
+
+namespace queue_detail {
+
+/** Avoid false sharing between producer and consumer indexes. */
+static constexpr size_t kCacheLine = 64;
+
+/** Round n up to next power of two, at least 2. */
+inline size_t RoundCapacity(size_t n) {
+  size_t size = 2;
+  while (size < n) size <<= 1;
+  return size;
+}
+
+/** Overrun/drop bookkeeping shared by SpscQueue and MpmcQueue. */
+class Counters {
+public:
+  Counters() : m_pushed(0), m_popped(0), m_dropped(0), m_overruns(0) {}
+
+  void Pushed(size_t n) { m_pushed.fetch_add(n, std::memory_order_relaxed); }
+  void Popped(size_t n) { m_popped.fetch_add(n, std::memory_order_relaxed); }
+  void Dropped(size_t n) {
+    m_dropped.fetch_add(n, std::memory_order_relaxed);
+    m_overruns.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  QueueStats Get() const {
+    return {m_pushed.load(std::memory_order_relaxed),
+            m_popped.load(std::memory_order_relaxed),
+            m_dropped.load(std::memory_order_relaxed),
+            m_overruns.load(std::memory_order_relaxed)};
+  }
+
+  void Reset() {
+    m_pushed.store(0, std::memory_order_relaxed);
+    m_popped.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_overruns.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> m_pushed;
+  std::atomic<uint64_t> m_popped;
+  std::atomic<uint64_t> m_dropped;
+  std::atomic<uint64_t> m_overruns;
+};
+
+}  // namespace queue_detail
+
+/**
+ * Bounded, lock-free single producer, single consumer fifo queue.
+ *
+ * Exactly one thread may call the Push*() methods and exactly one
+ * thread may call the Pop*() methods, these can be the same. Capacity
+ * is rounded up to a power of two. Pushing into a full queue drops the
+ * new item(s) and updates the dropped and overruns counters.
+ */
+template <typename T>
+class SpscQueue {
+public:
+  explicit SpscQueue(size_t capacity)
+      : m_size(queue_detail::RoundCapacity(capacity)),
+        m_mask(m_size - 1),
+        m_buf(new T[m_size]),
+        m_head(0),
+        m_tail(0) {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  /** Return max number of items which can be stored. */
+  size_t Capacity() const { return m_size; }
+
+  /** Return current size, exact only when called from producer or consumer */
+  size_t Size() const {
+    return m_head.load(std::memory_order_acquire) -
+           m_tail.load(std::memory_order_acquire);
+  }
+
+  bool IsEmpty() const { return Size() == 0; }
+
+  bool IsFull() const { return Size() >= m_size; }
+
+  /** Insert item, return false and count a drop if queue is full. */
+  bool TryPush(const T& item) {
+    T copy(item);
+    return TryPush(std::move(copy));
+  }
+
+  bool TryPush(T&& item) {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= m_size) {
+      m_counters.Dropped(1);
+      return false;
+    }
+    m_buf[head & m_mask] = std::move(item);
+    m_head.store(head + 1, std::memory_order_release);
+    m_counters.Pushed(1);
+    return true;
+  }
+
+  /**
+   * Insert up to count items from items[] in one operation.
+   * @return Number of inserted items, the remaining ones are dropped.
+   */
+  size_t PushBatch(const T* items, size_t count) {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    const size_t free = m_size - (head - m_tail.load(std::memory_order_acquire));
+    const size_t n = count < free ? count : free;
+    for (size_t i = 0; i < n; i++) m_buf[(head + i) & m_mask] = items[i];
+    m_head.store(head + n, std::memory_order_release);
+    m_counters.Pushed(n);
+    if (n < count) m_counters.Dropped(count - n);
+    return n;
+  }
+
+  /** Combined front() and pop(), return false if queue is empty. */
+  bool TryPop(T& item) {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_head.load(std::memory_order_acquire) == tail) return false;
+    item = std::move(m_buf[tail & m_mask]);
+    m_tail.store(tail + 1, std::memory_order_release);
+    m_counters.Popped(1);
+    return true;
+  }
+
+  /**
+   * Retrieve up to max_count items into out[] in one operation.
+   * @return Number of retrieved items.
+   */
+  size_t PopBatch(T* out, size_t max_count) {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t avail = m_head.load(std::memory_order_acquire) - tail;
+    const size_t n = max_count < avail ? max_count : avail;
+    for (size_t i = 0; i < n; i++) out[i] = std::move(m_buf[(tail + i) & m_mask]);
+    m_tail.store(tail + n, std::memory_order_release);
+    m_counters.Popped(n);
+    return n;
+  }
+
+  /** Discard all items. Only safe to call from the consumer thread. */
+  void Clear() {
+    m_tail.store(m_head.load(std::memory_order_acquire),
+                 std::memory_order_release);
+  }
+
+  QueueStats GetStats() const { return m_counters.Get(); }
+
+  void ResetStats() { m_counters.Reset(); }
+
+private:
+  const size_t m_size;
+  const size_t m_mask;
+  std::unique_ptr<T[]> m_buf;
+  alignas(queue_detail::kCacheLine) std::atomic<size_t> m_head;
+  alignas(queue_detail::kCacheLine) std::atomic<size_t> m_tail;
+  alignas(queue_detail::kCacheLine) queue_detail::Counters m_counters;
+};
+
+/**
+ * Bounded, lock-free multiple producer, multiple consumer fifo queue.
+ *
+ * Based on the sequence numbered cell design by Dmitry Vyukov: each cell
+ * carries a sequence counter which tells producers and consumers if it is
+ * free or filled, so the only shared write per operation is a CAS on the
+ * enqueue or dequeue position. Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class MpmcQueue {
+public:
+  explicit MpmcQueue(size_t capacity)
+      : m_size(queue_detail::RoundCapacity(capacity)),
+        m_mask(m_size - 1),
+        m_cells(new Cell[m_size]),
+        m_enqueue_pos(0),
+        m_dequeue_pos(0) {
+    for (size_t i = 0; i < m_size; i++)
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  /** Return max number of items which can be stored. */
+  size_t Capacity() const { return m_size; }
+
+  /** Return approximate size, exact only when queue is quiescent. */
+  size_t Size() const {
+    const size_t head = m_enqueue_pos.load(std::memory_order_acquire);
+    const size_t tail = m_dequeue_pos.load(std::memory_order_acquire);
+    return head > tail ? head - tail : 0;
+  }
+
+  bool IsEmpty() const { return Size() == 0; }
+
+  bool IsFull() const { return Size() >= m_size; }
+
+  /** Insert item, return false and count a drop if queue is full. */
+  bool TryPush(const T& item) {
+    T copy(item);
+    return TryPush(std::move(copy));
+  }
+
+  bool TryPush(T&& item) {
+    Cell* cell = AcquireForWrite();
+    if (!cell) {
+      m_counters.Dropped(1);
+      return false;
+    }
+    cell->data = std::move(item);
+    cell->sequence.store(cell->pos + 1, std::memory_order_release);
+    m_counters.Pushed(1);
+    return true;
+  }
+
+  /**
+   * Insert up to count items from items[]. Items are inserted one by one
+   * and may thus be interleaved with other producers.
+   * @return Number of inserted items, the remaining ones are dropped.
+   */
+  size_t PushBatch(const T* items, size_t count) {
+    size_t n = 0;
+    for (; n < count; n++) {
+      Cell* cell = AcquireForWrite();
+      if (!cell) break;
+      cell->data = items[n];
+      cell->sequence.store(cell->pos + 1, std::memory_order_release);
+    }
+    m_counters.Pushed(n);
+    if (n < count) m_counters.Dropped(count - n);
+    return n;
+  }
+
+  /** Combined front() and pop(), return false if queue is empty. */
+  bool TryPop(T& item) {
+    Cell* cell = AcquireForRead();
+    if (!cell) return false;
+    item = std::move(cell->data);
+    cell->sequence.store(cell->pos + m_size, std::memory_order_release);
+    m_counters.Popped(1);
+    return true;
+  }
+
+  /**
+   * Retrieve up to max_count items into out[].
+   * @return Number of retrieved items.
+   */
+  size_t PopBatch(T* out, size_t max_count) {
+    size_t n = 0;
+    for (; n < max_count; n++) {
+      Cell* cell = AcquireForRead();
+      if (!cell) break;
+      out[n] = std::move(cell->data);
+      cell->sequence.store(cell->pos + m_size, std::memory_order_release);
+    }
+    m_counters.Popped(n);
+    return n;
+  }
+
+  QueueStats GetStats() const { return m_counters.Get(); }
+
+  void ResetStats() { m_counters.Reset(); }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    size_t pos;  // Position claimed by current owner, valid while owned.
+    T data;
+  };
+
+  Cell* AcquireForWrite() {
+    size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell* cell = &m_cells[pos & m_mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+          cell->pos = pos;
+          return cell;
+        }
+      } else if (diff < 0) {
+        return nullptr;  // full
+      } else {
+        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  Cell* AcquireForRead() {
+    size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell* cell = &m_cells[pos & m_mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+          cell->pos = pos;
+          return cell;
+        }
+      } else if (diff < 0) {
+        return nullptr;  // empty
+      } else {
+        pos = m_dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  const size_t m_size;
+  const size_t m_mask;
+  std::unique_ptr<Cell[]> m_cells;
+  alignas(queue_detail::kCacheLine) std::atomic<size_t> m_enqueue_pos;
+  alignas(queue_detail::kCacheLine) std::atomic<size_t> m_dequeue_pos;
+  alignas(queue_detail::kCacheLine) queue_detail::Counters m_counters;
+};
+
+#endif  // ATOMIC_QUEUE_H_
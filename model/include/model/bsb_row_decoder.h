@@ -0,0 +1,102 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Decoding of BSB/KAP run length encoded raster rows.
+ */
+
+#ifndef BSB_ROW_DECODER_H_
+#define BSB_ROW_DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Table driven decoder for the rows of a BSB raster.
+ *
+ * A row is a variable length line number followed by runs. Each run
+ * starts with a byte holding the color index in the upper color_bits of
+ * the low seven bits, and the start of the run length in the remaining
+ * bits. The high bit marks a continuation byte adding seven more bits
+ * to the length. A zero byte terminates the row.
+ *
+ * The decoder is immutable once created, and thus safe to use from
+ * several threads decoding different rows.
+ */
+class BsbRowDecoder {
+public:
+  /** Index of the black fill color used outside the chart. */
+  static constexpr uint8_t kFillIndex = 255;
+
+  /**
+   * @param color_bits Number of bits in color index, 1..7
+   * @param palette Colors with red in the low byte, as in opncpnPalette
+   * @param palette_size Number of colors, other indices are black
+   */
+  BsbRowDecoder(int color_bits, const int* palette, int palette_size);
+
+  /** Return offset of first run, after the line number. */
+  static size_t SkipLineNumber(const uint8_t* row, size_t size);
+
+  /**
+   * Expand pixels [xs, xl) of a row into 3 bytes per pixel RGB.
+   *
+   * Decoding starts at offset pos which is the start of the run beginning
+   * at pixel ix <= xs, typically the first run or a tile offset. Pixels
+   * beyond the end of a truncated or corrupt row get color index 0.
+   */
+  void ExpandRgb(const uint8_t* row, size_t size, size_t pos, int ix, int xs,
+                 int xl, uint8_t* rgb) const;
+
+  /** Like ExpandRgb(), but store one color index byte per pixel. */
+  void ExpandIndices(const uint8_t* row, size_t size, size_t pos, int ix,
+                     int xs, int xl, uint8_t* indices) const;
+
+  /** Convert count color indices to 3 bytes per pixel RGB. */
+  void IndicesToRgb(const uint8_t* indices, int count, uint8_t* rgb) const;
+
+  /**
+   * Box filter one row of color indices as created by ExpandIndices().
+   *
+   * For each target pixel x < targets, add the colors of the source pixels
+   * (int)(x * factor) + i where 0 <= i < blur and the pixel is less than
+   * count to sums[4 * x] (red), sums[4 * x + 1] (green), sums[4 * x + 2]
+   * (blue) and the number of pixels to sums[4 * x + 3].
+   */
+  void AccumulateBox(const uint8_t* indices, int count, double factor,
+                     int blur, int targets, uint32_t* sums) const;
+
+  /** Return color for index, red in the low byte. */
+  uint32_t GetColor(uint8_t index) const { return m_palette[index]; }
+
+private:
+  template <typename Fill>
+  void Expand(const uint8_t* row, size_t size, size_t pos, int ix, int xs,
+              int xl, Fill&& fill) const;
+
+  static constexpr int kLaneBits = 21;
+  static constexpr uint64_t kLaneMask = (1 << kLaneBits) - 1;
+
+  uint8_t m_value[256];  ///< Color index by run byte
+  uint8_t m_count[256];  ///< Start of run length by run byte
+  uint32_t m_palette[256];
+  uint64_t m_packed[256];  ///< Color components in kLaneBits wide lanes
+};
+
+#endif  // BSB_ROW_DECODER_H_
@@ -0,0 +1,138 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Bounding box index over the chart database entries.
+ */
+
+#ifndef CHART_SPATIAL_INDEX_H_
+#define CHART_SPATIAL_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "model/packed_rtree.h"
+
+/** Index record for a single chart database entry. */
+struct ChartIndexEntry {
+  float lat_min = 0;
+  float lat_max = 0;
+  float lon_min = 0;
+  float lon_max = 0;
+
+  /** If true, entry is part of every query result regardless of extent. */
+  bool always = false;
+
+  /** Chart groups (1-based) this entry belongs to. */
+  std::vector<int> groups;
+};
+
+/**
+ * Packed R-tree over chart bounding boxes, keyed by database index.
+ *
+ * The boxes are kept in a PackedRTree, x being longitude. Incremental
+ * changes (Append(), RemoveSwapBack()) are kept in a small overflow list
+ * which is scanned linearly, the tree is repacked when this list grows
+ * too large.
+ *
+ * Longitudes are used as stored in the database i. e., either in the
+ * -180..180 or the 0..360 range. Queries are repeated with the longitude
+ * shifted by +/- 360 degrees so that the result is correct for charts and
+ * query areas on both sides of the antimeridian.
+ *
+ * Group membership is kept as one bitset per group, allowing queries to
+ * filter on group without touching the chart table entries.
+ *
+ * Query results are returned in ascending database index order, and are
+ * a superset of the charts actually covering the query area: callers
+ * still need to check the chart's coverage polygons.
+ */
+class ChartSpatialIndex {
+public:
+  ChartSpatialIndex() = default;
+
+  /** Replace all contents with entries, entry i being db index i. */
+  void Build(std::vector<ChartIndexEntry> entries);
+
+  /** Add entry using next free db index, i. e. Size(). */
+  void Append(ChartIndexEntry entry);
+
+  /**
+   * Remove db index, moving the last entry into the free slot. Mirrors
+   * the removal in ChartDatabase::RemoveSingleChart().
+   */
+  void RemoveSwapBack(int db_index);
+
+  /** Replace group memberships for db index. */
+  void SetGroups(int db_index, const std::vector<int>& groups);
+
+  /** Return true if db index is member of group, group <= 0 means all. */
+  bool IsInGroup(int db_index, int group) const;
+
+  /**
+   * Return db indexes of entries whose bounding box contains the position
+   * and which are members of group (all if group <= 0).
+   */
+  std::vector<int> QueryPoint(float lat, float lon, int group = 0) const;
+
+  /**
+   * Return db indexes of entries whose bounding box intersects the given
+   * box and which are members of group (all if group <= 0).
+   */
+  std::vector<int> QueryBox(float lat_min, float lat_max, float lon_min,
+                            float lon_max, int group = 0) const;
+
+  /** Remove all entries. */
+  void Clear();
+
+  /** Mark index as out of sync with the database. */
+  void Invalidate() { m_valid = false; }
+
+  /** Return true if built and kept in sync since. */
+  bool IsValid() const { return m_valid; }
+
+  /** Return number of indexed entries. */
+  size_t Size() const { return m_entries.size(); }
+
+private:
+  using Box = PackedRTree::Box;
+  using Bitset = std::vector<uint64_t>;
+
+  static constexpr size_t kMinOverflow = 64;
+
+  void Pack();
+  void AddToGroups(int db_index, const std::vector<int>& groups);
+  void RemoveFromGroups(int db_index);
+  bool TestGroup(int db_index, int group) const;
+  void Search(const Box& query, int group, std::vector<int>& result) const;
+
+  std::vector<Box> m_boxes;
+  std::vector<ChartIndexEntry> m_entries;
+  PackedRTree m_tree;
+  std::vector<uint32_t> m_tree_ids;  ///< db index of each m_tree item
+
+  /** db indexes not covered by the packed tree, scanned linearly. */
+  std::vector<int> m_overflow;
+  std::vector<int> m_always;
+  std::vector<Bitset> m_groups;  ///< Indexed by group number.
+  bool m_valid = false;
+};
+
+#endif  // CHART_SPATIAL_INDEX_H_
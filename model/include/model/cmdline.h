@@ -33,6 +33,7 @@ extern int g_unit_test_2;
 extern bool g_start_fullscreen;
 extern bool g_rebuild_gl_cache;
 extern bool g_parse_all_enc;
+extern bool g_exit_after_parse;
 extern bool g_bportable;
 extern bool g_config_wizard;
 extern bool g_bdisable_opengl;
@@ -25,6 +25,7 @@
 #ifndef COMM_BRIDGE_H
 #define COMM_BRIDGE_H
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -147,24 +148,14 @@ private:
   PriorityMap priority_map_variation;
   PriorityMap priority_map_satellites;
 
+  /** Max delivery rate of position, velocity and heading messages. */
+  static constexpr std::chrono::milliseconds kNavInterval{200};
+
   //  comm event listeners
-  ObsListener m_n2k_129029_lstnr;
-  ObsListener m_n2k_129025_lstnr;
-  ObsListener m_n2k_129026_lstnr;
-  ObsListener m_n2k_127250_lstnr;
-  ObsListener m_n2k_127258_lstnr;
+  int m_nav_listener;  ///< NavMsgBus conflating listener handle
   ObsListener m_n2k_129540_lstnr;
 
-  ObsListener m_n0183_rmc_lstnr;
-  ObsListener m_n0183_ths_lstnr;
-  ObsListener m_n0183_hdt_lstnr;
-  ObsListener m_n0183_hdg_lstnr;
-  ObsListener m_n0183_hdm_lstnr;
-  ObsListener m_n0183_hvd_lstnr;
-  ObsListener m_n0183_vtg_lstnr;
   ObsListener m_n0183_gsv_lstnr;
-  ObsListener m_n0183_gga_lstnr;
-  ObsListener m_n0183_gll_lstnr;
   ObsListener m_n0183_aivdo_lstnr;
 
   ObsListener m_signal_k_lstnr;
@@ -25,34 +25,114 @@
 #ifndef _COMM_DRV_FILE_H
 #define _COMM_DRV_FILE_H
 
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <vector>
 #include <string>
 
+#include "model/comm_can_util.h"
 #include "model/comm_driver.h"
+#include "model/comm_drv_stats.h"
+#include "model/log_replay.h"
 
-/** Read and write data to/from files test driver  */
-class FileCommDriver : public AbstractCommDriver {
+/**
+ * Read and write data to/from files test driver.
+ *
+ * Input lines are either "bus key id payload" as written by SendMessage(),
+ * raw NMEA 0183 sentences as recorded by the VDR plugin, optionally with
+ * v4 tag blocks, or candump -L lines whose frames are assembled to
+ * NMEA 2000 messages.
+ *
+ * Input is played either synchronously in the constructor, or by a
+ * background thread streaming the file and pacing the messages according
+ * to the log timestamps, see ReplayPacer. Lines without timestamps are
+ * played as fast as possible.
+ *
+ * Output is appended to a file kept open, flushed after each message
+ * unless SetBuffered() is used.
+ */
+class FileCommDriver : public AbstractCommDriver, public DriverStatsProvider {
 public:
   /** An instance which can write to file and play data from another. */
   FileCommDriver(const std::string& opath, const std::string& ipath,
                  DriverListener& l);
 
+  /**
+   * An instance which can write to file and plays data from another in a
+   * background thread.
+   * @param speed Replay speed, see ReplayPacer::SetSpeed().
+   */
+  FileCommDriver(const std::string& opath, const std::string& ipath,
+                 DriverListener& l, double speed);
+
   /** A write-only instance writing to file. */
   FileCommDriver(const std::string& opath);
 
-  virtual ~FileCommDriver() = default;
+  virtual ~FileCommDriver();
 
   bool SendMessage(std::shared_ptr<const NavMsg> msg,
                    std::shared_ptr<const NavAddr> addr) override;
 
   virtual std::shared_ptr<NavAddr> GetAddress();
 
+  DriverStats GetDriverStats() const override;
+
+  /** Change speed of a running replay, see ReplayPacer::SetSpeed(). */
+  void SetSpeed(double speed) { m_pacer.SetSpeed(speed); }
+
+  /** Stop a running replay and wait for the reader thread to exit. */
+  void Stop();
+
+  /** Return true while the background replay is running. */
+  bool IsReplaying() const { return m_replaying; }
+
+  /** Return replay progress, also of a finished replay. */
+  ReplayStats GetReplayStats() const;
+
+  /**
+   * Enable or disable buffered output. When enabled messages written by
+   * SendMessage() are only flushed when the buffer is full, by Flush() and
+   * when the driver is destroyed.
+   */
+  void SetBuffered(bool buffered) { m_buffered = buffered; }
+
+  /** Write buffered output to file. */
+  void Flush();
+
 private:
+  /** Play all lines in input file, pacing them if m_paced. */
+  void Replay();
+
+  /** Parse line and send resulting message(s) to listener. */
+  void HandleLine(const std::string& line);
+
+  /** Handle a candump frame, assembling fast messages. */
+  void HandleFrame(const std::string& iface, const can_frame& frame);
+
   std::string output_path;
   std::string input_path;
   DriverListener& listener;
+
+  std::ofstream m_output;
+  std::mutex m_output_mutex;
+  std::atomic<bool> m_buffered;
+
+  ReplayPacer m_pacer;
+  bool m_paced;
+  FastMessageMap m_fast_messages;
+  std::thread m_thread;
+  std::atomic<bool> m_replaying;
+  bool m_stop;
+  std::condition_variable m_stop_cv;
+  mutable std::mutex m_stats_mutex;  ///< Protects m_stop and stats
+  ReplayStats m_replay_stats;
+  DriverStats m_driver_stats;
+  ReplayPacer::Clock::time_point m_start;
 };
 
 #endif  // COMM_DRV_FILE_H
@@ -37,6 +37,7 @@
 
 #include <wx/datetime.h>
 
+#include "model/atomic_queue.h"
 #include "model/comm_buffers.h"
 #include "model/comm_can_util.h"
 #include "model/comm_drv_n2k.h"
@@ -114,6 +115,8 @@ public:
   wxSocketBase* GetSock() const { return m_sock; }
 
 private:
+  friend class CommBench;  ///< Benchmark hook, see test/comm_bench.cpp
+
   ConnectionParams m_params;
   DriverListener& m_listener;
 
@@ -207,7 +210,7 @@ private:
   int m_ib;
   bool m_bInMsg, m_bGotESC, m_bGotSOT;
 
-  CircularBuffer<unsigned char> m_circle;
+  SpscQueue<unsigned char> m_circle;
   unsigned char* rx_buffer;
   std::string m_sentence;
 
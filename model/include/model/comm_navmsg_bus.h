@@ -27,16 +27,55 @@
 #ifndef NAVMSG_BUS_H_
 #define NAVMSG_BUS_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <wx/event.h>
 
+#include "model/atomic_queue.h"
 #include "model/comm_driver.h"
+#include "model/worker_pool.h"
 #include "observable_evtvar.h"
 
+/** A set of messages delivered in one call to a batch listener. */
+using NavMsgBatch = std::vector<std::shared_ptr<const NavMsg>>;
+
+/** Callback invoked with each batch of messages. */
+using NavMsgBatchHandler = std::function<void(const NavMsgBatch&)>;
+
+/** Thread context used when invoking a batch listener. */
+enum class NavMsgDelivery {
+  kGuiThread,  ///< Invoked in main thread using CallAfter()
+  kWorker      ///< Invoked in a NavMsgBus worker thread.
+};
+
+/** Dispatch metrics returned by NavMsgBus::GetStats(). */
+struct NavMsgBusStats {
+  size_t queue_depth;      ///< Messages currently waiting for next tick.
+  size_t max_queue_depth;  ///< Highest depth observed at a tick.
+  uint64_t batches;        ///< Number of dispatched batches.
+  uint64_t delivered;      ///< Number of dispatched messages.
+  uint64_t dropped;        ///< Messages lost due to a full queue.
+  double avg_latency_ms;   ///< Mean time from Notify() to dispatch.
+  double max_latency_ms;   ///< Max time from Notify() to dispatch.
+};
+
+/** Counters for a conflating listener, see AddConflatingListener(). */
+struct ConflatingStats {
+  uint64_t received;   ///< Messages matching the listener's keys.
+  uint64_t delivered;  ///< Messages passed to the listener.
+  uint64_t skipped;    ///< Messages replaced by a newer one before delivery.
+};
+
 /** The raw message layer, a singleton. */
 class NavMsgBus : public wxEvtHandler, public DriverListener {
 public:
@@ -65,14 +104,135 @@ public:
   /** Return list of message types sent or received. */
   const std::set<std::string>& GetActiveMessages() { return m_active_messages; }
 
+  /**
+   * Enable or disable batching. When enabled, Notify() just queues the
+   * message. Queued messages are dispatched to all listeners once per
+   * tick instead of one CallAfter() per message. Observable listeners still
+   * get one event per message, high rate consumers should use
+   * AddBatchListener() or AddConflatingListener() instead.
+   */
+  void SetBatchMode(bool enable, std::chrono::milliseconds tick = kDefaultTick);
+
+  bool IsBatchMode() const { return m_batch_mode; }
+
+  /**
+   * Add a listener receiving all messages in batches, once per tick.
+   * Batch listeners are served also when batch mode is disabled.
+   * @return Handle to be used in RemoveBatchListener().
+   */
+  int AddBatchListener(NavMsgBatchHandler handler, NavMsgDelivery delivery);
+
+  /**
+   * Add a listener which only receives the latest message for each key
+   * and source, at most once per min_interval. Intermediate messages are
+   * counted as skipped. Each call to handler contains at most one message
+   * per key and source, in arrival order.
+   *
+   * @param keys Message keys as returned by NavMsg::GetKey() e. g.,
+   *   Nmea0183Msg("RMC").GetKey(). Empty set means all keys.
+   * @param min_interval Minimum time between two deliveries of same key
+   *   i. e., 200ms for 5 Hz. Resolution is limited by the tick.
+   * @return Handle to be used in RemoveBatchListener() and
+   *    GetConflatingStats().
+   */
+  int AddConflatingListener(const std::unordered_set<std::string>& keys,
+                            std::chrono::milliseconds min_interval,
+                            NavMsgBatchHandler handler,
+                            NavMsgDelivery delivery);
+
+  /**
+   * Remove a listener added by AddBatchListener() or
+   * AddConflatingListener(). When invoked from a kWorker handler the
+   * removal is effective for all following batches but does not wait for
+   * other handlers; otherwise returns when no worker runs the handler.
+   */
+  void RemoveBatchListener(int handle);
+
+  /** Return counters for conflating listener, all zero if not found. */
+  ConflatingStats GetConflatingStats(int handle) const;
+
+  /** Return current dispatch metrics. */
+  NavMsgBusStats GetStats() const;
+
+  void ResetStats();
+
   /** Notified without data when new message type(s) are detected. */
   EventVar new_msg_event;
 
+  static constexpr std::chrono::milliseconds kDefaultTick{50};
+
 private:
+  class BatchTimer;
+
+  struct QueuedMsg {
+    std::shared_ptr<const NavMsg> msg;
+    std::chrono::steady_clock::time_point arrival;
+    bool notify_observable;  ///< Queued in batch mode, not yet notified.
+  };
+
+  /** Latest not yet delivered message for a key and source. */
+  struct ConflatedSlot {
+    std::shared_ptr<const NavMsg> latest;
+    uint64_t seq;  ///< Arrival order of latest.
+    std::chrono::steady_clock::time_point last_delivery;
+  };
+
+  struct BatchListener {
+    int handle;
+    NavMsgBatchHandler handler;
+    NavMsgDelivery delivery;
+
+    // Conflating listeners only:
+    bool conflating;
+    std::unordered_set<std::string> keys;
+    std::chrono::milliseconds min_interval;
+    std::unordered_map<std::string, ConflatedSlot> slots;
+    uint64_t next_seq;
+    ConflatingStats stats;
+  };
+
   std::mutex m_mutex;
-  NavMsgBus() = default;
+  NavMsgBus();
+  ~NavMsgBus() override;
+
+  void StartTimer(std::chrono::milliseconds tick);
+  void StopTimerIfIdle();
+  std::chrono::milliseconds GetTick() const;
+
+  /** Drain queue and dispatch to all listeners, run by the timer thread. */
+  void DispatchBatch();
+
+  void UpdateLatency(const std::vector<QueuedMsg>& queued);
+
+  /**
+   * Update a conflating listener with new messages.
+   * @return Messages due for delivery, possibly empty.
+   */
+  static std::shared_ptr<NavMsgBatch> Conflate(BatchListener& listener,
+                                               const NavMsgBatch& batch);
+
+  int AddListener(BatchListener listener);
 
   std::set<std::string> m_active_messages;
+
+  std::atomic<bool> m_batch_mode;
+  std::atomic<bool> m_has_batch_listeners;
+  MpmcQueue<QueuedMsg> m_queue;
+  std::unique_ptr<BatchTimer> m_timer;
+  std::chrono::milliseconds m_tick;
+  std::unique_ptr<WorkerPool> m_workers;
+
+  std::vector<BatchListener> m_batch_listeners;
+  int m_next_handle;
+  mutable std::mutex m_listeners_mutex;
+
+  mutable std::mutex m_stats_mutex;
+  size_t m_max_queue_depth;
+  uint64_t m_batches;
+  uint64_t m_delivered;
+  uint64_t m_latency_samples;
+  double m_latency_sum_ms;
+  double m_max_latency_ms;
 };
 
 #endif  // NAVMSG_BUS_H_
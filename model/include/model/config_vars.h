@@ -73,8 +73,10 @@ extern bool g_bGDAL_Debug;
 extern bool g_bGLexpert;
 extern bool g_bHighliteTracks;
 extern bool g_bInlandEcdis;
+extern bool g_bLazyTrackLoad;  ///< Load track points on demand
 extern bool g_bLookAhead;
 extern bool g_bMagneticAPB;
+extern bool g_bMbtilesPrefetch;  ///< Prefetch MBTiles next zoom level
 extern bool g_bNavAidRadarRingsShown;
 extern bool g_bopengl;
 extern bool g_bOverruleScaMin;
@@ -200,10 +202,12 @@ extern int g_lastClientRecth;
 extern int g_lastClientRectw;
 extern int g_lastClientRectx;
 extern int g_lastClientRecty;
+extern int g_lazyTrackPoints;  ///< Loaded track points budget, 0: default
 extern int g_maintoolbar_x;
 extern int g_maintoolbar_y;
 extern int g_maxWPNameLength;
 extern int g_maxzoomin;
+extern int g_mbtilesCacheMB;  ///< MBTiles cache byte budget, 0: default
 extern int g_mbtilesMaxLayers;
 extern int g_memCacheLimit;
 extern int g_MemFootMB;
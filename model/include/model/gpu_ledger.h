@@ -0,0 +1,143 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Book keeping of GPU memory used by chart textures and vertex buffers.
+ */
+
+#ifndef GPU_LEDGER_H_
+#define GPU_LEDGER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Central register of GPU resources: raster chart textures, MBTiles tile
+ * textures and S57 vertex buffers.
+ *
+ * Owners register each resource with its size and a callback freeing it,
+ * and touch it whenever it is rendered. Enforce() then evicts resources
+ * least recently rendered first, regardless of chart type, until the
+ * total size is within given target. The ledger itself is pure C++ and
+ * never calls OpenGL; evictors are invoked from Enforce() and thus in the
+ * rendering thread.
+ *
+ * All methods are thread safe.
+ */
+class GpuLedger {
+public:
+  enum class Kind { kRasterTexture, kTileTexture, kVertexBuffer };
+  static const size_t kKindCount = 3;
+
+  /** Resource identifier, 0 is never used and ignored by all methods. */
+  using Handle = uint64_t;
+
+  /**
+   * Free the GPU resource. The ledger entry is already removed when
+   * called, so a Release() from the evictor is harmless.
+   */
+  using Evictor = std::function<void()>;
+
+  /** GPU memory used by one owner, typically a chart. */
+  struct OwnerStats {
+    std::string owner;
+    size_t bytes = 0;  ///< Total of all kinds
+    std::array<size_t, kKindCount> bytes_by_kind{};
+    size_t resources = 0;
+  };
+
+  GpuLedger() = default;
+  GpuLedger(const GpuLedger&) = delete;
+  GpuLedger& operator=(const GpuLedger&) = delete;
+
+  /** Ledger shared by all charts. */
+  static GpuLedger& GetInstance();
+
+  /**
+   * Register a new resource, regarded as rendered in current frame.
+   * @param owner Owning chart, used in GetStats().
+   * @param evictor Invoked by Enforce() to free the resource.
+   * @return Handle used in all other calls.
+   */
+  Handle Register(const std::string& owner, Kind kind, size_t bytes,
+                  Evictor evictor);
+
+  /** Update size of a resource, e. g. after uploading more mipmap levels. */
+  void Resize(Handle handle, size_t bytes);
+
+  /** Mark resource as rendered in current frame. */
+  void Touch(Handle handle);
+
+  /** Remove resource freed by its owner. Unknown handles are ignored. */
+  void Release(Handle handle);
+
+  /** Start a new frame, called once per canvas render. */
+  void NextFrame();
+
+  uint64_t GetFrame() const;
+
+  /** Return total size of all registered resources. */
+  size_t GetUsed() const;
+
+  /** Return total size of registered resources of given kind. */
+  size_t GetUsed(Kind kind) const;
+
+  /** Return number of registered resources. */
+  size_t GetCount() const;
+
+  /**
+   * Evict least recently rendered resources until total size is at most
+   * target.
+   * @param keep_frames Resources rendered in the last keep_frames frames,
+   *     at least the current one, are never evicted.
+   * @return Number of bytes evicted.
+   */
+  size_t Enforce(size_t target, unsigned keep_frames = 1);
+
+  /** Return memory use by owner, largest first. */
+  std::vector<OwnerStats> GetStats() const;
+
+private:
+  struct Entry {
+    std::string owner;
+    Kind kind;
+    size_t bytes;
+    uint64_t frame;  ///< Last frame rendered
+    Evictor evictor;
+    std::list<Handle>::iterator lru;
+  };
+
+  void Erase(std::unordered_map<Handle, Entry>::iterator it);
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<Handle, Entry> m_entries;
+  std::list<Handle> m_lru;  ///< Most recently rendered first
+  std::array<size_t, kKindCount> m_used{};
+  Handle m_next_handle = 1;
+  uint64_t m_frame = 0;
+};
+
+#endif  // GPU_LEDGER_H_
@@ -0,0 +1,103 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Timestamp parsing and pacing for replay of recorded NMEA logs.
+ */
+
+#ifndef LOG_REPLAY_H_
+#define LOG_REPLAY_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Parse the time a log line was recorded. Handles candump -L lines like
+ * "(1659169701.507935) can0 09FD0200#FF8101B877FAFFFF" and NMEA 0183 v4
+ * tag blocks like "\c:1659169701*hh\$GPRMC,...".
+ * @param secs Unix time in seconds, updated on success.
+ * @return true if line has a timestamp.
+ */
+bool ParseLogTime(const std::string& line, double& secs);
+
+/**
+ * Parse a candump -L line "(timestamp) iface ID#DATA".
+ * @param iface Interface name, for example "can0".
+ * @param can_id Extended CAN identifier.
+ * @param data Frame payload, at most 8 bytes.
+ * @return false if line is not a classic CAN candump line.
+ */
+bool ParseCandumpLine(const std::string& line, std::string& iface,
+                      uint32_t& can_id, std::vector<unsigned char>& data);
+
+/** Replay progress report. */
+struct ReplayStats {
+  uint64_t lines = 0;     ///< Lines read from input
+  uint64_t messages = 0;  ///< Messages sent to listener
+  double seconds = 0;     ///< Wall clock time since replay start
+
+  /** Return messages per second since replay start. */
+  double GetRate() const { return seconds > 0 ? messages / seconds : 0; }
+};
+
+/**
+ * Map log timestamps to wall clock times when replaying a log at given
+ * speed. The first timestamp is due immediately, later ones at their
+ * offset from it divided by the speed. Timestamps going backwards or
+ * jumping more than kMaxGap, typically concatenated logs, restart the
+ * pacing rather than stalling the replay.
+ *
+ * Thread safe.
+ */
+class ReplayPacer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr double kMaxSpeed = 100.0;
+
+  /** Largest log time gap honoured, seconds. */
+  static constexpr double kMaxGap = 10.0;
+
+  /** @param speed See SetSpeed(). */
+  explicit ReplayPacer(double speed = 1.0);
+
+  /**
+   * Set replay speed, 1.0 being real time. Values above kMaxSpeed are
+   * clamped, 0 or less means as fast as possible.
+   */
+  void SetSpeed(double speed);
+
+  double GetSpeed() const;
+
+  /** Return wall clock time when a line with log time ts is due. */
+  Clock::time_point Due(double ts, Clock::time_point now = Clock::now());
+
+private:
+  mutable std::mutex m_mutex;
+  double m_speed;
+  bool m_anchored;
+  double m_log_start;  ///< Log time of anchor
+  double m_last_ts;
+  Clock::time_point m_wall_start;  ///< Wall clock time of anchor
+};
+
+#endif  // LOG_REPLAY_H_
@@ -0,0 +1,91 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Read-only memory mapped file, pure C++17 on top of mmap() or
+ * CreateFileMapping().
+ */
+
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * A file mapped read-only into memory. Pages are loaded by the OS on
+ * first access, so opening even very large files is cheap.
+ *
+ * The mapping reflects the file as it is on disk: the file must not be
+ * truncated or rewritten in place while mapped. Replace it by writing a
+ * new file and renaming it instead.
+ */
+class MappedFile {
+public:
+  /** Expected access pattern, see Advise(). */
+  enum class Access { kNormal, kSequential, kRandom };
+
+  MappedFile() = default;
+
+  /** Map given file, check result using IsOpen(). */
+  explicit MappedFile(const std::string& path) { Open(path); }
+
+  ~MappedFile() { Close(); }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Map given file, unmapping any existing mapping.
+   * @param path UTF-8 encoded file path.
+   * @return false if file cannot be opened, is empty or cannot be mapped.
+   */
+  bool Open(const std::string& path);
+
+  /** Unmap file, no-op if not mapped. */
+  void Close();
+
+  /** Return true if file is mapped. */
+  bool IsOpen() const { return m_data != nullptr; }
+
+  /** Return start of mapped data, nullptr if not open. */
+  const uint8_t* Data() const { return m_data; }
+
+  /** Return size of mapped data in bytes. */
+  size_t Size() const { return m_size; }
+
+  /** Return true if [offset, offset + length) is within mapped data. */
+  bool Contains(uint64_t offset, uint64_t length) const {
+    return offset <= m_size && length <= m_size - offset;
+  }
+
+  /** Hint the OS about expected access pattern, no-op if unsupported. */
+  void Advise(Access access) const;
+
+private:
+  const uint8_t* m_data = nullptr;
+  size_t m_size = 0;
+#ifdef _WIN32
+  void* m_file = nullptr;
+  void* m_mapping = nullptr;
+#endif
+};
+
+#endif  // MAPPED_FILE_H_
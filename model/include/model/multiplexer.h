@@ -33,6 +33,7 @@
 #endif
 
 #include "model/comm_navmsg.h"
+#include "model/comm_navmsg_bus.h"
 #include "model/nmea_log.h"
 
 class Multiplexer;  // forward
@@ -82,12 +83,11 @@ public:
 private:
   MuxLogCallbacks m_log_callbacks;
   bool& m_legacy_input_filter_behaviour;
-  std::unordered_map<std::string, ObsListener> m_listeners;
-  ObsListener m_new_msgtype_lstnr;
+  int m_batch_listener;  ///< NavMsgBus batch listener handle
   int m_n2k_repeat_count;
   unsigned int m_last_pgn_logged;
 
-  void OnNewMessageType();
+  void HandleBatch(const NavMsgBatch& batch);
 
   void HandleN0183(const std::shared_ptr<const Nmea0183Msg>& n0183_msg) const;
 
@@ -24,14 +24,25 @@
 #ifndef _NAVOBJ_DB_H__
 #define _NAVOBJ_DB_H__
 
+#include <memory>
+#include <string>
+#include <unordered_set>
+
 #include <wx/timer.h>
+#include "navobj_write_queue.h"
 #include "notification.h"
 #include "observable_evtvar.h"
 #include "comm_appmsg.h"
 #include <sqlite3.h>
 #include "track.h"
 
-/** The navobj SQLite container object, a singleton. */
+/**
+ * The navobj SQLite container object, a singleton.
+ *
+ * Track point additions and route point updates are queued and committed
+ * in batches by a background thread, see NavObjWriteQueue. All other
+ * methods flush the queue before accessing the database.
+ */
 class NavObj_dB {
 public:
   static NavObj_dB &GetInstance();
@@ -43,12 +54,21 @@ public:
   void LoadNavObjects();
 
   // Tracks
+  /**
+   * Load all tracks. With g_bLazyTrackLoad only headers and bounding boxes
+   * are loaded, points are paged in using LoadTrackPoints().
+   */
   bool LoadAllTracks();
+  /** Append points stored for track to it. */
+  bool LoadTrackPoints(Track *track);
   bool InsertTrack(Track *track);
   bool UpdateTrack(Track *track);
+  /** Queue insertion of point, last in track, if track is in database. */
   bool AddTrackPoint(Track *track, TrackPoint *point);
   bool UpdateDBTrackAttributes(Track *track);
   bool DeleteTrack(Track *track);
+  /** Queue saving the simplified pyramid of track, see TrackLod. */
+  bool SaveTrackLod(Track *track, const TrackLod &lod);
 
   // Routes
   bool LoadAllRoutes();
@@ -65,6 +85,7 @@ public:
   bool LoadAllPoints();
   bool InsertRoutePoint(RoutePoint *point);
   bool DeleteRoutePoint(RoutePoint *point);
+  /** Queue update of point, replacing pending updates of same point. */
   bool UpdateRoutePoint(RoutePoint *point);
 
   // Legacy navobj import
@@ -74,6 +95,10 @@ public:
   bool Backup(wxString fileName);
   bool FullSchemaMigrate(wxFrame *frame);
 
+  /** Block until all queued mutations are committed. */
+  void FlushWrites();
+  NavObjWriteStats GetWriteStats() const;
+
 private:
   NavObj_dB();
   ~NavObj_dB();
@@ -92,6 +117,9 @@ private:
   int m_nImportObjects;
   int m_import_progesscount;
   wxProgressDialog *m_pImportProgress;
+  std::unique_ptr<NavObjWriteQueue> m_write_queue;
+  /** Guids of tracks in the database, loaded or inserted. */
+  std::unordered_set<std::string> m_track_guids;
 };
 
 #endif
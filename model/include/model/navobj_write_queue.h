@@ -0,0 +1,164 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Asynchronous write-behind queue for the navobj database.
+ */
+
+#ifndef NAVOBJ_WRITE_QUEUE_H_
+#define NAVOBJ_WRITE_QUEUE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sqlite3.h>
+
+/** Value bound to a statement parameter. */
+struct SqlValue {
+  enum class Type { kInt, kDouble, kText, kBlob };
+
+  SqlValue(int v) : type(Type::kInt), i(v) {}
+  SqlValue(int64_t v) : type(Type::kInt), i(v) {}
+  SqlValue(double v) : type(Type::kDouble), d(v) {}
+  SqlValue(std::string v) : type(Type::kText), text(std::move(v)) {}
+  SqlValue(const char* v) : type(Type::kText), text(v) {}
+  SqlValue(std::vector<uint8_t> v) : type(Type::kBlob), blob(std::move(v)) {}
+
+  Type type;
+  int64_t i = 0;
+  double d = 0;
+  std::string text;
+  std::vector<uint8_t> blob;
+};
+
+/** A statement and the values bound to its parameters, in order. */
+struct SqlStatement {
+  std::string sql;
+  std::vector<SqlValue> args;
+};
+
+/** Write queue counters, see NavObjWriteQueue::GetStats(). */
+struct NavObjWriteStats {
+  size_t queued = 0;      ///< Mutations pushed.
+  size_t coalesced = 0;   ///< Mutations replaced by a newer one.
+  size_t statements = 0;  ///< Statements executed.
+  size_t errors = 0;      ///< Failed statements and transactions.
+  size_t batches = 0;     ///< Committed transactions.
+  size_t max_batch = 0;   ///< Largest number of mutations in one batch.
+  size_t pending = 0;     ///< Mutations not yet committed.
+  double last_commit_ms = 0;  ///< Wall time of latest transaction.
+};
+
+/**
+ * Write-behind queue running mutations in a separate thread on a private
+ * connection to the database. Mutations pushed within one interval are
+ * committed in a single transaction, so at most one interval of data is
+ * lost on a crash. Prepared statements are cached for the lifetime of the
+ * queue.
+ *
+ * The database should use WAL journalling so that readers on other
+ * connections are not blocked while a batch is written. Users doing
+ * direct writes on another connection must Flush() first to keep the
+ * order of mutations.
+ */
+class NavObjWriteQueue {
+public:
+  using ErrorFunc = std::function<void(const std::string&)>;
+
+  /** Pending mutations causing an immediate commit. */
+  static constexpr size_t kMaxBatch = 1024;
+
+  /** Pending mutations blocking Push() until the worker catches up. */
+  static constexpr size_t kMaxPending = 64 * 1024;
+
+  /**
+   * Milliseconds waited for locks held by other connections, used both
+   * by the queue and the main connection.
+   */
+  static constexpr int kBusyTimeout = 5000;
+
+  /**
+   * Open a connection to existing database and start the worker.
+   * @param path      Database file.
+   * @param interval  Maximum time a mutation is kept in queue.
+   * @param on_error  Invoked in the worker thread on errors, may be empty.
+   */
+  NavObjWriteQueue(const std::string& path, std::chrono::milliseconds interval,
+                   ErrorFunc on_error = nullptr);
+
+  /** Commit pending mutations, stop the worker and close the connection. */
+  ~NavObjWriteQueue();
+
+  NavObjWriteQueue(const NavObjWriteQueue&) = delete;
+  NavObjWriteQueue& operator=(const NavObjWriteQueue&) = delete;
+
+  /** Return true if the database could be opened. */
+  bool IsOpen() const { return m_db != nullptr; }
+
+  /**
+   * Queue statements to be run in order in a coming transaction.
+   * @param key  If non-empty, a pending mutation with the same key is
+   *             replaced in place. Only usable for mutations writing the
+   *             complete state of an object.
+   */
+  void Push(std::vector<SqlStatement> statements, const std::string& key = "");
+
+  /** Block until all pushed mutations are committed. */
+  void Flush();
+
+  NavObjWriteStats GetStats() const;
+
+private:
+  struct Mutation {
+    std::vector<SqlStatement> statements;
+  };
+
+  void Worker();
+  void Commit(std::deque<Mutation>& batch);
+  bool Execute(const SqlStatement& statement);
+  sqlite3_stmt* Prepare(const std::string& sql);
+  void Error(const std::string& what);
+
+  sqlite3* m_db;
+  const std::chrono::milliseconds m_interval;
+  ErrorFunc m_on_error;
+  std::unordered_map<std::string, sqlite3_stmt*> m_statements;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_idle_cv;
+  std::deque<Mutation> m_pending;
+  std::unordered_map<std::string, size_t> m_keys;
+  std::chrono::steady_clock::time_point m_oldest;
+  bool m_busy;
+  bool m_stop;
+  int m_flush_requests;
+  NavObjWriteStats m_stats;
+  std::thread m_thread;
+};
+
+#endif  // NAVOBJ_WRITE_QUEUE_H_
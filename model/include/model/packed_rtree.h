@@ -0,0 +1,121 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Static R-tree over bounding boxes.
+ */
+
+#ifndef PACKED_RTREE_H_
+#define PACKED_RTREE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * Read-only R-tree over axis aligned boxes, bulk loaded using
+ * Sort-Tile-Recursive packing. Items are identified by their position in
+ * the vector given to Build(). Rebuilding is cheap enough to be done
+ * whenever the set of items changes.
+ */
+class PackedRTree {
+public:
+  /** Closed box, typically x = longitude and y = latitude. */
+  struct Box {
+    float x_min;
+    float y_min;
+    float x_max;
+    float y_max;
+
+    bool Intersects(const Box& other) const {
+      return x_min <= other.x_max && other.x_min <= x_max &&
+             y_min <= other.y_max && other.y_min <= y_max;
+    }
+  };
+
+  PackedRTree() = default;
+
+  /** Replace all contents, item i having boxes[i]. */
+  void Build(const std::vector<Box>& boxes);
+
+  /**
+   * Append the items whose box intersects query to result, in no
+   * particular order.
+   */
+  void Search(const Box& query, std::vector<uint32_t>& result) const;
+
+  /**
+   * Lower bound of the distance from the query to anything inside a box.
+   * Must not decrease when the box is shrunk.
+   */
+  using BoxDistance = std::function<double(const Box&)>;
+
+  /**
+   * Append up to count items closest to the query to result, closest
+   * first, using a best first traversal.
+   * @param distance Distance to the query, applied to both node and item
+   *     boxes.
+   */
+  void Nearest(size_t count, const BoxDistance& distance,
+               std::vector<uint32_t>& result) const;
+
+  /** Remove all items. */
+  void Clear();
+
+  /**
+   * Append the tree to out in a flat native endian layout of 32 bit words,
+   * which Load() restores without rebuilding.
+   */
+  void Save(std::vector<uint8_t>& out) const;
+
+  /**
+   * Replace all contents with a tree stored by Save().
+   * @return false and an empty tree if data is not a valid tree.
+   */
+  bool Load(const uint8_t* data, size_t size);
+
+  /** Return number of items. */
+  size_t Size() const { return m_boxes.size(); }
+
+  /** Number of children per node. */
+  static constexpr unsigned kNodeSize = 16;
+
+private:
+  struct Node {
+    Box box;
+    uint32_t first;  ///< First child in m_refs
+    uint16_t count;
+    bool leaf;  ///< If true, children are items, else nodes
+  };
+
+  /** Pack ids into nodes of one level, return the new node ids. */
+  std::vector<uint32_t> Pack(std::vector<uint32_t> ids, bool leaf);
+
+  const Box& GetBox(uint32_t id, bool leaf) const {
+    return leaf ? m_boxes[id] : m_nodes[id].box;
+  }
+
+  std::vector<Box> m_boxes;
+  std::vector<Node> m_nodes;
+  std::vector<uint32_t> m_refs;  ///< Node children, item or node ids
+  uint32_t m_root = 0;
+};
+
+#endif  // PACKED_RTREE_H_
@@ -0,0 +1,105 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Candidate selection when picking chart objects.
+ */
+
+#ifndef PICK_INDEX_H_
+#define PICK_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "model/packed_rtree.h"
+
+/**
+ * Entries which may be hit when picking at a position, used by s57chart
+ * for its area and line rules. Entries are numbered in the order added,
+ * which is the order callers test them in. The boxes are coarse: callers
+ * still do the geometric tests.
+ *
+ * The PackedRTree is either built from the entry boxes or given by
+ * SetTree(), e.g. when stored in a SENC. In the latter case several
+ * entries may share a tree item.
+ */
+class PickIndex {
+public:
+  using Box = PackedRTree::Box;
+
+  PickIndex() = default;
+
+  /** Use a prebuilt tree, entries then being added by AddToItem(). */
+  void SetTree(PackedRTree tree);
+
+  /** Return true if using a tree given to SetTree(). */
+  bool HasTree() const { return m_prebuilt; }
+
+  /** Remove all entries, keeping a tree given to SetTree(). */
+  void ClearEntries();
+
+  /** Remove all entries and the tree. */
+  void Clear();
+
+  /**
+   * Add next entry indexed by box. Unindexed when using a tree given to
+   * SetTree().
+   */
+  void AddBox(const Box& box);
+
+  /**
+   * Add next entry as part of item of the tree given to SetTree().
+   * Unindexed if there is no such item.
+   */
+  void AddToItem(uint32_t item);
+
+  /** Add next entry, candidate in every search. */
+  void AddUnindexed();
+
+  /** Make the entries added since last ClearEntries() searchable. */
+  void Finish();
+
+  /** Return entries which may intersect query, in ascending order. */
+  std::vector<uint32_t> Search(const Box& query) const;
+
+  /** Return number of entries. */
+  size_t Size() const { return m_entry_count; }
+
+private:
+  PackedRTree m_tree;
+  bool m_prebuilt = false;
+  uint32_t m_entry_count = 0;
+
+  /** Boxes of AddBox() entries, until Finish(). */
+  std::vector<Box> m_boxes;
+  /** Item and entry pairs, until Finish(). */
+  std::vector<std::pair<uint32_t, uint32_t>> m_item_entries;
+
+  std::vector<uint32_t> m_unindexed;
+  /**
+   * Entries of item i, from m_entries[m_item_first[i]] up to
+   * m_entries[m_item_first[i + 1]].
+   */
+  std::vector<uint32_t> m_item_first;
+  std::vector<uint32_t> m_entries;
+};
+
+#endif  // PICK_INDEX_H_
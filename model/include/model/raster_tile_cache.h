@@ -0,0 +1,144 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Process wide cache of decoded raster chart tiles.
+ */
+
+#ifndef RASTER_TILE_CACHE_H_
+#define RASTER_TILE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Byte budgeted, least recently used cache of decoded raster tiles shared
+ * by all charts.
+ *
+ * Tiles are keyed by chart and tile column/row. Chart ids are handed out
+ * by GetChartId() for a chart file path and a version identifying its
+ * contents, so a chart closed and opened again finds its tiles while a
+ * changed file does not. Tiles are immutable and reference counted: an
+ * evicted tile stays valid as long as someone holds it.
+ *
+ * All methods are thread safe.
+ */
+class RasterTileCache {
+public:
+  using Tile = std::shared_ptr<const std::vector<uint8_t>>;
+
+  static const size_t kDefaultBudget = 128 * 1024 * 1024;
+
+  explicit RasterTileCache(size_t budget = kDefaultBudget)
+      : m_budget(budget) {}
+  RasterTileCache(const RasterTileCache&) = delete;
+  RasterTileCache& operator=(const RasterTileCache&) = delete;
+
+  /** Cache shared by all raster charts. */
+  static RasterTileCache& GetInstance();
+
+  /**
+   * Return id for chart file, the same id as long as the version is
+   * unchanged. A new version, typically the modification time, drops the
+   * tiles of the previous one and gets a new id.
+   */
+  uint32_t GetChartId(const std::string& path, int64_t version);
+
+  /** Return cached tile, or an empty pointer if not cached. */
+  Tile Get(uint32_t chart, int tx, int ty);
+
+  /**
+   * Add a decoded tile and evict the least recently used tiles until
+   * within budget. If the tile was added by another thread meanwhile, the
+   * existing tile is kept.
+   * @return The cached tile.
+   */
+  Tile Put(uint32_t chart, int tx, int ty, std::vector<uint8_t> data);
+
+  /** Drop all tiles of given chart. */
+  void Erase(uint32_t chart);
+
+  /** Drop all tiles and the id of given chart file, if any. */
+  void Erase(const std::string& path);
+
+  /**
+   * Return true unless chart's file has been erased or got a new version
+   * since the id was handed out. Charts then stop using data mapped from
+   * the file, which might be gone or rewritten.
+   */
+  bool IsCurrent(uint32_t chart) const;
+
+  /** Set budget in bytes, evicting tiles if needed. */
+  void SetBudget(size_t budget);
+
+  size_t GetBudget() const;
+
+  /** Return total size of cached tiles in bytes. */
+  size_t GetUsed() const;
+
+  /** Return number of cached tiles. */
+  size_t GetCount() const;
+
+  /** Return number of Get() calls finding a tile. */
+  uint64_t GetHits() const;
+
+  /** Return number of Get() calls not finding a tile. */
+  uint64_t GetMisses() const;
+
+private:
+  using Key = uint64_t;
+
+  struct Entry {
+    Tile tile;
+    std::list<Key>::iterator lru;
+  };
+
+  struct ChartId {
+    int64_t version;
+    uint32_t id;
+  };
+
+  static Key MakeKey(uint32_t chart, int tx, int ty);
+
+  /** Drop all tiles of given chart, lock held by caller. */
+  void EraseTiles(uint32_t chart);
+
+  /** Evict tiles until within budget, keeping the most recent one. */
+  void Enforce();
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<Key, Entry> m_entries;
+  std::list<Key> m_lru;  ///< Most recently used first
+  std::unordered_map<std::string, ChartId> m_charts;
+  std::unordered_set<uint32_t> m_current;  ///< Ids in m_charts
+  uint32_t m_next_id = 1;
+  size_t m_budget;
+  size_t m_used = 0;
+  uint64_t m_hits = 0;
+  uint64_t m_misses = 0;
+};
+
+#endif  // RASTER_TILE_CACHE_H_
@@ -25,6 +25,7 @@
 #define SELECT_H_
 
 #include "select_item.h"
+#include "model/select_index.h"
 
 #include "model/track.h"
 #include "model/route.h"
@@ -97,6 +98,9 @@ public:
   bool DeleteSelectablePoint(void *data, int SeltypeToDelete);
   bool ModifySelectablePoint(float slat, float slon, void *data, int fseltype);
 
+  /** Move a point item, keeping the spatial index in sync. */
+  void ModifySelectableItem(SelectItem *item, float slat, float slon);
+
   //    Delete all selectable points in list by type
   bool DeleteAllSelectableTypePoints(int SeltypeToDelete);
 
@@ -110,7 +114,14 @@ private:
   // FIXME (leamas?) this is not model stuff.
   void CalcSelectRadius(SelectCtx &ctx);
 
+  /** Add item to pSelectList and m_index. */
+  void AddItem(SelectItem *item, bool at_front);
+
+  /** Remove item from m_index and delete it. */
+  void DeleteItem(SelectItem *item);
+
   SelectableItemList *pSelectList;
+  SelectIndex m_index;
   int pixelRadius;
   float selectRadius;
 };
@@ -0,0 +1,131 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Spatial index over SelectItem objects, used by Select.
+ */
+
+#ifndef SELECT_INDEX_H_
+#define SELECT_INDEX_H_
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "model/select_item.h"
+
+/**
+ * Hierarchical, loose grid index over SelectItem bounding boxes, one grid
+ * for each selection type.
+ *
+ * Each item is stored in exactly one cell: on the finest level where the
+ * cell size is larger than the item's extent, in the cell holding the
+ * bounding box's lower left corner. An item thus covers at most 2x2 cells
+ * on its level. Items larger than the coarsest cells, including segments
+ * crossing the antimeridian, are kept in a separate list which is always
+ * part of the query result.
+ *
+ * Items also carry a sequence number reflecting their position in the
+ * Select list so that queries can return candidates in list order.
+ */
+class SelectIndex {
+public:
+  SelectIndex();
+
+  /**
+   * Add item to index using current coordinates.
+   * @param at_front If true, item is ordered before all existing items
+   *                 of the same type, otherwise after.
+   */
+  void Insert(SelectItem* item, bool at_front);
+
+  /** Remove item from index, no-op if not indexed. */
+  void Remove(const SelectItem* item);
+
+  /** Update index after item's coordinates are modified. */
+  void Update(SelectItem* item);
+
+  /** Return true if item is indexed. */
+  bool Contains(const SelectItem* item) const;
+
+  /**
+   * Return items of given type whose bounding box is within radius
+   * degrees of (lat, lon), in Select list order. Result is a superset of
+   * the actually selected items.
+   */
+  std::vector<SelectItem*> Query(float lat, float lon, float radius,
+                                 int seltype) const;
+
+  /** Remove all items. */
+  void Clear();
+
+  /** Return number of indexed items. */
+  size_t Size() const { return m_locations.size(); }
+
+  /** Number of levels, each with 4 x cell size of previous. */
+  static const int kLevels = 8;
+
+  /** Cell size in degrees at level 0. */
+  static constexpr float kBaseCellSize = 0.005f;
+
+private:
+  struct Box {
+    float lat_min;
+    float lat_max;
+    float lon_min;
+    float lon_max;
+  };
+
+  struct Entry {
+    SelectItem* item;
+    int64_t seq;
+  };
+
+  using CellMap = std::unordered_map<uint64_t, std::vector<Entry>>;
+
+  struct Grid {
+    std::array<CellMap, kLevels> levels;
+    std::vector<Entry> oversized;
+  };
+
+  /** Where an item is stored, level == -1 means Grid.oversized. */
+  struct Location {
+    int seltype;
+    int level;
+    uint64_t cell;
+    int64_t seq;
+  };
+
+  static Box GetBox(const SelectItem* item);
+  static uint64_t CellKey(int ix, int iy);
+  static float CellSize(int level);
+
+  void DoInsert(SelectItem* item, int64_t seq);
+
+  void QueryBox(const Grid& grid, const Box& box,
+                std::vector<Entry>& result) const;
+
+  std::unordered_map<int, Grid> m_grids;
+  std::unordered_map<const SelectItem*, Location> m_locations;
+  int64_t m_front_seq;
+  int64_t m_back_seq;
+};
+
+#endif  // SELECT_INDEX_H_
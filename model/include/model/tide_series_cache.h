@@ -0,0 +1,127 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Precomputed tide and current time series.
+ */
+
+#ifndef TIDE_SERIES_CACHE_H_
+#define TIDE_SERIES_CACHE_H_
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "model/worker_pool.h"
+
+/**
+ * Per station ring of tide level or current speed samples at fixed
+ * intervals, covering a window around a centre time. Samples are computed
+ * by a background thread and linearly interpolated by Get().
+ *
+ * Each station's window follows the queries: when a query is more than
+ * half a span from the centre the window is moved, keeping the samples
+ * still inside it and computing the missing ones. SetCentre() moves all
+ * windows at once, e.g. when the time source changes.
+ *
+ * All methods are thread safe. The evaluator is invoked from the worker
+ * thread only, without any lock held.
+ */
+class TideSeriesCache {
+public:
+  /**
+   * Compute count samples of station idx at times t0, t0 + step, ...
+   * @return false if station data is unavailable.
+   */
+  using Evaluator = std::function<bool(time_t t0, int step, int count,
+                                       int idx, std::vector<float>& values)>;
+
+  /**
+   * @param span Window half width, seconds.
+   * @param step Sample interval, seconds.
+   */
+  TideSeriesCache(Evaluator evaluator, int span = 3 * 24 * 3600,
+                  int step = 6 * 60);
+
+  ~TideSeriesCache();
+
+  TideSeriesCache(const TideSeriesCache&) = delete;
+  TideSeriesCache& operator=(const TideSeriesCache&) = delete;
+
+  /**
+   * Look up interpolated value of station idx at time t. On miss, the
+   * samples are scheduled for computation.
+   * @return true if value is set, false if not (yet) available.
+   */
+  bool Get(int idx, time_t t, float& value);
+
+  /** Move the window of all stations to given centre. */
+  void SetCentre(time_t t);
+
+  /** Drop all samples, e.g. after loading new harmonics data. */
+  void Clear();
+
+  /** Block until no samples are being computed. */
+  void WaitIdle();
+
+  int GetStep() const { return m_step; }
+
+  /** Number of samples computed per job, one day at default step. */
+  static const int kChunk = 240;
+
+private:
+  struct Series {
+    int64_t centre;       ///< Slot in window centre
+    int64_t valid_begin;  ///< First computed slot
+    int64_t valid_end;    ///< Slot after last computed one
+    std::vector<float> ring;
+    bool queued = false;  ///< Fill job posted
+    bool failed = false;  ///< Evaluator returned false
+  };
+
+  int64_t Slot(time_t t) const;
+
+  static size_t RingIndex(const Series& series, int64_t slot);
+
+  /** Return series for idx, creating it if needed. Requires m_mutex. */
+  Series& GetSeries(int idx, int64_t slot);
+
+  /** Move window if slot is too far from centre. Requires m_mutex. */
+  void Recentre(Series& series, int64_t slot);
+
+  /** Post fill job unless complete or queued. Requires m_mutex. */
+  void Schedule(int idx, Series& series);
+
+  /** Compute next chunk of samples for station idx. */
+  void Fill(int idx, uint64_t generation);
+
+  const Evaluator m_evaluator;
+  const int m_step;
+  const int64_t m_half;  ///< Window half width, slots
+  std::mutex m_mutex;
+  std::unordered_map<int, Series> m_series;
+  uint64_t m_generation;  ///< Incremented by Clear()
+  bool m_stopping;
+  WorkerPool m_pool;  ///< Last member, stopped first
+};
+
+#endif  // TIDE_SERIES_CACHE_H_
@@ -29,10 +29,12 @@
 
 #include <deque>
 #include <list>
+#include <string>
 #include <vector>
 
 #include "model/datetime.h"
 #include "model/route.h"
+#include "model/track_lod.h"
 #include "bbox.h"
 #include "hyperlink.h"
 #include "route.h"
@@ -121,7 +123,15 @@ public:
   Track();
   virtual ~Track();
 
-  int GetnPoints(void) { return TrackPoints.size(); }
+  int GetnPoints(void) {
+    if (m_paged_out) PageIn();
+    return TrackPoints.size();
+  }
+
+  /** Return number of points like GetnPoints(), without paging in. */
+  int GetPointCount() const {
+    return m_paged_out ? m_paged_points : static_cast<int>(TrackPoints.size());
+  }
 
   void SetVisible(bool visible = true) { m_bVisible = visible; }
   TrackPoint *GetPoint(int nWhichPoint);
@@ -140,11 +150,54 @@ public:
   void SetCurrentTrackSeg(int seg) { m_CurrentTrackSeg = seg; }
 
   double Length();
+
+  /** Distance between two consecutive points as summed by Length(). */
+  static double LegLength(double from_lat, double from_lon, double to_lat,
+                          double to_lon);
   int Simplify(double maxDelta);
   Route *RouteFromTrack(wxGenericProgressDialog *pprog);
 
   void ClearHighlights();
 
+  /**
+   * Make this a track whose points are stored in navobj.db but not
+   * loaded. The points are paged in on demand by all point accessors,
+   * and paged out again by EnforcePageBudget() when not used.
+   * @param extent Bounding box of all points.
+   * @param start_time Timestamp of first point, used for unnamed tracks.
+   * @param points Number of points, returned by GetPointCount().
+   * @param length Length() of all points, < 0 if unknown.
+   */
+  void SetPagedOut(const LLBBox &extent, const std::string &start_time,
+                   int points, double length);
+
+  /** Drop the points of a track set up by SetPagedOut(). */
+  void PageOut();
+
+  bool IsPagedOut() const { return m_paged_out; }
+
+  /** Return true if points are loaded on demand, see SetPagedOut(). */
+  bool IsPageable() const { return m_pageable; }
+
+  /** Bounding box of all points, only valid if IsPageable(). */
+  const LLBBox &GetExtent() const { return m_extent; }
+
+  /**
+   * Page out least recently drawn tracks until the number of loaded
+   * points is within the configured budget.
+   */
+  static void EnforcePageBudget();
+
+  /**
+   * Return simplified pyramid used to render the track at small scales,
+   * brought up to date with the points. Does not page in, but returns
+   * nullptr for short tracks and paged out tracks without a pyramid.
+   */
+  const TrackLod *GetLod();
+
+  /** Restore pyramid saved by NavObj_dB::SaveTrackLod(). */
+  void SetLod(const void *data, size_t size);
+
   /* Return the name of the track, or the start date/time of the track if no
    * name has been set. */
   wxString GetName(bool auto_if_empty = false) const {
@@ -201,8 +254,11 @@ protected:
 
   std::vector<TrackPoint *> TrackPoints;
   std::vector<std::vector<SubTrack> > SubTracks;
+  TrackLod m_lod;
 
 private:
+  void PageIn();
+  void KeepResident();
   void Finalize();
   double ComputeScale(int left, int right);
   void InsertSubTracks(LLBBox &box, int level, int pos);
@@ -218,6 +274,14 @@ private:
   //                pos);
   //
   wxString m_TrackNameString;
+
+  bool m_pageable;
+  bool m_paged_out;
+  LLBBox m_extent;
+  std::string m_paged_start;
+  double m_paged_length;  ///< Length() when paged out, < 0 if unknown
+  int m_paged_points;     ///< Number of points when paged out
+  size_t m_lod_saved;     ///< Number of points in last saved m_lod
 };
 
 class Route;
@@ -0,0 +1,156 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Multi-resolution, simplified representations of a track.
+ */
+
+#ifndef TRACK_LOD_H_
+#define TRACK_LOD_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Pyramid of increasingly simplified versions of a track used to render
+ * long tracks at small scales.
+ *
+ * Each level is a Douglas-Peucker reduction of the level below it, the
+ * first level is a reduction of the raw track points. The tolerance grows
+ * by a factor four per level. Rendering a level thus costs roughly the
+ * number of pixels covered by the track rather than the number of points.
+ *
+ * The pyramid is append only and maintained incrementally: points are
+ * reduced in chunks of kChunk points as they are appended, the end of
+ * each chunk is always kept. Points not yet reduced on a level are
+ * represented by the finer levels below it, see Visit().
+ *
+ * Distances are measured in the projected meters used by the mercator
+ * canvas projection, so that a tolerance can be compared directly to
+ * 1 / view_scale_ppm i. e., one pixel.
+ */
+class TrackLod {
+public:
+  static constexpr int kLevels = 10;
+  static constexpr size_t kChunk = 256;
+  static constexpr size_t kBlock = 64;
+  static constexpr double kTolerance = 10.0;  ///< Level 0, meters
+
+  struct Point {
+    double lat;
+    double lon;
+    uint32_t index;  ///< Index of the original track point
+  };
+
+  struct Extent {
+    double lat_min;
+    double lat_max;
+    double lon_min;
+    double lon_max;
+  };
+
+  TrackLod() { Clear(); }
+
+  void Clear();
+
+  /** Append next track point, reducing completed chunks. */
+  void Append(double lat, double lon);
+
+  /** Return number of appended points. */
+  size_t GetCount() const { return m_count; }
+
+  /** Return maximum distance between a level and the original track. */
+  double GetError(int level) const { return m_levels[level].error; }
+
+  /** Return number of reduced points in a level. */
+  size_t GetSize(int level) const { return m_levels[level].points.size(); }
+
+  /**
+   * Return coarsest level where no track point deviates more than
+   * max_error from the level, or -1 if there is no such level.
+   */
+  int SelectLevel(double max_error) const;
+
+  /**
+   * Visit the points of given level in track order, including the end of
+   * the track not yet reduced into the level, which is reduced on the fly.
+   *
+   * Blocks of kBlock segments for which visible(const Extent&) returns
+   * false are skipped.
+   * @param f Invoked as f(const Point&, bool first) where first is true
+   *   for the first point in each run of connected points.
+   */
+  template <typename V, typename F>
+  void Visit(int level, V&& visible, F&& f) const {
+    const Level& l = m_levels[level];
+    bool run = false;
+    for (size_t b = 0; b < l.blocks.size(); b++) {
+      if (!visible(l.blocks[b])) {
+        run = false;
+        continue;
+      }
+      size_t first = b * kBlock;
+      size_t last = std::min(first + kBlock, l.points.size() - 1);
+      for (size_t i = run ? first + 1 : first; i <= last; i++) {
+        f(l.points[i], !run);
+        run = true;
+      }
+    }
+    if (m_count == 0) return;
+    std::vector<Point> tail;
+    GetTail(level, tail);
+    for (size_t i = run ? 1 : 0; i < tail.size(); i++) {
+      f(tail[i], !run);
+      run = true;
+    }
+  }
+
+  /** Store complete state in a host byte order blob. */
+  std::vector<uint8_t> Serialize() const;
+
+  /**
+   * Restore state stored by Serialize().
+   * @return false and cleared state if data is invalid or outdated.
+   */
+  bool Deserialize(const void* data, size_t size);
+
+private:
+  struct Level {
+    double tolerance;
+    double error;
+    size_t source;  ///< Position of last point in level below
+    std::vector<Point> points;
+    std::vector<Extent> blocks;  ///< Extent of each kBlock segments
+  };
+
+  void Commit(Level& level, const Point& point);
+  void Reduce(const std::vector<Point>& from, size_t first, Level& to);
+
+  /** Return the end of the track from the last point in given level. */
+  void GetTail(int level, std::vector<Point>& tail) const;
+
+  size_t m_count;
+  Level m_levels[kLevels];
+  std::vector<Point> m_raw;    ///< Points not yet reduced into level 0
+  std::vector<uint8_t> m_keep;  ///< Scratch buffer for Reduce()
+};
+
+#endif  // TRACK_LOD_H_
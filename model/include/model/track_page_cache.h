@@ -0,0 +1,107 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Least recently used set of tracks with points paged in from navobj.db.
+ */
+
+#ifndef TRACK_PAGE_CACHE_H_
+#define TRACK_PAGE_CACHE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * Book keeping of tracks whose points are loaded on demand.
+ *
+ * A track is added when its points are paged in and touched whenever it
+ * is drawn. Enforce() pages out tracks least recently drawn first until
+ * the total number of loaded points is within budget. Tracks drawn
+ * recently or pinned, typically while shown in a dialog, are never paged
+ * out.
+ *
+ * Not thread safe, used from the GUI thread only.
+ */
+class TrackPageCache {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Key = const void*;
+
+  /**
+   * Page out the track. The entry is already removed when called, so a
+   * Remove() from the evictor is harmless.
+   */
+  using Evictor = std::function<void()>;
+
+  TrackPageCache() = default;
+  TrackPageCache(const TrackPageCache&) = delete;
+  TrackPageCache& operator=(const TrackPageCache&) = delete;
+
+  /** Cache shared by all tracks. */
+  static TrackPageCache& GetInstance();
+
+  /** Add track with given number of loaded points, regarded as touched. */
+  void Add(Key key, size_t points, Evictor evictor,
+           Clock::time_point now = Clock::now());
+
+  /** Mark track as used. Unknown keys are ignored. */
+  void Touch(Key key, Clock::time_point now = Clock::now());
+
+  /** Remove paged out track, pins are kept. Unknown keys are ignored. */
+  void Remove(Key key);
+
+  /** Set or clear pin protecting a track, also when not yet added. */
+  void SetPinned(Key key, bool pinned);
+
+  bool Contains(Key key) const { return m_entries.count(key) != 0; }
+
+  /** Return total number of loaded points. */
+  size_t GetPoints() const { return m_points; }
+
+  /** Return number of tracks added. */
+  size_t GetCount() const { return m_entries.size(); }
+
+  /**
+   * Page out least recently used tracks until at most budget points are
+   * loaded.
+   * @param keep Tracks touched this recently are never paged out.
+   * @return Number of points paged out.
+   */
+  size_t Enforce(size_t budget, std::chrono::milliseconds keep,
+                 Clock::time_point now = Clock::now());
+
+private:
+  struct Entry {
+    size_t points;
+    Clock::time_point touched;
+    Evictor evictor;
+    std::list<Key>::iterator lru;
+  };
+
+  std::unordered_map<Key, Entry> m_entries;
+  std::list<Key> m_lru;  ///< Most recently touched first
+  std::unordered_set<Key> m_pinned;
+  size_t m_points = 0;
+};
+
+#endif  // TRACK_PAGE_CACHE_H_
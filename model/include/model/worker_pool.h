@@ -0,0 +1,96 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Pure C++17 fixed size thread pool.
+ */
+
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of threads running jobs posted using Post(). Jobs are run in
+ * fifo order. The destructor runs all pending jobs and joins the threads.
+ */
+class WorkerPool {
+public:
+  using Job = std::function<void()>;
+
+  /**
+   * Create pool.
+   * @param threads  Number of worker threads, 0 means one per hardware
+   *                 thread.
+   */
+  explicit WorkerPool(unsigned threads = 0);
+
+  virtual ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /** Process-wide pool with one thread per hardware thread. */
+  static WorkerPool& GetShared();
+
+  /** Queue job for execution by a worker thread. */
+  void Post(Job job);
+
+  /**
+   * Run func(begin, end) over [0, count) split in chunks, using the
+   * calling thread as one of the workers. Blocks until all chunks are
+   * done. Must not be invoked from a job running in the same pool.
+   */
+  void ParallelFor(size_t count,
+                   const std::function<void(size_t, size_t)>& func);
+
+  /**
+   * Block until no jobs are queued or running. Must not be invoked from
+   * a job running in the same pool.
+   */
+  void WaitIdle();
+
+  /** Return true if invoked from one of this pool's worker threads. */
+  bool IsWorkerThread() const;
+
+  /** Return number of worker threads. */
+  unsigned Size() const { return static_cast<unsigned>(m_threads.size()); }
+
+  /** Return number of queued, not yet started jobs. */
+  size_t Pending() const;
+
+private:
+  void Worker();
+
+  std::vector<std::thread> m_threads;
+  std::deque<Job> m_jobs;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_job_cv;
+  std::condition_variable m_idle_cv;
+  unsigned m_running;
+  bool m_stop;
+};
+
+#endif  // WORKER_POOL_H_
@@ -21,16 +21,44 @@
  * Implement ais_bitstring.h -- AIS use bitstring.
  */
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 
 #include "model/ais_bitstring.h"
 
-AisBitstring::AisBitstring(const char *str) {
-  byte_length = strlen(str);
+namespace {
+
+/** IEC 6 bit value of all characters, 0xff for invalid ones. */
+struct SixBitTable {
+  unsigned char value[256];
+
+  constexpr SixBitTable() : value() {
+    for (int c = 0; c < 256; c++) {
+      if (c < 0x30 || c > 0x77 || (0x57 < c && c < 0x60)) {
+        value[c] = 0xff;
+        continue;
+      }
+      unsigned char cp = static_cast<unsigned char>(c + 0x28);
+      cp += cp > 0x80 ? 0x20 : 0x28;
+      value[c] = cp & 0x3f;
+    }
+  }
+};
+
+constexpr SixBitTable kSixBit;
 
+}  // namespace
+
+AisBitstring::AisBitstring(const char *str)
+    : AisBitstring(str, strlen(str)) {}
+
+AisBitstring::AisBitstring(const char *str, size_t len) {
+  byte_length = static_cast<int>(std::min(len, size_t(AIS_MAX_MESSAGE_LEN)));
   for (int i = 0; i < byte_length; i++) {
-    bitbytes[i] = to_6bit(str[i]);
+    bitbytes[i] = kSixBit.value[static_cast<unsigned char>(str[i])];
   }
+  memset(bitbytes + byte_length, 0, AIS_MAX_MESSAGE_LEN - byte_length);
 }
 
 int AisBitstring::GetBitCount() { return byte_length * 6; }
@@ -38,71 +66,47 @@ int AisBitstring::GetBitCount() { return byte_length * 6; }
 //  Convert printable characters to IEC 6 bit representation
 //  according to rules in IEC AIS Specification
 unsigned char AisBitstring::to_6bit(const char c) {
-  if (c < 0x30) return (unsigned char)-1;
-  if (c > 0x77) return (unsigned char)-1;
-  if ((0x57 < c) && (c < 0x60)) return (unsigned char)-1;
-
-  unsigned char cp = c;
-  cp += 0x28;
-
-  if (cp > 0x80)
-    cp += 0x20;
-  else
-    cp += 0x28;
-
-  return (unsigned char)(cp & 0x3f);
+  return kSixBit.value[static_cast<unsigned char>(c)];
 }
 
 int AisBitstring::GetInt(int sp, int len, bool signed_flag) {
-  int acc = 0;
+  if (len <= 0) return 0;
   int s0p = sp - 1;  // to zero base
-
-  int cp, cx, c0;
-
-  for (int i = 0; i < len; i++) {
-    acc = acc << 1;
-    cp = (s0p + i) / 6;
-    cx = bitbytes[cp];  // what if cp >= byte_length?
-    c0 = (cx >> (5 - ((s0p + i) % 6))) & 1;
-    if (i == 0 && signed_flag &&
-        c0)  // if signed value and first bit is 1, pad with 1's
-      acc = ~acc;
-    acc |= c0;
+  int last = (s0p + len - 1) / 6;
+  if (s0p < 0 || len > 32 || last >= AIS_MAX_MESSAGE_LEN) {
+    // Out of range, handle bit by bit.
+    uint32_t acc = 0;
+    for (int i = 0; i < len; i++) {
+      int cp = (s0p + i) / 6;
+      int cx = cp >= 0 && cp < AIS_MAX_MESSAGE_LEN ? bitbytes[cp] : 0;
+      uint32_t c0 = (cx >> (5 - ((s0p + i) % 6))) & 1;
+      // if signed value and first bit is 1, pad with 1's
+      if (i == 0 && signed_flag && c0) acc = ~acc;
+      acc = (acc << 1) | c0;
+    }
+    return static_cast<int>(acc);
   }
-
-  return acc;
+  // Collect the at most 7 characters covering the field, then shift and
+  // mask it out.
+  uint64_t acc = 0;
+  for (int cp = s0p / 6; cp <= last; cp++) {
+    acc = (acc << 6) | (bitbytes[cp] & 0x3f);
+  }
+  acc >>= 5 - (s0p + len - 1) % 6;
+  const uint64_t mask = (uint64_t(1) << len) - 1;
+  acc &= mask;
+  if (signed_flag && (acc >> (len - 1)) & 1) acc |= ~mask;
+  return static_cast<int>(static_cast<uint32_t>(acc));
 }
 
 int AisBitstring::GetStr(int sp, int bit_len, char *dest, int max_len) {
-  // char temp_str[85];
-  char *temp_str = dest;
-
-  char acc = 0;
-  int s0p = sp - 1;  // to zero base
-
   int k = 0;
-  int cp, cx, c0, cs;
-
-  int i = 0;
-  while (i < bit_len && k < max_len) {
-    acc = 0;
-    for (int j = 0; j < 6; j++) {
-      acc = acc << 1;
-      cp = (s0p + i) / 6;
-      cx = bitbytes[cp];  // what if cp >= byte_length?
-      cs = 5 - ((s0p + i) % 6);
-      c0 = (cx >> cs) & 1;
-      acc |= c0;
-
-      i++;
-    }
-    temp_str[k] = (char)(acc & 0x3f);
-
-    if (acc < 32) temp_str[k] += 0x40;
+  for (int i = 0; i < bit_len && k < max_len; i += 6) {
+    char acc = static_cast<char>(GetInt(sp + i, 6));
+    dest[k] = acc;
+    if (acc < 32) dest[k] += 0x40;
     k++;
   }
-
-  temp_str[k] = 0;
-
+  dest[k] = 0;
   return k;
 }
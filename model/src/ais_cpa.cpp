@@ -0,0 +1,215 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement ais_cpa.h -- CPA/TCPA computation
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "model/ais_cpa.h"
+#include "model/georef.h"
+#include "model/worker_pool.h"
+
+/** Bits in AisCpaBatch::m_state. */
+enum CpaState : uint8_t { kHasCpa = 1, kValid = 2, kExact = 4 };
+
+bool CpaReach::Contains(double range_nm, double own_sog, double sog) const {
+  if (!(range_nm <= range_max_nm)) return false;
+  if (tcpa_max_h == kNone) return true;
+  // Closing speed is at most the sum of speeds. Allow some slack for the
+  // difference between the mercator range and great circle CPA.
+  double reach = warn_nm + (own_sog + sog) * tcpa_max_h;
+  return range_nm <= reach * 1.01 + 0.1;
+}
+
+void ComputeCpa(const CpaOwnShip& own, double lat, double lon, double cog,
+                double sog, uint8_t flags, const CpaReach& reach,
+                CpaResult& result) {
+  result = CpaResult();
+
+  //    Compute the current Range/Brg to the target. This should always be
+  //    possible even if GPS data is not valid, plugins need it.
+  double brg, dist;
+  DistanceBearingMercator(lat, lon, own.lat, own.lon, &brg, &dist);
+  result.range_nm = dist;
+  result.brg = brg;
+  if (dist <= 1e-5) result.brg = -1.0;  // Brg is undefined if Range == 0.
+
+  if (!(flags & kCpaPositionValid) || !own.valid) return;
+
+  //  Ais Meteo is not a hard target in danger for collision
+  if (flags & kCpaMeteo) return;
+
+  //    There can be no collision between ownship and itself. This happens
+  //    when AIVDO messages are received besides another position source.
+  if (flags & kCpaOwnShip) {
+    result.cpa = 100;
+    result.tcpa = -100;
+    result.has_cpa = true;
+    return;
+  }
+
+  double cpa_calc_ownship_cog = own.cog;
+  double cpa_calc_target_cog = cog;
+
+  //    Ownship is not reporting valid SOG, so no way to calculate CPA
+  if (std::isnan(own.sog) || (own.sog > 102.2)) return;
+
+  //    Ownship is maybe anchored and not reporting COG
+  if (std::isnan(own.cog) || own.cog == 360.0) {
+    if (!(own.sog < .01)) return;
+    cpa_calc_ownship_cog = 0.;  // substitute value when SOG ~= 0
+  }
+
+  //    Target is maybe anchored and not reporting COG
+  if (cog == 360.0) {
+    if (!(sog < .01)) return;  // Includes unknown SOG, > 102.2
+    cpa_calc_target_cog = 0.;  // substitute value when SOG ~= 0
+  }
+
+  //    Express the SOGs as meters per hour
+  double v0 = own.sog * 1852.;
+  double v1 = sog * 1852.;
+
+  result.has_cpa = true;
+  if ((v0 < 1e-6) && (v1 < 1e-6)) {
+    result.tcpa = 0.;
+    result.cpa = 0.;
+    return;
+  }
+
+  //    Working on a Reduced Lat/Lon orthogonal plotting sheet....
+  //    Get easting/northing to target,  in meters
+  double east1 = (lon - own.lon) * 60 * 1852;
+  double north1 = (lat - own.lat) * 60 * 1852;
+  double east = east1 * (cos(own.lat * PI / 180.));
+  double north = north1;
+
+  //    Convert COGs trigonometry to standard unit circle
+  double cosa = cos((90. - cpa_calc_ownship_cog) * PI / 180.);
+  double sina = sin((90. - cpa_calc_ownship_cog) * PI / 180.);
+  double cosb = cos((90. - cpa_calc_target_cog) * PI / 180.);
+  double sinb = sin((90. - cpa_calc_target_cog) * PI / 180.);
+
+  //    These will be useful
+  double fc = (v0 * cosa) - (v1 * cosb);
+  double fs = (v0 * sina) - (v1 * sinb);
+
+  double d = (fc * fc) + (fs * fs);
+  double tcpa;
+
+  // the tracks are almost parallel
+  if (fabs(d) < 1e-6)
+    tcpa = 0.;
+  else
+    //    Here is the equation for t, which will be in hours
+    tcpa = ((fc * east) + (fs * north)) / d;
+
+  //    Convert to minutes
+  result.tcpa = tcpa * 60.;
+
+  result.exact = reach.Contains(dist, own.sog, sog);
+  if (result.exact) {
+    //    Using TCPA, predict ownship and target positions
+    double OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA, TargetLonCPA;
+    ll_gc_ll(own.lat, own.lon, cpa_calc_ownship_cog, own.sog * tcpa,
+             &OwnshipLatCPA, &OwnshipLonCPA);
+    ll_gc_ll(lat, lon, cpa_calc_target_cog, sog * tcpa, &TargetLatCPA,
+             &TargetLonCPA);
+
+    //   And compute the distance
+    result.cpa = DistGreatCircle(OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA,
+                                 TargetLonCPA);
+  } else {
+    // Relative position at TCPA on the plotting sheet
+    double x = east - fc * tcpa;
+    double y = north - fs * tcpa;
+    result.cpa = sqrt(x * x + y * y) / 1852.;
+  }
+  result.valid = !(result.tcpa < 0);
+}
+
+void AisCpaBatch::Clear() {
+  m_lat.clear();
+  m_lon.clear();
+  m_cog.clear();
+  m_sog.clear();
+  m_flags.clear();
+}
+
+size_t AisCpaBatch::Add(double lat, double lon, double cog, double sog,
+                        uint8_t flags) {
+  m_lat.push_back(lat);
+  m_lon.push_back(lon);
+  m_cog.push_back(cog);
+  m_sog.push_back(sog);
+  m_flags.push_back(flags);
+  return m_lat.size() - 1;
+}
+
+void AisCpaBatch::Compute(const CpaOwnShip& own, const CpaReach& reach,
+                          WorkerPool* pool) {
+  const size_t size = Size();
+  m_range.resize(size);
+  m_brg.resize(size);
+  m_cpa.resize(size);
+  m_tcpa.resize(size);
+  m_state.resize(size);
+  if (!pool || size < kMinParallel) {
+    ComputeRange(own, reach, 0, size);
+    return;
+  }
+  pool->ParallelFor(size, [&](size_t begin, size_t end) {
+    ComputeRange(own, reach, begin, end);
+  });
+}
+
+void AisCpaBatch::ComputeRange(const CpaOwnShip& own, const CpaReach& reach,
+                               size_t begin, size_t end) {
+  CpaResult result;
+  for (size_t i = begin; i < end; i++) {
+    ComputeCpa(own, m_lat[i], m_lon[i], m_cog[i], m_sog[i], m_flags[i],
+               reach, result);
+    m_range[i] = result.range_nm;
+    m_brg[i] = result.brg;
+    m_cpa[i] = result.cpa;
+    m_tcpa[i] = result.tcpa;
+    m_state[i] = (result.has_cpa ? kHasCpa : 0) | (result.valid ? kValid : 0) |
+                 (result.exact ? kExact : 0);
+  }
+}
+
+CpaResult AisCpaBatch::GetResult(size_t index) const {
+  CpaResult result;
+  result.range_nm = m_range[index];
+  result.brg = m_brg[index];
+  result.cpa = m_cpa[index];
+  result.tcpa = m_tcpa[index];
+  result.has_cpa = m_state[index] & kHasCpa;
+  result.valid = m_state[index] & kValid;
+  result.exact = m_state[index] & kExact;
+  return result;
+}
+
+size_t AisCpaBatch::GetExactCount() const {
+  return std::count_if(m_state.begin(), m_state.end(),
+                       [](uint8_t state) { return state & kExact; });
+}
@@ -24,6 +24,7 @@
 // For compilers that support precompilation, includes "wx.h".
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <fstream>
 
@@ -52,10 +53,12 @@
 #include "rapidjson/writer.h"
 #include "rapidjson/stringbuffer.h"
 
+#include "model/ais_cpa.h"
 #include "model/ais_decoder.h"
 #include "model/ais_state_vars.h"
 #include "model/meteo_points.h"
 #include "model/ais_target_data.h"
+#include "model/ais_vdm.h"
 #include "model/comm_navmsg_bus.h"
 #include "model/config_vars.h"
 #include "model/geodesic.h"
@@ -67,6 +70,7 @@
 #include "model/route_point.h"
 #include "model/select.h"
 #include "model/track.h"
+#include "model/worker_pool.h"
 #include "N2KParser.h"
 
 #if !defined(NAN)
@@ -84,7 +88,6 @@ wxString AISTargetNameFileName;
 unsigned g_OwnShipmmsi;
 
 wxDEFINE_EVENT(EVT_N0183_VDO, ObservedEvt);
-wxDEFINE_EVENT(EVT_N0183_VDM, ObservedEvt);
 wxDEFINE_EVENT(EVT_N0183_FRPOS, ObservedEvt);
 wxDEFINE_EVENT(EVT_N0183_CDDSC, ObservedEvt);
 wxDEFINE_EVENT(EVT_N0183_CDDSE, ObservedEvt);
@@ -1274,6 +1277,8 @@ AisDecoder::AisDecoder(const AisDecoderCallbacks &callbacks)
 }
 
 AisDecoder::~AisDecoder() {
+  NavMsgBus::GetInstance().RemoveBatchListener(m_vdm_listener);
+
   //   for (const auto &it : GetTargetList()) {
   //     AisTargetData *td = it.second;
   //
@@ -1337,14 +1342,18 @@ void AisDecoder::InitCommListeners() {
   // Initialize the comm listeners
 
   // NMEA0183
-  // VDM
-  Nmea0183Msg n0183_msg_VDM("VDM");
-  listener_N0183_VDM.Listen(n0183_msg_VDM, this, EVT_N0183_VDM);
-  Bind(EVT_N0183_VDM, [&](const ObservedEvt &ev) {
-    auto ptr = ev.GetSharedPtr();
-    auto n0183_msg = std::static_pointer_cast<const Nmea0183Msg>(ptr);
-    HandleN0183_AIS(n0183_msg);
-  });
+  // VDM, the bulk of AIS traffic, handled in batches: one main loop call
+  // per tick instead of one event for each message.
+  const std::string vdm_key = Nmea0183Msg("VDM").GetKey();
+  m_vdm_listener = NavMsgBus::GetInstance().AddBatchListener(
+      [&, vdm_key](const NavMsgBatch &batch) {
+        for (const auto &msg : batch) {
+          if (msg->bus != NavAddr::Bus::N0183 || msg->GetKey() != vdm_key)
+            continue;
+          HandleN0183_AIS(std::static_pointer_cast<const Nmea0183Msg>(msg));
+        }
+      },
+      NavMsgDelivery::kGuiThread);
 
   // FRPOS
   Nmea0183Msg n0183_msg_FRPOS("FRPOS");
@@ -1476,9 +1485,13 @@ void AisDecoder::InitCommListeners() {
 }
 
 bool AisDecoder::HandleN0183_AIS(const N0183MsgPtr &n0183_msg) {
-  std::string str = n0183_msg->payload;
-  wxString sentence(str.c_str());
-  DecodeN0183(sentence);
+  const std::string &str = n0183_msg->payload;
+  if (str.size() > 5 && str.compare(3, 2, "VD") == 0) {
+    DecodeVdm(str);
+  } else {
+    wxString sentence(str.c_str());
+    DecodeN0183(sentence);
+  }
   touch_state.Notify();
   return true;
 }
@@ -3048,134 +3061,12 @@ AisError AisDecoder::DecodeN0183(const wxString &str) {
 
     //  Extract the MMSI
     if (!mmsi) mmsi = strbit.GetInt(9, 30);
-    long mmsi_long = mmsi;
 
-    // Ais8_001_31 || ais8_367_33 (class AIS_METEO) test for a new mmsi ID
-    int origin_mmsi = 0;
-    int messID = strbit.GetInt(1, 6);
-    int dac = strbit.GetInt(41, 10);
-    int fi = strbit.GetInt(51, 6);
-    if (messID == 8) {
-      int met_lon, met_lat;
-      if (dac == 001 && fi == 31) {
-        origin_mmsi = mmsi;
-        met_lon = strbit.GetInt(57, 25);
-        met_lat = strbit.GetInt(82, 24);
-        mmsi = AisMeteoNewMmsi(mmsi, met_lat, met_lon, 25, 0);
-        mmsi_long = mmsi;
-
-      } else if (dac == 367 && fi == 33) {  // ais8_367_33
-        // Check for a valid message size before further handling
-        const int size = strbit.GetBitCount();
-        if (size < 168) return AIS_GENERIC_ERROR;
-        const int startb = 56;
-        const int slot_size = 112;
-        const int extra_bits = (size - startb) % slot_size;
-        if (extra_bits > 0) return AIS_GENERIC_ERROR;
-
-        int mes_type = strbit.GetInt(57, 4);
-        int site_ID = strbit.GetInt(77, 7);
-        if (mes_type == 0) {  // Location
-          origin_mmsi = mmsi;
-          met_lon = strbit.GetInt(90, 28);
-          met_lat = strbit.GetInt(118, 27);
-          mmsi = AisMeteoNewMmsi(mmsi, met_lat, met_lon, 28, site_ID);
-          mmsi_long = mmsi;
-        } else {  // Other messsage types without position.
-          // We need a previously received type 0, position message
-          // to get use of any sensor report.
-          int x_mmsi = AisMeteoNewMmsi(mmsi, 91, 181, 0, site_ID);
-          if (x_mmsi) {
-            origin_mmsi = mmsi;
-            mmsi = x_mmsi;
-            mmsi_long = mmsi;
-          } else  // So far no use for this report.
-            return AIS_GENERIC_ERROR;
-        }
-      }
-    }
-
-    // Check for own ship mmsi. It's not a valid AIS target.
-    if (mmsi == g_OwnShipmmsi) return AIS_GENERIC_ERROR;
-
-    //  Search the current AISTargetList for an MMSI match
-    auto it = AISTargetList.find(mmsi);
-    if (it == AISTargetList.end())  // not found
-    {
-      pTargetData = AisTargetDataMaker::GetInstance().GetTargetData();
-      bnewtarget = true;
-      m_n_targets++;
-
-      if (origin_mmsi) {  // New mmsi allocated for a Meteo station
-        pTargetData->MMSI = mmsi;
-        pTargetData->met_data.original_mmsi = origin_mmsi;
-      }
-    } else {
-      pTargetData = it->second;  // find current entry
-
-      if (!bnewtarget)
-        pStaleTarget = pTargetData;  // save a pointer to stale data
-      if (origin_mmsi) {             // Meteo point
-        pTargetData->MMSI = mmsi;
-        pTargetData->met_data.original_mmsi = origin_mmsi;
-      }
-    }
-    for (unsigned int i = 0; i < g_MMSI_Props_Array.GetCount(); i++) {
-      MmsiProperties *props = g_MMSI_Props_Array[i];
-      if (mmsi == static_cast<unsigned>(props->MMSI)) {
-        // Check if this target has a dedicated tracktype
-        if (TRACKTYPE_NEVER == props->TrackType) {
-          pTargetData->b_show_track = false;
-        } else if (TRACKTYPE_ALWAYS == props->TrackType) {
-          pTargetData->b_show_track = true;
-        }
-
-        // Check to see if this MMSI has been configured to be ignored
-        // completely...
-        if (props->m_bignore) return AIS_NoError;
-        // Check to see if this MMSI wants VDM translated to VDO or whether we
-        // want to persist it's track...
-        else if (props->m_bVDM) {
-          // Only single line VDM messages to be translated
-          if (str.Mid(3, 9).IsSameAs("VDM,1,1,,")) {
-            int message_ID = strbit.GetInt(1, 6);  // Parse on message ID
-            // Only translate the dynamic positionreport messages (1, 2, 3 or
-            // 18)
-            if ((message_ID <= 3) || (message_ID == 18)) {
-              // set OwnShip to prevent target from being drawn
-              pTargetData->b_OwnShip = true;
-              // Rename nmea sentence to AIVDO and calc a new checksum
-              wxString aivdostr = str;
-              aivdostr.replace(1, 5, "AIVDO");
-              unsigned char calculated_checksum = 0;
-              wxString::iterator j;
-              for (j = aivdostr.begin() + 1; j != aivdostr.end() && *j != '*';
-                   ++j)
-                calculated_checksum ^= static_cast<unsigned char>(*j);
-              // if i is not at least 3 positons befoere end, there is no
-              // checksum added so also no need to add one now.
-              if (j <= aivdostr.end() - 3)
-                aivdostr.replace(
-                    j + 1, j + 3,
-                    wxString::Format(_("%02X"), calculated_checksum));
-
-              gps_watchdog_timeout_ticks =
-                  60;  // increase watchdog time up to 1 minute
-              // add the changed sentence into nmea message system
-              std::string full_sentence = aivdostr.ToStdString();
-              auto address = std::make_shared<NavAddr0183>("virtual");
-              // We notify based on full message, including the Talker ID
-              // Notify message listener
-              auto msg = std::make_shared<const Nmea0183Msg>(
-                  "AIVDO", full_sentence, address);
-              NavMsgBus::GetInstance().Notify(std::move(msg));
-            }
-          }
-          return AIS_NoError;
-        } else
-          break;
-      }
-    }
+    AisError result;
+    if (!PrepareAisTarget(strbit, str.ToStdString(), mmsi, pTargetData,
+                          pStaleTarget, bnewtarget, result))
+      return result;
+    long mmsi_long = mmsi;
 
     //  Grab the stale targets's last report time
     wxDateTime now = wxDateTime::Now();
@@ -3319,6 +3210,173 @@ AisError AisDecoder::DecodeN0183(const wxString &str) {
   return ret;
 }
 
+//----------------------------------------------------------------------------------------
+//      Target lookup common to DecodeN0183() and DecodeVdm()
+//----------------------------------------------------------------------------------------
+
+bool AisDecoder::PrepareAisTarget(AisBitstring &strbit,
+                                  std::string_view sentence, unsigned &mmsi,
+                                  std::shared_ptr<AisTargetData> &pTargetData,
+                                  std::shared_ptr<AisTargetData> &pStaleTarget,
+                                  bool &bnewtarget, AisError &result) {
+  result = AIS_NoError;
+
+  // Ais8_001_31 || ais8_367_33 (class AIS_METEO) test for a new mmsi ID
+  int origin_mmsi = 0;
+  int messID = strbit.GetInt(1, 6);
+  int dac = strbit.GetInt(41, 10);
+  int fi = strbit.GetInt(51, 6);
+  if (messID == 8) {
+    int met_lon, met_lat;
+    if (dac == 001 && fi == 31) {
+      origin_mmsi = mmsi;
+      met_lon = strbit.GetInt(57, 25);
+      met_lat = strbit.GetInt(82, 24);
+      mmsi = AisMeteoNewMmsi(mmsi, met_lat, met_lon, 25, 0);
+    } else if (dac == 367 && fi == 33) {  // ais8_367_33
+      // Check for a valid message size before further handling
+      result = AIS_GENERIC_ERROR;
+      const int size = strbit.GetBitCount();
+      if (size < 168) return false;
+      const int startb = 56;
+      const int slot_size = 112;
+      const int extra_bits = (size - startb) % slot_size;
+      if (extra_bits > 0) return false;
+
+      int mes_type = strbit.GetInt(57, 4);
+      int site_ID = strbit.GetInt(77, 7);
+      if (mes_type == 0) {  // Location
+        origin_mmsi = mmsi;
+        met_lon = strbit.GetInt(90, 28);
+        met_lat = strbit.GetInt(118, 27);
+        mmsi = AisMeteoNewMmsi(mmsi, met_lat, met_lon, 28, site_ID);
+      } else {  // Other messsage types without position.
+        // We need a previously received type 0, position message
+        // to get use of any sensor report.
+        int x_mmsi = AisMeteoNewMmsi(mmsi, 91, 181, 0, site_ID);
+        if (!x_mmsi) return false;  // So far no use for this report.
+        origin_mmsi = mmsi;
+        mmsi = x_mmsi;
+      }
+      result = AIS_NoError;
+    }
+  }
+
+  // Check for own ship mmsi. It's not a valid AIS target.
+  if (mmsi == g_OwnShipmmsi) {
+    result = AIS_GENERIC_ERROR;
+    return false;
+  }
+
+  //  Search the current AISTargetList for an MMSI match
+  auto it = AISTargetList.find(mmsi);
+  if (it == AISTargetList.end()) {
+    pTargetData = AisTargetDataMaker::GetInstance().GetTargetData();
+    bnewtarget = true;
+    m_n_targets++;
+  } else {
+    pTargetData = it->second;
+    pStaleTarget = pTargetData;  // save a pointer to stale data
+  }
+  if (origin_mmsi) {  // New mmsi allocated for a Meteo station
+    pTargetData->MMSI = mmsi;
+    pTargetData->met_data.original_mmsi = origin_mmsi;
+  }
+
+  for (unsigned int i = 0; i < g_MMSI_Props_Array.GetCount(); i++) {
+    MmsiProperties *props = g_MMSI_Props_Array[i];
+    if (mmsi != static_cast<unsigned>(props->MMSI)) continue;
+    // Check if this target has a dedicated tracktype
+    if (TRACKTYPE_NEVER == props->TrackType) {
+      pTargetData->b_show_track = false;
+    } else if (TRACKTYPE_ALWAYS == props->TrackType) {
+      pTargetData->b_show_track = true;
+    }
+
+    // Check to see if this MMSI has been configured to be ignored
+    // completely...
+    if (props->m_bignore) return false;
+    // Check to see if this MMSI wants VDM translated to VDO or whether we
+    // want to persist it's track...
+    if (props->m_bVDM) {
+      // Only translate single line dynamic position reports (1, 2, 3 or 18)
+      if (sentence.size() > 12 && sentence.substr(3, 9) == "VDM,1,1,," &&
+          (messID <= 3 || messID == 18)) {
+        // set OwnShip to prevent target from being drawn
+        pTargetData->b_OwnShip = true;
+        // Rename nmea sentence to AIVDO and calc a new checksum
+        std::string aivdo(sentence);
+        aivdo.replace(1, 5, "AIVDO");
+        unsigned char checksum = 0;
+        size_t j = 1;
+        for (; j < aivdo.size() && aivdo[j] != '*'; j++) checksum ^= aivdo[j];
+        // If j is not at least 3 positions before end, there is no
+        // checksum added so also no need to add one now.
+        if (j + 3 <= aivdo.size()) {
+          char hex[3];
+          snprintf(hex, sizeof(hex), "%02X", checksum);
+          aivdo.replace(j + 1, 2, hex);
+        }
+        gps_watchdog_timeout_ticks = 60;  // increase watchdog time to 1 min
+        // add the changed sentence into nmea message system
+        auto address = std::make_shared<NavAddr0183>("virtual");
+        auto msg =
+            std::make_shared<const Nmea0183Msg>("AIVDO", aivdo, address);
+        NavMsgBus::GetInstance().Notify(std::move(msg));
+      }
+      return false;
+    }
+    break;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------
+//      Decode a VDM/VDO sentence without wxString and tokenizer
+//----------------------------------------------------------------------------------------
+
+AisError AisDecoder::DecodeVdm(std::string_view sentence) {
+  if (sentence.size() > 128) return AIS_NMEAVDX_TOO_LONG;
+  if (!VdmChecksumOk(sentence)) return AIS_NMEAVDX_CHECKSUM_BAD;
+
+  AisVdmSentence vdm;
+  if (!ParseVdmSentence(sentence, vdm)) return AIS_NMEAVDX_BAD;
+  std::string_view payload = m_vdm_assembler.Add(vdm);
+  n_msgs++;
+  if (payload.empty()) return AIS_Partial;
+
+  AisBitstring strbit(payload.data(), payload.size());
+  unsigned mmsi = strbit.GetInt(9, 30);
+
+  std::shared_ptr<AisTargetData> pTargetData;
+  std::shared_ptr<AisTargetData> pStaleTarget;
+  bool bnewtarget = false;
+  AisError result;
+  if (!PrepareAisTarget(strbit, sentence, mmsi, pTargetData, pStaleTarget,
+                        bnewtarget, result))
+    return result;
+  long mmsi_long = mmsi;
+
+  wxDateTime now = wxDateTime::Now();
+  now.MakeGMT();
+  int last_report_ticks =
+      pStaleTarget ? pStaleTarget->PositionReportTicks : now.GetTicks();
+
+  // Delete the stale AIS Target selectable point
+  if (pStaleTarget)
+    pSelectAIS->DeleteSelectablePoint((void *)mmsi_long, SELTYPE_AISTARGET);
+
+  bool bdecode_result = Parse_VDXBitstring(&strbit, pTargetData);
+  getMmsiProperties(pTargetData);
+  pTargetData->RecentPeriod =
+      pTargetData->PositionReportTicks - last_report_ticks;
+
+  // As CommitAISTarget() does for a non-empty sentence.
+  pTargetData->b_OwnShip = vdm.own_ship;
+  CommitAISTarget(pTargetData, "", bdecode_result, bnewtarget);
+  return AIS_NoError;
+}
+
 void AisDecoder::CommitAISTarget(
     const std::shared_ptr<AisTargetData> &pTargetData, const wxString &str,
     bool message_valid, bool new_target) {
@@ -3765,13 +3823,64 @@ bool AisDecoder::NMEACheckSumOK(const wxString &str_in) {
   return false;
 }
 
+static CpaOwnShip GetCpaOwnShip() {
+  return CpaOwnShip{gLat, gLon, gCog, gSog, bGPSValid};
+}
+
+static uint8_t GetCpaFlags(const AisTargetData *td) {
+  uint8_t flags = 0;
+  if (td->b_positionOnceValid) flags |= kCpaPositionValid;
+  if (td->Class == AIS_METEO) flags |= kCpaMeteo;
+  if (td->b_OwnShip) flags |= kCpaOwnShip;
+  return flags;
+}
+
+static void ApplyCpa(AisTargetData *td, const CpaResult &result) {
+  td->Range_NM = result.range_nm;
+  td->Brg = result.brg;
+  if (result.has_cpa) {
+    td->CPA = result.cpa;
+    td->TCPA = result.tcpa;
+  }
+  td->bCPA_Valid = result.valid;
+}
+
+static double MillisSince(std::chrono::steady_clock::time_point start) {
+  using namespace std::chrono;
+  return duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
 void AisDecoder::UpdateAllCPA() {
-  //    Iterate thru all the targets
+  // Snapshot the kinematics, compute in parallel outside the target list
+  // and write back all results at once.
+  auto start = std::chrono::steady_clock::now();
+  m_cpa_batch.Clear();
+  m_cpa_targets.clear();
   for (const auto &it : GetTargetList()) {
-    std::shared_ptr<AisTargetData> td = it.second;
-
-    if (nullptr != td) UpdateOneCPA(td.get());
+    AisTargetData *td = it.second.get();
+    if (!td) continue;
+    m_cpa_targets.push_back(td);
+    m_cpa_batch.Add(td->Lat, td->Lon, td->COG, td->SOG, GetCpaFlags(td));
   }
+  m_cpa_stats.targets = m_cpa_targets.size();
+  m_cpa_stats.snapshot_ms = MillisSince(start);
+
+  // Targets which cannot trigger the alarms in UpdateAllAlarms() are
+  // pruned from the exact CPA computation.
+  CpaReach reach;
+  reach.warn_nm = g_CPAWarn_NM;
+  if (g_bCPAMax) reach.range_max_nm = g_CPAMax_NM;
+  if (g_bTCPA_Max) reach.tcpa_max_h = g_TCPA_Max / 60.;
+  start = std::chrono::steady_clock::now();
+  m_cpa_batch.Compute(GetCpaOwnShip(), reach, &WorkerPool::GetShared());
+  m_cpa_stats.compute_ms = MillisSince(start);
+
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < m_cpa_targets.size(); i++) {
+    ApplyCpa(m_cpa_targets[i], m_cpa_batch.GetResult(i));
+  }
+  m_cpa_stats.commit_ms = MillisSince(start);
+  m_cpa_stats.exact = m_cpa_batch.GetExactCount();
 }
 
 void AisDecoder::UpdateAllTracks() {
@@ -4007,141 +4116,10 @@ void AisDecoder::UpdateAllAlarms() {
 }
 
 void AisDecoder::UpdateOneCPA(AisTargetData *ptarget) {
-  ptarget->Range_NM = -1.;  // Defaults
-  ptarget->Brg = -1.;
-
-  //    Compute the current Range/Brg to the target
-  //    This should always be possible even if GPS data is not valid
-  //    because O must always have a position for own-ship. Plugins need
-  //    AIS target range and bearing from own-ship position even if GPS is not
-  //    valid.
-  double brg, dist;
-  DistanceBearingMercator(ptarget->Lat, ptarget->Lon, gLat, gLon, &brg, &dist);
-  ptarget->Range_NM = dist;
-  ptarget->Brg = brg;
-
-  if (dist <= 1e-5) ptarget->Brg = -1.0;  // Brg is undefined if Range == 0.
-
-  if (!ptarget->b_positionOnceValid || !bGPSValid) {
-    ptarget->bCPA_Valid = false;
-    return;
-  }
-  //  Ais Meteo is not a hard target in danger for collision
-  if (ptarget->Class == AIS_METEO) {
-    ptarget->bCPA_Valid = false;
-    return;
-  }
-
-  //    There can be no collision between ownship and itself....
-  //    This can happen if AIVDO messages are received, and there is another
-  //    source of ownship position, like NMEA GLL The two positions are always
-  //    temporally out of sync, and one will always be exactly in front of the
-  //    other one.
-  if (ptarget->b_OwnShip) {
-    ptarget->CPA = 100;
-    ptarget->TCPA = -100;
-    ptarget->bCPA_Valid = false;
-    return;
-  }
-
-  double cpa_calc_ownship_cog = gCog;
-  double cpa_calc_target_cog = ptarget->COG;
-
-  //    Ownship is not reporting valid SOG, so no way to calculate CPA
-  if (std::isnan(gSog) || (gSog > 102.2)) {
-    ptarget->bCPA_Valid = false;
-    return;
-  }
-
-  //    Ownship is maybe anchored and not reporting COG
-  if (std::isnan(gCog) || gCog == 360.0) {
-    if (gSog < .01)
-      cpa_calc_ownship_cog =
-          0.;  // substitute value
-               // for the case where SOG ~= 0, and COG is unknown.
-    else {
-      ptarget->bCPA_Valid = false;
-      return;
-    }
-  }
-
-  //    Target is maybe anchored and not reporting COG
-  if (ptarget->COG == 360.0) {
-    if (ptarget->SOG > 102.2) {
-      ptarget->bCPA_Valid = false;
-      return;
-    } else if (ptarget->SOG < .01) {
-      cpa_calc_target_cog = 0.;  // substitute value
-      // for the case where SOG ~= 0, and COG is unknown.
-    } else {
-      ptarget->bCPA_Valid = false;
-      return;
-    }
-  }
-
-  //    Express the SOGs as meters per hour
-  double v0 = gSog * 1852.;
-  double v1 = ptarget->SOG * 1852.;
-
-  if ((v0 < 1e-6) && (v1 < 1e-6)) {
-    ptarget->TCPA = 0.;
-    ptarget->CPA = 0.;
-
-    ptarget->bCPA_Valid = false;
-  } else {
-    //    Calculate the TCPA first
-
-    //    Working on a Reduced Lat/Lon orthogonal plotting sheet....
-    //    Get easting/northing to target,  in meters
-
-    double east1 = (ptarget->Lon - gLon) * 60 * 1852;
-    double north1 = (ptarget->Lat - gLat) * 60 * 1852;
-
-    double east = east1 * (cos(gLat * PI / 180.));
-
-    double north = north1;
-
-    //    Convert COGs trigonometry to standard unit circle
-    double cosa = cos((90. - cpa_calc_ownship_cog) * PI / 180.);
-    double sina = sin((90. - cpa_calc_ownship_cog) * PI / 180.);
-    double cosb = cos((90. - cpa_calc_target_cog) * PI / 180.);
-    double sinb = sin((90. - cpa_calc_target_cog) * PI / 180.);
-
-    //    These will be useful
-    double fc = (v0 * cosa) - (v1 * cosb);
-    double fs = (v0 * sina) - (v1 * sinb);
-
-    double d = (fc * fc) + (fs * fs);
-    double tcpa;
-
-    // the tracks are almost parallel
-    if (fabs(d) < 1e-6)
-      tcpa = 0.;
-    else
-      //    Here is the equation for t, which will be in hours
-      tcpa = ((fc * east) + (fs * north)) / d;
-
-    //    Convert to minutes
-    ptarget->TCPA = tcpa * 60.;
-
-    //    Calculate CPA
-    //    Using TCPA, predict ownship and target positions
-
-    double OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA, TargetLonCPA;
-
-    ll_gc_ll(gLat, gLon, cpa_calc_ownship_cog, gSog * tcpa, &OwnshipLatCPA,
-             &OwnshipLonCPA);
-    ll_gc_ll(ptarget->Lat, ptarget->Lon, cpa_calc_target_cog,
-             ptarget->SOG * tcpa, &TargetLatCPA, &TargetLonCPA);
-
-    //   And compute the distance
-    ptarget->CPA = DistGreatCircle(OwnshipLatCPA, OwnshipLonCPA, TargetLatCPA,
-                                   TargetLonCPA);
-
-    ptarget->bCPA_Valid = true;
-
-    if (ptarget->TCPA < 0) ptarget->bCPA_Valid = false;
-  }
+  CpaResult result;
+  ComputeCpa(GetCpaOwnShip(), ptarget->Lat, ptarget->Lon, ptarget->COG,
+             ptarget->SOG, GetCpaFlags(ptarget), CpaReach(), result);
+  ApplyCpa(ptarget, result);
 }
 
 void AisDecoder::OnTimerDSC(wxTimerEvent &event) {
@@ -0,0 +1,120 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement ais_vdm.h -- VDM/VDO parsing and reassembly
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "model/ais_vdm.h"
+
+static int HexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/** Leading decimal digits as an int like atoi(), -1 if there are none. */
+static int ToInt(std::string_view s) {
+  int value = -1;
+  for (char c : s) {
+    if (c < '0' || c > '9') break;
+    value = (value < 0 ? 0 : value * 10) + (c - '0');
+  }
+  return value;
+}
+
+bool VdmChecksumOk(std::string_view sentence) {
+  size_t star = sentence.find('*');
+  if (star == std::string_view::npos || sentence.size() <= 4) return false;
+  unsigned char checksum = 0;
+  for (size_t i = 1; i < star; i++) checksum ^= sentence[i];
+
+  int sum = -1;
+  for (size_t i = star + 1; i < sentence.size() && i < star + 3; i++) {
+    int digit = HexDigit(sentence[i]);
+    if (digit < 0) break;
+    sum = (sum < 0 ? 0 : sum * 16) + digit;
+  }
+  return sum == checksum;
+}
+
+bool ParseVdmSentence(std::string_view sentence, AisVdmSentence& vdm) {
+  vdm = AisVdmSentence();
+  if (sentence.size() < 6 || sentence.substr(3, 2) != "VD") return false;
+  vdm.own_ship = sentence[5] == 'O';
+
+  // !xxVDx,count,index,sequence id,channel,payload,fill bits*hh
+  std::string_view fields[6];
+  size_t field = 0;
+  size_t start = 0;
+  while (field < 6) {
+    size_t comma = sentence.find(',', start);
+    fields[field++] = sentence.substr(start, comma - start);
+    if (comma == std::string_view::npos) break;
+    start = comma + 1;
+  }
+  vdm.count = std::max(ToInt(fields[1]), 0);
+  vdm.index = std::max(ToInt(fields[2]), 0);
+  vdm.sequence_id = ToInt(fields[3]);
+  if (!fields[4].empty()) vdm.channel = fields[4][0];
+  vdm.payload = fields[5];
+  return true;
+}
+
+std::string_view AisVdmAssembler::Add(const AisVdmSentence& vdm) {
+  if (vdm.count == 1 && vdm.index == 1) return vdm.payload;
+  if (vdm.count < 2 || vdm.index < 1 || vdm.index > vdm.count) return {};
+
+  size_t seq = vdm.sequence_id >= 0 && vdm.sequence_id <= 9
+                   ? static_cast<size_t>(vdm.sequence_id)
+                   : 10;
+  size_t channel = 2;
+  if (vdm.channel == 'A' || vdm.channel == '1') channel = 0;
+  if (vdm.channel == 'B' || vdm.channel == '2') channel = 1;
+  Part& part = m_parts[seq * 3 + channel];
+
+  if (vdm.index == 1) {
+    part.count = vdm.count;
+    part.next = 1;
+    part.length = 0;
+  } else if (part.next != vdm.index || part.count != vdm.count) {
+    part.next = 0;  // Lost or reordered sentence
+    return {};
+  }
+  if (part.length + vdm.payload.size() >= AIS_MAX_MESSAGE_LEN) {
+    part.next = 0;
+    return {};
+  }
+  memcpy(part.data + part.length, vdm.payload.data(), vdm.payload.size());
+  part.length += vdm.payload.size();
+  if (vdm.index < vdm.count) {
+    part.next++;
+    return {};
+  }
+  part.next = 0;
+  return std::string_view(part.data, part.length);
+}
+
+void AisVdmAssembler::Clear() {
+  for (auto& part : m_parts) part.next = 0;
+}
@@ -0,0 +1,66 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement arena.h -- Arena
+ */
+
+#include <cstdint>
+
+#include "model/arena.h"
+
+Arena::Arena(size_t block_size) : m_block_size(block_size) {}
+
+void* Arena::Allocate(size_t size, size_t align) {
+  if (size == 0) size = 1;
+  auto padding = [&](const unsigned char* p) {
+    return (align - reinterpret_cast<uintptr_t>(p) % align) % align;
+  };
+  if (m_next && padding(m_next) + size <= m_available) {
+    size_t pad = padding(m_next);
+    unsigned char* p = m_next + pad;
+    m_next += pad + size;
+    m_available -= pad + size;
+    m_used += size;
+    return p;
+  }
+
+  // Oversized requests get a dedicated block, leaving current one in use.
+  size_t block_size = size + align;
+  bool dedicated = size > m_block_size / 4;
+  if (!dedicated) block_size = m_block_size;
+  auto block = std::make_unique<unsigned char[]>(block_size);
+  unsigned char* p = block.get() + padding(block.get());
+  m_blocks.push_back(std::move(block));
+  m_capacity += block_size;
+  m_used += size;
+  if (!dedicated) {
+    m_next = p + size;
+    m_available = block_size - (m_next - m_blocks.back().get());
+  }
+  return p;
+}
+
+void Arena::Release() {
+  m_blocks.clear();
+  m_next = nullptr;
+  m_available = 0;
+  m_used = 0;
+  m_capacity = 0;
+}
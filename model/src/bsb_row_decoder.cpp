@@ -0,0 +1,159 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement bsb_row_decoder.h -- BsbRowDecoder
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "model/bsb_row_decoder.h"
+
+BsbRowDecoder::BsbRowDecoder(int color_bits, const int* palette,
+                             int palette_size) {
+  const int value_shift = 7 - color_bits;
+  const int value_mask = ((1 << color_bits) - 1) << value_shift;
+  const int count_mask = (1 << value_shift) - 1;
+  for (int b = 0; b < 256; b++) {
+    m_value[b] = static_cast<uint8_t>((b & value_mask) >> value_shift);
+    m_count[b] = static_cast<uint8_t>(b & count_mask);
+  }
+  palette_size = palette ? std::min(palette_size, 255) : 0;
+  for (int i = 0; i < 256; i++) {
+    m_palette[i] = i < palette_size ? palette[i] & 0xffffff : 0;
+    uint64_t color = m_palette[i];
+    m_packed[i] = (color & 0xff) | (color >> 8 & 0xff) << kLaneBits |
+                  (color >> 16) << (2 * kLaneBits);
+  }
+}
+
+size_t BsbRowDecoder::SkipLineNumber(const uint8_t* row, size_t size) {
+  size_t pos = 0;
+  while (pos < size && (row[pos++] & 0x80) != 0) continue;
+  return pos;
+}
+
+template <typename Fill>
+void BsbRowDecoder::Expand(const uint8_t* row, size_t size, size_t pos,
+                           int ix, int xs, int xl, Fill&& fill) const {
+  while (ix < xl) {
+    uint8_t value = 0;
+    // Corrupt or truncated rows: run to the end.
+    unsigned count = xl - ix;
+    if (pos < size && row[pos] != 0) {
+      uint8_t b = row[pos++];
+      value = m_value[b];
+      count = m_count[b];
+      while ((b & 0x80) != 0) {
+        if (pos == size) {
+          count = xl - ix;
+          break;
+        }
+        b = row[pos++];
+        count = count * 128 + (b & 0x7f);
+      }
+      count++;
+    }
+    if (ix < xs) {
+      if (ix + count <= static_cast<unsigned>(xs)) {
+        ix += count;
+        continue;
+      }
+      count -= xs - ix;
+      ix = xs;
+    }
+    count = std::min(count, static_cast<unsigned>(xl - ix));
+    fill(ix - xs, value, count);
+    ix += count;
+  }
+}
+
+void BsbRowDecoder::ExpandRgb(const uint8_t* row, size_t size, size_t pos,
+                              int ix, int xs, int xl, uint8_t* rgb) const {
+  uint8_t* const end = rgb + 3 * std::max(0, xl - xs);
+  Expand(row, size, pos, ix, xs, xl, [&](int x, uint8_t value, unsigned n) {
+    const uint32_t color = m_palette[value];
+    uint8_t* p = rgb + 3 * x;
+    uint8_t* const q = p + 3 * n;
+    if (n >= 16) {
+      // Copy 16 pixels in 48 byte blocks which the compiler turns into
+      // vector stores. The last block overlaps the previous one.
+      uint8_t pattern[52];
+      for (int i = 0; i < 4; i++) memcpy(pattern + 3 * i, &color, 4);
+      memcpy(pattern + 12, pattern, 12);
+      memcpy(pattern + 24, pattern, 24);
+      for (; p + 48 < q; p += 48) memcpy(p, pattern, 48);
+      memcpy(q - 48, pattern, 48);
+      return;
+    }
+    // Four byte stores are fine as long as there is a following pixel.
+    if (q < end) {
+      for (; p < q; p += 3) memcpy(p, &color, 4);
+      return;
+    }
+    for (; p + 3 < q; p += 3) memcpy(p, &color, 4);
+    memcpy(p, &color, 3);
+  });
+}
+
+void BsbRowDecoder::ExpandIndices(const uint8_t* row, size_t size, size_t pos,
+                                  int ix, int xs, int xl,
+                                  uint8_t* indices) const {
+  Expand(row, size, pos, ix, xs, xl, [&](int x, uint8_t value, unsigned n) {
+    memset(indices + x, value, n);
+  });
+}
+
+void BsbRowDecoder::IndicesToRgb(const uint8_t* indices, int count,
+                                 uint8_t* rgb) const {
+  if (count <= 0) return;
+  for (int i = 0; i < count - 1; i++, rgb += 3) {
+    memcpy(rgb, &m_palette[indices[i]], 4);
+  }
+  memcpy(rgb, &m_palette[indices[count - 1]], 3);
+}
+
+void BsbRowDecoder::AccumulateBox(const uint8_t* indices, int count,
+                                  double factor, int blur, int targets,
+                                  uint32_t* sums) const {
+  // Sum the packed colors, the lanes cannot overflow for boxes narrower
+  // than 2^21 / 256 pixels.
+  const bool packed = blur < (1 << 13);
+  for (int x = 0; x < targets; x++, sums += 4) {
+    int first = static_cast<int>(x * factor);
+    int last = std::min(first + blur, count);
+    if (last <= first) continue;
+    if (packed) {
+      uint64_t sum = 0;
+      for (int i = first; i < last; i++) sum += m_packed[indices[i]];
+      sums[0] += sum & kLaneMask;
+      sums[1] += (sum >> kLaneBits) & kLaneMask;
+      sums[2] += sum >> (2 * kLaneBits);
+    } else {
+      for (int i = first; i < last; i++) {
+        uint32_t color = m_palette[indices[i]];
+        sums[0] += color & 0xff;
+        sums[1] += (color >> 8) & 0xff;
+        sums[2] += (color >> 16) & 0xff;
+      }
+    }
+    sums[3] += last - first;
+  }
+}
@@ -0,0 +1,196 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement chart_spatial_index.h -- ChartSpatialIndex
+ */
+
+#include <algorithm>
+
+#include "model/chart_spatial_index.h"
+
+void ChartSpatialIndex::Build(std::vector<ChartIndexEntry> entries) {
+  m_entries = std::move(entries);
+  m_boxes.clear();
+  m_boxes.reserve(m_entries.size());
+  m_groups.clear();
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    const auto& e = m_entries[i];
+    m_boxes.push_back({e.lon_min, e.lat_min, e.lon_max, e.lat_max});
+    AddToGroups(static_cast<int>(i), e.groups);
+  }
+  Pack();
+  m_valid = true;
+}
+
+void ChartSpatialIndex::Append(ChartIndexEntry entry) {
+  int db_index = static_cast<int>(m_entries.size());
+  m_boxes.push_back(
+      {entry.lon_min, entry.lat_min, entry.lon_max, entry.lat_max});
+  AddToGroups(db_index, entry.groups);
+  if (entry.always)
+    m_always.push_back(db_index);
+  else
+    m_overflow.push_back(db_index);
+  m_entries.push_back(std::move(entry));
+  if (m_overflow.size() > std::max(kMinOverflow, m_entries.size() / 8)) Pack();
+}
+
+void ChartSpatialIndex::RemoveSwapBack(int db_index) {
+  if (db_index < 0 || db_index >= static_cast<int>(m_entries.size())) return;
+  int last = static_cast<int>(m_entries.size()) - 1;
+
+  auto erase_value = [](std::vector<int>& v, int value) {
+    v.erase(std::remove(v.begin(), v.end(), value), v.end());
+  };
+  RemoveFromGroups(db_index);
+  erase_value(m_always, db_index);
+  erase_value(m_overflow, db_index);
+  if (db_index != last) {
+    // The packed tree still refers to the old box of db_index and does not
+    // necessarily cover the new one: look it up in the overflow list.
+    RemoveFromGroups(last);
+    erase_value(m_always, last);
+    erase_value(m_overflow, last);
+    m_entries[db_index] = std::move(m_entries[last]);
+    m_boxes[db_index] = m_boxes[last];
+    AddToGroups(db_index, m_entries[db_index].groups);
+    if (m_entries[db_index].always)
+      m_always.push_back(db_index);
+    else
+      m_overflow.push_back(db_index);
+  }
+  m_entries.pop_back();
+  m_boxes.pop_back();
+  if (m_overflow.size() > std::max(kMinOverflow, m_entries.size() / 8)) Pack();
+}
+
+void ChartSpatialIndex::SetGroups(int db_index,
+                                  const std::vector<int>& groups) {
+  if (db_index < 0 || db_index >= static_cast<int>(m_entries.size())) return;
+  RemoveFromGroups(db_index);
+  m_entries[db_index].groups = groups;
+  AddToGroups(db_index, groups);
+}
+
+bool ChartSpatialIndex::IsInGroup(int db_index, int group) const {
+  if (db_index < 0 || db_index >= static_cast<int>(m_entries.size()))
+    return false;
+  return TestGroup(db_index, group);
+}
+
+std::vector<int> ChartSpatialIndex::QueryPoint(float lat, float lon,
+                                               int group) const {
+  return QueryBox(lat, lat, lon, lon, group);
+}
+
+std::vector<int> ChartSpatialIndex::QueryBox(float lat_min, float lat_max,
+                                             float lon_min, float lon_max,
+                                             int group) const {
+  std::vector<int> result;
+  for (float bias : {0.0F, 360.0F, -360.0F}) {
+    Box query{lon_min + bias, lat_min, lon_max + bias, lat_max};
+    Search(query, group, result);
+  }
+  for (int db_index : m_always) {
+    if (TestGroup(db_index, group)) result.push_back(db_index);
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+void ChartSpatialIndex::Clear() {
+  m_entries.clear();
+  m_boxes.clear();
+  m_tree.Clear();
+  m_tree_ids.clear();
+  m_overflow.clear();
+  m_always.clear();
+  m_groups.clear();
+  m_valid = false;
+}
+
+void ChartSpatialIndex::Pack() {
+  m_overflow.clear();
+  m_always.clear();
+  m_tree_ids.clear();
+
+  std::vector<Box> boxes;
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    if (m_entries[i].always) {
+      m_always.push_back(static_cast<int>(i));
+    } else {
+      m_tree_ids.push_back(static_cast<uint32_t>(i));
+      boxes.push_back(m_boxes[i]);
+    }
+  }
+  m_tree.Build(boxes);
+}
+
+void ChartSpatialIndex::AddToGroups(int db_index,
+                                    const std::vector<int>& groups) {
+  size_t word = static_cast<size_t>(db_index) / 64;
+  uint64_t bit = uint64_t(1) << (db_index % 64);
+  for (int group : groups) {
+    if (group <= 0) continue;
+    if (static_cast<size_t>(group) >= m_groups.size())
+      m_groups.resize(group + 1);
+    Bitset& bits = m_groups[group];
+    if (word >= bits.size()) bits.resize(word + 1, 0);
+    bits[word] |= bit;
+  }
+}
+
+void ChartSpatialIndex::RemoveFromGroups(int db_index) {
+  size_t word = static_cast<size_t>(db_index) / 64;
+  uint64_t bit = uint64_t(1) << (db_index % 64);
+  for (int group : m_entries[db_index].groups) {
+    if (group <= 0 || static_cast<size_t>(group) >= m_groups.size()) continue;
+    Bitset& bits = m_groups[group];
+    if (word < bits.size()) bits[word] &= ~bit;
+  }
+}
+
+bool ChartSpatialIndex::TestGroup(int db_index, int group) const {
+  if (group <= 0) return true;
+  if (static_cast<size_t>(group) >= m_groups.size()) return false;
+  const Bitset& bits = m_groups[group];
+  size_t word = static_cast<size_t>(db_index) / 64;
+  if (word >= bits.size()) return false;
+  return (bits[word] >> (db_index % 64)) & 1;
+}
+
+void ChartSpatialIndex::Search(const Box& query, int group,
+                               std::vector<int>& result) const {
+  auto size = static_cast<uint32_t>(m_entries.size());
+  std::vector<uint32_t> hits;
+  m_tree.Search(query, hits);
+  for (uint32_t hit : hits) {
+    uint32_t id = m_tree_ids[hit];
+    // Stale entries after RemoveSwapBack(), found elsewhere if valid.
+    if (id >= size || m_entries[id].always) continue;
+    if (m_boxes[id].Intersects(query) && TestGroup(id, group))
+      result.push_back(static_cast<int>(id));
+  }
+  for (int id : m_overflow) {
+    if (m_boxes[id].Intersects(query) && TestGroup(id, group))
+      result.push_back(id);
+  }
+}
@@ -29,6 +29,7 @@ int g_unit_test_2 = 0;
 bool g_start_fullscreen = false;
 bool g_rebuild_gl_cache = false;
 bool g_parse_all_enc = false;
+bool g_exit_after_parse = false;
 bool g_bportable = false;
 bool g_bdisable_opengl = false;
 bool g_config_wizard = false;
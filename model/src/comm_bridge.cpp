@@ -429,34 +429,48 @@ void CommBridge::MakeHDTFromHDM() {
 void CommBridge::InitCommListeners() {
   // Initialize the comm listeners
 
-  // GNSS Position Data PGN  129029
-  m_n2k_129029_lstnr.Init(Nmea2000Msg(static_cast<uint64_t>(129029)),
-                          [&](const ObservedEvt& ev) {
-                            HandleN2K_129029(UnpackEvtPointer<Nmea2000Msg>(ev));
-                          });
-
-  // Position rapid   PGN 129025
-  m_n2k_129025_lstnr.Init(Nmea2000Msg(static_cast<uint64_t>(129025)),
-                          [&](const ObservedEvt& ev) {
-                            HandleN2K_129025(UnpackEvtPointer<Nmea2000Msg>(ev));
-                          });
-
-  // COG SOG rapid   PGN 129026
-  m_n2k_129026_lstnr.Init(Nmea2000Msg(static_cast<uint64_t>(129026)),
-                          [&](const ObservedEvt& ev) {
-                            HandleN2K_129026(UnpackEvtPointer<Nmea2000Msg>(ev));
-                          });
-
-  // Heading rapid   PGN 127250
-  m_n2k_127250_lstnr.Init(Nmea2000Msg(static_cast<uint64_t>(127250)),
-                          [&](const ObservedEvt& ev) {
-                            HandleN2K_127250(UnpackEvtPointer<Nmea2000Msg>(ev));
-                          });
-  // Variation   PGN 127258
-  m_n2k_127258_lstnr.Init(Nmea2000Msg(static_cast<uint64_t>(127258)),
-                          [&](const ObservedEvt& ev) {
-                            HandleN2K_127258(UnpackEvtPointer<Nmea2000Msg>(ev));
-                          });
+  // Position, velocity and heading. Only the latest message of each type
+  // and source is used, at most 5 Hz: rapid PGNs and compass sentences
+  // often arrive at 10 Hz or more.
+  using Handler = std::function<void(const NavMsgPtr&)>;
+  std::unordered_map<std::string, Handler> handlers;
+  auto add_n2k = [&](uint64_t pgn,
+                     bool (CommBridge::*handler)(const N2000MsgPtr&)) {
+    handlers[Nmea2000Msg(pgn).GetKey()] = [this, handler](const NavMsgPtr& m) {
+      (this->*handler)(std::static_pointer_cast<const Nmea2000Msg>(m));
+    };
+  };
+  auto add_n0183 = [&](const char* type,
+                       bool (CommBridge::*handler)(const N0183MsgPtr&)) {
+    handlers[Nmea0183Msg(type).GetKey()] = [this, handler](const NavMsgPtr& m) {
+      (this->*handler)(std::static_pointer_cast<const Nmea0183Msg>(m));
+    };
+  };
+  add_n2k(129029, &CommBridge::HandleN2K_129029);  // GNSS Position Data
+  add_n2k(129025, &CommBridge::HandleN2K_129025);  // Position rapid
+  add_n2k(129026, &CommBridge::HandleN2K_129026);  // COG SOG rapid
+  add_n2k(127250, &CommBridge::HandleN2K_127250);  // Heading rapid
+  add_n2k(127258, &CommBridge::HandleN2K_127258);  // Variation
+  add_n0183("RMC", &CommBridge::HandleN0183_RMC);
+  add_n0183("THS", &CommBridge::HandleN0183_THS);
+  add_n0183("HDT", &CommBridge::HandleN0183_HDT);
+  add_n0183("HDG", &CommBridge::HandleN0183_HDG);
+  add_n0183("HDM", &CommBridge::HandleN0183_HDM);
+  add_n0183("HVD", &CommBridge::HandleN0183_HVD);
+  add_n0183("VTG", &CommBridge::HandleN0183_VTG);
+  add_n0183("GGA", &CommBridge::HandleN0183_GGA);
+  add_n0183("GLL", &CommBridge::HandleN0183_GLL);
+
+  std::unordered_set<std::string> keys;
+  for (const auto& kv : handlers) keys.insert(kv.first);
+  m_nav_listener = NavMsgBus::GetInstance().AddConflatingListener(
+      keys, kNavInterval,
+      [handlers](const NavMsgBatch& batch) {
+        for (const auto& msg : batch) handlers.at(msg->GetKey())(msg);
+      },
+      NavMsgDelivery::kGuiThread);
+
+  // Messages which each carry different data, all of them are needed.
 
   // GNSS Satellites in View   PGN 129540
   m_n2k_129540_lstnr.Init(Nmea2000Msg(static_cast<uint64_t>(129540)),
@@ -464,59 +478,11 @@ void CommBridge::InitCommListeners() {
                             HandleN2K_129540(UnpackEvtPointer<Nmea2000Msg>(ev));
                           });
 
-  // NMEA0183
-  // RMC
-  Nmea0183Msg n0183_msg_RMC("RMC");
-  m_n0183_rmc_lstnr.Init(Nmea0183Msg("RMC"), [&](const ObservedEvt& ev) {
-    HandleN0183_RMC(UnpackEvtPointer<Nmea0183Msg>(ev));
-  });
-
-  // THS
-  m_n0183_ths_lstnr.Init(Nmea0183Msg("THS"), [&](const ObservedEvt& ev) {
-    HandleN0183_THS(UnpackEvtPointer<Nmea0183Msg>(ev));
-  });
-
-  // HDT
-  m_n0183_hdt_lstnr.Init(Nmea0183Msg("HDT"), [&](const ObservedEvt& ev) {
-    HandleN0183_HDT(UnpackEvtPointer<Nmea0183Msg>(ev));
-  });
-
-  // HDG
-  m_n0183_hdg_lstnr.Init(Nmea0183Msg("HDG"), [&](const ObservedEvt& ev) {
-    HandleN0183_HDG(UnpackEvtPointer<Nmea0183Msg>(ev));
-  });
-
-  // HDM
-  m_n0183_hdm_lstnr.Init(Nmea0183Msg("HDM"), [&](const ObservedEvt& ev) {
-    HandleN0183_HDM(UnpackEvtPointer<Nmea0183Msg>(ev));
-  });
-
-  // HVD
-  m_n0183_hvd_lstnr.Init(Nmea0183Msg("HVD"), [&](const ObservedEvt& ev) {
-    HandleN0183_HVD(UnpackEvtPointer<Nmea0183Msg>(ev));
-  });
-
-  // VTG
-  m_n0183_vtg_lstnr.Init(Nmea0183Msg("VTG"), [&](const ObservedEvt& ev) {
-    HandleN0183_VTG(UnpackEvtPointer<Nmea0183Msg>(ev));
-  });
-
   // GSV
   m_n0183_gsv_lstnr.Init(Nmea0183Msg("GSV"), [&](const ObservedEvt& ev) {
     HandleN0183_GSV(UnpackEvtPointer<Nmea0183Msg>(ev));
   });
 
-  // GGA
-  m_n0183_gga_lstnr.Init(Nmea0183Msg("GGA"), [&](const ObservedEvt& ev) {
-    HandleN0183_GGA(UnpackEvtPointer<Nmea0183Msg>(ev));
-  });
-
-  // GLL
-  Nmea0183Msg n0183_msg_GLL("GLL");
-  m_n0183_gll_lstnr.Init(Nmea0183Msg("GLL"), [&](const ObservedEvt& ev) {
-    HandleN0183_GLL(UnpackEvtPointer<Nmea0183Msg>(ev));
-  });
-
   // AIVDO
   m_n0183_aivdo_lstnr.Init(Nmea0183Msg("AIVDO"), [&](const ObservedEvt& ev) {
     HandleN0183_AIVDO(UnpackEvtPointer<Nmea0183Msg>(ev));
@@ -29,6 +29,8 @@
 #include <wx/wx.h>
 #endif  // precompiled headers
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -42,6 +44,9 @@
 
 using namespace std;
 
+/** Input stream buffer size, large logs are read sequentially. */
+static const size_t kReadBufferSize = 1 << 20;
+
 class VoidDriverListener : public DriverListener {
   virtual void Notify(std::shared_ptr<const NavMsg> message) {}
   virtual void Notify(const AbstractCommDriver& driver) {}
@@ -64,6 +69,10 @@ static vector<unsigned char> HexToChar(string hex) {
 static shared_ptr<const NavMsg> LineToMessage(const string& line,
                                               std::shared_ptr<NavAddr> src) {
   auto words = ocpn::split(line.c_str(), " ");
+  if (words.size() < 4) {
+    std::cerr << "Cannot parse line: \"" << line << "\"\n" << flush;
+    return make_shared<NullNavMsg>();
+  }
   NavAddr::Bus bus = NavAddr::StringToBus(words[0]);
   switch (bus) {
     case NavAddr::Bus::N2000:
@@ -89,38 +98,234 @@ static shared_ptr<const NavMsg> LineToMessage(const string& line,
   return make_shared<NullNavMsg>();  // for the compiler.
 }
 
+/**
+ * Return message payload in the format used by the socketcan driver, an
+ * Actisense like header followed by the data and a dummy CRC.
+ */
+static vector<unsigned char> CanPayload(const CanHeader& header,
+                                        const unsigned char* data,
+                                        unsigned length) {
+  vector<unsigned char> payload;
+  payload.reserve(length + 14);
+  payload.push_back(0x93);
+  payload.push_back(length + 11);
+  payload.push_back(header.priority);
+  payload.push_back(header.pgn & 0xFF);
+  payload.push_back((header.pgn >> 8) & 0xFF);
+  payload.push_back((header.pgn >> 16) & 0xFF);
+  payload.push_back(header.destination);
+  payload.push_back(header.source);
+  for (int i = 0; i < 4; i++) payload.push_back(0xFF);  // No time fields
+  payload.push_back(length);
+  payload.insert(payload.end(), data, data + length);
+  payload.push_back(0x55);  // CRC dummy, not checked
+  return payload;
+}
+
 FileCommDriver::FileCommDriver(const string& opath, const string& ipath,
                                DriverListener& l)
     : AbstractCommDriver(NavAddr::Bus::TestBus, opath),
       output_path(opath),
       input_path(ipath),
-      listener(l) {
+      listener(l),
+      m_buffered(false),
+      m_pacer(0),
+      m_paced(false),
+      m_replaying(false),
+      m_stop(false),
+      m_start(ReplayPacer::Clock::now()) {
+  m_driver_stats.driver_bus = NavAddr::Bus::TestBus;
+  m_driver_stats.driver_iface = opath;
+  if (input_path != "") Replay();
+}
+
+FileCommDriver::FileCommDriver(const string& opath, const string& ipath,
+                               DriverListener& l, double speed)
+    : AbstractCommDriver(NavAddr::Bus::TestBus, opath),
+      output_path(opath),
+      input_path(ipath),
+      listener(l),
+      m_buffered(false),
+      m_pacer(speed),
+      m_paced(true),
+      m_replaying(false),
+      m_stop(false),
+      m_start(ReplayPacer::Clock::now()) {
+  m_driver_stats.driver_bus = NavAddr::Bus::TestBus;
+  m_driver_stats.driver_iface = opath;
   if (input_path != "") {
-    ifstream f(input_path);
-    string line;
-    while (getline(f, line)) {
-      auto msg = LineToMessage(line, GetAddress());
-      if (msg->bus != NavAddr::Bus::Undef) listener.Notify(msg);
-    }
+    m_replaying = true;
+    m_thread = std::thread([this] { Replay(); });
   }
 }
 
 FileCommDriver::FileCommDriver(const string& opath)
     : FileCommDriver(opath, "", kVoidDriverListener) {}
 
+FileCommDriver::~FileCommDriver() {
+  Stop();
+  Flush();
+}
+
+void FileCommDriver::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_stop = true;
+  }
+  m_stop_cv.notify_all();
+  if (m_thread.joinable()) m_thread.join();
+}
+
 std::shared_ptr<NavAddr> FileCommDriver::GetAddress() {
   return std::make_shared<NavAddr>(NavAddrTest(output_path));
 }
 
+DriverStats FileCommDriver::GetDriverStats() const {
+  std::lock_guard<std::mutex> lock(m_stats_mutex);
+  DriverStats stats = m_driver_stats;
+  stats.available = m_replaying;
+  return stats;
+}
+
+ReplayStats FileCommDriver::GetReplayStats() const {
+  std::lock_guard<std::mutex> lock(m_stats_mutex);
+  ReplayStats stats = m_replay_stats;
+  if (m_replaying) {
+    std::chrono::duration<double> elapsed = ReplayPacer::Clock::now() - m_start;
+    stats.seconds = elapsed.count();
+  }
+  return stats;
+}
+
+void FileCommDriver::Replay() {
+  // Stream the file through a large buffer: logs might be several GB.
+  vector<char> buffer(kReadBufferSize);
+  ifstream f;
+  f.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+  f.open(input_path);
+  if (!f.is_open()) {
+    wxLogWarning("Cannot open file %s for reading", input_path.c_str());
+  }
+  string line;
+  while (getline(f, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    double ts;
+    if (m_paced && ParseLogTime(line, ts)) {
+      auto due = m_pacer.Due(ts);
+      std::unique_lock<std::mutex> lock(m_stats_mutex);
+      if (m_stop_cv.wait_until(lock, due, [&] { return m_stop; })) break;
+    } else if (m_paced) {
+      std::lock_guard<std::mutex> lock(m_stats_mutex);
+      if (m_stop) break;
+    }
+    HandleLine(line);
+  }
+  std::lock_guard<std::mutex> lock(m_stats_mutex);
+  std::chrono::duration<double> elapsed = ReplayPacer::Clock::now() - m_start;
+  m_replay_stats.seconds = elapsed.count();
+  m_replaying = false;
+  if (m_paced) {
+    wxLogMessage("Replayed %s: %llu messages in %.1f s, %.0f msg/s",
+                 input_path.c_str(),
+                 static_cast<unsigned long long>(m_replay_stats.messages),
+                 m_replay_stats.seconds, m_replay_stats.GetRate());
+  }
+}
+
+void FileCommDriver::HandleLine(const string& line) {
+  shared_ptr<const NavMsg> msg;
+  if (line.empty()) {
+    msg = make_shared<NullNavMsg>();
+  } else if (line[0] == '(') {
+    string iface;
+    uint32_t can_id;
+    vector<unsigned char> data;
+    if (ParseCandumpLine(line, iface, can_id, data)) {
+      can_frame frame;
+      memset(&frame, 0xFF, sizeof(frame));  // Pad data as on the wire.
+      frame.can_id = can_id;
+      frame.can_dlc = static_cast<uint8_t>(data.size());
+      std::copy(data.begin(), data.end(), frame.data);
+      HandleFrame(iface, frame);
+    }
+  } else if (line[0] == '$' || line[0] == '!' || line[0] == '\\') {
+    // Raw sentence, possibly prefixed by a v4 tag block.
+    size_t start = line.find_first_of("$!");
+    if (start != string::npos && line.size() >= start + 6) {
+      string sentence = line.substr(start);
+      msg = make_shared<Nmea0183Msg>(sentence.substr(1, 5), sentence,
+                                     GetAddress());
+    }
+  } else {
+    msg = LineToMessage(line, GetAddress());
+  }
+  bool valid = msg && msg->bus != NavAddr::Bus::Undef;
+  {
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_replay_stats.lines += 1;
+    m_driver_stats.rx_count += line.size();
+    if (valid) m_replay_stats.messages += 1;
+  }
+  if (valid) listener.Notify(std::move(msg));
+}
+
+/**
+ * Handle a frame, like the socketcan driver. A complete message or last
+ * part of a multipart fast message is sent to listener, otherwise the
+ * fragment is stored waiting for next one.
+ */
+void FileCommDriver::HandleFrame(const string& iface, const can_frame& frame) {
+  CanHeader header(frame);
+  int position = -1;
+  bool ready = true;
+  if (header.IsFastMessage()) {
+    position = m_fast_messages.FindMatchingEntry(header, frame.data[0]);
+    if (position == -1) {
+      position = m_fast_messages.AddNewEntry();
+      ready = m_fast_messages.InsertEntry(header, frame.data, position);
+    } else {
+      ready = m_fast_messages.AppendEntry(header, frame.data, position);
+    }
+  }
+  if (!ready) return;
+  vector<unsigned char> payload;
+  if (position >= 0) {
+    const auto& entry = m_fast_messages[position];
+    payload = CanPayload(header, entry.data.data(), entry.expected_length);
+    m_fast_messages.Remove(position);
+  } else {
+    payload = CanPayload(header, frame.data, CAN_MAX_DLEN);
+  }
+  auto src = make_shared<NavAddr2000>(iface, header.source);
+  auto msg = make_shared<const Nmea2000Msg>(header.pgn, payload, src);
+  {
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_replay_stats.messages += 1;
+  }
+  listener.Notify(std::move(msg));
+}
+
 bool FileCommDriver::SendMessage(std::shared_ptr<const NavMsg> msg,
                                  std::shared_ptr<const NavAddr> addr) {
-  ofstream f;
-  f.open(output_path, ios::app);
-  if (!f.is_open()) {
-    wxLogWarning("Cannot open file %s for writing", output_path.c_str());
-    return false;
+  std::lock_guard<std::mutex> lock(m_output_mutex);
+  if (!m_output.is_open()) {
+    m_output.open(output_path, ios::app);
+    if (!m_output.is_open()) {
+      wxLogWarning("Cannot open file %s for writing", output_path.c_str());
+      return false;
+    }
   }
-  f << msg->to_string();
-  f.close();
-  return true;
+  const string s = msg->to_string();
+  m_output << s;
+  if (!m_buffered) m_output.flush();
+  {
+    std::lock_guard<std::mutex> stats_lock(m_stats_mutex);
+    m_driver_stats.tx_count += s.size();
+  }
+  return m_output.good();
+}
+
+void FileCommDriver::Flush() {
+  std::lock_guard<std::mutex> lock(m_output_mutex);
+  if (m_output.is_open()) m_output.flush();
 }
@@ -23,8 +23,6 @@
  * driver.
  */
 
-#include <mutex>  // std::mutex
-#include <queue>  // std::queue
 #include <vector>
 
 // For compilers that support precompilation, includes "wx.h".
@@ -58,39 +56,6 @@ class CommDriverN0183AndroidBT;  // forward
 
 #define MAX_OUT_QUEUE_MESSAGE_LENGTH 100
 
-template <typename T>
-class n0183_atomic_queue {
-public:
-  size_t size() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_queque.size();
-  }
-
-  bool empty() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_queque.empty();
-  }
-
-  const T& front() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_queque.front();
-  }
-
-  void push(const T& value) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_queque.push(value);
-  }
-
-  void pop() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_queque.pop();
-  }
-
-private:
-  std::queue<T> m_queque;
-  mutable std::mutex m_mutex;
-};
-
 #define OUT_QUEUE_LENGTH 20
 #define MAX_OUT_QUEUE_MESSAGE_LENGTH 100
 
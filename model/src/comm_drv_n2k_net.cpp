@@ -614,8 +614,8 @@ bool CommDriverN2KNet::ProcessActisense_N2K(std::vector<unsigned char> packet) {
   bool bGotESC = false;
   bool bGotSOT = false;
 
-  while (!m_circle.IsEmpty()) {
-    uint8_t next_byte = m_circle.Get();
+  uint8_t next_byte;
+  while (m_circle.TryPop(next_byte)) {
 
     if (bInMsg) {
       if (bGotESC) {
@@ -728,8 +728,8 @@ bool CommDriverN2KNet::ProcessActisense_RAW(std::vector<unsigned char> packet) {
   bool bGotESC = false;
   bool bGotSOT = false;
 
-  while (!m_circle.IsEmpty()) {
-    uint8_t next_byte = m_circle.Get();
+  uint8_t next_byte;
+  while (m_circle.TryPop(next_byte)) {
 
     if (bInMsg) {
       if (bGotESC) {
@@ -803,8 +803,8 @@ bool CommDriverN2KNet::ProcessActisense_NGT(std::vector<unsigned char> packet) {
   bool bGotESC = false;
   bool bGotSOT = false;
 
-  while (!m_circle.IsEmpty()) {
-    uint8_t next_byte = m_circle.Get();
+  uint8_t next_byte;
+  while (m_circle.TryPop(next_byte)) {
 
     if (bInMsg) {
       if (bGotESC) {
@@ -864,8 +864,9 @@ bool CommDriverN2KNet::ProcessActisense_ASCII_RAW(
     std::vector<unsigned char> packet) {
   can_frame frame;
 
-  while (!m_circle.IsEmpty()) {
-    char b = m_circle.Get();
+  unsigned char ub;
+  while (m_circle.TryPop(ub)) {
+    char b = ub;
     if ((b != 0x0a) && (b != 0x0d)) {
       m_sentence += b;
     }
@@ -914,8 +915,9 @@ bool CommDriverN2KNet::ProcessActisense_ASCII_N2K(
   // A001001.732 04FF6 1FA03 C8FBA80329026400
   std::string sentence;
 
-  while (!m_circle.IsEmpty()) {
-    char b = m_circle.Get();
+  unsigned char ub;
+  while (m_circle.TryPop(ub)) {
+    char b = ub;
     if ((b != 0x0a) && (b != 0x0d)) {
       sentence += b;
     }
@@ -985,8 +987,9 @@ bool CommDriverN2KNet::ProcessActisense_ASCII_N2K(
 }
 
 bool CommDriverN2KNet::ProcessSeaSmart(std::vector<unsigned char> packet) {
-  while (!m_circle.IsEmpty()) {
-    char b = m_circle.Get();
+  unsigned char ub;
+  while (m_circle.TryPop(ub)) {
+    char b = ub;
     if ((b != 0x0a) && (b != 0x0d)) {
       m_sentence += b;
     }
@@ -1150,8 +1153,9 @@ bool CommDriverN2KNet::ProcessMiniPlex(std::vector<unsigned char> packet) {
   $MXPGN,01F200,2816,FFFF7FFFFF43F800*10\r\n
   $MXPGN,01F205,2816,FF050D3A1D4CFC00*19\r\n"
   */
-  while (!m_circle.IsEmpty()) {
-    char b = m_circle.Get();
+  unsigned char ub;
+  while (m_circle.TryPop(ub)) {
+    char b = ub;
     if ((b != 0x0a) && (b != 0x0d)) {
       m_sentence += b;
     }
@@ -1250,10 +1254,7 @@ void CommDriverN2KNet::OnSocketEvent(wxSocketEvent& event) {
 
       bool done = false;
       if (newdata > 0) {
-        for (int i = 0; i < newdata; i++) {
-          if (!m_circle.IsFull()) m_circle.Put(data[i]);
-          // printf("%c", data.at(i));
-        }
+        m_circle.PushBatch(data.data(), newdata);
       }
 
       m_n2k_format = DetectFormat(data);
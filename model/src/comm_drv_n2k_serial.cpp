@@ -34,7 +34,7 @@
 
 #include <wx/log.h>
 
-#include "model/comm_buffers.h"
+#include "model/atomic_queue.h"
 #include "model/comm_drv_n2k_serial.h"
 #include "model/comm_navmsg_bus.h"
 #include "model/comm_drv_registry.h"
@@ -95,7 +95,7 @@ class CommDriverN2KSerialThread : public wxThread {
   int m_baud;
   int m_n_timeout;
 
-  CircularBuffer<std::vector<unsigned char>> m_out_que;
+  MpmcQueue<std::vector<unsigned char>> m_out_que;
   DriverStats m_driver_stats;
   mutable std::mutex m_stats_mutex;
 #ifdef __WXMSW__
@@ -621,11 +621,7 @@ size_t CommDriverN2KSerialThread::WriteComPortPhysical(unsigned char* msg,
 
 bool CommDriverN2KSerialThread::SetOutMsg(
     const std::vector<unsigned char>& msg) {
-  if (!m_out_que.IsFull()) {
-    m_out_que.Put(msg);
-    return true;
-  }
-  return false;
+  return m_out_que.TryPush(msg);
 }
 
 #ifndef __WXMSW__
@@ -634,7 +630,7 @@ void* CommDriverN2KSerialThread::Entry() {
   bool nl_found = false;
   wxString msg;
   uint8_t rdata[2000];
-  CircularBuffer<uint8_t> circle(DS_RX_BUFFER_SIZE);
+  SpscQueue<uint8_t> circle(DS_RX_BUFFER_SIZE);
   int ib = 0;
 
   //    Request the com port from the comm manager
@@ -709,14 +705,11 @@ void* CommDriverN2KSerialThread::Entry() {
       std::lock_guard lock(m_stats_mutex);
       m_driver_stats.rx_count += newdata;
 
-      for (int i = 0; i < newdata; i++) {
-        circle.Put(rdata[i]);
-      }
+      circle.PushBatch(rdata, newdata);
     }
 
-    while (!circle.IsEmpty()) {
+    while (circle.TryPop(next_byte)) {
       if (ib >= DS_RX_BUFFER_SIZE) ib = 0;
-      uint8_t next_byte = circle.Get();
 
       if (bInMsg) {
         if (bGotESC) {
@@ -780,12 +773,8 @@ void* CommDriverN2KSerialThread::Entry() {
 
     //      Check for any pending output message
 #if 1
-    bool b_qdata = !m_out_que.IsEmpty();
-
-    while (b_qdata) {
-      //  Take a copy of message
-      std::vector<unsigned char> qmsg = m_out_que.Get();
-
+    std::vector<unsigned char> qmsg;
+    while (m_out_que.TryPop(qmsg)) {
       if (static_cast<size_t>(-1) == WriteComPortPhysical(qmsg) &&
           10 < retries++) {
         // We failed to write the port 10 times, let's close the port so that
@@ -793,9 +782,7 @@ void* CommDriverN2KSerialThread::Entry() {
         retries = 0;
         CloseComPortPhysical();
       }
-
-      b_qdata = !m_out_que.IsEmpty();
-    }  // while b_qdata
+    }  // while m_out_que
 
 #endif
   }  // while ((not_done)
@@ -816,7 +803,7 @@ void* CommDriverN2KSerialThread::Entry() {
   bool not_done = true;
   bool nl_found = false;
   wxString msg;
-  CircularBuffer<uint8_t> circle(DS_RX_BUFFER_SIZE);
+  SpscQueue<uint8_t> circle(DS_RX_BUFFER_SIZE);
 
   //    Request the com port from the comm manager
   if (!OpenComPortPhysical(m_PortName, m_baud)) {
@@ -882,13 +869,10 @@ void* CommDriverN2KSerialThread::Entry() {
     }
 
     if (newdata > 0) {
-      for (int i = 0; i < newdata; i++) {
-        circle.Put(rdata[i]);
-      }
+      circle.PushBatch(rdata, newdata);
     }
 
-    while (!circle.IsEmpty()) {
-      uint8_t next_byte = circle.Get();
+    while (circle.TryPop(next_byte)) {
 
       if (1) {
         if (bInMsg) {
@@ -968,11 +952,8 @@ void* CommDriverN2KSerialThread::Entry() {
     }  // while
 
     //      Check for any pending output message
-    bool b_qdata = !m_out_que.IsEmpty();
-
-    while (!m_out_que.IsEmpty()) {
-      //  Take a copy of message
-      std::vector<unsigned char> qmsg = m_out_que.Get();
+    std::vector<unsigned char> qmsg;
+    while (m_out_que.TryPop(qmsg)) {
 
       if (static_cast<size_t>(-1) == WriteComPortPhysical(qmsg) &&
           10 < retries++) {
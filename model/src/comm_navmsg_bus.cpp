@@ -22,18 +22,305 @@
  * Implement comm_navmsg_bus.h i. e., NavMsgBus.
  */
 
+#include <algorithm>
+
 #include "model/comm_navmsg_bus.h"
+#include "model/periodic_timer.h"
+
+/** Max number of messages queued between two ticks. */
+static const size_t kQueueSize = 16384;
+
+/** Runs NavMsgBus::DispatchBatch() once per tick. */
+class NavMsgBus::BatchTimer : public PeriodicTimer {
+public:
+  BatchTimer(NavMsgBus& bus, std::chrono::milliseconds tick)
+      : PeriodicTimer(tick), m_bus(bus) {}
+
+protected:
+  void Notify() override { m_bus.DispatchBatch(); }
+
+private:
+  NavMsgBus& m_bus;
+};
+
+NavMsgBus::NavMsgBus()
+    : m_batch_mode(false),
+      m_has_batch_listeners(false),
+      m_queue(kQueueSize),
+      m_tick(kDefaultTick),
+      m_next_handle(1),
+      m_max_queue_depth(0),
+      m_batches(0),
+      m_delivered(0),
+      m_latency_samples(0),
+      m_latency_sum_ms(0),
+      m_max_latency_ms(0) {}
+
+NavMsgBus::~NavMsgBus() {
+  if (m_timer) m_timer->Stop();
+  m_timer.reset();
+  m_workers.reset();
+}
 
 void NavMsgBus::Notify(std::shared_ptr<const NavMsg> msg) {
   if (!msg) return;
   std::string key = NavAddr::BusToString(msg->bus) + "::" + msg->GetKey();
-  if (RegisterKey(key))
+  bool is_new_key = RegisterKey(key);
+  bool batch_mode = m_batch_mode;
+  if (batch_mode || m_has_batch_listeners)
+    m_queue.TryPush({msg, std::chrono::steady_clock::now(), batch_mode});
+  if (batch_mode) return;  // Observable listeners are served by next tick
+
+  if (is_new_key)
     // Leave some time for listeners to register before message is sent.
     CallAfter([msg] { Observable(*msg).Notify(msg); });
   else
     Observable(*msg).Notify(msg);
 }
 
+void NavMsgBus::SetBatchMode(bool enable, std::chrono::milliseconds tick) {
+  m_batch_mode = enable;
+  if (enable)
+    StartTimer(tick);
+  else
+    StopTimerIfIdle();
+}
+
+int NavMsgBus::AddBatchListener(NavMsgBatchHandler handler,
+                                NavMsgDelivery delivery) {
+  BatchListener listener;
+  listener.handler = std::move(handler);
+  listener.delivery = delivery;
+  listener.conflating = false;
+  return AddListener(std::move(listener));
+}
+
+int NavMsgBus::AddConflatingListener(
+    const std::unordered_set<std::string>& keys,
+    std::chrono::milliseconds min_interval, NavMsgBatchHandler handler,
+    NavMsgDelivery delivery) {
+  BatchListener listener;
+  listener.handler = std::move(handler);
+  listener.delivery = delivery;
+  listener.conflating = true;
+  listener.keys = keys;
+  listener.min_interval = min_interval;
+  listener.next_seq = 0;
+  listener.stats = {0, 0, 0};
+  return AddListener(std::move(listener));
+}
+
+int NavMsgBus::AddListener(BatchListener listener) {
+  int handle;
+  {
+    std::lock_guard lock(m_listeners_mutex);
+    handle = m_next_handle++;
+    listener.handle = handle;
+    if (listener.delivery == NavMsgDelivery::kWorker && !m_workers) {
+      // One thread keeps batches in order for each listener.
+      m_workers = std::make_unique<WorkerPool>(1);
+    }
+    m_batch_listeners.push_back(std::move(listener));
+  }
+  m_has_batch_listeners = true;
+  StartTimer(GetTick());
+  return handle;
+}
+
+ConflatingStats NavMsgBus::GetConflatingStats(int handle) const {
+  std::lock_guard lock(m_listeners_mutex);
+  for (const auto& l : m_batch_listeners)
+    if (l.handle == handle) return l.stats;
+  return {0, 0, 0};
+}
+
+std::shared_ptr<NavMsgBatch> NavMsgBus::Conflate(BatchListener& listener,
+                                                 const NavMsgBatch& batch) {
+  for (const auto& msg : batch) {
+    std::string key = msg->GetKey();
+    if (!listener.keys.empty() && listener.keys.count(key) == 0) continue;
+    listener.stats.received += 1;
+    // Keep sources apart, listeners might select between them.
+    if (msg->source)
+      key += "::" + msg->source->iface + "::" + msg->source->to_string();
+    auto& slot = listener.slots[key];
+    if (slot.latest) listener.stats.skipped += 1;
+    slot.latest = msg;
+    slot.seq = listener.next_seq++;
+  }
+  std::vector<std::pair<uint64_t, std::shared_ptr<const NavMsg>>> ready;
+  auto now = std::chrono::steady_clock::now();
+  for (auto& kv : listener.slots) {
+    ConflatedSlot& slot = kv.second;
+    if (!slot.latest) continue;
+    if (now - slot.last_delivery < listener.min_interval) continue;
+    ready.emplace_back(slot.seq, std::move(slot.latest));
+    slot.latest.reset();
+    slot.last_delivery = now;
+  }
+  std::sort(ready.begin(), ready.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  auto due = std::make_shared<NavMsgBatch>();
+  due->reserve(ready.size());
+  for (auto& r : ready) due->push_back(std::move(r.second));
+  listener.stats.delivered += due->size();
+  return due;
+}
+
+void NavMsgBus::RemoveBatchListener(int handle) {
+  bool has_listeners;
+  {
+    std::lock_guard lock(m_listeners_mutex);
+    auto found = std::find_if(
+        m_batch_listeners.begin(), m_batch_listeners.end(),
+        [handle](const BatchListener& l) { return l.handle == handle; });
+    if (found == m_batch_listeners.end()) return;
+    m_batch_listeners.erase(found);
+    has_listeners = !m_batch_listeners.empty();
+  }
+  m_has_batch_listeners = has_listeners;
+  // Make sure no worker is still invoking the removed handler. A handler
+  // removing itself is the running job, waiting for it would deadlock.
+  if (m_workers && !m_workers->IsWorkerThread()) m_workers->WaitIdle();
+  StopTimerIfIdle();
+}
+
+void NavMsgBus::StartTimer(std::chrono::milliseconds tick) {
+  std::unique_ptr<BatchTimer> old_timer;
+  {
+    std::lock_guard lock(m_listeners_mutex);
+    if (m_timer && tick == m_tick) return;
+    old_timer = std::move(m_timer);
+    m_tick = tick;
+    m_timer = std::make_unique<BatchTimer>(*this, m_tick);
+  }
+  // Stopping might wait for a DispatchBatch() using m_listeners_mutex.
+  if (old_timer) old_timer->Stop();
+}
+
+std::chrono::milliseconds NavMsgBus::GetTick() const {
+  std::lock_guard lock(m_listeners_mutex);
+  return m_tick;
+}
+
+void NavMsgBus::StopTimerIfIdle() {
+  std::unique_ptr<BatchTimer> timer;
+  {
+    std::lock_guard lock(m_listeners_mutex);
+    if (m_batch_mode || m_has_batch_listeners) return;
+    timer = std::move(m_timer);
+  }
+  if (timer) timer->Stop();
+  DispatchBatch();  // Flush messages queued before the timer stopped.
+}
+
+void NavMsgBus::DispatchBatch() {
+  std::vector<QueuedMsg> queued(std::max(m_queue.Size(), size_t(1)));
+  size_t count = m_queue.PopBatch(queued.data(), queued.size());
+  queued.resize(count);
+  // Conflating listeners might have pending messages also without input.
+  if (count == 0 && !m_has_batch_listeners) return;
+
+  auto batch = std::make_shared<NavMsgBatch>();
+  batch->reserve(count);
+  for (const auto& q : queued) batch->push_back(q.msg);
+  if (count > 0) {
+    {
+      std::lock_guard lock(m_stats_mutex);
+      m_max_queue_depth = std::max(m_max_queue_depth, count);
+      m_batches += 1;
+      m_delivered += count;
+    }
+    UpdateLatency(queued);
+  }
+
+  // Observable::Notify() just queues events, no need for the main thread.
+  for (const auto& q : queued) {
+    if (q.notify_observable) Observable(*q.msg).Notify(q.msg);
+  }
+
+  // Handlers and their batches to be invoked in the main thread.
+  using GuiJob = std::pair<int, std::shared_ptr<NavMsgBatch>>;
+  std::vector<GuiJob> gui_jobs;
+  {
+    std::lock_guard lock(m_listeners_mutex);
+    for (auto& l : m_batch_listeners) {
+      auto listener_batch = l.conflating ? Conflate(l, *batch) : batch;
+      if (listener_batch->empty()) continue;
+      if (l.delivery == NavMsgDelivery::kGuiThread) {
+        gui_jobs.emplace_back(l.handle, listener_batch);
+        continue;
+      }
+      // Look up handler when run, it might have been removed meanwhile.
+      int handle = l.handle;
+      m_workers->Post([this, handle, listener_batch] {
+        NavMsgBatchHandler handler;
+        {
+          std::lock_guard lock(m_listeners_mutex);
+          for (const auto& other : m_batch_listeners)
+            if (other.handle == handle) handler = other.handler;
+        }
+        if (handler) handler(*listener_batch);
+      });
+    }
+  }
+  if (gui_jobs.empty()) return;
+
+  // One main loop wakeup for all batches.
+  CallAfter([this, gui_jobs] {
+    for (const auto& job : gui_jobs) {
+      NavMsgBatchHandler handler;
+      {
+        std::lock_guard lock(m_listeners_mutex);
+        for (const auto& l : m_batch_listeners)
+          if (l.handle == job.first) handler = l.handler;
+      }
+      if (handler) handler(*job.second);
+    }
+  });
+}
+
+void NavMsgBus::UpdateLatency(const std::vector<QueuedMsg>& queued) {
+  using namespace std::chrono;
+  auto now = steady_clock::now();
+  double sum = 0;
+  double max = 0;
+  for (const auto& q : queued) {
+    double latency = duration<double, std::milli>(now - q.arrival).count();
+    sum += latency;
+    max = std::max(max, latency);
+  }
+  std::lock_guard lock(m_stats_mutex);
+  m_latency_samples += queued.size();
+  m_latency_sum_ms += sum;
+  m_max_latency_ms = std::max(m_max_latency_ms, max);
+}
+
+NavMsgBusStats NavMsgBus::GetStats() const {
+  std::lock_guard lock(m_stats_mutex);
+  NavMsgBusStats stats;
+  stats.queue_depth = m_queue.Size();
+  stats.max_queue_depth = m_max_queue_depth;
+  stats.batches = m_batches;
+  stats.delivered = m_delivered;
+  stats.dropped = m_queue.GetStats().dropped;
+  stats.avg_latency_ms =
+      m_latency_samples > 0 ? m_latency_sum_ms / m_latency_samples : 0;
+  stats.max_latency_ms = m_max_latency_ms;
+  return stats;
+}
+
+void NavMsgBus::ResetStats() {
+  std::lock_guard lock(m_stats_mutex);
+  m_max_queue_depth = 0;
+  m_batches = 0;
+  m_delivered = 0;
+  m_latency_samples = 0;
+  m_latency_sum_ms = 0;
+  m_max_latency_ms = 0;
+  m_queue.ResetStats();
+}
+
 bool NavMsgBus::RegisterKey(const std::string& key) {
   std::lock_guard lock(m_mutex);
   auto rv = m_active_messages.insert(key);
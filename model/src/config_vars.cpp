@@ -59,8 +59,10 @@ bool g_bGDAL_Debug = false;
 bool g_bGLexpert = false;
 bool g_bHighliteTracks = false;
 bool g_bInlandEcdis = false;
+bool g_bLazyTrackLoad = false;
 bool g_bLookAhead = false;
 bool g_bMagneticAPB = false;
+bool g_bMbtilesPrefetch = false;
 bool g_bNavAidRadarRingsShown = false;
 bool g_bopengl = false;
 bool g_bOverruleScaMin = false;
@@ -183,10 +185,12 @@ int g_lastClientRecth = 0;
 int g_lastClientRectw = 0;
 int g_lastClientRectx = 0;
 int g_lastClientRecty = 0;
+int g_lazyTrackPoints = 0;
 int g_maintoolbar_x = 0;
 int g_maintoolbar_y = 0;
 int g_maxWPNameLength;
 int g_maxzoomin = 0;
+int g_mbtilesCacheMB = 0;
 int g_mbtilesMaxLayers = 2;
 int g_memCacheLimit = 0;
 int g_MemFootMB = 0;
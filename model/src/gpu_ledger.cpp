@@ -0,0 +1,150 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement gpu_ledger.h -- GpuLedger
+ */
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "model/gpu_ledger.h"
+
+GpuLedger& GpuLedger::GetInstance() {
+  static GpuLedger instance;
+  return instance;
+}
+
+GpuLedger::Handle GpuLedger::Register(const std::string& owner, Kind kind,
+                                      size_t bytes, Evictor evictor) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Handle handle = m_next_handle++;
+  m_lru.push_front(handle);
+  m_entries.emplace(handle, Entry{owner, kind, bytes, m_frame,
+                                  std::move(evictor), m_lru.begin()});
+  m_used[static_cast<size_t>(kind)] += bytes;
+  return handle;
+}
+
+void GpuLedger::Resize(Handle handle, size_t bytes) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(handle);
+  if (it == m_entries.end()) return;
+  size_t& used = m_used[static_cast<size_t>(it->second.kind)];
+  used = used - it->second.bytes + bytes;
+  it->second.bytes = bytes;
+}
+
+void GpuLedger::Touch(Handle handle) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(handle);
+  if (it == m_entries.end()) return;
+  it->second.frame = m_frame;
+  m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+}
+
+void GpuLedger::Release(Handle handle) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(handle);
+  if (it != m_entries.end()) Erase(it);
+}
+
+void GpuLedger::Erase(std::unordered_map<Handle, Entry>::iterator it) {
+  m_used[static_cast<size_t>(it->second.kind)] -= it->second.bytes;
+  m_lru.erase(it->second.lru);
+  m_entries.erase(it);
+}
+
+void GpuLedger::NextFrame() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_frame++;
+}
+
+uint64_t GpuLedger::GetFrame() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_frame;
+}
+
+size_t GpuLedger::GetUsed() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t used = 0;
+  for (size_t bytes : m_used) used += bytes;
+  return used;
+}
+
+size_t GpuLedger::GetUsed(Kind kind) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_used[static_cast<size_t>(kind)];
+}
+
+size_t GpuLedger::GetCount() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+size_t GpuLedger::Enforce(size_t target, unsigned keep_frames) {
+  // Collect the evictors under the lock, but invoke them without it since
+  // they typically call back into the ledger.
+  std::vector<Evictor> evictors;
+  size_t evicted = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t used = 0;
+    for (size_t bytes : m_used) used += bytes;
+    keep_frames = std::max(keep_frames, 1u);
+    while (used > target && !m_lru.empty()) {
+      auto it = m_entries.find(m_lru.back());
+      if (it->second.frame + keep_frames > m_frame) break;
+      used -= it->second.bytes;
+      evicted += it->second.bytes;
+      evictors.push_back(std::move(it->second.evictor));
+      Erase(it);
+    }
+  }
+  for (auto& evictor : evictors) {
+    if (evictor) evictor();
+  }
+  return evicted;
+}
+
+std::vector<GpuLedger::OwnerStats> GpuLedger::GetStats() const {
+  std::map<std::string, OwnerStats> by_owner;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& kv : m_entries) {
+      const Entry& entry = kv.second;
+      OwnerStats& stats = by_owner[entry.owner];
+      stats.bytes += entry.bytes;
+      stats.bytes_by_kind[static_cast<size_t>(entry.kind)] += entry.bytes;
+      stats.resources++;
+    }
+  }
+  std::vector<OwnerStats> result;
+  result.reserve(by_owner.size());
+  for (auto& kv : by_owner) {
+    kv.second.owner = kv.first;
+    result.push_back(std::move(kv.second));
+  }
+  std::stable_sort(result.begin(), result.end(),
+                   [](const OwnerStats& a, const OwnerStats& b) {
+                     return a.bytes > b.bytes;
+                   });
+  return result;
+}
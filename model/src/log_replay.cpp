@@ -0,0 +1,134 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement log_replay.h -- replay timestamps and pacing.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#include "model/log_replay.h"
+
+/** Return value of hex digit c, -1 if not a hex digit. */
+static int HexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool ParseLogTime(const std::string& line, double& secs) {
+  if (line.size() < 3) return false;
+  if (line[0] == '(') {
+    char* end = nullptr;
+    double value = std::strtod(line.c_str() + 1, &end);
+    if (end == line.c_str() + 1 || *end != ')') return false;
+    secs = value;
+    return true;
+  }
+  if (line[0] == '\\') {
+    size_t tag_end = line.find('\\', 1);
+    if (tag_end == std::string::npos) return false;
+    for (size_t pos = 1; pos < tag_end;) {
+      if (line.compare(pos, 2, "c:") == 0) {
+        char* end = nullptr;
+        long long value = std::strtoll(line.c_str() + pos + 2, &end, 10);
+        if (end == line.c_str() + pos + 2) return false;
+        // Some loggers use milliseconds rather than seconds.
+        secs = value > 100000000000LL ? value / 1000.0 : value;
+        return true;
+      }
+      pos = line.find(',', pos);
+      if (pos == std::string::npos || pos > tag_end) break;
+      pos += 1;
+    }
+  }
+  return false;
+}
+
+bool ParseCandumpLine(const std::string& line, std::string& iface,
+                      uint32_t& can_id, std::vector<unsigned char>& data) {
+  size_t pos = line.find(')');
+  if (line.empty() || line[0] != '(' || pos == std::string::npos) return false;
+  pos = line.find_first_not_of(' ', pos + 1);
+  if (pos == std::string::npos) return false;
+  size_t iface_end = line.find(' ', pos);
+  if (iface_end == std::string::npos) return false;
+  size_t hash = line.find('#', iface_end);
+  if (hash == std::string::npos) return false;
+
+  size_t id_start = line.find_first_not_of(' ', iface_end);
+  if (hash == id_start || hash - id_start > 8) return false;
+  uint32_t id = 0;
+  for (size_t i = id_start; i < hash; i++) {
+    int v = HexValue(line[i]);
+    if (v < 0) return false;
+    id = id << 4 | v;
+  }
+  std::vector<unsigned char> bytes;
+  size_t i = hash + 1;
+  for (; i + 1 < line.size(); i += 2) {
+    int hi = HexValue(line[i]);
+    int lo = HexValue(line[i + 1]);
+    if (hi < 0 || lo < 0) break;
+    bytes.push_back(static_cast<unsigned char>(hi << 4 | lo));
+  }
+  // Reject CAN FD ("##"), remote frames ("R") and trailing garbage.
+  if (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i])))
+    return false;
+  if (bytes.size() > 8) return false;
+
+  iface = line.substr(pos, iface_end - pos);
+  can_id = id;
+  data = std::move(bytes);
+  return true;
+}
+
+ReplayPacer::ReplayPacer(double speed)
+    : m_speed(0), m_anchored(false), m_log_start(0), m_last_ts(0) {
+  SetSpeed(speed);
+}
+
+void ReplayPacer::SetSpeed(double speed) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_speed = std::min(std::max(speed, 0.0), kMaxSpeed);
+  m_anchored = false;  // Restart pacing from next line at new speed.
+}
+
+double ReplayPacer::GetSpeed() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_speed;
+}
+
+ReplayPacer::Clock::time_point ReplayPacer::Due(double ts,
+                                                Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_speed <= 0) return now;
+  if (!m_anchored || ts < m_last_ts || ts - m_last_ts > kMaxGap) {
+    m_anchored = true;
+    m_log_start = ts;
+    m_wall_start = now;
+  }
+  m_last_ts = ts;
+  std::chrono::duration<double> offset((ts - m_log_start) / m_speed);
+  return m_wall_start +
+         std::chrono::duration_cast<Clock::duration>(offset);
+}
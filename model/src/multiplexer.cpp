@@ -185,14 +185,19 @@ Multiplexer::Multiplexer(const MuxLogCallbacks &cb, bool &filter_behaviour)
 
     : m_log_callbacks(cb),
       m_legacy_input_filter_behaviour(filter_behaviour),
-      m_new_msgtype_lstnr(NavMsgBus::GetInstance().new_msg_event,
-                          [&](ObservedEvt &) { OnNewMessageType(); }),
       m_n2k_repeat_count(0),
       m_last_pgn_logged(0) {
   if (g_GPS_Ident.IsEmpty()) g_GPS_Ident = "Generic";
+  // All messages are handled, one main loop call per batch instead of one
+  // event for each message.
+  m_batch_listener = NavMsgBus::GetInstance().AddBatchListener(
+      [&](const NavMsgBatch &batch) { HandleBatch(batch); },
+      NavMsgDelivery::kGuiThread);
 }
 
-Multiplexer::~Multiplexer() = default;
+Multiplexer::~Multiplexer() {
+  NavMsgBus::GetInstance().RemoveBatchListener(m_batch_listener);
+}
 
 void Multiplexer::LogOutputMessage(const std::shared_ptr<const NavMsg> &msg,
                                    NavmsgStatus ns) const {
@@ -345,23 +350,15 @@ bool Multiplexer::HandleN2kLog(
   return true;
 }
 
-void Multiplexer::OnNewMessageType() {
-  for (auto msg_key : NavMsgBus::GetInstance().GetActiveMessages()) {
-    if (m_listeners.find(msg_key) != m_listeners.end()) continue;
-    auto key_parts = ocpn::split(msg_key, "::");
-    switch (NavMsg::GetBusByKey(msg_key)) {
+void Multiplexer::HandleBatch(const NavMsgBatch &batch) {
+  for (const auto &msg : batch) {
+    switch (msg->bus) {
       case NavAddr::Bus::N0183:
-        m_listeners[msg_key] =
-            ObsListener(RawKey(key_parts[1]), [&](ObservedEvt &ev) {
-              HandleN0183(UnpackEvtPointer<Nmea0183Msg>(ev));
-            });
+        HandleN0183(std::static_pointer_cast<const Nmea0183Msg>(msg));
         break;
 
       case NavAddr::Bus::N2000:
-        m_listeners[msg_key] =
-            ObsListener(RawKey(key_parts[1]), [&](ObservedEvt &ev) {
-              HandleN2kLog(UnpackEvtPointer<Nmea2000Msg>(ev));
-            });
+        HandleN2kLog(std::static_pointer_cast<const Nmea2000Msg>(msg));
         break;
 
       default:
@@ -1277,13 +1277,16 @@ bool NavObjectCollection1::CreateNavObjGPXRoutes() {
 bool NavObjectCollection1::CreateNavObjGPXTracks() {
   // Tracks
   for (Track *pTrack : g_TrackList) {
-    if (pTrack->GetnPoints()) {
+    if (pTrack->GetPointCount()) {
       if (!pTrack->m_bIsInLayer && !pTrack->m_btemp) {
         pugi::xml_node doc = root();
         pugi::xml_node gpx = doc.first_child();
         pugi::xml_node new_node = gpx.append_child("trk");
 
+        //  Do not keep all tracks loaded at once.
+        bool paged_out = pTrack->IsPagedOut();
         GPXCreateTrk(new_node, pTrack, 0);
+        if (paged_out) pTrack->PageOut();
       }
     }
   }
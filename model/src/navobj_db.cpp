@@ -21,6 +21,7 @@
  * Implement navobj_db.h -- MySQL based storage for routes, tracks, etc.
  */
 
+#include <chrono>
 #include <cmath>
 #include <iomanip>
 #include <memory>
@@ -32,6 +33,7 @@
 
 #include "model/base_platform.h"
 #include "model/comm_appmsg_bus.h"
+#include "model/config_vars.h"
 #include "model/navobj_db.h"
 #include "model/navobj_db_util.h"
 #include "model/navutil_base.h"
@@ -41,6 +43,39 @@
 
 static void ReportError(const std::string zmsg);  // forward
 
+/**
+ * Maximum time queued track and route points are kept in memory, i. e.
+ * the data lost on a crash.
+ */
+static const std::chrono::milliseconds kWriteInterval(2000);
+
+static const char* const kUpdateRoutePointSql =
+    "UPDATE routepoints SET "
+    "lat = ?, "
+    "lon = ?, "
+    "Symbol = ?, "
+    "Name = ?, "
+    "description = ?, "
+    "TideStation = ?, "
+    "plan_speed = ?, "
+    "etd = ?, "
+    "Type = ?, "
+    "Time = ?, "
+    "ArrivalRadius = ?, "
+    "RangeRingsNumber = ?, "
+    "RangeRingsStep = ?, "
+    "RangeRingsStepUnits = ?, "
+    "RangeRingsVisible = ?, "
+    "RangeRingsColour = ?, "
+    "ScaleMin = ?, "
+    "ScaleMax = ?, "
+    "UseScale = ?, "
+    "visibility = ?, "
+    "viz_name = ?, "
+    "shared = ?, "
+    "isolated = ? "
+    "WHERE guid = ?";
+
 static bool executeSQL(sqlite3* db, const char* sql) {
   char* errMsg = nullptr;
   if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
@@ -59,6 +94,54 @@ static bool executeSQL(sqlite3* db, wxString& sql) {
   return executeSQL(db, sql.ToStdString().c_str());
 }
 
+/**
+ * Compute missing trk_extents rows from the trk_points table. CROSS JOIN
+ * makes SQLite visit tracks first, so this is cheap when nothing is
+ * missing.
+ */
+static bool RebuildTrackExtents(sqlite3* db) {
+  const char* sql = R"(
+        INSERT OR IGNORE INTO trk_extents
+            (track_guid, lat_min, lat_max, lon_min, lon_max, points, start_time)
+        SELECT p.track_guid, MIN(latitude), MAX(latitude),
+               MIN(longitude), MAX(longitude), COUNT(*),
+               (SELECT timestamp FROM trk_points AS first
+                WHERE first.track_guid = p.track_guid
+                ORDER BY point_order ASC LIMIT 1)
+        FROM tracks AS t CROSS JOIN trk_points AS p ON p.track_guid = t.guid
+        WHERE t.guid NOT IN (SELECT track_guid FROM trk_extents)
+        GROUP BY p.track_guid
+    )";
+  return executeSQL(db, sql);
+}
+
+/** Return Track::Length() of a stored track without loading its points. */
+static double ComputeTrackLength(sqlite3* db, const std::string& guid) {
+  const char* sql = R"(
+        SELECT latitude, longitude
+        FROM trk_points
+        WHERE track_guid = ?
+        ORDER BY point_order ASC
+    )";
+  sqlite3_stmt* stmt;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return -1;
+  sqlite3_bind_text(stmt, 1, guid.c_str(), -1, SQLITE_TRANSIENT);
+  double total = 0;
+  double lat = 0;
+  double lon = 0;
+  bool first = true;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    double next_lat = sqlite3_column_double(stmt, 0);
+    double next_lon = sqlite3_column_double(stmt, 1);
+    if (!first) total += Track::LegLength(lat, lon, next_lat, next_lon);
+    lat = next_lat;
+    lon = next_lon;
+    first = false;
+  }
+  sqlite3_finalize(stmt);
+  return total;
+}
+
 bool CreateTables(sqlite3* db) {
   // Track tables
   const char* create_tables_sql = R"(
@@ -174,7 +257,82 @@ bool CreateTables(sqlite3* db) {
 
   if (!executeSQL(db, create_tables_sql)) return false;
 
-  return true;
+  // Track bounding boxes, the spatial index used to decide which tracks
+  // to page in when tracks are loaded lazily. Kept up to date by triggers
+  // on trk_points, so all insert paths including the write queue are
+  // covered. A partial delete drops the row, it is then rebuilt at next
+  // startup. The track length is valid when length_points matches points,
+  // it is updated when loading tracks.
+  const char* create_extents_sql = R"(
+        CREATE TABLE IF NOT EXISTS trk_extents (
+            track_guid TEXT PRIMARY KEY NOT NULL,
+            lat_min REAL,
+            lat_max REAL,
+            lon_min REAL,
+            lon_max REAL,
+            points INTEGER NOT NULL DEFAULT 0,
+            start_time TEXT,
+            length REAL,
+            length_points INTEGER NOT NULL DEFAULT 0,
+            FOREIGN KEY (track_guid) REFERENCES tracks(guid) ON DELETE CASCADE
+        );
+
+        CREATE TRIGGER IF NOT EXISTS trk_points_extent_insert
+        AFTER INSERT ON trk_points
+        BEGIN
+            INSERT OR IGNORE INTO trk_extents
+                (track_guid, lat_min, lat_max, lon_min, lon_max, start_time)
+            VALUES (NEW.track_guid, NEW.latitude, NEW.latitude,
+                    NEW.longitude, NEW.longitude, NEW.timestamp);
+            UPDATE trk_extents SET
+                lat_min = MIN(lat_min, NEW.latitude),
+                lat_max = MAX(lat_max, NEW.latitude),
+                lon_min = MIN(lon_min, NEW.longitude),
+                lon_max = MAX(lon_max, NEW.longitude),
+                points = points + 1
+            WHERE track_guid = NEW.track_guid;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS trk_points_extent_delete
+        AFTER DELETE ON trk_points
+        BEGIN
+            DELETE FROM trk_extents WHERE track_guid = OLD.track_guid;
+        END;
+        )";
+  if (!executeSQL(db, create_extents_sql)) return false;
+  sqlite3_stmt* stmt;
+  if (sqlite3_prepare_v2(db, "SELECT length FROM trk_extents", -1, &stmt,
+                         nullptr) == SQLITE_OK) {
+    sqlite3_finalize(stmt);
+  } else {
+    // Table created before the length columns were added.
+    const char* add_length_sql = R"(
+        ALTER TABLE trk_extents ADD COLUMN length REAL;
+        ALTER TABLE trk_extents
+            ADD COLUMN length_points INTEGER NOT NULL DEFAULT 0;
+        )";
+    if (!executeSQL(db, add_length_sql)) return false;
+  }
+  if (!RebuildTrackExtents(db)) return false;
+
+  // Simplified track pyramids, see TrackLod. Valid when points matches the
+  // number of track points; dropped when points are deleted and rebuilt
+  // when the track is drawn.
+  const char* create_lod_sql = R"(
+        CREATE TABLE IF NOT EXISTS trk_lod (
+            track_guid TEXT PRIMARY KEY NOT NULL,
+            points INTEGER NOT NULL,
+            data BLOB,
+            FOREIGN KEY (track_guid) REFERENCES tracks(guid) ON DELETE CASCADE
+        );
+
+        CREATE TRIGGER IF NOT EXISTS trk_points_lod_delete
+        AFTER DELETE ON trk_points
+        BEGIN
+            DELETE FROM trk_lod WHERE track_guid = OLD.track_guid;
+        END;
+        )";
+  return executeSQL(db, create_lod_sql);
 }
 
 bool TrackExists(sqlite3* db, const std::string& track_guid) {
@@ -606,18 +764,47 @@ NavObj_dB::NavObj_dB() {
                                   SQLITE_OPEN_READWRITE, NULL);
   sqlite3_exec(m_db, "PRAGMA foreign_keys = ON;", nullptr, nullptr, nullptr);
 
+  // WAL lets the write queue commit without blocking readers, and makes
+  // each commit a single sequential write.
+  sqlite3_exec(m_db, "PRAGMA journal_mode = WAL;", nullptr, nullptr, nullptr);
+  sqlite3_exec(m_db, "PRAGMA synchronous = NORMAL;", nullptr, nullptr,
+               nullptr);
+  sqlite3_busy_timeout(m_db, NavObjWriteQueue::kBusyTimeout);
+
+  if (m_open_result == SQLITE_OK) {
+    m_write_queue = std::make_unique<NavObjWriteQueue>(
+        db_filename.ToStdString(), kWriteInterval, [](const std::string& msg) {
+          wxLogMessage("navobj database write queue error: %s", msg.c_str());
+        });
+    if (!m_write_queue->IsOpen()) m_write_queue.reset();
+  }
+
   // Init class members
   m_importing = false;
 }
 
-NavObj_dB::~NavObj_dB() { sqlite3_close_v2(m_db); }
+NavObj_dB::~NavObj_dB() {
+  m_write_queue.reset();
+  sqlite3_close_v2(m_db);
+}
 
 void NavObj_dB::Close() {
+  m_write_queue.reset();
   sqlite3_close_v2(m_db);
   m_db = nullptr;
+  m_track_guids.clear();
+}
+
+void NavObj_dB::FlushWrites() {
+  if (m_write_queue) m_write_queue->Flush();
+}
+
+NavObjWriteStats NavObj_dB::GetWriteStats() const {
+  return m_write_queue ? m_write_queue->GetStats() : NavObjWriteStats();
 }
 
 bool NavObj_dB::FullSchemaMigrate(wxFrame* frame) {
+  FlushWrites();
   // Call successive schema updates as defined.
   if (needsMigration_0_1(m_db)) {
     std::string rs = SchemaUpdate_0_1(m_db, frame);
@@ -645,6 +832,7 @@ bool NavObj_dB::FullSchemaMigrate(wxFrame* frame) {
 }
 
 bool NavObj_dB::ImportLegacyNavobj(wxFrame* frame) {
+  FlushWrites();
   wxString navobj_filename = g_BasePlatform->GetPrivateDataDir() +
                              wxFileName::GetPathSeparator() + "navobj.xml";
   bool rv = false;
@@ -801,7 +989,11 @@ void NavObj_dB::LoadNavObjects() {
 }
 
 bool NavObj_dB::InsertTrack(Track* track) {
-  if (TrackExists(m_db, track->m_GUID.ToStdString())) return false;
+  FlushWrites();
+  if (TrackExists(m_db, track->m_GUID.ToStdString())) {
+    m_track_guids.insert(track->m_GUID.ToStdString());
+    return false;
+  }
 
   bool rv = false;
   char* errMsg = 0;
@@ -818,6 +1010,7 @@ bool NavObj_dB::InsertTrack(Track* track) {
     sqlite3_exec(m_db, "COMMIT", 0, 0, &errMsg);
     return false;
   }
+  m_track_guids.insert(track->m_GUID.ToStdString());
 
   UpdateDBTrackAttributes(track);
 
@@ -850,6 +1043,7 @@ bool NavObj_dB::InsertTrack(Track* track) {
 };
 
 bool NavObj_dB::UpdateTrack(Track* track) {
+  FlushWrites();
   bool rv = false;
   char* errMsg = 0;
 
@@ -894,6 +1088,9 @@ bool NavObj_dB::UpdateTrack(Track* track) {
 
   sqlite3_exec(m_db, "COMMIT", 0, 0, nullptr);
 
+  // Deleting the points dropped the saved pyramid.
+  if (const TrackLod* lod = track->GetLod()) SaveTrackLod(track, *lod);
+
   rv = true;
   if (errMsg) rv = false;
   return rv;
@@ -988,8 +1185,23 @@ bool NavObj_dB::UpdateDBTrackAttributes(Track* track) {
 }
 
 bool NavObj_dB::AddTrackPoint(Track* track, TrackPoint* point) {
-  //  If track does not yet exist in dB, return
-  if (!TrackExists(m_db, track->m_GUID.ToStdString())) return false;
+  //  If track does not yet exist in dB, return. Checked in memory: this is
+  //  called for each point of every track, also the non persistent ones.
+  if (m_track_guids.count(track->m_GUID.ToStdString()) == 0) return false;
+
+  if (m_write_queue) {
+    // The track might be deleted before the point is written.
+    const char* sql = R"(
+        INSERT INTO trk_points (track_guid, latitude, longitude, timestamp, point_order)
+        SELECT ?1, ?2, ?3, ?4, ?5
+        WHERE EXISTS (SELECT 1 FROM tracks WHERE guid = ?1)
+    )";
+    m_write_queue->Push(
+        {{sql,
+          {track->m_GUID.ToStdString(), point->m_lat, point->m_lon,
+           point->GetTimeString(), track->GetnPoints() - 1}}});
+    return true;
+  }
 
   // Get next point order
   int this_point_index = track->GetnPoints();
@@ -1003,13 +1215,46 @@ bool NavObj_dB::AddTrackPoint(Track* track, TrackPoint* point) {
   return true;
 }
 
+bool NavObj_dB::SaveTrackLod(Track* track, const TrackLod& lod) {
+  const char* sql = R"(
+        INSERT OR REPLACE INTO trk_lod (track_guid, points, data)
+        SELECT ?1, ?2, ?3
+        WHERE EXISTS (SELECT 1 FROM tracks WHERE guid = ?1)
+    )";
+  std::string guid = track->m_GUID.ToStdString();
+  int64_t points = static_cast<int64_t>(lod.GetCount());
+  if (m_write_queue) {
+    m_write_queue->Push({{sql, {guid, points, lod.Serialize()}}},
+                        "trklod:" + guid);
+    return true;
+  }
+  sqlite3_stmt* stmt;
+  if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    ReportError("SaveTrackLod:prepare");
+    return false;
+  }
+  std::vector<uint8_t> data = lod.Serialize();
+  sqlite3_bind_text(stmt, 1, guid.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int64(stmt, 2, points);
+  sqlite3_bind_blob(stmt, 3, data.data(), static_cast<int>(data.size()),
+                    SQLITE_STATIC);
+  bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+  if (!ok) ReportError("SaveTrackLod:step");
+  sqlite3_finalize(stmt);
+  return ok;
+}
+
 bool NavObj_dB::LoadAllTracks() {
+  FlushWrites();
   const char* sql = R"(
         SELECT guid, name,
         description, visibility, start_string, end_string,
         width, style, color,
-        created_at
-        FROM tracks
+        created_at,
+        e.points, e.lat_min, e.lat_max, e.lon_min, e.lon_max, e.start_time,
+        l.points, l.data, e.length, e.length_points
+        FROM tracks LEFT JOIN trk_extents AS e ON e.track_guid = tracks.guid
+        LEFT JOIN trk_lod AS l ON l.track_guid = tracks.guid
         ORDER BY created_at ASC
     )";
 
@@ -1018,6 +1263,8 @@ bool NavObj_dB::LoadAllTracks() {
     return false;
   }
 
+  //  Lengths computed for paged out tracks, stored when done reading.
+  std::vector<std::pair<std::string, double>> new_lengths;
   while (sqlite3_step(stmt) == SQLITE_ROW) {
     std::string guid =
         reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
@@ -1036,108 +1283,162 @@ bool NavObj_dB::LoadAllTracks() {
         reinterpret_cast<const char*>(sqlite3_column_text(stmt, 8));
     std::string created =
         reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
+    int extent_points = sqlite3_column_int(stmt, 10);
+
+    Track* new_trk = new Track;
+    new_trk->m_GUID = guid;
+    m_track_guids.insert(guid);
+
+    // Set all the track attributes
+    new_trk->SetVisible(visibility == 1);
+    new_trk->SetName(name.c_str());
+    new_trk->m_TrackDescription = description.c_str();
+    new_trk->m_TrackStartString = start_string.c_str();
+    new_trk->m_TrackEndString = end_string.c_str();
+    new_trk->m_width = width;
+    new_trk->m_style = (wxPenStyle)style;
+    new_trk->m_Colour = color;
+
+    if (g_bLazyTrackLoad && extent_points > 0) {
+      //  Only the bounding box, points are paged in when needed.
+      LLBBox extent;
+      extent.Set(sqlite3_column_double(stmt, 11),
+                 sqlite3_column_double(stmt, 13),
+                 sqlite3_column_double(stmt, 12),
+                 sqlite3_column_double(stmt, 14));
+      const char* start_time =
+          reinterpret_cast<const char*>(sqlite3_column_text(stmt, 15));
+      //  Lists and sorts by length should not page in every track.
+      double length = sqlite3_column_double(stmt, 18);
+      if (sqlite3_column_type(stmt, 18) == SQLITE_NULL ||
+          sqlite3_column_int(stmt, 19) != extent_points) {
+        length = ComputeTrackLength(m_db, guid);
+        if (length >= 0) new_lengths.emplace_back(guid, length);
+      }
+      new_trk->SetPagedOut(extent, start_time ? start_time : "",
+                           extent_points, length);
+    } else {
+      //  Add the trk_points
+      LoadTrackPoints(new_trk);
+      if (new_trk->GetnPoints() == 0) {
+        delete new_trk;
+        continue;
+      }
+    }
 
-    Track* new_trk = NULL;
+    // Use saved pyramid if up to date, otherwise it is rebuilt when needed.
+    if (sqlite3_column_int(stmt, 16) == extent_points && extent_points > 0) {
+      new_trk->SetLod(sqlite3_column_blob(stmt, 17),
+                      sqlite3_column_bytes(stmt, 17));
+    }
 
-    //  Add the trk_points
-    const char* sql = R"(
-        SELECT  latitude, longitude, timestamp, point_order
-        FROM trk_points
+    //    Add the HTML links
+    const char* sqlh = R"(
+        SELECT guid, html_link, html_description, html_type
+        FROM track_html_links
         WHERE track_guid = ?
-        ORDER BY point_order ASC
+        ORDER BY html_type ASC
     )";
 
-    sqlite3_stmt* stmtp;
-    if (sqlite3_prepare_v2(m_db, sql, -1, &stmtp, nullptr) != SQLITE_OK) {
-      return false;
-    }
+    sqlite3_stmt* stmth;
 
-    sqlite3_bind_text(stmtp, 1, guid.c_str(), -1, SQLITE_TRANSIENT);
-
-    int GPXTrkSeg = 1;
-    while (sqlite3_step(stmtp) == SQLITE_ROW) {
-      if (!new_trk) {
-        new_trk = new Track;
-        new_trk->m_GUID = guid;
-
-        // Set all the track attributes
-        new_trk->SetVisible(visibility == 1);
-        new_trk->SetName(name.c_str());
-        new_trk->m_TrackDescription = description.c_str();
-        new_trk->m_TrackStartString = start_string.c_str();
-        new_trk->m_TrackEndString = end_string.c_str();
-        new_trk->m_width = width;
-        new_trk->m_style = (wxPenStyle)style;
-        new_trk->m_Colour = color;
-      }
+    if (sqlite3_prepare_v2(m_db, sqlh, -1, &stmth, nullptr) == SQLITE_OK) {
+      sqlite3_bind_text(stmth, 1, new_trk->m_GUID.ToStdString().c_str(), -1,
+                        SQLITE_TRANSIENT);
 
-      double latitude = sqlite3_column_double(stmtp, 0);
-      double longitude = sqlite3_column_double(stmtp, 1);
-      std::string timestamp =
-          reinterpret_cast<const char*>(sqlite3_column_text(stmtp, 2));
-      int point_order = sqlite3_column_int(stmtp, 3);
+      while (sqlite3_step(stmth) == SQLITE_ROW) {
+        std::string link_guid =
+            reinterpret_cast<const char*>(sqlite3_column_text(stmth, 0));
+        std::string link_link =
+            reinterpret_cast<const char*>(sqlite3_column_text(stmth, 1));
+        std::string link_description =
+            reinterpret_cast<const char*>(sqlite3_column_text(stmth, 2));
+        std::string link_type =
+            reinterpret_cast<const char*>(sqlite3_column_text(stmth, 3));
 
-      auto point = new TrackPoint(latitude, longitude, timestamp);
+        Hyperlink* h = new Hyperlink();
+        h->DescrText = link_description;
+        h->Link = link_link;
+        h->LType = link_type;
 
-      point->m_GPXTrkSegNo = GPXTrkSeg;
-      new_trk->AddPoint(point);
+        new_trk->m_TrackHyperlinkList->push_back(h);
+      }
+
+      sqlite3_finalize(stmth);
+
+    } else {
+      delete new_trk;
+      sqlite3_finalize(stmt);
+      return false;
     }
-    sqlite3_finalize(stmtp);
 
-    if (new_trk) {
-      new_trk->SetCurrentTrackSeg(GPXTrkSeg);
+    //  Insert the track into the global list
+    g_TrackList.push_back(new_trk);
+    //    Add the selectable points and segments of the track
+    if (!new_trk->IsPagedOut()) pSelect->AddAllSelectableTrackSegments(new_trk);
+  }
+  sqlite3_finalize(stmt);
 
-      //    Add the HTML links
-      const char* sqlh = R"(
-        SELECT guid, html_link, html_description, html_type
-        FROM track_html_links
+  if (!new_lengths.empty()) {
+    const char* sqlu = R"(
+        UPDATE trk_extents SET length = ?, length_points = points
         WHERE track_guid = ?
-        ORDER BY html_type ASC
     )";
+    sqlite3_stmt* stmtu;
+    if (sqlite3_prepare_v2(m_db, sqlu, -1, &stmtu, nullptr) == SQLITE_OK) {
+      executeSQL(m_db, "BEGIN TRANSACTION");
+      for (const auto& kv : new_lengths) {
+        sqlite3_bind_double(stmtu, 1, kv.second);
+        sqlite3_bind_text(stmtu, 2, kv.first.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmtu);
+        sqlite3_reset(stmtu);
+      }
+      executeSQL(m_db, "COMMIT");
+      sqlite3_finalize(stmtu);
+    }
+  }
+  return true;
+}
 
-      sqlite3_stmt* stmt;
-
-      if (sqlite3_prepare_v2(m_db, sqlh, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, new_trk->m_GUID.ToStdString().c_str(), -1,
-                          SQLITE_TRANSIENT);
-
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-          std::string link_guid =
-              reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-          std::string link_link =
-              reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-          std::string link_description =
-              reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-          std::string link_type =
-              reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+bool NavObj_dB::LoadTrackPoints(Track* track) {
+  const char* sql = R"(
+        SELECT  latitude, longitude, timestamp, point_order
+        FROM trk_points
+        WHERE track_guid = ?
+        ORDER BY point_order ASC
+    )";
 
-          Hyperlink* h = new Hyperlink();
-          h->DescrText = link_description;
-          h->Link = link_link;
-          h->LType = link_type;
+  sqlite3_stmt* stmt;
+  if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    ReportError("LoadTrackPoints:prepare");
+    return false;
+  }
 
-          new_trk->m_TrackHyperlinkList->push_back(h);
-          int yyp = 4;
-        }
+  sqlite3_bind_text(stmt, 1, track->m_GUID.ToStdString().c_str(), -1,
+                    SQLITE_TRANSIENT);
 
-        sqlite3_finalize(stmt);
+  int GPXTrkSeg = 1;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    double latitude = sqlite3_column_double(stmt, 0);
+    double longitude = sqlite3_column_double(stmt, 1);
+    std::string timestamp =
+        reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
 
-      } else {
-        return false;
-      }
+    auto point = new TrackPoint(latitude, longitude, timestamp);
 
-      //  Insert the track into the global list
-      g_TrackList.push_back(new_trk);
-      //    Add the selectable points and segments of the track
-      pSelect->AddAllSelectableTrackSegments(new_trk);
-    }
+    point->m_GPXTrkSegNo = GPXTrkSeg;
+    track->AddPoint(point);
   }
+  sqlite3_finalize(stmt);
+  track->SetCurrentTrackSeg(GPXTrkSeg);
   return true;
 }
 
 bool NavObj_dB::DeleteTrack(Track* track) {
+  FlushWrites();
   if (!track) return false;
   std::string track_guid = track->m_GUID.ToStdString();
+  m_track_guids.erase(track_guid);
   const char* sql = "DELETE FROM tracks WHERE guid = ?";
   sqlite3_stmt* stmt;
 
@@ -1159,6 +1460,7 @@ bool NavObj_dB::DeleteTrack(Track* track) {
 //  Route support
 
 bool NavObj_dB::InsertRoute(Route* route) {
+  FlushWrites();
   bool rv = false;
   char* errMsg = 0;
 
@@ -1223,6 +1525,7 @@ bool NavObj_dB::InsertRoute(Route* route) {
 };
 
 bool NavObj_dB::UpdateRoute(Route* route) {
+  FlushWrites();
   bool rv = false;
   char* errMsg = 0;
 
@@ -1296,6 +1599,7 @@ bool NavObj_dB::UpdateRoute(Route* route) {
 };
 
 bool NavObj_dB::UpdateRouteViz(Route* route) {
+  FlushWrites();
   bool rv = false;
   char* errMsg = 0;
   if (!RouteExistsDB(m_db, route->m_GUID.ToStdString())) return false;
@@ -1415,32 +1719,7 @@ bool NavObj_dB::UpdateDBRouteAttributes(Route* route) {
 }
 
 bool NavObj_dB::UpdateDBRoutePointAttributes(RoutePoint* point) {
-  const char* sql =
-      "UPDATE routepoints SET "
-      "lat = ?, "
-      "lon = ?, "
-      "Symbol = ?, "
-      "Name = ?, "
-      "description = ?, "
-      "TideStation = ?, "
-      "plan_speed = ?, "
-      "etd = ?, "
-      "Type = ?, "
-      "Time = ?, "
-      "ArrivalRadius = ?, "
-      "RangeRingsNumber = ?, "
-      "RangeRingsStep = ?, "
-      "RangeRingsStepUnits = ?, "
-      "RangeRingsVisible = ?, "
-      "RangeRingsColour = ?, "
-      "ScaleMin = ?, "
-      "ScaleMax = ?, "
-      "UseScale = ?, "
-      "visibility = ?, "
-      "viz_name = ?, "
-      "shared = ?, "
-      "isolated = ? "
-      "WHERE guid = ?";
+  const char* sql = kUpdateRoutePointSql;
 
   sqlite3_stmt* stmt;
   if (sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
@@ -1549,6 +1828,7 @@ bool NavObj_dB::UpdateDBRoutePointAttributes(RoutePoint* point) {
 }
 
 bool NavObj_dB::UpdateDBRoutePointViz(RoutePoint* point) {
+  FlushWrites();
   const char* sql =
       "UPDATE routepoints SET "
       "visibility = ? "
@@ -1576,6 +1856,7 @@ bool NavObj_dB::UpdateDBRoutePointViz(RoutePoint* point) {
 }
 
 bool NavObj_dB::DeleteRoute(Route* route) {
+  FlushWrites();
   if (m_importing) return false;
   if (!route) return false;
   std::string route_guid = route->m_GUID.ToStdString();
@@ -1597,6 +1878,7 @@ bool NavObj_dB::DeleteRoute(Route* route) {
 }
 
 bool NavObj_dB::LoadAllRoutes() {
+  FlushWrites();
   const char* sql =
       "SELECT "
       "guid, "
@@ -1936,6 +2218,7 @@ bool NavObj_dB::LoadAllRoutes() {
 }
 
 bool NavObj_dB::LoadAllPoints() {
+  FlushWrites();
   const char* sqlp =
       "SELECT "
       "p.guid, "
@@ -2093,6 +2376,7 @@ bool NavObj_dB::LoadAllPoints() {
   return true;
 }
 bool NavObj_dB::InsertRoutePoint(RoutePoint* point) {
+  FlushWrites();
   bool rv = false;
   char* errMsg = 0;
 
@@ -2127,6 +2411,7 @@ bool NavObj_dB::InsertRoutePoint(RoutePoint* point) {
 }
 
 bool NavObj_dB::DeleteRoutePoint(RoutePoint* point) {
+  FlushWrites();
   if (m_importing) return false;
   if (!point) return false;
 
@@ -2154,12 +2439,58 @@ bool NavObj_dB::DeleteRoutePoint(RoutePoint* point) {
 
 bool NavObj_dB::UpdateRoutePoint(RoutePoint* point) {
   if (m_importing) return false;
-  if (!RoutePointExists(m_db, point->m_GUID.ToStdString())) return false;
+  std::string guid = point->m_GUID.ToStdString();
+  if (!RoutePointExists(m_db, guid)) return false;
+  if (m_write_queue) {
+    // Points are typically updated many times while dragged, or all at
+    // once when a route is moved. Queue a complete snapshot of the
+    // attributes and links, later updates replace the pending one.
+    time_t etd = -1;
+    if (point->GetManualETD().IsValid()) etd = point->GetManualETD().GetTicks();
+    std::vector<SqlStatement> statements;
+    statements.push_back(
+        {kUpdateRoutePointSql,
+         {point->GetLatitude(), point->GetLongitude(),
+          point->GetIconName().ToStdString(), point->GetName().ToStdString(),
+          point->GetDescription().ToStdString(),
+          point->m_TideStation.ToStdString(), point->GetPlannedSpeed(),
+          static_cast<int64_t>(etd), "type", point->m_timestring.ToStdString(),
+          point->m_WaypointArrivalRadius, point->m_iWaypointRangeRingsNumber,
+          static_cast<double>(point->m_fWaypointRangeRingsStep),
+          point->m_iWaypointRangeRingsStepUnits,
+          static_cast<int>(point->m_bShowWaypointRangeRings),
+          point->m_wxcWaypointRangeRingsColour.GetAsString(wxC2S_HTML_SYNTAX)
+              .ToStdString(),
+          static_cast<int>(point->GetScaMin()),
+          static_cast<int>(point->GetScaMax()),
+          static_cast<int>(point->GetUseSca()),
+          static_cast<int>(point->IsVisible()),
+          static_cast<int>(point->IsNameShown()),
+          static_cast<int>(point->IsShared()),
+          static_cast<int>(point->m_bIsolatedMark), guid}});
+    statements.push_back(
+        {"DELETE FROM routepoint_html_links WHERE routepoint_guid = ?",
+         {guid}});
+    for (Hyperlink* link : *point->m_HyperlinkList) {
+      statements.push_back(
+          {R"(
+              INSERT OR REPLACE INTO routepoint_html_links
+                  (guid, routepoint_guid, html_link, html_description, html_type)
+              SELECT ?1, ?2, ?3, ?4, ?5
+              WHERE EXISTS (SELECT 1 FROM routepoints WHERE guid = ?2)
+          )",
+           {link->GUID, guid, link->Link.ToStdString(),
+            link->DescrText.ToStdString(), link->LType.ToStdString()}});
+    }
+    m_write_queue->Push(std::move(statements), "routepoint:" + guid);
+    return true;
+  }
   UpdateDBRoutePointAttributes(point);
   return true;
 }
 
 bool NavObj_dB::Backup(wxString fileName) {
+  FlushWrites();
   sqlite3_backup* pBackup;
   sqlite3* backupDatabase;
 
@@ -0,0 +1,209 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement navobj_write_queue.h -- NavObjWriteQueue
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "model/navobj_write_queue.h"
+
+NavObjWriteQueue::NavObjWriteQueue(const std::string& path,
+                                   std::chrono::milliseconds interval,
+                                   ErrorFunc on_error)
+    : m_db(nullptr),
+      m_interval(interval),
+      m_on_error(std::move(on_error)),
+      m_busy(false),
+      m_stop(false),
+      m_flush_requests(0) {
+  if (sqlite3_open_v2(path.c_str(), &m_db, SQLITE_OPEN_READWRITE, nullptr) !=
+      SQLITE_OK) {
+    Error("open: " + std::string(sqlite3_errmsg(m_db)));
+    sqlite3_close_v2(m_db);
+    m_db = nullptr;
+    return;
+  }
+  sqlite3_busy_timeout(m_db, kBusyTimeout);
+  sqlite3_exec(m_db,
+               "PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL; "
+               "PRAGMA foreign_keys = ON;",
+               nullptr, nullptr, nullptr);
+  m_thread = std::thread([this] { Worker(); });
+}
+
+NavObjWriteQueue::~NavObjWriteQueue() {
+  if (!m_db) return;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_work_cv.notify_one();
+  m_thread.join();
+  for (auto& kv : m_statements) sqlite3_finalize(kv.second);
+  sqlite3_close_v2(m_db);
+}
+
+void NavObjWriteQueue::Push(std::vector<SqlStatement> statements,
+                            const std::string& key) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_stats.queued++;
+  if (!m_db) {
+    m_stats.errors++;
+    return;
+  }
+  if (!key.empty()) {
+    auto it = m_keys.find(key);
+    if (it != m_keys.end()) {
+      m_pending[it->second].statements = std::move(statements);
+      m_stats.coalesced++;
+      return;
+    }
+  }
+  m_idle_cv.wait(lock, [&] { return m_pending.size() < kMaxPending; });
+  if (m_pending.empty()) m_oldest = std::chrono::steady_clock::now();
+  if (!key.empty()) m_keys[key] = m_pending.size();
+  m_pending.push_back(Mutation{std::move(statements)});
+  if (m_pending.size() == 1 || m_pending.size() >= kMaxBatch) {
+    m_work_cv.notify_one();
+  }
+}
+
+void NavObjWriteQueue::Flush() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_pending.empty() && !m_busy) return;
+  m_flush_requests++;
+  m_work_cv.notify_one();
+  m_idle_cv.wait(lock, [&] { return m_pending.empty() && !m_busy; });
+  m_flush_requests--;
+}
+
+NavObjWriteStats NavObjWriteQueue::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  NavObjWriteStats stats = m_stats;
+  stats.pending = m_pending.size() + (m_busy ? 1 : 0);
+  return stats;
+}
+
+void NavObjWriteQueue::Worker() {
+  std::deque<Mutation> batch;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_work_cv.wait(lock, [&] { return m_stop || !m_pending.empty(); });
+    m_work_cv.wait_until(lock, m_oldest + m_interval, [&] {
+      return m_stop || m_flush_requests > 0 || m_pending.size() >= kMaxBatch;
+    });
+    if (m_pending.empty()) {
+      if (m_stop) break;
+      continue;
+    }
+    batch.swap(m_pending);
+    m_keys.clear();
+    m_busy = true;
+    // Unblock Push() callers waiting for room.
+    m_idle_cv.notify_all();
+    lock.unlock();
+
+    auto start = std::chrono::steady_clock::now();
+    Commit(batch);
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    lock.lock();
+    m_stats.batches++;
+    m_stats.max_batch = std::max(m_stats.max_batch, batch.size());
+    m_stats.last_commit_ms = elapsed.count();
+    m_busy = false;
+    batch.clear();
+    m_idle_cv.notify_all();
+  }
+}
+
+void NavObjWriteQueue::Commit(std::deque<Mutation>& batch) {
+  bool in_transaction =
+      sqlite3_exec(m_db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) ==
+      SQLITE_OK;
+  if (!in_transaction) Error("BEGIN: " + std::string(sqlite3_errmsg(m_db)));
+  size_t executed = 0;
+  for (const auto& mutation : batch) {
+    for (const auto& statement : mutation.statements) {
+      if (Execute(statement)) executed++;
+    }
+  }
+  if (in_transaction &&
+      sqlite3_exec(m_db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+    Error("COMMIT: " + std::string(sqlite3_errmsg(m_db)));
+    sqlite3_exec(m_db, "ROLLBACK", nullptr, nullptr, nullptr);
+    executed = 0;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.statements += executed;
+}
+
+bool NavObjWriteQueue::Execute(const SqlStatement& statement) {
+  sqlite3_stmt* stmt = Prepare(statement.sql);
+  if (!stmt) return false;
+  int index = 1;
+  for (const auto& arg : statement.args) {
+    switch (arg.type) {
+      case SqlValue::Type::kInt:
+        sqlite3_bind_int64(stmt, index, arg.i);
+        break;
+      case SqlValue::Type::kDouble:
+        sqlite3_bind_double(stmt, index, arg.d);
+        break;
+      case SqlValue::Type::kText:
+        sqlite3_bind_text(stmt, index, arg.text.c_str(), -1, SQLITE_STATIC);
+        break;
+      case SqlValue::Type::kBlob:
+        sqlite3_bind_blob(stmt, index, arg.blob.data(),
+                          static_cast<int>(arg.blob.size()), SQLITE_STATIC);
+        break;
+    }
+    index++;
+  }
+  bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+  if (!ok) Error("step: " + std::string(sqlite3_errmsg(m_db)));
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  return ok;
+}
+
+sqlite3_stmt* NavObjWriteQueue::Prepare(const std::string& sql) {
+  auto it = m_statements.find(sql);
+  if (it != m_statements.end()) return it->second;
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v3(m_db, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT,
+                         &stmt, nullptr) != SQLITE_OK) {
+    Error("prepare: " + std::string(sqlite3_errmsg(m_db)));
+    return nullptr;
+  }
+  m_statements.emplace(sql, stmt);
+  return stmt;
+}
+
+void NavObjWriteQueue::Error(const std::string& what) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.errors++;
+  }
+  if (m_on_error) m_on_error(what);
+}
@@ -0,0 +1,231 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement packed_rtree.h -- PackedRTree
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <queue>
+
+#include "model/packed_rtree.h"
+
+void PackedRTree::Build(const std::vector<Box>& boxes) {
+  Clear();
+  m_boxes = boxes;
+  if (m_boxes.empty()) return;
+
+  std::vector<uint32_t> level(m_boxes.size());
+  std::iota(level.begin(), level.end(), 0);
+  level = Pack(std::move(level), true);
+  while (level.size() > 1) level = Pack(std::move(level), false);
+  m_root = level[0];
+}
+
+std::vector<uint32_t> PackedRTree::Pack(std::vector<uint32_t> ids, bool leaf) {
+  auto center_x = [&](uint32_t id) {
+    const Box& b = GetBox(id, leaf);
+    return b.x_min + b.x_max;
+  };
+  auto center_y = [&](uint32_t id) {
+    const Box& b = GetBox(id, leaf);
+    return b.y_min + b.y_max;
+  };
+
+  // Sort-Tile-Recursive: vertical slices sorted on x, each sorted on y.
+  size_t node_count = (ids.size() + kNodeSize - 1) / kNodeSize;
+  size_t slice_count = std::ceil(std::sqrt(static_cast<double>(node_count)));
+  size_t slice_size = slice_count * kNodeSize;
+  std::sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) {
+    return center_x(a) < center_x(b);
+  });
+  for (size_t start = 0; start < ids.size(); start += slice_size) {
+    auto end = ids.begin() + std::min(start + slice_size, ids.size());
+    std::sort(ids.begin() + start, end, [&](uint32_t a, uint32_t b) {
+      return center_y(a) < center_y(b);
+    });
+  }
+
+  std::vector<uint32_t> nodes;
+  nodes.reserve(node_count);
+  for (size_t start = 0; start < ids.size(); start += kNodeSize) {
+    size_t end = std::min(start + kNodeSize, ids.size());
+    Node node;
+    node.box = GetBox(ids[start], leaf);
+    node.first = m_refs.size();
+    node.count = end - start;
+    node.leaf = leaf;
+    for (size_t i = start; i < end; i++) {
+      const Box& b = GetBox(ids[i], leaf);
+      node.box.x_min = std::min(node.box.x_min, b.x_min);
+      node.box.y_min = std::min(node.box.y_min, b.y_min);
+      node.box.x_max = std::max(node.box.x_max, b.x_max);
+      node.box.y_max = std::max(node.box.y_max, b.y_max);
+      m_refs.push_back(ids[i]);
+    }
+    nodes.push_back(m_nodes.size());
+    m_nodes.push_back(node);
+  }
+  return nodes;
+}
+
+void PackedRTree::Search(const Box& query,
+                         std::vector<uint32_t>& result) const {
+  if (m_nodes.empty()) return;
+  std::vector<uint32_t> stack;
+  stack.push_back(m_root);
+  while (!stack.empty()) {
+    const Node& node = m_nodes[stack.back()];
+    stack.pop_back();
+    if (!node.box.Intersects(query)) continue;
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+      uint32_t id = m_refs[i];
+      if (node.leaf) {
+        if (m_boxes[id].Intersects(query)) result.push_back(id);
+      } else {
+        stack.push_back(id);
+      }
+    }
+  }
+}
+
+void PackedRTree::Nearest(size_t count, const BoxDistance& distance,
+                          std::vector<uint32_t>& result) const {
+  if (m_nodes.empty() || count == 0) return;
+  struct Entry {
+    double distance;
+    uint32_t id;
+    bool item;  ///< If true, id is an item, else a node
+    bool operator<(const Entry& other) const {
+      return distance > other.distance;
+    }
+  };
+  std::priority_queue<Entry> queue;
+  queue.push({distance(m_nodes[m_root].box), m_root, false});
+  size_t found = 0;
+  while (!queue.empty()) {
+    Entry entry = queue.top();
+    queue.pop();
+    if (entry.item) {
+      result.push_back(entry.id);
+      if (++found == count) return;
+      continue;
+    }
+    const Node& node = m_nodes[entry.id];
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+      uint32_t id = m_refs[i];
+      const Box& box = node.leaf ? m_boxes[id] : m_nodes[id].box;
+      queue.push({distance(box), id, node.leaf});
+    }
+  }
+}
+
+void PackedRTree::Clear() {
+  m_boxes.clear();
+  m_nodes.clear();
+  m_refs.clear();
+  m_root = 0;
+}
+
+/** Stored node: box, first child and count with leaf flag in top bit. */
+static constexpr size_t kStoredNodeSize =
+    4 * sizeof(float) + 2 * sizeof(uint32_t);
+static constexpr uint32_t kLeafFlag = 0x80000000;
+
+void PackedRTree::Save(std::vector<uint8_t>& out) const {
+  auto append = [&out](const void* src, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(src);
+    out.insert(out.end(), bytes, bytes + size);
+  };
+  uint32_t header[4] = {static_cast<uint32_t>(m_boxes.size()),
+                        static_cast<uint32_t>(m_nodes.size()),
+                        static_cast<uint32_t>(m_refs.size()), m_root};
+  append(header, sizeof(header));
+  for (const Box& box : m_boxes) {
+    float coords[4] = {box.x_min, box.y_min, box.x_max, box.y_max};
+    append(coords, sizeof(coords));
+  }
+  for (const Node& node : m_nodes) {
+    float coords[4] = {node.box.x_min, node.box.y_min, node.box.x_max,
+                       node.box.y_max};
+    uint32_t children[2] = {node.first,
+                            node.count | (node.leaf ? kLeafFlag : 0)};
+    append(coords, sizeof(coords));
+    append(children, sizeof(children));
+  }
+  append(m_refs.data(), m_refs.size() * sizeof(uint32_t));
+}
+
+bool PackedRTree::Load(const uint8_t* data, size_t size) {
+  Clear();
+  uint32_t header[4];
+  if (size < sizeof(header)) return false;
+  memcpy(header, data, sizeof(header));
+  size_t box_count = header[0];
+  size_t node_count = header[1];
+  size_t ref_count = header[2];
+  if (size != sizeof(header) + box_count * 4 * sizeof(float) +
+                  node_count * kStoredNodeSize + ref_count * sizeof(uint32_t))
+    return false;
+  if (box_count && header[3] >= node_count) return false;
+
+  const uint8_t* run = data + sizeof(header);
+  m_boxes.resize(box_count);
+  for (Box& box : m_boxes) {
+    float coords[4];
+    memcpy(coords, run, sizeof(coords));
+    run += sizeof(coords);
+    box = {coords[0], coords[1], coords[2], coords[3]};
+  }
+  m_nodes.resize(node_count);
+  for (Node& node : m_nodes) {
+    float coords[4];
+    uint32_t children[2];
+    memcpy(coords, run, sizeof(coords));
+    memcpy(children, run + sizeof(coords), sizeof(children));
+    run += kStoredNodeSize;
+    node.box = {coords[0], coords[1], coords[2], coords[3]};
+    node.first = children[0];
+    node.count = children[1] & 0xffff;
+    node.leaf = children[1] & kLeafFlag;
+  }
+  m_refs.resize(ref_count);
+  memcpy(m_refs.data(), run, ref_count * sizeof(uint32_t));
+  m_root = header[3];
+
+  // Children must exist, and inner nodes only refer to nodes packed before
+  // them as Pack() does, so searches always terminate.
+  for (uint32_t id = 0; id < m_nodes.size(); id++) {
+    const Node& node = m_nodes[id];
+    if (node.first > ref_count || node.count > ref_count - node.first) {
+      Clear();
+      return false;
+    }
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+      if (node.leaf ? m_refs[i] >= box_count : m_refs[i] >= id) {
+        Clear();
+        return false;
+      }
+    }
+  }
+  return true;
+}
@@ -40,7 +40,12 @@ PeriodicTimer::~PeriodicTimer() {
 }
 
 void PeriodicTimer::Stop() {
-  m_run_sts = 0;
+  {
+    // Set under lock, the worker might otherwise check the status and then
+    // miss the wakeup, sleeping a full interval.
+    std::lock_guard lock(m_mutex);
+    if (m_run_sts > 0) m_run_sts = 0;
+  }
   m_cond_var.notify_all();
   std::unique_lock lock(m_mutex);
   m_cond_var.wait_for(lock, m_interval, [&] { return m_run_sts < 0; });
@@ -54,6 +59,9 @@ void PeriodicTimer::Worker() {
     lock.unlock();
     if (m_run_sts > 0) Notify();
   }
-  m_run_sts = -1;
+  {
+    std::lock_guard lock(m_mutex);
+    m_run_sts = -1;
+  }
   m_cond_var.notify_all();
 }
@@ -0,0 +1,99 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement pick_index.h -- PickIndex
+ */
+
+#include <algorithm>
+
+#include "model/pick_index.h"
+
+void PickIndex::SetTree(PackedRTree tree) {
+  Clear();
+  m_tree = std::move(tree);
+  m_prebuilt = true;
+}
+
+void PickIndex::ClearEntries() {
+  m_entry_count = 0;
+  m_boxes.clear();
+  m_item_entries.clear();
+  m_unindexed.clear();
+  m_item_first.clear();
+  m_entries.clear();
+  if (!m_prebuilt) m_tree.Clear();
+}
+
+void PickIndex::Clear() {
+  m_prebuilt = false;
+  ClearEntries();
+}
+
+void PickIndex::AddBox(const Box& box) {
+  if (m_prebuilt) {
+    AddUnindexed();
+    return;
+  }
+  m_item_entries.push_back({static_cast<uint32_t>(m_boxes.size()),
+                            m_entry_count++});
+  m_boxes.push_back(box);
+}
+
+void PickIndex::AddToItem(uint32_t item) {
+  if (!m_prebuilt || item >= m_tree.Size()) {
+    AddUnindexed();
+    return;
+  }
+  m_item_entries.push_back({item, m_entry_count++});
+}
+
+void PickIndex::AddUnindexed() { m_unindexed.push_back(m_entry_count++); }
+
+void PickIndex::Finish() {
+  if (!m_prebuilt) {
+    m_tree.Build(m_boxes);
+    m_boxes.clear();
+  }
+
+  //  Group the entries by item, keeping their order
+  size_t n_items = m_tree.Size();
+  m_item_first.assign(n_items + 1, 0);
+  for (const auto& item_entry : m_item_entries)
+    m_item_first[item_entry.first + 1]++;
+  for (size_t i = 0; i < n_items; i++) m_item_first[i + 1] += m_item_first[i];
+  std::vector<uint32_t> next(m_item_first.begin(), m_item_first.end() - 1);
+  m_entries.resize(m_item_entries.size());
+  for (const auto& item_entry : m_item_entries)
+    m_entries[next[item_entry.first]++] = item_entry.second;
+  m_item_entries.clear();
+}
+
+std::vector<uint32_t> PickIndex::Search(const Box& query) const {
+  std::vector<uint32_t> result = m_unindexed;
+  if (m_item_first.empty()) return result;
+  std::vector<uint32_t> hits;
+  m_tree.Search(query, hits);
+  for (uint32_t hit : hits) {
+    result.insert(result.end(), m_entries.begin() + m_item_first[hit],
+                  m_entries.begin() + m_item_first[hit + 1]);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
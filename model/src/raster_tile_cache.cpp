@@ -0,0 +1,156 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement raster_tile_cache.h -- RasterTileCache
+ */
+
+#include <utility>
+
+#include "model/raster_tile_cache.h"
+
+RasterTileCache& RasterTileCache::GetInstance() {
+  static RasterTileCache instance;
+  return instance;
+}
+
+RasterTileCache::Key RasterTileCache::MakeKey(uint32_t chart, int tx,
+                                              int ty) {
+  // 24 bits chart id, 20 bits each for tile row and column.
+  return static_cast<Key>(chart) << 40 |
+         static_cast<Key>(ty & 0xfffff) << 20 | (tx & 0xfffff);
+}
+
+uint32_t RasterTileCache::GetChartId(const std::string& path,
+                                     int64_t version) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_charts.find(path);
+  if (it != m_charts.end()) {
+    if (it->second.version == version) return it->second.id;
+    EraseTiles(it->second.id);
+    m_current.erase(it->second.id);
+    it->second = ChartId{version, m_next_id++};
+    m_current.insert(it->second.id);
+    return it->second.id;
+  }
+  uint32_t id = m_next_id++;
+  m_charts.emplace(path, ChartId{version, id});
+  m_current.insert(id);
+  return id;
+}
+
+RasterTileCache::Tile RasterTileCache::Get(uint32_t chart, int tx, int ty) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(MakeKey(chart, tx, ty));
+  if (it == m_entries.end()) {
+    m_misses++;
+    return Tile();
+  }
+  m_hits++;
+  m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+  return it->second.tile;
+}
+
+RasterTileCache::Tile RasterTileCache::Put(uint32_t chart, int tx, int ty,
+                                           std::vector<uint8_t> data) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Key key = MakeKey(chart, tx, ty);
+  auto it = m_entries.find(key);
+  if (it != m_entries.end()) {
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    return it->second.tile;
+  }
+  m_used += data.size();
+  auto tile = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+  m_lru.push_front(key);
+  m_entries.emplace(key, Entry{tile, m_lru.begin()});
+  Enforce();
+  return tile;
+}
+
+void RasterTileCache::Erase(uint32_t chart) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  EraseTiles(chart);
+}
+
+void RasterTileCache::Erase(const std::string& path) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_charts.find(path);
+  if (it == m_charts.end()) return;
+  EraseTiles(it->second.id);
+  m_current.erase(it->second.id);
+  m_charts.erase(it);
+}
+
+bool RasterTileCache::IsCurrent(uint32_t chart) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_current.count(chart) > 0;
+}
+
+void RasterTileCache::EraseTiles(uint32_t chart) {
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (it->first >> 40 == chart) {
+      m_used -= it->second.tile->size();
+      m_lru.erase(it->second.lru);
+      it = m_entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void RasterTileCache::Enforce() {
+  while (m_used > m_budget && m_lru.size() > 1) {
+    auto it = m_entries.find(m_lru.back());
+    m_used -= it->second.tile->size();
+    m_lru.pop_back();
+    m_entries.erase(it);
+  }
+}
+
+void RasterTileCache::SetBudget(size_t budget) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_budget = budget;
+  Enforce();
+}
+
+size_t RasterTileCache::GetBudget() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_budget;
+}
+
+size_t RasterTileCache::GetUsed() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_used;
+}
+
+size_t RasterTileCache::GetCount() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+uint64_t RasterTileCache::GetHits() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_hits;
+}
+
+uint64_t RasterTileCache::GetMisses() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_misses;
+}
@@ -44,11 +44,29 @@ Select::Select() {
 Select::~Select() {
   for (SelectItem *si : *pSelectList) delete si;
   pSelectList->clear();
+  m_index.Clear();
   delete pSelectList;
 }
 
+void Select::AddItem(SelectItem *item, bool at_front) {
+  if (at_front)
+    pSelectList->push_front(item);
+  else
+    pSelectList->push_back(item);
+  m_index.Insert(item, at_front);
+}
+
+void Select::DeleteItem(SelectItem *item) {
+  m_index.Remove(item);
+  delete item;
+}
+
 bool Select::IsSelectableRoutePointValid(RoutePoint *pRoutePoint) {
-  SelectItem *pFindSel;
+  auto *pFindSel = (SelectItem *)pRoutePoint->GetSelectNode();
+  if (pFindSel && m_index.Contains(pFindSel) &&
+      pFindSel->m_seltype == SELTYPE_ROUTEPOINT &&
+      pFindSel->m_pData1 == pRoutePoint)
+    return true;
 
   //    Iterate on the select list
   for (SelectItem *pFindSel : *pSelectList) {
@@ -68,10 +86,7 @@ bool Select::AddSelectableRoutePoint(float slat, float slon,
   pSelItem->m_bIsSelected = false;
   pSelItem->m_pData1 = pRoutePointAdd;
 
-  if (pRoutePointAdd->m_bIsInLayer)
-    pSelectList->push_back(pSelItem);
-  else
-    pSelectList->push_front(pSelItem);
+  AddItem(pSelItem, !pRoutePointAdd->m_bIsInLayer);
 
   pRoutePointAdd->SetSelectNode(pSelItem);
 
@@ -93,19 +108,16 @@ bool Select::AddSelectableRouteSegment(float slat1, float slon1, float slat2,
   pSelItem->m_pData2 = pRoutePointAdd2;
   pSelItem->m_pData3 = pRoute;
 
-  if (pRoute->m_bIsInLayer)
-    pSelectList->push_back(pSelItem);
-  else
-    pSelectList->push_front(pSelItem);
+  AddItem(pSelItem, !pRoute->m_bIsInLayer);
 
   return true;
 }
 
 bool Select::DeleteAllSelectableRouteSegments(Route *pr) {
   auto removed_begin = std::remove_if(
-      pSelectList->begin(), pSelectList->end(), [pr](SelectItem *si) {
+      pSelectList->begin(), pSelectList->end(), [this, pr](SelectItem *si) {
         bool is_pr = (Route *)si->m_pData3 == pr;
-        if (is_pr) delete si;
+        if (is_pr) DeleteItem(si);
         return is_pr;
       });
   pSelectList->erase(removed_begin, pSelectList->end());
@@ -129,7 +141,7 @@ bool Select::DeleteAllSelectableRoutePoints(Route *pr) {
           auto pos =
               std::find(pSelectList->begin(), pSelectList->end(), pFindSel);
           if (pos != pSelectList->end()) pSelectList->erase(pos);
-          delete pFindSel;
+          DeleteItem(pFindSel);
           prp->SetSelectNode(nullptr);
           node = pSelectList->begin();
           is_restarted = true;
@@ -211,10 +223,12 @@ bool Select::UpdateSelectableRouteSegments(RoutePoint *prp) {
       if (pFindSel->m_pData1 == prp) {
         pFindSel->m_slat = prp->m_lat;
         pFindSel->m_slon = prp->m_lon;
+        m_index.Update(pFindSel);
         ret = true;
       } else if (pFindSel->m_pData2 == prp) {
         pFindSel->m_slat2 = prp->m_lat;
         pFindSel->m_slon2 = prp->m_lon;
+        m_index.Update(pFindSel);
         ret = true;
       }
     }
@@ -233,7 +247,7 @@ SelectItem *Select::AddSelectablePoint(float slat, float slon,
     pSelItem->m_bIsSelected = false;
     pSelItem->m_pData1 = pdata;
 
-    pSelectList->push_back(pSelItem);
+    AddItem(pSelItem, false);
   }
 
   return pSelItem;
@@ -253,10 +267,10 @@ bool Select::DeleteSelectablePoint(void *pdata, int SeltypeToDelete) {
 
   auto removed_begin =
       std::remove_if(pSelectList->begin(), pSelectList->end(),
-                     [pdata, SeltypeToDelete](SelectItem *si) {
+                     [this, pdata, SeltypeToDelete](SelectItem *si) {
                        bool is_victim = si->m_seltype == SeltypeToDelete &&
                                         si->m_pData1 == pdata;
-                       if (is_victim) delete si;
+                       if (is_victim) DeleteItem(si);
                        if (is_victim && SELTYPE_ROUTEPOINT == SeltypeToDelete) {
                          RoutePoint *prp = (RoutePoint *)pdata;
                          prp->SetSelectNode(NULL);
@@ -270,13 +284,13 @@ bool Select::DeleteSelectablePoint(void *pdata, int SeltypeToDelete) {
 bool Select::DeleteAllSelectableTypePoints(int SeltypeToDelete) {
   auto removed_begin =
       std::remove_if(pSelectList->begin(), pSelectList->end(),
-                     [SeltypeToDelete](SelectItem *si) {
+                     [this, SeltypeToDelete](SelectItem *si) {
                        bool is_match = si->m_seltype == SeltypeToDelete;
                        if (is_match && SELTYPE_ROUTEPOINT == SeltypeToDelete) {
                          RoutePoint *prp = (RoutePoint *)si->m_pData1;
                          prp->SetSelectNode(NULL);
                        }
-                       if (is_match) delete si;
+                       if (is_match) DeleteItem(si);
                        return is_match;
                      });
   pSelectList->erase(removed_begin, pSelectList->end());
@@ -290,7 +304,7 @@ bool Select::DeleteSelectableRoutePoint(RoutePoint *prp) {
   if (pFindSel) {
     auto pos = std::find(pSelectList->begin(), pSelectList->end(), pFindSel);
     if (pos != pSelectList->end()) pSelectList->erase(pos);
-    delete pFindSel;
+    DeleteItem(pFindSel);
     prp->SetSelectNode(nullptr);
     return true;
   } else {
@@ -300,14 +314,11 @@ bool Select::DeleteSelectableRoutePoint(RoutePoint *prp) {
 
 bool Select::ModifySelectablePoint(float lat, float lon, void *data,
                                    int SeltypeToModify) {
-  SelectItem *pFindSel;
-
   //    Iterate on the list
   for (SelectItem *pFindSel : *pSelectList) {
     if (pFindSel->m_seltype == SeltypeToModify) {
       if (data == pFindSel->m_pData1) {
-        pFindSel->m_slat = lat;
-        pFindSel->m_slon = lon;
+        ModifySelectableItem(pFindSel, lat, lon);
         return true;
       }
     }
@@ -315,6 +326,12 @@ bool Select::ModifySelectablePoint(float lat, float lon, void *data,
   return false;
 }
 
+void Select::ModifySelectableItem(SelectItem *item, float lat, float lon) {
+  item->m_slat = lat;
+  item->m_slon = lon;
+  m_index.Update(item);
+}
+
 bool Select::AddSelectableTrackSegment(float slat1, float slon1, float slat2,
                                        float slon2, TrackPoint *pTrackPointAdd1,
                                        TrackPoint *pTrackPointAdd2,
@@ -330,20 +347,17 @@ bool Select::AddSelectableTrackSegment(float slat1, float slon1, float slat2,
   pSelItem->m_pData2 = pTrackPointAdd2;
   pSelItem->m_pData3 = pTrack;
 
-  if (pTrack->m_bIsInLayer)
-    pSelectList->push_back(pSelItem);
-  else
-    pSelectList->push_front(pSelItem);
+  AddItem(pSelItem, !pTrack->m_bIsInLayer);
 
   return true;
 }
 
 bool Select::DeleteAllSelectableTrackSegments(Track *pt) {
   auto removed_begin = std::remove_if(
-      pSelectList->begin(), pSelectList->end(), [pt](SelectItem *si) {
+      pSelectList->begin(), pSelectList->end(), [this, pt](SelectItem *si) {
         bool is_victim = si->m_seltype == SELTYPE_TRACKSEGMENT &&
                          (Track *)si->m_pData3 == pt;
-        if (is_victim) delete si;
+        if (is_victim) DeleteItem(si);
         return is_victim;
       });
   pSelectList->erase(removed_begin, pSelectList->end());
@@ -352,11 +366,11 @@ bool Select::DeleteAllSelectableTrackSegments(Track *pt) {
 
 bool Select::DeletePointSelectableTrackSegments(TrackPoint *pt) {
   auto removed_begin = std::remove_if(
-      pSelectList->begin(), pSelectList->end(), [pt](SelectItem *si) {
+      pSelectList->begin(), pSelectList->end(), [this, pt](SelectItem *si) {
         bool is_victim = si->m_seltype == SELTYPE_TRACKSEGMENT &&
                          ((TrackPoint *)si->m_pData1 == pt ||
                           (TrackPoint *)si->m_pData2 == pt);
-        if (is_victim) delete si;
+        if (is_victim) DeleteItem(si);
         return is_victim;
       });
   pSelectList->erase(removed_begin, pSelectList->end());
@@ -435,8 +449,8 @@ SelectItem *Select::FindSelection(SelectCtx &ctx, float slat, float slon,
 
   CalcSelectRadius(ctx);
 
-  //    Iterate on the list
-  for (SelectItem *si : *pSelectList) {
+  //    Iterate on the candidates from the spatial index, in list order
+  for (SelectItem *si : m_index.Query(slat, slon, selectRadius, fseltype)) {
     pFindSel = si;
     if (pFindSel->m_seltype == fseltype) {
       switch (fseltype) {
@@ -478,15 +492,7 @@ SelectItem *Select::FindSelection(SelectCtx &ctx, float slat, float slon,
 
 bool Select::IsSelectableSegmentSelected(SelectCtx &ctx, float slat, float slon,
                                          SelectItem *pFindSel) {
-  bool valid = false;
-  for (SelectItem *si : *pSelectList) {
-    if (pFindSel == si) {
-      valid = true;
-      break;
-    }
-  }
-
-  if (valid == false) {
+  if (!m_index.Contains(pFindSel)) {
     // not in the list anymore
     return false;
   }
@@ -520,8 +526,8 @@ SelectableItemList Select::FindSelectionList(SelectCtx &ctx, float slat,
 
   CalcSelectRadius(ctx);
 
-  //    Iterate on the list
-  for (SelectItem *si : *pSelectList) {
+  //    Iterate on the candidates from the spatial index, in list order
+  for (SelectItem *si : m_index.Query(slat, slon, selectRadius, fseltype)) {
     pFindSel = si;
     if (pFindSel->m_seltype == fseltype) {
       switch (fseltype) {
@@ -0,0 +1,202 @@
+/***************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement select_index.h -- spatial index over SelectItem objects.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "model/select.h"
+#include "model/select_index.h"
+
+/** Normalize longitude to [-180, 180) like Select::IsSegmentSelected(). */
+static float NormalizeLon(float lon) {
+  if (lon >= 180.0f) lon -= 360.0f;
+  if (lon < -180.0f) lon += 360.0f;
+  return lon;
+}
+
+static bool IsSegment(int seltype) {
+  return seltype == SELTYPE_ROUTESEGMENT || seltype == SELTYPE_TRACKSEGMENT;
+}
+
+SelectIndex::SelectIndex() : m_front_seq(0), m_back_seq(0) {}
+
+float SelectIndex::CellSize(int level) {
+  return kBaseCellSize * static_cast<float>(1 << (2 * level));
+}
+
+uint64_t SelectIndex::CellKey(int ix, int iy) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(ix)) << 32) |
+         static_cast<uint32_t>(iy);
+}
+
+SelectIndex::Box SelectIndex::GetBox(const SelectItem* item) {
+  Box box;
+  float lon1 = NormalizeLon(item->m_slon);
+  box.lat_min = box.lat_max = item->m_slat;
+  box.lon_min = box.lon_max = lon1;
+  if (IsSegment(item->m_seltype)) {
+    float lon2 = NormalizeLon(item->m_slon2);
+    box.lat_min = std::min(box.lat_min, item->m_slat2);
+    box.lat_max = std::max(box.lat_max, item->m_slat2);
+    box.lon_min = std::min(lon1, lon2);
+    box.lon_max = std::max(lon1, lon2);
+  }
+  return box;
+}
+
+void SelectIndex::Insert(SelectItem* item, bool at_front) {
+  Remove(item);
+  DoInsert(item, at_front ? --m_front_seq : ++m_back_seq);
+}
+
+void SelectIndex::DoInsert(SelectItem* item, int64_t seq) {
+  Grid& grid = m_grids[item->m_seltype];
+  Box box = GetBox(item);
+  Location loc{item->m_seltype, -1, 0, seq};
+
+  float extent =
+      std::max(box.lat_max - box.lat_min, box.lon_max - box.lon_min);
+  bool in_range = box.lat_min >= -90.0f && box.lat_max <= 90.0f;
+  for (int level = 0; in_range && level < kLevels; level += 1) {
+    float size = CellSize(level);
+    if (extent > size) continue;
+    int ix = static_cast<int>(std::floor((box.lon_min + 180.0f) / size));
+    int iy = static_cast<int>(std::floor((box.lat_min + 90.0f) / size));
+    loc.level = level;
+    loc.cell = CellKey(ix, iy);
+    break;
+  }
+  if (loc.level < 0)
+    grid.oversized.push_back({item, seq});
+  else
+    grid.levels[loc.level][loc.cell].push_back({item, seq});
+  m_locations[item] = loc;
+}
+
+void SelectIndex::Remove(const SelectItem* item) {
+  auto found = m_locations.find(item);
+  if (found == m_locations.end()) return;
+  const Location& loc = found->second;
+  Grid& grid = m_grids[loc.seltype];
+  auto remove_from = [item](std::vector<Entry>& entries) {
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [item](const Entry& e) { return e.item == item; });
+    if (it == entries.end()) return;
+    *it = entries.back();
+    entries.pop_back();
+  };
+  if (loc.level < 0) {
+    remove_from(grid.oversized);
+  } else {
+    CellMap& cells = grid.levels[loc.level];
+    auto cell = cells.find(loc.cell);
+    if (cell != cells.end()) {
+      remove_from(cell->second);
+      if (cell->second.empty()) cells.erase(cell);
+    }
+  }
+  m_locations.erase(found);
+}
+
+void SelectIndex::Update(SelectItem* item) {
+  auto found = m_locations.find(item);
+  if (found == m_locations.end()) return;
+  int64_t seq = found->second.seq;
+  Remove(item);
+  DoInsert(item, seq);
+}
+
+bool SelectIndex::Contains(const SelectItem* item) const {
+  return m_locations.find(item) != m_locations.end();
+}
+
+void SelectIndex::Clear() {
+  m_grids.clear();
+  m_locations.clear();
+}
+
+void SelectIndex::QueryBox(const Grid& grid, const Box& box,
+                           std::vector<Entry>& result) const {
+  auto overlaps = [&box](const SelectItem* item) {
+    Box b = GetBox(item);
+    return b.lat_max >= box.lat_min && b.lat_min <= box.lat_max &&
+           b.lon_max >= box.lon_min && b.lon_min <= box.lon_max;
+  };
+  for (int level = 0; level < kLevels; level += 1) {
+    const CellMap& cells = grid.levels[level];
+    if (cells.empty()) continue;
+    float size = CellSize(level);
+    // Items in cell i covers [i * size, (i + 2) * size).
+    int x0 = static_cast<int>(std::floor((box.lon_min + 180.0f) / size)) - 1;
+    int x1 = static_cast<int>(std::floor((box.lon_max + 180.0f) / size));
+    int y0 = static_cast<int>(std::floor((box.lat_min + 90.0f) / size)) - 1;
+    int y1 = static_cast<int>(std::floor((box.lat_max + 90.0f) / size));
+    double cell_count = double(x1 - x0 + 1) * double(y1 - y0 + 1);
+    if (cell_count > static_cast<double>(cells.size())) {
+      // Query covers more cells than there are: scan occupied ones.
+      for (const auto& kv : cells)
+        for (const Entry& e : kv.second)
+          if (overlaps(e.item)) result.push_back(e);
+      continue;
+    }
+    for (int ix = x0; ix <= x1; ix += 1) {
+      for (int iy = y0; iy <= y1; iy += 1) {
+        auto cell = cells.find(CellKey(ix, iy));
+        if (cell == cells.end()) continue;
+        for (const Entry& e : cell->second)
+          if (overlaps(e.item)) result.push_back(e);
+      }
+    }
+  }
+}
+
+std::vector<SelectItem*> SelectIndex::Query(float lat, float lon,
+                                            float radius, int seltype) const {
+  std::vector<SelectItem*> items;
+  auto found = m_grids.find(seltype);
+  if (found == m_grids.end()) return items;
+  const Grid& grid = found->second;
+
+  std::vector<Entry> entries(grid.oversized);
+  lon = NormalizeLon(lon);
+  Box box{lat - radius, lat + radius, lon - radius, lon + radius};
+  if (box.lon_min < -180.0f) {
+    QueryBox(grid, {box.lat_min, box.lat_max, box.lon_min + 360.0f, 180.0f},
+             entries);
+    box.lon_min = -180.0f;
+  }
+  if (box.lon_max >= 180.0f) {
+    QueryBox(grid, {box.lat_min, box.lat_max, -180.0f, box.lon_max - 360.0f},
+             entries);
+    box.lon_max = 180.0f;
+  }
+  QueryBox(grid, box, entries);
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.seq < b.seq; });
+  items.reserve(entries.size());
+  for (const Entry& e : entries) {
+    if (items.empty() || items.back() != e.item) items.push_back(e.item);
+  }
+  return items;
+}
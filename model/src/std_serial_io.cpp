@@ -23,6 +23,7 @@
  * on the serial/serial.h header.
  */
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -42,6 +43,7 @@
 #include <wx/string.h>
 #include <wx/utils.h>
 
+#include "model/atomic_queue.h"
 #include "model/comm_buffers.h"
 #include "model/comm_drv_registry.h"
 #include "model/logger.h"
@@ -52,18 +54,29 @@
 class StdSerialIo : public SerialIo {
 public:
   StdSerialIo(SendMsgFunc send_func, const std::string& port, unsigned baud)
-      : SerialIo(send_func, port, baud) {}
+      : SerialIo(send_func, port, baud), m_out_que(kOutQueueSize) {}
 
   bool SetOutMsg(const wxString& msg) override;
   void Start() override;
   DriverStats GetStats() const override;
 
 private:
+  /**
+   * Pending output sentences kept in the lock free queue. Bursts beyond
+   * this, like a route upload at 4800 baud, go to m_out_overflow.
+   */
+  static constexpr size_t kOutQueueSize = 256;
+
   serial::Serial m_serial;
-  OutputBuffer m_out_que;
+  MpmcQueue<std::string> m_out_que;
+  OutputBuffer m_out_overflow;  ///< Unbounded, used when m_out_que is full
+  std::atomic<size_t> m_overflow_count{0};  ///< Lines in m_out_overflow
   void* Entry();
   void Reconnect();
 
+  /** Get next output sentence, in the order given to SetOutMsg(). */
+  bool GetOutMsg(std::string& msg);
+
   bool OpenComPortPhysical(const wxString& com_name, unsigned baud_rate);
   void CloseComPortPhysical();
   ssize_t WriteComPortPhysical(const char* msg);
@@ -132,7 +145,7 @@ void* StdSerialIo::Entry() {
 
     //  Handle pending output messages
     std::string qmsg;
-    while (KeepGoing() && m_out_que.Get(qmsg)) {
+    while (KeepGoing() && GetOutMsg(qmsg)) {
       if (qmsg.size() < 3) continue;
       if (qmsg.find("\r\n", qmsg.size() - 2) == std::string::npos)
         qmsg += "\r\n";
@@ -161,7 +174,22 @@ void StdSerialIo::Start() {
 
 bool StdSerialIo::SetOutMsg(const wxString& msg) {
   if (msg.size() < 6 || (msg[0] != '$' && msg[0] != '!')) return false;
-  m_out_que.Put(msg.ToStdString());
+  // Once overflowing, keep using the overflow buffer until it is drained
+  // so sentences are not reordered.
+  if (m_overflow_count.load() == 0 && m_out_que.TryPush(msg.ToStdString()))
+    return true;
+  if (m_overflow_count.fetch_add(1) == 0) {
+    DEBUG_LOG << "Serial output queue full on " << m_portname
+              << ", buffering";
+  }
+  m_out_overflow.Put(msg.ToStdString());
+  return true;
+}
+
+bool StdSerialIo::GetOutMsg(std::string& msg) {
+  if (m_out_que.TryPop(msg)) return true;
+  if (m_overflow_count.load() == 0 || !m_out_overflow.Get(msg)) return false;
+  m_overflow_count--;
   return true;
 }
 
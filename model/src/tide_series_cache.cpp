@@ -0,0 +1,175 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement tide_series_cache.h -- TideSeriesCache
+ */
+
+#include <algorithm>
+
+#include "model/tide_series_cache.h"
+
+TideSeriesCache::TideSeriesCache(Evaluator evaluator, int span, int step)
+    : m_evaluator(std::move(evaluator)),
+      m_step(std::max(1, step)),
+      m_half(std::max(1, span / m_step)),
+      m_generation(0),
+      m_stopping(false),
+      m_pool(1) {}
+
+TideSeriesCache::~TideSeriesCache() {
+  // Make queued jobs return at once, the pool then joins its thread.
+  std::lock_guard lock(m_mutex);
+  m_stopping = true;
+}
+
+int64_t TideSeriesCache::Slot(time_t t) const {
+  int64_t slot = static_cast<int64_t>(t) / m_step;
+  if (slot * m_step > t) slot--;
+  return slot;
+}
+
+size_t TideSeriesCache::RingIndex(const Series& series, int64_t slot) {
+  const int64_t size = series.ring.size();
+  return ((slot % size) + size) % size;
+}
+
+TideSeriesCache::Series& TideSeriesCache::GetSeries(int idx, int64_t slot) {
+  auto it = m_series.find(idx);
+  if (it != m_series.end()) return it->second;
+  Series& series = m_series[idx];
+  series.centre = slot;
+  series.valid_begin = slot;
+  series.valid_end = slot;
+  series.ring.resize(2 * m_half + 1);
+  return series;
+}
+
+void TideSeriesCache::Recentre(Series& series, int64_t slot) {
+  if (std::abs(slot - series.centre) <= m_half / 2) return;
+  series.centre = slot;
+  series.valid_begin = std::max(series.valid_begin, slot - m_half);
+  series.valid_end = std::min(series.valid_end, slot + m_half + 1);
+  if (series.valid_begin >= series.valid_end) {
+    series.valid_begin = slot;
+    series.valid_end = slot;
+  }
+}
+
+void TideSeriesCache::Schedule(int idx, Series& series) {
+  if (series.queued || series.failed || m_stopping) return;
+  if (series.valid_begin <= series.centre - m_half &&
+      series.valid_end > series.centre + m_half)
+    return;
+  series.queued = true;
+  uint64_t generation = m_generation;
+  m_pool.Post([this, idx, generation] { Fill(idx, generation); });
+}
+
+void TideSeriesCache::Fill(int idx, uint64_t generation) {
+  int64_t begin;
+  int64_t end;
+  {
+    std::lock_guard lock(m_mutex);
+    if (m_stopping || generation != m_generation) return;
+    auto it = m_series.find(idx);
+    if (it == m_series.end()) return;
+    const Series& series = it->second;
+
+    // Grow the computed range on the side closest to the centre.
+    int64_t c = series.centre;
+    bool append = series.valid_end <= c + m_half &&
+                  (series.valid_end - c <= c - series.valid_begin ||
+                   series.valid_begin <= c - m_half);
+    if (append) {
+      begin = series.valid_end;
+      end = std::min(begin + kChunk, c + m_half + 1);
+    } else {
+      end = series.valid_begin;
+      begin = std::max(end - kChunk, c - m_half);
+    }
+  }
+
+  std::vector<float> values;
+  bool ok = m_evaluator(static_cast<time_t>(begin * m_step), m_step,
+                        static_cast<int>(end - begin), idx, values) &&
+            values.size() == static_cast<size_t>(end - begin);
+
+  std::lock_guard lock(m_mutex);
+  if (m_stopping || generation != m_generation) return;
+  auto it = m_series.find(idx);
+  if (it == m_series.end()) return;
+  Series& series = it->second;
+  series.queued = false;
+  if (!ok) {
+    series.failed = true;
+    return;
+  }
+
+  // The window may have moved meanwhile, only keep samples which extend
+  // the valid range and are inside the window.
+  int64_t lo = std::max(begin, series.centre - m_half);
+  int64_t hi = std::min(end, series.centre + m_half + 1);
+  bool empty = series.valid_begin == series.valid_end;
+  bool adjacent = lo <= series.valid_end && hi >= series.valid_begin;
+  if (lo < hi && (empty || adjacent)) {
+    for (int64_t slot = lo; slot < hi; slot++)
+      series.ring[RingIndex(series, slot)] = values[slot - begin];
+    if (empty) {
+      series.valid_begin = lo;
+      series.valid_end = hi;
+    } else {
+      series.valid_begin = std::min(series.valid_begin, lo);
+      series.valid_end = std::max(series.valid_end, hi);
+    }
+  }
+  Schedule(idx, series);
+}
+
+bool TideSeriesCache::Get(int idx, time_t t, float& value) {
+  std::lock_guard lock(m_mutex);
+  int64_t slot = Slot(t);
+  Series& series = GetSeries(idx, slot);
+  Recentre(series, slot);
+  Schedule(idx, series);
+  if (slot < series.valid_begin || slot + 1 >= series.valid_end) return false;
+
+  float v0 = series.ring[RingIndex(series, slot)];
+  float v1 = series.ring[RingIndex(series, slot + 1)];
+  double frac = static_cast<double>(t - slot * m_step) / m_step;
+  value = v0 + (v1 - v0) * frac;
+  return true;
+}
+
+void TideSeriesCache::SetCentre(time_t t) {
+  std::lock_guard lock(m_mutex);
+  int64_t slot = Slot(t);
+  for (auto& kv : m_series) {
+    Recentre(kv.second, slot);
+    Schedule(kv.first, kv.second);
+  }
+}
+
+void TideSeriesCache::Clear() {
+  std::lock_guard lock(m_mutex);
+  m_series.clear();
+  m_generation++;
+}
+
+void TideSeriesCache::WaitIdle() { m_pool.WaitIdle(); }
@@ -67,6 +67,7 @@ of segments will be higher, though it should be managable with tracks with
 millions of points.
 */
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -90,6 +91,7 @@ millions of points.
 #include "model/own_ship.h"
 #include "model/routeman.h"
 #include "model/select.h"
+#include "model/track_page_cache.h"
 #include "ocpn_plugin.h"
 #include "model/navobj_db.h"
 
@@ -178,9 +180,18 @@ Track::Track() {
 
   m_TrackHyperlinkList = new HyperlinkList;
   m_HighlightedTrackPoint = -1;
+
+  m_pageable = false;
+  m_paged_out = false;
+  m_paged_length = -1;
+  m_paged_points = 0;
+  m_lod_saved = 0;
 }
 
 Track::~Track() {
+  auto &cache = TrackPageCache::GetInstance();
+  cache.Remove(this);
+  cache.SetPinned(this, false);
   for (size_t i = 0; i < TrackPoints.size(); i++) delete TrackPoints[i];
 
   delete m_TrackHyperlinkList;
@@ -347,6 +358,7 @@ void Track::Clone(Track *psourcetrack, int start_nPoint, int end_nPoint,
 void ActiveTrack::AdjustCurrentTrackPoint(TrackPoint *prototype) {
   if (prototype) {
     *m_lastStoredTP = *prototype;
+    m_lod.Clear();
     m_prev_time = prototype->GetCreateTime().FromUTC();
   }
 }
@@ -499,7 +511,86 @@ void ActiveTrack::AddPointNow(bool do_add_point) {
 
 void Track::ClearHighlights() { m_HighlightedTrackPoint = -1; }
 
+void Track::SetPagedOut(const LLBBox &extent, const std::string &start_time,
+                        int points, double length) {
+  for (size_t i = 0; i < TrackPoints.size(); i++) delete TrackPoints[i];
+  TrackPoints.clear();
+  SubTracks.clear();
+  m_lod.Clear();
+  m_lod_saved = 0;
+  m_extent = extent;
+  m_paged_start = start_time;
+  m_paged_length = length;
+  m_paged_points = points;
+  m_pageable = true;
+  m_paged_out = true;
+}
+
+void Track::PageIn() {
+  if (!m_paged_out) return;
+  m_paged_out = false;
+  // Points are added using AddPoint(), which must not end paging.
+  m_pageable = false;
+  NavObj_dB::GetInstance().LoadTrackPoints(this);
+  m_pageable = true;
+  pSelect->AddAllSelectableTrackSegments(this);
+  TrackPageCache::GetInstance().Add(this, TrackPoints.size(),
+                                    [this] { PageOut(); });
+}
+
+void Track::PageOut() {
+  if (!m_pageable || m_paged_out) return;
+  TrackPageCache::GetInstance().Remove(this);
+  m_paged_length = Length();
+  m_paged_points = TrackPoints.size();
+  pSelect->DeleteAllSelectableTrackSegments(this);
+  for (size_t i = 0; i < TrackPoints.size(); i++) delete TrackPoints[i];
+  TrackPoints.clear();
+  SubTracks.clear();
+  m_HighlightedTrackPoint = -1;
+  m_paged_out = true;
+}
+
+/* Points modified in memory are not necessarily saved, so stop paging. */
+void Track::KeepResident() {
+  if (m_paged_out) PageIn();
+  if (!m_pageable) return;
+  m_pageable = false;
+  TrackPageCache::GetInstance().Remove(this);
+}
+
+void Track::EnforcePageBudget() {
+  const size_t kDefaultBudget = 2000000;
+  size_t budget = g_lazyTrackPoints > 0 ? g_lazyTrackPoints : kDefaultBudget;
+  // Keep tracks drawn during the last seconds, on any canvas.
+  TrackPageCache::GetInstance().Enforce(budget, std::chrono::seconds(2));
+}
+
+const TrackLod *Track::GetLod() {
+  // Shorter tracks are drawn fast enough using the SubTracks tree.
+  const size_t kMinPoints = 2000;
+  if (m_paged_out) return m_lod.GetCount() > 0 ? &m_lod : nullptr;
+  if (TrackPoints.size() < kMinPoints) return nullptr;
+  if (m_lod.GetCount() > TrackPoints.size()) m_lod.Clear();
+  for (size_t i = m_lod.GetCount(); i < TrackPoints.size(); i++) {
+    m_lod.Append(TrackPoints[i]->m_lat, TrackPoints[i]->m_lon);
+  }
+  // Save when built and then as the track grows, so that tracks loaded
+  // lazily can be drawn at small scales without being paged in.
+  size_t count = m_lod.GetCount();
+  if (!m_bIsInLayer && !m_btemp && count > m_lod_saved + m_lod_saved / 4) {
+    NavObj_dB::GetInstance().SaveTrackLod(this, m_lod);
+    m_lod_saved = count;
+  }
+  return &m_lod;
+}
+
+void Track::SetLod(const void *data, size_t size) {
+  if (m_lod.Deserialize(data, size)) m_lod_saved = m_lod.GetCount();
+}
+
 TrackPoint *Track::GetPoint(int nWhichPoint) {
+  if (m_paged_out) PageIn();
   if (nWhichPoint < (int)TrackPoints.size())
     return TrackPoints[nWhichPoint];
   else
@@ -507,6 +598,7 @@ TrackPoint *Track::GetPoint(int nWhichPoint) {
 }
 
 TrackPoint *Track::GetLastPoint() {
+  if (m_paged_out) PageIn();
   if (TrackPoints.empty()) return NULL;
 
   return TrackPoints.back();
@@ -583,6 +675,7 @@ double Track::ComputeScale(int left, int right) {
    on to build up a track from data.  If a track
    is being slowing enlarged, see AddPointFinalized below */
 void Track::AddPoint(TrackPoint *pNewPoint) {
+  KeepResident();
   TrackPoints.push_back(pNewPoint);
   SubTracks.clear();  // invalidate subtracks
 }
@@ -661,6 +754,7 @@ void Track::InsertSubTracks(LLBBox &box, int level, int pos) {
    _is_ worse than blowing the subtracks and calling Finalize.
 */
 void Track::AddPointFinalized(TrackPoint *pNewPoint) {
+  KeepResident();
   TrackPoints.push_back(pNewPoint);
 
   int pos = TrackPoints.size() - 1;
@@ -719,25 +813,31 @@ void Track::DouglasPeuckerReducer(std::vector<TrackPoint *> &list,
 }
 
 double Track::Length() {
+  if (m_paged_out) {
+    if (m_paged_length >= 0) return m_paged_length;
+    PageIn();
+  }
   TrackPoint *l = NULL;
   double total = 0.0;
   for (size_t i = 0; i < TrackPoints.size(); i++) {
     TrackPoint *t = TrackPoints[i];
-    if (l) {
-      const double offsetLat = 1e-6;
-      const double deltaLat = l->m_lat - t->m_lat;
-      if (fabs(deltaLat) > offsetLat)
-        total += DistGreatCircle(l->m_lat, l->m_lon, t->m_lat, t->m_lon);
-      else
-        total += DistGreatCircle(l->m_lat + copysign(offsetLat, deltaLat),
-                                 l->m_lon, t->m_lat, t->m_lon);
-    }
+    if (l) total += LegLength(l->m_lat, l->m_lon, t->m_lat, t->m_lon);
     l = t;
   }
 
   return total;
 }
 
+double Track::LegLength(double from_lat, double from_lon, double to_lat,
+                        double to_lon) {
+  const double offsetLat = 1e-6;
+  const double deltaLat = from_lat - to_lat;
+  if (fabs(deltaLat) > offsetLat)
+    return DistGreatCircle(from_lat, from_lon, to_lat, to_lon);
+  return DistGreatCircle(from_lat + copysign(offsetLat, deltaLat), from_lon,
+                         to_lat, to_lon);
+}
+
 int Track::Simplify(double maxDelta) {
   int reduction = 0;
 
@@ -746,6 +846,7 @@ int Track::Simplify(double maxDelta) {
 
   ::wxBeginBusyCursor();
 
+  KeepResident();
   for (size_t i = 0; i < TrackPoints.size(); i++) {
     TrackPoint *trackpoint = TrackPoints[i];
 
@@ -758,6 +859,8 @@ int Track::Simplify(double maxDelta) {
   pSelect->DeleteAllSelectableTrackSegments(this);
   SubTracks.clear();
   TrackPoints.clear();
+  m_lod.Clear();
+  m_lod_saved = 0;
 
   for (size_t i = 0; i < pointlist.size(); i++) {
     if (keeplist[i])
@@ -777,6 +880,7 @@ int Track::Simplify(double maxDelta) {
 }
 
 Route *Track::RouteFromTrack(wxGenericProgressDialog *pprog) {
+  if (m_paged_out) PageIn();
   Route *route = new Route();
 
   TrackPoint *pWP_src = TrackPoints.front();
@@ -979,7 +1083,11 @@ double Track::GetXTE(TrackPoint *fm1, TrackPoint *fm2, TrackPoint *to) {
 wxString Track::GetIsoDateTime(const wxString label_for_invalid_date) const {
   wxString name;
   TrackPoint *rp = NULL;
-  if ((int)TrackPoints.size() > 0) rp = TrackPoints[0];
+  TrackPoint paged_first(0, 0, m_paged_start);
+  if (m_paged_out)
+    rp = &paged_first;
+  else if ((int)TrackPoints.size() > 0)
+    rp = TrackPoints[0];
   if (rp && rp->GetCreateTime().IsValid())
     name = rp->GetCreateTime().FormatISOCombined(' ');
   else
@@ -990,7 +1098,11 @@ wxString Track::GetIsoDateTime(const wxString label_for_invalid_date) const {
 wxString Track::GetDateTime(const wxString label_for_invalid_date) const {
   wxString name;
   TrackPoint *rp = NULL;
-  if ((int)TrackPoints.size() > 0) rp = TrackPoints[0];
+  TrackPoint paged_first(0, 0, m_paged_start);
+  if (m_paged_out)
+    rp = &paged_first;
+  else if ((int)TrackPoints.size() > 0)
+    rp = TrackPoints[0];
   if (rp && rp->GetCreateTime().IsValid())
     name = ocpn::toUsrDateTimeFormat(rp->GetCreateTime().FromUTC());
   else
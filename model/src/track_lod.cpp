@@ -0,0 +1,290 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement track_lod.h -- TrackLod
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "model/georef.h"
+#include "model/track_lod.h"
+
+static const uint32_t kMagic = 0x444f4c54;  // "TLOD"
+static const uint32_t kVersion = 1;
+
+static double LonDiff(double x) {
+  if (x > 180) return x - 360;
+  if (x < -180) return x + 360;
+  return x;
+}
+
+/** Projected mercator northing, as used by toSM(). */
+static double Northing(double lat) {
+  const double z = WGS84_semimajor_axis_meters * mercator_k0;
+  lat = std::max(-89.0, std::min(89.0, lat));
+  return z * log(tan(DEGREE * (45 + lat / 2)));
+}
+
+static void Expand(TrackLod::Extent& extent, const TrackLod::Point& p) {
+  extent.lat_min = std::min(extent.lat_min, p.lat);
+  extent.lat_max = std::max(extent.lat_max, p.lat);
+  extent.lon_min = std::min(extent.lon_min, p.lon);
+  extent.lon_max = std::max(extent.lon_max, p.lon);
+}
+
+void TrackLod::Clear() {
+  m_count = 0;
+  m_raw.clear();
+  double tolerance = kTolerance;
+  double error = 0;
+  for (Level& level : m_levels) {
+    error += tolerance;
+    level.tolerance = tolerance;
+    level.error = error;
+    level.source = 0;
+    level.points.clear();
+    level.blocks.clear();
+    tolerance *= 4;
+  }
+}
+
+void TrackLod::Commit(Level& level, const Point& point) {
+  level.points.push_back(point);
+  size_t n = level.points.size();
+  if (n < 2) return;
+  size_t block = (n - 2) / kBlock;
+  if (block == level.blocks.size()) {
+    const Point& prev = level.points[n - 2];
+    level.blocks.push_back({prev.lat, prev.lat, prev.lon, prev.lon});
+  }
+  Expand(level.blocks[block], point);
+}
+
+void TrackLod::Append(double lat, double lon) {
+  Point point{lat, lon, static_cast<uint32_t>(m_count++)};
+  m_raw.push_back(point);
+  if (m_count == 1) {
+    for (Level& level : m_levels) Commit(level, point);
+    return;
+  }
+  if (m_raw.size() <= kChunk) return;
+
+  Reduce(m_raw, 0, m_levels[0]);
+  m_raw.erase(m_raw.begin(), m_raw.begin() + kChunk);
+  for (int k = 1; k < kLevels; k++) {
+    const auto& below = m_levels[k - 1].points;
+    Level& level = m_levels[k];
+    if (below.size() - 1 - level.source < kChunk) break;
+    Reduce(below, level.source, level);
+    level.source += kChunk;
+  }
+}
+
+/**
+ * Douglas-Peucker reduction of points[0...n - 1], setting keep for points
+ * to keep. Iterative since a long run may be reduced to a single segment,
+ * and using the distance to the segment rather than to the line since
+ * tracks often turn back, e.g., while at anchor.
+ */
+static void DouglasPeucker(const TrackLod::Point* points, size_t n,
+                           double tolerance, std::vector<uint8_t>& keep) {
+  const double z = WGS84_semimajor_axis_meters * mercator_k0;
+  std::vector<double> xy(2 * n);
+  double x = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (i > 0) x += z * DEGREE * LonDiff(points[i].lon - points[i - 1].lon);
+    xy[2 * i] = x;
+    xy[2 * i + 1] = Northing(points[i].lat);
+  }
+  keep.assign(n, 0);
+  if (n == 0) return;
+  keep[0] = keep[n - 1] = 1;
+  const double tolerance2 = tolerance * tolerance;
+  std::vector<std::pair<size_t, size_t>> stack;
+  stack.emplace_back(0, n - 1);
+  while (!stack.empty()) {
+    size_t a = stack.back().first;
+    size_t b = stack.back().second;
+    stack.pop_back();
+    double ax = xy[2 * a], ay = xy[2 * a + 1];
+    double bx = xy[2 * b] - ax, by = xy[2 * b + 1] - ay;
+    double length2 = bx * bx + by * by;
+    double max_dist = 0;
+    size_t max_index = 0;
+    for (size_t i = a + 1; i < b; i++) {
+      double vx = xy[2 * i] - ax, vy = xy[2 * i + 1] - ay;
+      double t = length2 > 0 ? (vx * bx + vy * by) / length2 : 0;
+      t = std::max(0.0, std::min(1.0, t));
+      double dx = vx - t * bx, dy = vy - t * by;
+      double dist = dx * dx + dy * dy;
+      if (dist > max_dist) {
+        max_dist = dist;
+        max_index = i;
+      }
+    }
+    if (max_dist > tolerance2) {
+      keep[max_index] = 1;
+      stack.emplace_back(a, max_index);
+      stack.emplace_back(max_index, b);
+    }
+  }
+}
+
+/** Reduce from[first...first + kChunk] into level. */
+void TrackLod::Reduce(const std::vector<Point>& from, size_t first,
+                      Level& to) {
+  DouglasPeucker(&from[first], kChunk + 1, to.tolerance, m_keep);
+  for (size_t i = 1; i <= kChunk; i++) {
+    if (m_keep[i]) Commit(to, from[first + i]);
+  }
+}
+
+/*
+ * The points after the last one in a level are in the levels below and
+ * in m_raw, all within the level error of the track when reduced using
+ * the level tolerance.
+ */
+void TrackLod::GetTail(int level, std::vector<Point>& tail) const {
+  std::vector<Point> points(1, m_levels[level].points.back());
+  for (int k = level - 1; k >= 0; k--) {
+    const auto& below = m_levels[k].points;
+    points.insert(points.end(), below.begin() + m_levels[k + 1].source + 1,
+                  below.end());
+  }
+  points.insert(points.end(), m_raw.begin() + 1, m_raw.end());
+  std::vector<uint8_t> keep;
+  DouglasPeucker(points.data(), points.size(), m_levels[level].tolerance,
+                 keep);
+  for (size_t i = 0; i < points.size(); i++) {
+    if (keep[i]) tail.push_back(points[i]);
+  }
+}
+
+int TrackLod::SelectLevel(double max_error) const {
+  int selected = -1;
+  for (int k = 0; k < kLevels && m_levels[k].error <= max_error; k++) {
+    selected = k;
+  }
+  return selected;
+}
+
+namespace {
+class Writer {
+public:
+  template <typename T>
+  void Put(const T& value) {
+    auto p = reinterpret_cast<const uint8_t*>(&value);
+    data.insert(data.end(), p, p + sizeof(T));
+  }
+  void Put(const std::vector<TrackLod::Point>& points) {
+    Put(static_cast<uint64_t>(points.size()));
+    for (const auto& p : points) {
+      Put(p.lat);
+      Put(p.lon);
+      Put(p.index);
+    }
+  }
+  std::vector<uint8_t> data;
+};
+
+class Reader {
+public:
+  Reader(const void* data, size_t size)
+      : m_data(static_cast<const uint8_t*>(data)), m_size(size) {}
+
+  template <typename T>
+  bool Get(T& value) {
+    if (m_size - m_pos < sizeof(T)) return false;
+    memcpy(&value, m_data + m_pos, sizeof(T));
+    m_pos += sizeof(T);
+    return true;
+  }
+
+  bool Get(std::vector<TrackLod::Point>& points) {
+    const size_t kPointSize = 2 * sizeof(double) + sizeof(uint32_t);
+    uint64_t n;
+    if (!Get(n) || n > (m_size - m_pos) / kPointSize) return false;
+    points.resize(n);
+    for (auto& p : points) {
+      Get(p.lat);
+      Get(p.lon);
+      Get(p.index);
+    }
+    return true;
+  }
+
+  bool AtEnd() const { return m_pos == m_size; }
+
+private:
+  const uint8_t* m_data;
+  size_t m_size;
+  size_t m_pos = 0;
+};
+}  // namespace
+
+std::vector<uint8_t> TrackLod::Serialize() const {
+  Writer writer;
+  writer.Put(kMagic);
+  writer.Put(kVersion);
+  writer.Put(static_cast<uint32_t>(kLevels));
+  writer.Put(static_cast<uint32_t>(kChunk));
+  writer.Put(kTolerance);
+  writer.Put(static_cast<uint64_t>(m_count));
+  for (const Level& level : m_levels) {
+    writer.Put(static_cast<uint64_t>(level.source));
+    writer.Put(level.points);
+  }
+  writer.Put(m_raw);
+  return std::move(writer.data);
+}
+
+bool TrackLod::Deserialize(const void* data, size_t size) {
+  Clear();
+  Reader reader(data, size);
+  uint32_t magic, version, levels, chunk;
+  double tolerance;
+  uint64_t count;
+  bool ok = reader.Get(magic) && magic == kMagic && reader.Get(version) &&
+            version == kVersion && reader.Get(levels) && levels == kLevels &&
+            reader.Get(chunk) && chunk == kChunk && reader.Get(tolerance) &&
+            tolerance == kTolerance && reader.Get(count);
+  for (int k = 0; ok && k < kLevels; k++) {
+    uint64_t source;
+    std::vector<Point> points;
+    ok = reader.Get(source) && reader.Get(points);
+    if (!ok) break;
+    Level& level = m_levels[k];
+    level.source = source;
+    for (const Point& p : points) Commit(level, p);
+    size_t below = k > 0 ? m_levels[k - 1].points.size() : SIZE_MAX;
+    ok = (count == 0) == points.empty() && source < std::max(below, size_t(1));
+  }
+  ok = ok && reader.Get(m_raw) && reader.AtEnd() &&
+       (count == 0) == m_raw.empty() && m_raw.size() <= kChunk;
+  if (!ok) {
+    Clear();
+    return false;
+  }
+  m_count = count;
+  return true;
+}
@@ -0,0 +1,90 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement track_page_cache.h -- TrackPageCache
+ */
+
+#include <utility>
+#include <vector>
+
+#include "model/track_page_cache.h"
+
+TrackPageCache& TrackPageCache::GetInstance() {
+  static TrackPageCache instance;
+  return instance;
+}
+
+void TrackPageCache::Add(Key key, size_t points, Evictor evictor,
+                         Clock::time_point now) {
+  Remove(key);
+  m_lru.push_front(key);
+  m_entries.emplace(key, Entry{points, now, std::move(evictor), m_lru.begin()});
+  m_points += points;
+}
+
+void TrackPageCache::Touch(Key key, Clock::time_point now) {
+  auto it = m_entries.find(key);
+  if (it == m_entries.end()) return;
+  it->second.touched = now;
+  m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+}
+
+void TrackPageCache::Remove(Key key) {
+  auto it = m_entries.find(key);
+  if (it == m_entries.end()) return;
+  m_points -= it->second.points;
+  m_lru.erase(it->second.lru);
+  m_entries.erase(it);
+}
+
+void TrackPageCache::SetPinned(Key key, bool pinned) {
+  if (pinned)
+    m_pinned.insert(key);
+  else
+    m_pinned.erase(key);
+}
+
+size_t TrackPageCache::Enforce(size_t budget, std::chrono::milliseconds keep,
+                               Clock::time_point now) {
+  if (m_points <= budget) return 0;
+  // Collect the evictors first since they call back into the cache.
+  std::vector<Evictor> evictors;
+  size_t evicted = 0;
+  size_t points = m_points;
+  for (auto key = m_lru.rbegin(); key != m_lru.rend() && points > budget;) {
+    Entry& entry = m_entries.at(*key);
+    if (entry.touched + keep > now) break;
+    if (m_pinned.count(*key)) {
+      ++key;
+      continue;
+    }
+    points -= entry.points;
+    evicted += entry.points;
+    evictors.push_back(std::move(entry.evictor));
+    Key erased = *key;
+    key = std::list<Key>::reverse_iterator(m_lru.erase(std::next(key).base()));
+    m_points -= m_entries.at(erased).points;
+    m_entries.erase(erased);
+  }
+  for (auto& evictor : evictors) {
+    if (evictor) evictor();
+  }
+  return evicted;
+}
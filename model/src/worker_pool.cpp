@@ -0,0 +1,115 @@
+/**************************************************************************
+ *   Copyright (C) 2025 by agent                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <https://www.gnu.org/licenses/>. *
+ **************************************************************************/
+
+/**
+ * \file
+ *
+ * Implement worker_pool.h -- fixed size thread pool
+ */
+
+#include <algorithm>
+
+#include "model/worker_pool.h"
+
+WorkerPool::WorkerPool(unsigned threads) : m_running(0), m_stop(false) {
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < threads; i++)
+    m_threads.emplace_back([&] { Worker(); });
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard lock(m_mutex);
+    m_stop = true;
+  }
+  m_job_cv.notify_all();
+  for (auto& t : m_threads) {
+    if (t.joinable()) t.join();
+  }
+}
+
+WorkerPool& WorkerPool::GetShared() {
+  static WorkerPool instance;
+  return instance;
+}
+
+void WorkerPool::Post(Job job) {
+  {
+    std::lock_guard lock(m_mutex);
+    m_jobs.push_back(std::move(job));
+  }
+  m_job_cv.notify_one();
+}
+
+size_t WorkerPool::Pending() const {
+  std::lock_guard lock(m_mutex);
+  return m_jobs.size();
+}
+
+void WorkerPool::WaitIdle() {
+  std::unique_lock lock(m_mutex);
+  m_idle_cv.wait(lock, [&] { return m_jobs.empty() && m_running == 0; });
+}
+
+bool WorkerPool::IsWorkerThread() const {
+  auto id = std::this_thread::get_id();
+  for (const auto& t : m_threads)
+    if (t.get_id() == id) return true;
+  return false;
+}
+
+void WorkerPool::ParallelFor(size_t count,
+                             const std::function<void(size_t, size_t)>& func) {
+  if (count == 0) return;
+  const size_t chunks = std::min<size_t>(count, Size() + 1);
+  const size_t chunk_size = (count + chunks - 1) / chunks;
+
+  std::mutex done_mutex;
+  std::condition_variable done_cv;
+  size_t remaining = (count - 1) / chunk_size;  // chunks run by workers
+  for (size_t begin = chunk_size; begin < count; begin += chunk_size) {
+    size_t end = std::min(count, begin + chunk_size);
+    Post([&, begin, end] {
+      func(begin, end);
+      std::lock_guard lock(done_mutex);
+      if (--remaining == 0) done_cv.notify_all();
+    });
+  }
+  func(0, std::min(count, chunk_size));
+  std::unique_lock lock(done_mutex);
+  done_cv.wait(lock, [&] { return remaining == 0; });
+}
+
+void WorkerPool::Worker() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock lock(m_mutex);
+      m_job_cv.wait(lock, [&] { return m_stop || !m_jobs.empty(); });
+      if (m_jobs.empty()) return;  // m_stop is set and all jobs are done
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+      m_running++;
+    }
+    job();
+    {
+      std::lock_guard lock(m_mutex);
+      m_running--;
+      if (m_jobs.empty() && m_running == 0) m_idle_cv.notify_all();
+    }
+  }
+}
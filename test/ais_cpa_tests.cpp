@@ -0,0 +1,154 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/ais_cpa.h"
+#include "model/georef.h"
+#include "model/worker_pool.h"
+
+struct Target {
+  double lat;
+  double lon;
+  double cog;
+  double sog;
+};
+
+static std::vector<Target> MakeTargets(size_t count, double spread) {
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<double> offset(-spread, spread);
+  std::uniform_real_distribution<double> course(0, 360);
+  std::uniform_real_distribution<double> speed(0, 30);
+  std::vector<Target> targets;
+  for (size_t i = 0; i < count; i++) {
+    targets.push_back({57.9 + offset(rng), 11.7 + 2 * offset(rng),
+                       course(rng), speed(rng)});
+  }
+  // Anchored target not reporting COG and a parallel track.
+  targets.push_back({57.91, 11.71, 360.0, 0.0});
+  targets.push_back({57.91, 11.71, 45.0, 10.0});
+  return targets;
+}
+
+TEST(AisCpa, HeadOn) {
+  CpaOwnShip own{57.0, 11.0, 0.0, 10.0, true};
+  CpaResult result;
+  // Target 6 NM north, heading south at 10 kn: meet in 18 minutes.
+  ComputeCpa(own, 57.1, 11.0, 180.0, 10.0, kCpaPositionValid, CpaReach(),
+             result);
+  EXPECT_NEAR(result.range_nm, 6.0, 0.01);
+  EXPECT_NEAR(result.brg, 0.0, 0.1);
+  EXPECT_TRUE(result.has_cpa);
+  EXPECT_TRUE(result.valid);
+  EXPECT_TRUE(result.exact);
+  EXPECT_NEAR(result.tcpa, 18.0, 0.1);
+  EXPECT_NEAR(result.cpa, 0.0, 0.02);
+
+  // Receding target.
+  ComputeCpa(own, 56.9, 11.0, 180.0, 10.0, kCpaPositionValid, CpaReach(),
+             result);
+  EXPECT_LT(result.tcpa, 0);
+  EXPECT_FALSE(result.valid);
+
+  // Own ship is never a hazard, meteo stations leave CPA unchanged.
+  ComputeCpa(own, 57.1, 11.0, 180.0, 10.0, kCpaPositionValid | kCpaOwnShip,
+             CpaReach(), result);
+  EXPECT_TRUE(result.has_cpa);
+  EXPECT_EQ(result.cpa, 100);
+  EXPECT_EQ(result.tcpa, -100);
+  EXPECT_FALSE(result.valid);
+  ComputeCpa(own, 57.1, 11.0, 180.0, 10.0, kCpaPositionValid | kCpaMeteo,
+             CpaReach(), result);
+  EXPECT_FALSE(result.has_cpa);
+  EXPECT_FALSE(result.valid);
+  EXPECT_NEAR(result.range_nm, 6.0, 0.01);
+
+  // Unknown own SOG and target moving without COG.
+  ComputeCpa(CpaOwnShip{57.0, 11.0, 0.0, NAN, true}, 57.1, 11.0, 180.0,
+             10.0, kCpaPositionValid, CpaReach(), result);
+  EXPECT_FALSE(result.has_cpa);
+  ComputeCpa(own, 57.1, 11.0, 360.0, 5.0, kCpaPositionValid, CpaReach(),
+             result);
+  EXPECT_FALSE(result.has_cpa);
+  ComputeCpa(own, 57.1, 11.0, 360.0, NAN, kCpaPositionValid, CpaReach(),
+             result);
+  EXPECT_FALSE(result.has_cpa);
+}
+
+TEST(AisCpa, BatchMatchesSingle) {
+  auto targets = MakeTargets(3000, 1.0);
+  CpaOwnShip own{57.9, 11.7, 30.0, 8.0, true};
+  CpaReach reach;
+  reach.warn_nm = 0.5;
+  reach.tcpa_max_h = 0.5;
+
+  AisCpaBatch batch;
+  for (size_t i = 0; i < targets.size(); i++) {
+    const auto& t = targets[i];
+    EXPECT_EQ(batch.Add(t.lat, t.lon, t.cog, t.sog, kCpaPositionValid), i);
+  }
+  WorkerPool pool(4);
+  batch.Compute(own, reach, &pool);
+  ASSERT_EQ(batch.Size(), targets.size());
+  size_t exact = 0;
+  for (size_t i = 0; i < targets.size(); i++) {
+    const auto& t = targets[i];
+    CpaResult expected;
+    ComputeCpa(own, t.lat, t.lon, t.cog, t.sog, kCpaPositionValid, reach,
+               expected);
+    CpaResult result = batch.GetResult(i);
+    EXPECT_EQ(result.range_nm, expected.range_nm);
+    EXPECT_EQ(result.brg, expected.brg);
+    EXPECT_EQ(result.cpa, expected.cpa);
+    EXPECT_EQ(result.tcpa, expected.tcpa);
+    EXPECT_EQ(result.valid, expected.valid);
+    EXPECT_EQ(result.has_cpa, expected.has_cpa);
+    EXPECT_EQ(result.exact, expected.exact);
+    if (result.exact) exact++;
+  }
+  EXPECT_EQ(batch.GetExactCount(), exact);
+  EXPECT_GT(exact, 0);
+  EXPECT_LT(exact, targets.size() / 2);
+
+  // Reused batch keeps working after Clear().
+  batch.Clear();
+  batch.Add(57.1, 11.0, 180.0, 10.0, kCpaPositionValid);
+  batch.Compute(CpaOwnShip{57.0, 11.0, 0.0, 10.0, true}, CpaReach(), &pool);
+  EXPECT_EQ(batch.Size(), 1);
+  EXPECT_NEAR(batch.GetResult(0).tcpa, 18.0, 0.1);
+}
+
+TEST(AisCpa, PruneNeverHidesAlarm) {
+  // Targets outside reach must not be able to raise a CPA alarm, and their
+  // approximate CPA should stay within 1% of the range during the next
+  // hour.
+  auto targets = MakeTargets(3000, 0.5);
+  CpaOwnShip own{57.9, 11.7, 200.0, 12.0, true};
+  CpaReach reach;
+  reach.warn_nm = 1.0;
+  reach.range_max_nm = 20.0;
+  reach.tcpa_max_h = 0.25;
+  const double tcpa_max = reach.tcpa_max_h * 60;
+  size_t pruned = 0;
+  for (const auto& t : targets) {
+    CpaResult result;
+    ComputeCpa(own, t.lat, t.lon, t.cog, t.sog, kCpaPositionValid, reach,
+               result);
+    if (result.exact || !result.has_cpa) continue;
+    pruned++;
+    CpaResult exact;
+    ComputeCpa(own, t.lat, t.lon, t.cog, t.sog, kCpaPositionValid,
+               CpaReach(), exact);
+    EXPECT_TRUE(exact.exact);
+    EXPECT_EQ(exact.tcpa, result.tcpa);
+    bool alarm = exact.cpa < reach.warn_nm && exact.tcpa > 0 &&
+                 exact.tcpa < tcpa_max &&
+                 exact.range_nm <= reach.range_max_nm;
+    EXPECT_FALSE(alarm);
+    if (std::abs(exact.tcpa) < 60) {
+      EXPECT_NEAR(result.cpa, exact.cpa, 0.01 * exact.range_nm);
+    }
+  }
+  EXPECT_GT(pruned, 1000);
+}
@@ -0,0 +1,190 @@
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "model/ais_bitstring.h"
+#include "model/ais_vdm.h"
+
+// The original bit by bit decoding, used as reference.
+static unsigned char RefSixBit(const char c) {
+  if (c < 0x30) return (unsigned char)-1;
+  if (c > 0x77) return (unsigned char)-1;
+  if ((0x57 < c) && (c < 0x60)) return (unsigned char)-1;
+  unsigned char cp = c;
+  cp += 0x28;
+  if (cp > 0x80)
+    cp += 0x20;
+  else
+    cp += 0x28;
+  return (unsigned char)(cp & 0x3f);
+}
+
+static int RefGetInt(const std::string& payload, int sp, int len,
+                     bool signed_flag) {
+  unsigned acc = 0;
+  int s0p = sp - 1;
+  for (int i = 0; i < len; i++) {
+    acc = acc << 1;
+    size_t cp = (s0p + i) / 6;
+    unsigned cx = cp < payload.size() ? RefSixBit(payload[cp]) : 0;
+    unsigned c0 = (cx >> (5 - ((s0p + i) % 6))) & 1;
+    if (i == 0 && signed_flag && c0) acc = ~acc;
+    acc |= c0;
+  }
+  return static_cast<int>(acc);
+}
+
+static std::string Armour(const std::string& s) {
+  size_t star = s.find('*');
+  unsigned char sum = 0;
+  for (size_t i = 1; i < star; i++) sum ^= s[i];
+  char hex[3];
+  snprintf(hex, sizeof(hex), "%02X", sum);
+  return s.substr(0, star + 1) + hex;
+}
+
+TEST(AisBitstring, SixBit) {
+  AisBitstring bits("");
+  for (int c = 0; c < 256; c++) {
+    EXPECT_EQ(bits.to_6bit(static_cast<char>(c)),
+              RefSixBit(static_cast<char>(c)));
+  }
+}
+
+TEST(AisBitstring, GetInt) {
+  std::mt19937 rng(4711);
+  std::uniform_int_distribution<int> chars(0x20, 0x7f);
+  for (int round = 0; round < 20; round++) {
+    std::string payload;
+    for (int i = 0; i < 60; i++) payload += static_cast<char>(chars(rng));
+    AisBitstring bits(payload.data(), payload.size());
+    EXPECT_EQ(bits.GetBitCount(), 360);
+    for (int sp = 1; sp < 380; sp++) {
+      for (int len = 1; len <= 32; len++) {
+        EXPECT_EQ(bits.GetInt(sp, len), RefGetInt(payload, sp, len, false));
+        EXPECT_EQ(bits.GetInt(sp, len, true),
+                  RefGetInt(payload, sp, len, true));
+      }
+    }
+  }
+}
+
+TEST(AisBitstring, GetStr) {
+  std::string payload =
+      "55P5TL01VIaAL@7WKO@mBplU@<PDhh000000001S;AJ::4A80?4i@E531";
+  AisBitstring bits(payload.c_str());
+  for (int sp = 1; sp < 300; sp++) {
+    char str[21];
+    char ref[21];
+    EXPECT_EQ(bits.GetStr(sp, 120, str, 20), 20);
+    for (int k = 0; k < 20; k++) {
+      ref[k] = static_cast<char>(RefGetInt(payload, sp + 6 * k, 6, false));
+      if (ref[k] < 32) ref[k] += 0x40;
+    }
+    ref[20] = 0;
+    EXPECT_EQ(std::string(str), std::string(ref));
+  }
+  char name[5];
+  EXPECT_EQ(bits.GetStr(113, 120, name, 4), 4);
+  EXPECT_EQ(std::strlen(name), 4);
+}
+
+TEST(AisVdm, Parse) {
+  AisVdmSentence vdm;
+  const char* s = "!AIVDM,2,1,8,A,53bvpB02;CK10@lf220<u84j0lTh,0*3B";
+  EXPECT_TRUE(ParseVdmSentence(s, vdm));
+  EXPECT_EQ(vdm.count, 2);
+  EXPECT_EQ(vdm.index, 1);
+  EXPECT_EQ(vdm.sequence_id, 8);
+  EXPECT_EQ(vdm.channel, 'A');
+  EXPECT_FALSE(vdm.own_ship);
+  EXPECT_EQ(vdm.payload, "53bvpB02;CK10@lf220<u84j0lTh");
+
+  EXPECT_TRUE(ParseVdmSentence("!AIVDO,1,1,,,B3uBrjP0,0*31", vdm));
+  EXPECT_TRUE(vdm.own_ship);
+  EXPECT_EQ(vdm.sequence_id, -1);
+  EXPECT_EQ(vdm.channel, 0);
+  EXPECT_EQ(vdm.payload, "B3uBrjP0");
+
+  EXPECT_TRUE(ParseVdmSentence("!AIVDM,1", vdm));
+  EXPECT_EQ(vdm.count, 1);
+  EXPECT_EQ(vdm.index, 0);
+  EXPECT_TRUE(vdm.payload.empty());
+  EXPECT_FALSE(ParseVdmSentence("$GPRMC,092211.00,A", vdm));
+}
+
+TEST(AisVdm, Checksum) {
+  EXPECT_TRUE(
+      VdmChecksumOk("!AIVDM,1,1,,A,1535SB002qOg@MVLTi@b;H8V08;?,0*47"));
+  EXPECT_TRUE(
+      VdmChecksumOk("!AIVDM,1,1,,A,1535SB002qOg@MVLTi@b;H8V08;?,0*47\r\n"));
+  EXPECT_FALSE(
+      VdmChecksumOk("!AIVDM,1,1,,A,1535SB002qOg@MVLTi@b;H8V08;?,0*48"));
+  EXPECT_FALSE(VdmChecksumOk("!AIVDM,1,1,,A,1535SB002qOg@MVLTi@b;H8V08;?,0"));
+}
+
+TEST(AisVdm, Reassemble) {
+  AisVdmAssembler assembler;
+  AisVdmSentence vdm;
+  std::string sentence;
+  auto add = [&](const std::string& s) {
+    sentence = Armour(s);
+    ParseVdmSentence(sentence, vdm);
+    return std::string(assembler.Add(vdm));
+  };
+  EXPECT_EQ(add("!AIVDM,1,1,,A,abc,0*"), "abc");
+
+  // Interleaved messages on both channels and with different ids.
+  EXPECT_EQ(add("!AIVDM,2,1,3,A,abc,0*"), "");
+  EXPECT_EQ(add("!AIVDM,2,1,3,B,ABC,0*"), "");
+  EXPECT_EQ(add("!AIVDM,3,1,4,A,123,0*"), "");
+  EXPECT_EQ(add("!AIVDM,2,2,3,B,DEF,2*"), "ABCDEF");
+  EXPECT_EQ(add("!AIVDM,3,2,4,A,456,0*"), "");
+  EXPECT_EQ(add("!AIVDM,2,2,3,A,def,2*"), "abcdef");
+  EXPECT_EQ(add("!AIVDM,3,3,4,A,789,2*"), "123456789");
+
+  // Lost and duplicated parts drop the message.
+  EXPECT_EQ(add("!AIVDM,3,1,5,A,abc,0*"), "");
+  EXPECT_EQ(add("!AIVDM,3,3,5,A,ghi,0*"), "");
+  EXPECT_EQ(add("!AIVDM,2,2,6,A,def,0*"), "");
+  EXPECT_EQ(add("!AIVDM,2,1,7,A,abc,0*"), "");
+  EXPECT_EQ(add("!AIVDM,2,1,7,A,abc,0*"), "");
+  EXPECT_EQ(add("!AIVDM,2,2,7,A,def,0*"), "abcdef");
+  EXPECT_EQ(add("!AIVDM,2,2,7,A,def,0*"), "");
+
+  // Overlong messages are dropped.
+  std::string part(200, '0');
+  for (int i = 1; i <= 5; i++) {
+    EXPECT_EQ(add("!AIVDM,5," + std::to_string(i) + ",1,A," + part + ",0*"),
+              "");
+  }
+}
+
+TEST(AisVdm, Testdata) {
+  std::ifstream stream(std::string(TESTDATA) + "/Hakefjord.log");
+  ASSERT_TRUE(stream.good());
+  AisVdmAssembler assembler;
+  AisVdmSentence vdm;
+  int sentences = 0;
+  int messages = 0;
+  std::string line;
+  while (std::getline(stream, line)) {
+    if (!ParseVdmSentence(line, vdm)) continue;
+    sentences++;
+    EXPECT_TRUE(VdmChecksumOk(line));
+    auto payload = assembler.Add(vdm);
+    if (payload.empty()) continue;
+    messages++;
+    AisBitstring bits(payload.data(), payload.size());
+    int type = bits.GetInt(1, 6);
+    EXPECT_TRUE(type >= 1 && type <= 27);
+    if (type == 5) {
+      EXPECT_EQ(bits.GetBitCount(), 426);
+    }
+  }
+  EXPECT_EQ(sentences, 15912);
+  EXPECT_EQ(messages, 15824);
+}
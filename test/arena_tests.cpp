@@ -0,0 +1,47 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/arena.h"
+
+TEST(Arena, Alignment) {
+  Arena arena(256);
+  auto c = static_cast<char*>(arena.Allocate(1, 1));
+  auto d = arena.AllocateArray<double>(3);
+  auto f = arena.AllocateArray<float>(5);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(d) % alignof(double), 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(f) % alignof(float), 0);
+  EXPECT_NE(static_cast<void*>(c), static_cast<void*>(d));
+  EXPECT_EQ(arena.GetUsed(), 1 + 3 * sizeof(double) + 5 * sizeof(float));
+  EXPECT_EQ(arena.GetCapacity(), 256);
+}
+
+TEST(Arena, Blocks) {
+  Arena arena(256);
+  // Fill several regular blocks, all allocations must stay intact.
+  std::vector<uint32_t*> arrays;
+  for (uint32_t i = 0; i < 100; i++) {
+    uint32_t* a = arena.AllocateArray<uint32_t>(4);
+    for (int j = 0; j < 4; j++) a[j] = i;
+    arrays.push_back(a);
+  }
+  for (uint32_t i = 0; i < 100; i++) {
+    for (int j = 0; j < 4; j++) EXPECT_EQ(arrays[i][j], i);
+  }
+  EXPECT_EQ(arena.GetUsed(), 100 * 16);
+  EXPECT_GE(arena.GetCapacity(), 100 * 16);
+
+  // Large requests get a dedicated block.
+  size_t capacity = arena.GetCapacity();
+  auto big = static_cast<unsigned char*>(arena.Allocate(1000));
+  std::memset(big, 0xff, 1000);
+  EXPECT_GE(arena.GetCapacity(), capacity + 1000);
+  EXPECT_EQ(arrays.back()[0], 99);
+
+  arena.Release();
+  EXPECT_EQ(arena.GetUsed(), 0);
+  EXPECT_EQ(arena.GetCapacity(), 0);
+  EXPECT_NE(arena.AllocateArray<uint32_t>(1), nullptr);
+}
@@ -0,0 +1,177 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/bsb_row_decoder.h"
+
+// Plain run length encoding of a row, the inverse of the decoder.
+static std::vector<uint8_t> Encode(const std::vector<uint8_t>& pixels,
+                                   int color_bits, int line) {
+  std::vector<uint8_t> row;
+  // Line number, seven bits per byte with high bit as continuation.
+  if (line >= 128) row.push_back(0x80 | (line >> 7));
+  row.push_back(line & 0x7f);
+  const int shift = 7 - color_bits;
+  size_t i = 0;
+  while (i < pixels.size()) {
+    size_t n = 1;
+    while (i + n < pixels.size() && pixels[i + n] == pixels[i]) n++;
+    unsigned count = n - 1;
+    // Number of continuation bytes needed for count.
+    int extra = 0;
+    while ((count >> (shift + 7 * extra)) != 0) extra++;
+    uint8_t first = pixels[i] << shift | count >> (7 * extra);
+    if (extra > 0) first |= 0x80;
+    row.push_back(first);
+    for (int k = extra - 1; k >= 0; k--) {
+      uint8_t b = (count >> (7 * k)) & 0x7f;
+      if (k > 0) b |= 0x80;
+      row.push_back(b);
+    }
+    i += n;
+  }
+  row.push_back(0);
+  return row;
+}
+
+// Color index 0 is not used in charts, a run of one such pixel would
+// encode as the row terminator.
+static std::vector<uint8_t> MakePixels(std::mt19937& rng, int width,
+                                       int colors) {
+  std::uniform_int_distribution<int> color(1, colors - 1);
+  std::geometric_distribution<int> run(0.02);
+  std::vector<uint8_t> pixels;
+  while (pixels.size() < static_cast<size_t>(width)) {
+    pixels.insert(pixels.end(), run(rng) + 1, color(rng));
+  }
+  pixels.resize(width);
+  return pixels;
+}
+
+static std::vector<int> MakePalette(int colors) {
+  std::vector<int> palette;
+  for (int i = 0; i < colors; i++) {
+    palette.push_back(0x10000 * (i * 7 % 256) + 0x100 * (i * 3 % 256) + i);
+  }
+  return palette;
+}
+
+TEST(BsbRowDecoder, ExpandMatchesPixels) {
+  std::mt19937 rng(1234);
+  for (int color_bits = 1; color_bits <= 7; color_bits++) {
+    const int colors = 1 << color_bits;
+    auto palette = MakePalette(colors);
+    BsbRowDecoder decoder(color_bits, palette.data(), colors);
+    for (int round = 0; round < 20; round++) {
+      const int width = 1 + rng() % 3000;
+      auto pixels = MakePixels(rng, width, colors);
+      auto row = Encode(pixels, color_bits, round * 100);
+      size_t pos = decoder.SkipLineNumber(row.data(), row.size());
+      EXPECT_EQ(pos, round * 100 >= 128 ? 2 : 1);
+
+      int xs = rng() % width;
+      int xl = xs + 1 + rng() % (width - xs);
+      std::vector<uint8_t> rgb(3 * (xl - xs) + 1, 0xee);
+      decoder.ExpandRgb(row.data(), row.size(), pos, 0, xs, xl, rgb.data());
+      for (int x = xs; x < xl; x++) {
+        uint8_t* p = &rgb[3 * (x - xs)];
+        int color = palette[pixels[x]];
+        ASSERT_EQ(p[0], color & 0xff);
+        ASSERT_EQ(p[1], (color >> 8) & 0xff);
+        ASSERT_EQ(p[2], (color >> 16) & 0xff);
+      }
+      EXPECT_EQ(rgb.back(), 0xee);  // No write beyond last pixel
+
+      std::vector<uint8_t> indices(xl - xs);
+      decoder.ExpandIndices(row.data(), row.size(), pos, 0, xs, xl,
+                            indices.data());
+      for (int x = xs; x < xl; x++) ASSERT_EQ(indices[x - xs], pixels[x]);
+
+      std::vector<uint8_t> converted(rgb.size(), 0xee);
+      decoder.IndicesToRgb(indices.data(), xl - xs, converted.data());
+      EXPECT_EQ(converted, rgb);
+    }
+  }
+}
+
+TEST(BsbRowDecoder, StartInsideRow) {
+  // Start decoding at a run in the middle of the row, like the tile
+  // offsets in the chart line cache.
+  std::mt19937 rng(99);
+  auto palette = MakePalette(16);
+  BsbRowDecoder decoder(4, palette.data(), 16);
+  auto pixels = MakePixels(rng, 2000, 16);
+  auto row = Encode(pixels, 4, 5);
+  size_t pos = decoder.SkipLineNumber(row.data(), row.size());
+  int ix = 0;
+  int runs = 0;
+  while (ix < 2000) {
+    std::vector<uint8_t> indices(2000 - ix);
+    decoder.ExpandIndices(row.data(), row.size(), pos, ix, ix, 2000,
+                          indices.data());
+    for (int x = ix; x < 2000; x++) ASSERT_EQ(indices[x - ix], pixels[x]);
+    // Advance one run.
+    unsigned count = row[pos] & 0x07;
+    while (row[pos++] & 0x80) count = count * 128 + (row[pos] & 0x7f);
+    ix += count + 1;
+    runs++;
+  }
+  EXPECT_GT(runs, 10);
+}
+
+TEST(BsbRowDecoder, Corrupt) {
+  auto palette = MakePalette(128);
+  BsbRowDecoder decoder(7, palette.data(), 128);
+  std::vector<uint8_t> pixels(100, 5);
+  auto row = Encode(pixels, 7, 1);
+
+  // A truncated row runs to the end with index 0.
+  std::vector<uint8_t> indices(300, 0xee);
+  decoder.ExpandIndices(row.data(), row.size(), 1, 0, 0, 300, indices.data());
+  for (int x = 0; x < 100; x++) ASSERT_EQ(indices[x], 5);
+  for (int x = 100; x < 300; x++) ASSERT_EQ(indices[x], 0);
+
+  // A dangling continuation byte runs its color to the end.
+  row.back() = 6 | 0x80;
+  decoder.ExpandIndices(row.data(), row.size(), 1, 0, 0, 300, indices.data());
+  for (int x = 100; x < 300; x++) ASSERT_EQ(indices[x], 6);
+  decoder.ExpandIndices(row.data(), 0, 0, 0, 0, 300, indices.data());
+  for (int x = 0; x < 300; x++) ASSERT_EQ(indices[x], 0);
+
+  // Indices outside the palette and the fill index are black.
+  BsbRowDecoder small(7, palette.data(), 4);
+  EXPECT_EQ(small.GetColor(3), palette[3]);
+  EXPECT_EQ(small.GetColor(5), 0);
+  EXPECT_EQ(decoder.GetColor(BsbRowDecoder::kFillIndex), 0);
+}
+
+TEST(BsbRowDecoder, AccumulateBox) {
+  auto palette = MakePalette(8);
+  BsbRowDecoder decoder(3, palette.data(), 8);
+  std::mt19937 rng(7);
+  std::vector<uint8_t> indices(1000);
+  for (auto& i : indices) i = rng() % 8;
+  const double factor = 3.3;
+  const int blur = 3;
+  const int targets = 304;  // Boxes at the end are clipped
+  std::vector<uint32_t> sums(4 * targets, 0);
+  decoder.AccumulateBox(indices.data(), indices.size(), factor, blur, targets,
+                        sums.data());
+  decoder.AccumulateBox(indices.data(), indices.size(), factor, blur, targets,
+                        sums.data());
+  for (int x = 0; x < targets; x++) {
+    uint32_t expected[4] = {0, 0, 0, 0};
+    for (int i = (int)(x * factor); i < (int)(x * factor) + blur; i++) {
+      if (i >= 1000) break;
+      int color = palette[indices[i]];
+      expected[0] += 2 * (color & 0xff);
+      expected[1] += 2 * ((color >> 8) & 0xff);
+      expected[2] += 2 * ((color >> 16) & 0xff);
+      expected[3] += 2;
+    }
+    for (int k = 0; k < 4; k++) ASSERT_EQ(sums[4 * x + k], expected[k]);
+  }
+  EXPECT_EQ(sums[4 * 303 + 3], 2);
+}
@@ -4,12 +4,14 @@
 #include <fstream>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <wx/app.h>
 
 #include <gtest/gtest.h>
 
 #include "std_filesystem.h"
+#include "model/atomic_queue.h"
 #include "model/base_platform.h"
 #include "model/comm_buffers.h"
 #include "model/comm_drv_registry.h"
@@ -190,3 +192,130 @@ TEST(CircularBuffer, Basic) {
   EXPECT_EQ(buff.Size(), 10);
   EXPECT_THROW(buff.Put('z'), BufferError);
 }
+
+TEST(SpscQueue, Basic) {
+  SpscQueue<int> queue(5);
+  EXPECT_EQ(queue.Capacity(), 8);
+  EXPECT_TRUE(queue.IsEmpty());
+  for (int i = 0; i < 8; i++) EXPECT_TRUE(queue.TryPush(i));
+  EXPECT_TRUE(queue.IsFull());
+  EXPECT_FALSE(queue.TryPush(8));
+
+  int item;
+  EXPECT_TRUE(queue.TryPop(item));
+  EXPECT_EQ(item, 0);
+  int batch[10];
+  EXPECT_EQ(queue.PopBatch(batch, 10), 7);
+  for (int i = 0; i < 7; i++) EXPECT_EQ(batch[i], i + 1);
+  EXPECT_FALSE(queue.TryPop(item));
+
+  for (int i = 0; i < 10; i++) batch[i] = 100 + i;
+  EXPECT_EQ(queue.PushBatch(batch, 10), 8);
+  auto stats = queue.GetStats();
+  EXPECT_EQ(stats.pushed, 16);
+  EXPECT_EQ(stats.popped, 8);
+  EXPECT_EQ(stats.dropped, 3);
+  EXPECT_EQ(stats.overruns, 2);
+}
+
+TEST(MpmcQueue, Basic) {
+  MpmcQueue<std::string> queue(4);
+  EXPECT_TRUE(queue.TryPush(GPGGA));
+  EXPECT_TRUE(queue.TryPush(GPGGL));
+  EXPECT_EQ(queue.Size(), 2);
+  std::string line;
+  EXPECT_TRUE(queue.TryPop(line));
+  EXPECT_EQ(line, GPGGA);
+  EXPECT_TRUE(queue.TryPop(line));
+  EXPECT_EQ(line, GPGGL);
+  EXPECT_FALSE(queue.TryPop(line));
+  for (int i = 0; i < 6; i++) queue.TryPush(GPGGA);
+  EXPECT_EQ(queue.Size(), 4);
+  EXPECT_EQ(queue.GetStats().dropped, 2);
+}
+
+TEST(MpmcQueue, Threaded) {
+  const int kProducers = 4;
+  const int kItems = 20000;
+  MpmcQueue<int> queue(256);
+  std::atomic<long> sum(0);
+  std::atomic<int> received(0);
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; p++) {
+    threads.emplace_back([&] {
+      for (int i = 1; i <= kItems;) {
+        if (queue.TryPush(i))
+          i++;
+        else
+          std::this_thread::yield();
+      }
+    });
+  }
+  for (int c = 0; c < 2; c++) {
+    threads.emplace_back([&] {
+      int batch[16];
+      while (received < kProducers * kItems) {
+        size_t n = queue.PopBatch(batch, 16);
+        if (n == 0) std::this_thread::yield();
+        for (size_t i = 0; i < n; i++) sum += batch[i];
+        received += static_cast<int>(n);
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  EXPECT_EQ(received, kProducers * kItems);
+  EXPECT_EQ(sum, static_cast<long>(kProducers) * kItems * (kItems + 1) / 2);
+}
+
+/** Move kItems strings from one producer to one consumer, return items/s. */
+template <typename Push, typename Pop>
+static double MeasureThroughput(Push push, Pop pop) {
+  const int kItems = 200000;
+  auto start = std::chrono::steady_clock::now();
+  std::thread producer([&] {
+    for (int i = 0; i < kItems;) {
+      if (push(GPGGA))
+        i++;
+      else
+        std::this_thread::yield();
+    }
+  });
+  std::string line;
+  for (int i = 0; i < kItems;) {
+    if (pop(line))
+      i++;
+    else
+      std::this_thread::yield();
+  }
+  producer.join();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return kItems / elapsed.count();
+}
+
+TEST(MpmcQueue, Throughput) {
+  atomic_queue<std::string> locked;
+  double locked_rate = MeasureThroughput(
+      [&](const std::string& s) {
+        locked.push(s);
+        return true;
+      },
+      [&](std::string& s) { return locked.try_pop(s); });
+
+  MpmcQueue<std::string> mpmc(1024);
+  double mpmc_rate = MeasureThroughput(
+      [&](const std::string& s) { return mpmc.TryPush(s); },
+      [&](std::string& s) { return mpmc.TryPop(s); });
+
+  SpscQueue<std::string> spsc(1024);
+  double spsc_rate = MeasureThroughput(
+      [&](const std::string& s) { return spsc.TryPush(s); },
+      [&](std::string& s) { return spsc.TryPop(s); });
+
+  // writes to test_detail.xml if invoked with --gtest_output.xml
+  RecordProperty("atomic_queue msg/s", std::to_string(locked_rate));
+  RecordProperty("MpmcQueue msg/s", std::to_string(mpmc_rate));
+  RecordProperty("SpscQueue msg/s", std::to_string(spsc_rate));
+  EXPECT_GT(mpmc_rate, 0);
+  EXPECT_GT(spsc_rate, 0);
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/chart_spatial_index.h"
+
+// Random chart extents, some of them crossing the antimeridian using
+// either the -180..180 or the 0..360 longitude range.
+static ChartIndexEntry MakeEntry(std::mt19937& rng) {
+  std::uniform_real_distribution<float> lat(-80, 80);
+  std::uniform_real_distribution<float> lon(-180, 180);
+  std::uniform_real_distribution<float> unit(0, 1);
+  ChartIndexEntry entry;
+  float size = unit(rng) < 0.1 ? 20 * unit(rng) : 2 * unit(rng);
+  entry.lat_min = lat(rng);
+  entry.lat_max = entry.lat_min + size;
+  float r = unit(rng);
+  if (r < 0.1) {
+    entry.lon_min = 180 - size / 2;  // 0..360 range
+  } else if (r < 0.2) {
+    entry.lon_min = -180 - size / 2;
+  } else if (r < 0.3) {
+    entry.lon_min = 360 * unit(rng);
+  } else {
+    entry.lon_min = lon(rng);
+  }
+  entry.lon_max = entry.lon_min + size;
+  entry.always = unit(rng) < 0.01;
+  for (int group = 1; group <= 3; group++)
+    if (unit(rng) < 0.3) entry.groups.push_back(group);
+  return entry;
+}
+
+static bool InGroup(const ChartIndexEntry& e, int group) {
+  if (group <= 0) return true;
+  return std::find(e.groups.begin(), e.groups.end(), group) != e.groups.end();
+}
+
+static std::vector<int> BruteForce(const std::vector<ChartIndexEntry>& entries,
+                                   float lat_min, float lat_max, float lon_min,
+                                   float lon_max, int group) {
+  std::vector<int> result;
+  for (size_t i = 0; i < entries.size(); i++) {
+    const auto& e = entries[i];
+    if (!InGroup(e, group)) continue;
+    bool hit = e.always;
+    for (float bias : {0.0F, 360.0F, -360.0F}) {
+      hit = hit || (e.lat_min <= lat_max && e.lat_max >= lat_min &&
+                    e.lon_min <= lon_max + bias && e.lon_max >= lon_min + bias);
+    }
+    if (hit) result.push_back(static_cast<int>(i));
+  }
+  return result;
+}
+
+static void CheckQueries(const ChartSpatialIndex& index,
+                         const std::vector<ChartIndexEntry>& entries,
+                         std::mt19937& rng) {
+  std::uniform_real_distribution<float> lat(-85, 85);
+  std::uniform_real_distribution<float> lon(-185, 185);
+  std::uniform_real_distribution<float> unit(0, 1);
+  for (int i = 0; i < 200; i++) {
+    int group = rng() % 5 - 1;
+    float la = lat(rng);
+    float lo = lon(rng);
+    EXPECT_EQ(index.QueryPoint(la, lo, group),
+              BruteForce(entries, la, la, lo, lo, group));
+    float size = 10 * unit(rng);
+    EXPECT_EQ(index.QueryBox(la, la + size, lo, lo + size, group),
+              BruteForce(entries, la, la + size, lo, lo + size, group));
+  }
+  // Right at the antimeridian, from both sides.
+  for (float lo : {-180.0F, 180.0F, 179.9F, -179.9F}) {
+    EXPECT_EQ(index.QueryPoint(0, lo), BruteForce(entries, 0, 0, lo, lo, 0));
+  }
+}
+
+TEST(ChartSpatialIndex, MatchesBruteForce) {
+  std::mt19937 rng(4711);
+  std::vector<ChartIndexEntry> entries;
+  for (int i = 0; i < 5000; i++) entries.push_back(MakeEntry(rng));
+  ChartSpatialIndex index;
+  EXPECT_FALSE(index.IsValid());
+  index.Build(entries);
+  EXPECT_TRUE(index.IsValid());
+  EXPECT_EQ(index.Size(), entries.size());
+  CheckQueries(index, entries, rng);
+}
+
+TEST(ChartSpatialIndex, Updates) {
+  std::mt19937 rng(17);
+  std::vector<ChartIndexEntry> entries;
+  for (int i = 0; i < 1000; i++) entries.push_back(MakeEntry(rng));
+  ChartSpatialIndex index;
+  index.Build(entries);
+
+  // Enough changes to trigger repacking from the overflow list.
+  for (int round = 0; round < 400; round++) {
+    if (rng() % 2 == 0) {
+      auto entry = MakeEntry(rng);
+      index.Append(entry);
+      entries.push_back(entry);
+    } else {
+      int db_index = rng() % entries.size();
+      index.RemoveSwapBack(db_index);
+      entries[db_index] = entries.back();
+      entries.pop_back();
+    }
+    if (round % 50 == 0) CheckQueries(index, entries, rng);
+  }
+  EXPECT_EQ(index.Size(), entries.size());
+
+  std::vector<int> groups{2};
+  index.SetGroups(0, groups);
+  entries[0].groups = groups;
+  EXPECT_TRUE(index.IsInGroup(0, 2));
+  EXPECT_FALSE(index.IsInGroup(0, 1));
+  CheckQueries(index, entries, rng);
+
+  index.Clear();
+  EXPECT_EQ(index.Size(), 0);
+  EXPECT_TRUE(index.QueryBox(-90, 90, -180, 180).empty());
+}
@@ -0,0 +1,582 @@
+/*
+ * Headless decode throughput benchmark for the comm stack.
+ *
+ * Feeds recorded corpora from the test data directory through
+ * N0183Buffer, FastMessageMap reassembly, the CommDriverN2KNet text
+ * format decoders, NavMsgBus and the two AisDecoder paths DecodeN0183()
+ * and DecodeVdm(). Prints one JSON object per benchmark on stdout:
+ *
+ *   {"name": "n0183_buffer", "messages": 59434, "seconds": 0.021,
+ *    "msgs_per_sec": 2830190, "allocs_per_msg": 2.00,
+ *    "latency_us": {"p50": 0.3, "p90": 0.4, "p99": 1.1, "max": 18.0}}
+ *
+ * Latency is the time from input being available to the message being
+ * produced. Allocations are counted in all threads while the benchmark
+ * runs.
+ *
+ * Usage: comm-bench [--repeat n] [--filter substring] [--testdata dir]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <wx/app.h>
+#include <wx/log.h>
+#include <wx/string.h>
+
+#include "model/ais_decoder.h"
+#include "model/base_platform.h"
+#include "model/comm_buffers.h"
+#include "model/comm_can_util.h"
+#include "model/comm_driver.h"
+#include "model/comm_drv_n2k_net.h"
+#include "model/comm_navmsg.h"
+#include "model/comm_navmsg_bus.h"
+#include "model/conn_params.h"
+#include "model/log_replay.h"
+#include "model/select.h"
+#include "observable.h"
+
+using namespace std::literals::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+extern Select* pSelectAIS;
+extern Select* pSelect;
+
+/** Minimum number of CAN frames fed to the N2K benchmarks. */
+static const size_t kMinFrames = 100000;
+
+/** Max chunk size fed to CommDriverN2KNet, as read from socket. */
+static const size_t kChunkSize = 4096;
+
+static std::atomic<uint64_t> s_allocations(0);
+
+void* operator new(size_t size) {
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+static double Micros(Clock::duration d) {
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+/** Measurement of one benchmark, printed by Report(). */
+class Result {
+public:
+  explicit Result(const std::string& name, size_t expected = 0)
+      : m_name(name), m_messages(0), m_seconds(0), m_allocations(0) {
+    m_latencies.reserve(expected);
+  }
+
+  /** Start measuring, after all setup is done. */
+  void Start() {
+    m_allocations = s_allocations.load();
+    m_start = Clock::now();
+  }
+
+  void Stop() {
+    m_seconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+    m_allocations = s_allocations.load() - m_allocations;
+  }
+
+  /** Record a produced message with given latency. */
+  void Add(Clock::duration latency) {
+    m_messages++;
+    if (m_latencies.size() < m_latencies.capacity())
+      m_latencies.push_back(Micros(latency));
+  }
+
+  /** Print result as a JSON object on a single line. */
+  void Report() {
+    std::sort(m_latencies.begin(), m_latencies.end());
+    auto percentile = [&](double p) {
+      if (m_latencies.empty()) return 0.0;
+      return m_latencies[static_cast<size_t>(p * (m_latencies.size() - 1))];
+    };
+    double rate = m_seconds > 0 ? m_messages / m_seconds : 0;
+    double allocs = m_messages > 0 ? double(m_allocations) / m_messages : 0;
+    std::printf(
+        "{\"name\": \"%s\", \"messages\": %llu, \"seconds\": %.6f, "
+        "\"msgs_per_sec\": %.0f, \"allocs_per_msg\": %.2f, "
+        "\"latency_us\": {\"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, "
+        "\"max\": %.2f}}\n",
+        m_name.c_str(), static_cast<unsigned long long>(m_messages),
+        m_seconds, rate, allocs, percentile(0.5), percentile(0.9),
+        percentile(0.99), percentile(1.0));
+    std::fflush(stdout);
+  }
+
+private:
+  std::string m_name;
+  uint64_t m_messages;
+  double m_seconds;
+  uint64_t m_allocations;
+  Clock::time_point m_start;
+  std::vector<double> m_latencies;
+};
+
+/** A complete NMEA 2000 message, reassembled from CAN frames. */
+struct N2kMessage {
+  CanHeader header;
+  std::vector<unsigned char> data;
+};
+
+/**
+ * Feed frame to map like the socketcan driver does.
+ * @return true and set data if a message is complete.
+ */
+static bool Assemble(FastMessageMap& map, const can_frame& frame,
+                     std::vector<unsigned char>& data) {
+  CanHeader header(frame);
+  if (!header.IsFastMessage()) {
+    data.assign(frame.data, frame.data + CAN_MAX_DLEN);
+    return true;
+  }
+  int position = map.FindMatchingEntry(header, frame.data[0]);
+  bool ready;
+  if (position == -1) {
+    position = map.AddNewEntry();
+    ready = map.InsertEntry(header, frame.data, position);
+  } else {
+    ready = map.AppendEntry(header, frame.data, position);
+  }
+  if (!ready) return false;
+  const auto& entry = map[position];
+  data.assign(entry.data.begin(),
+              entry.data.begin() + entry.expected_length);
+  map.Remove(position);
+  return true;
+}
+
+static std::string Hex(const unsigned char* data, size_t size) {
+  static const char* const kDigits = "0123456789ABCDEF";
+  std::string s;
+  for (size_t i = 0; i < size; i++) {
+    s += kDigits[data[i] >> 4];
+    s += kDigits[data[i] & 0x0F];
+  }
+  return s;
+}
+
+/** Add "*hh\r\n" NMEA checksum and line ending to sentence. */
+static std::string Checksummed(const std::string& sentence) {
+  unsigned char cs = 0;
+  for (size_t i = 1; i < sentence.size(); i++) cs ^= sentence[i];
+  return sentence + "*" + Hex(&cs, 1) + "\r\n";
+}
+
+/** Split text in chunks of at most kChunkSize bytes at line boundaries. */
+static std::vector<std::vector<unsigned char>> Chunks(
+    const std::vector<std::string>& lines) {
+  std::vector<std::vector<unsigned char>> chunks(1);
+  for (const auto& line : lines) {
+    if (chunks.back().size() + line.size() > kChunkSize) chunks.emplace_back();
+    chunks.back().insert(chunks.back().end(), line.begin(), line.end());
+  }
+  return chunks;
+}
+
+/** Benchmark hook, friend of CommDriverN2KNet. */
+class CommBench : public DriverListener {
+public:
+  CommBench(Result& result) : m_result(result) {}
+
+  void Notify(std::shared_ptr<const NavMsg> message) override {
+    m_result.Add(Clock::now() - m_chunk_start);
+  }
+
+  void Notify(const AbstractCommDriver& driver) override {}
+
+  /** Feed chunks to driver as the socket event handler does. */
+  void Run(const std::vector<std::vector<unsigned char>>& chunks) {
+    ConnectionParams params;
+    params.Type = NETWORK;
+    params.NetProtocol = GPSD;  // Open() creates no socket.
+    params.IOSelect = DS_TYPE_INPUT;
+    params.NetworkAddress = "127.0.0.1";
+    CommDriverN2KNet driver(&params, *this);
+    m_result.Start();
+    for (const auto& chunk : chunks) {
+      m_chunk_start = Clock::now();
+      driver.m_circle.PushBatch(chunk.data(), chunk.size());
+      switch (driver.DetectFormat(chunk)) {
+        case N2KFormat_Actisense_RAW_ASCII:
+        case N2KFormat_YD_RAW:
+          driver.ProcessActisense_ASCII_RAW(chunk);
+          break;
+        case N2KFormat_Actisense_N2K_ASCII:
+          driver.ProcessActisense_ASCII_N2K(chunk);
+          break;
+        case N2KFormat_SeaSmart:
+          driver.ProcessSeaSmart(chunk);
+          break;
+        case N2KFormat_MiniPlex:
+          driver.ProcessMiniPlex(chunk);
+          break;
+        default:
+          break;
+      }
+      driver.ProcessPendingEvents();
+    }
+    m_result.Stop();
+  }
+
+private:
+  Result& m_result;
+  Clock::time_point m_chunk_start;
+};
+
+class CommBenchApp : public wxAppConsole {
+public:
+  /** No wxCmdLineParser, options are handled by OnRun(). */
+  bool OnInit() override { return true; }
+
+  int OnRun() override {
+    std::string testdata(TESTDATA);
+    for (int i = 1; i + 1 < argc; i += 2) {
+      std::string arg(argv[i].ToStdString());
+      std::string value(argv[i + 1].ToStdString());
+      if (arg == "--repeat") m_repeat = std::max(1, std::atoi(value.c_str()));
+      if (arg == "--filter") m_filter = value;
+      if (arg == "--testdata") testdata = value;
+    }
+    wxLog::SetLogLevel(wxLOG_Warning);
+    g_BasePlatform = new BasePlatform();
+    pSelectAIS = new Select();
+    pSelect = new Select();
+
+    LoadNmea0183(testdata + "/Hakefjord.log");
+    LoadCandump(testdata + "/candump-2022-07-30_102821-head.log");
+
+    if (Enabled("n0183_buffer")) N0183BufferBench();
+    if (Enabled("fast_message_map")) FastMessageBench();
+    if (Enabled("n2k_net_yd_raw")) N2kNetBench("n2k_net_yd_raw", YdRaw());
+    if (Enabled("n2k_net_actisense_ascii"))
+      N2kNetBench("n2k_net_actisense_ascii", ActisenseAscii());
+    if (Enabled("n2k_net_seasmart"))
+      N2kNetBench("n2k_net_seasmart", SeaSmart());
+    if (Enabled("n2k_net_miniplex"))
+      N2kNetBench("n2k_net_miniplex", MiniPlex());
+    if (Enabled("navmsg_bus")) NavMsgBusBench();
+    if (Enabled("navmsg_bus_batch")) NavMsgBusBatchBench();
+    if (Enabled("ais_decoder")) AisDecoderBench();
+    if (Enabled("ais_decoder_vdm")) AisDecoderVdmBench();
+    return 0;
+  }
+
+private:
+  bool Enabled(const std::string& name) const {
+    return m_filter.empty() || name.find(m_filter) != std::string::npos;
+  }
+
+  void LoadNmea0183(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) std::cerr << "Cannot open " << path << "\n";
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(f, line);) {
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (line.size() > 6) lines.push_back(line);
+    }
+    for (int i = 0; i < m_repeat; i++)
+      m_sentences.insert(m_sentences.end(), lines.begin(), lines.end());
+  }
+
+  void LoadCandump(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) std::cerr << "Cannot open " << path << "\n";
+    std::vector<can_frame> frames;
+    std::string iface;
+    uint32_t id;
+    std::vector<unsigned char> data;
+    for (std::string line; std::getline(f, line);) {
+      if (!ParseCandumpLine(line, iface, id, data)) continue;
+      can_frame frame;
+      std::memset(&frame, 0xFF, sizeof(frame));
+      frame.can_id = id;
+      frame.can_dlc = static_cast<uint8_t>(data.size());
+      std::copy(data.begin(), data.end(), frame.data);
+      frames.push_back(frame);
+    }
+    if (frames.empty()) return;
+    while (m_frames.size() < kMinFrames * m_repeat)
+      m_frames.insert(m_frames.end(), frames.begin(), frames.end());
+
+    FastMessageMap map;
+    for (const auto& frame : m_frames) {
+      if (Assemble(map, frame, data))
+        m_n2k_messages.push_back({CanHeader(frame), data});
+    }
+  }
+
+  /** Yacht Devices RAW, one CAN frame per line. */
+  std::vector<std::vector<unsigned char>> YdRaw() const {
+    std::vector<std::string> lines;
+    unsigned ms = 0;
+    for (const auto& frame : m_frames) {
+      char buf[64];
+      std::snprintf(buf, sizeof(buf), "%02u:%02u:%02u.%03u R %08X",
+                    ms / 3600000 % 24, ms / 60000 % 60, ms / 1000 % 60,
+                    ms % 1000, frame.can_id);
+      std::string line(buf);
+      for (int i = 0; i < frame.can_dlc; i++)
+        line += " " + Hex(&frame.data[i], 1);
+      lines.push_back(line + "\r\n");
+      ms += 1;
+    }
+    return Chunks(lines);
+  }
+
+  /** Actisense N2K ASCII, one message per line. */
+  std::vector<std::vector<unsigned char>> ActisenseAscii() const {
+    std::vector<std::string> lines;
+    unsigned ms = 0;
+    for (const auto& msg : m_n2k_messages) {
+      unsigned prio_addr = msg.header.source << 12 |
+                           msg.header.destination << 4 | msg.header.priority;
+      char buf[64];
+      std::snprintf(buf, sizeof(buf), "A%06u.%03u %05X %05X ", ms / 1000,
+                    ms % 1000, prio_addr, msg.header.pgn);
+      lines.push_back(buf + Hex(msg.data.data(), msg.data.size()) + "\r\n");
+      ms += 1;
+    }
+    return Chunks(lines);
+  }
+
+  /** SeaSmart $PCDIN, one message per line. */
+  std::vector<std::vector<unsigned char>> SeaSmart() const {
+    std::vector<std::string> lines;
+    unsigned ms = 0;
+    for (const auto& msg : m_n2k_messages) {
+      char buf[64];
+      std::snprintf(buf, sizeof(buf), "$PCDIN,%06X,%08X,%02X,",
+                    msg.header.pgn, ms++, msg.header.source);
+      lines.push_back(
+          Checksummed(buf + Hex(msg.data.data(), msg.data.size())));
+    }
+    return Chunks(lines);
+  }
+
+  /** MiniPlex $MXPGN, one CAN frame per line, data in reverse order. */
+  std::vector<std::vector<unsigned char>> MiniPlex() const {
+    std::vector<std::string> lines;
+    for (const auto& frame : m_frames) {
+      CanHeader header(frame);
+      unsigned attr =
+          header.priority << 12 | frame.can_dlc << 8 | header.source;
+      char buf[64];
+      std::snprintf(buf, sizeof(buf), "$MXPGN,%06X,%04X,", header.pgn, attr);
+      std::string line(buf);
+      for (int i = frame.can_dlc - 1; i >= 0; i--)
+        line += Hex(&frame.data[i], 1);
+      lines.push_back(Checksummed(line));
+    }
+    return Chunks(lines);
+  }
+
+  void N0183BufferBench() {
+    Result result("n0183_buffer", m_sentences.size());
+    N0183Buffer buffer;
+    result.Start();
+    for (const auto& sentence : m_sentences) {
+      auto start = Clock::now();
+      for (char c : sentence) buffer.Put(c);
+      buffer.Put('\r');
+      buffer.Put('\n');
+      while (buffer.HasSentence()) {
+        buffer.GetSentence();
+        result.Add(Clock::now() - start);
+      }
+    }
+    result.Stop();
+    result.Report();
+  }
+
+  void FastMessageBench() {
+    Result result("fast_message_map", m_frames.size());
+    FastMessageMap map;
+    std::vector<unsigned char> data;
+    data.reserve(256);
+    result.Start();
+    for (const auto& frame : m_frames) {
+      auto start = Clock::now();
+      if (Assemble(map, frame, data)) result.Add(Clock::now() - start);
+    }
+    result.Stop();
+    result.Report();
+  }
+
+  void N2kNetBench(const std::string& name,
+                   const std::vector<std::vector<unsigned char>>& chunks) {
+    Result result(name, m_frames.size());
+    CommBench bench(result);
+    bench.Run(chunks);
+    result.Report();
+  }
+
+  /** Messages for the bus benchmarks and their keys. */
+  std::vector<std::shared_ptr<const NavMsg>> BusMessages(
+      std::vector<std::string>& types) const {
+    auto src = std::make_shared<NavAddr0183>("bench");
+    std::vector<std::shared_ptr<const NavMsg>> messages;
+    for (const auto& sentence : m_sentences) {
+      if (sentence[0] != '$' && sentence[0] != '!') continue;
+      auto msg = std::make_shared<Nmea0183Msg>(sentence.substr(1, 5),
+                                               sentence, src);
+      types.push_back(msg->type);
+      messages.push_back(msg);
+    }
+    return messages;
+  }
+
+  /** Observable listeners, served by the wx event loop. */
+  void NavMsgBusBench() {
+    std::vector<std::string> types;
+    auto messages = BusMessages(types);
+    Result result("navmsg_bus", messages.size());
+
+    // Per type FIFO of message indexes, to find the send time of each
+    // delivered message.
+    std::map<std::string, std::vector<size_t>> by_type;
+    for (size_t i = 0; i < types.size(); i++) by_type[types[i]].push_back(i);
+    std::vector<Clock::time_point> sent(messages.size());
+    std::vector<std::unique_ptr<ObsListener>> listeners;
+    std::vector<size_t> cursors(by_type.size(), 0);
+    bool warmup = true;
+    size_t slot = 0;
+    for (const auto& kv : by_type) {
+      const std::vector<size_t>* indexes = &kv.second;
+      size_t* cursor = &cursors[slot++];
+      listeners.push_back(std::make_unique<ObsListener>(
+          Nmea0183Msg(kv.first), [&, indexes, cursor](ObservedEvt&) {
+            if (warmup) return;
+            result.Add(Clock::now() - sent[(*indexes)[(*cursor)++]]);
+          }));
+    }
+    // Register all keys so no message is deferred by CallAfter().
+    auto& bus = NavMsgBus::GetInstance();
+    for (const auto& kv : by_type) bus.Notify(messages[kv.second.front()]);
+    while (HasPendingEvents()) ProcessPendingEvents();
+    warmup = false;
+
+    result.Start();
+    const size_t kBatch = 1024;
+    for (size_t i = 0; i < messages.size(); i += kBatch) {
+      size_t end = std::min(i + kBatch, messages.size());
+      for (size_t j = i; j < end; j++) {
+        sent[j] = Clock::now();
+        bus.Notify(messages[j]);
+      }
+      while (HasPendingEvents()) ProcessPendingEvents();
+    }
+    result.Stop();
+    result.Report();
+  }
+
+  /** Batch mode with a batch listener in a worker thread. */
+  void NavMsgBusBatchBench() {
+    std::vector<std::string> types;
+    auto messages = BusMessages(types);
+    Result result("navmsg_bus_batch", messages.size());
+    std::vector<Clock::time_point> sent(messages.size());
+    std::atomic<size_t> delivered(0);
+    auto& bus = NavMsgBus::GetInstance();
+    bus.SetBatchMode(true, 10ms);
+    int handle = bus.AddBatchListener(
+        [&](const NavMsgBatch& batch) {
+          size_t n = delivered;
+          for (size_t i = 0; i < batch.size(); i++)
+            result.Add(Clock::now() - sent[n++]);
+          delivered = n;
+        },
+        NavMsgDelivery::kWorker);
+
+    result.Start();
+    const size_t kBatch = 4096;  // Well below the bus queue size.
+    for (size_t i = 0; i < messages.size(); i += kBatch) {
+      size_t end = std::min(i + kBatch, messages.size());
+      for (size_t j = i; j < end; j++) {
+        sent[j] = Clock::now();
+        bus.Notify(messages[j]);
+      }
+      while (delivered < end) std::this_thread::sleep_for(1ms);
+    }
+    result.Stop();
+    bus.RemoveBatchListener(handle);
+    bus.SetBatchMode(false);
+    ProcessPendingEvents();
+    result.Report();
+  }
+
+  void AisDecoderBench() {
+    std::vector<wxString> sentences;
+    for (const auto& sentence : m_sentences) {
+      if (sentence.find("VDM,") != std::string::npos ||
+          sentence.find("VDO,") != std::string::npos) {
+        sentences.push_back(wxString(sentence));
+      }
+    }
+    Result result("ais_decoder", sentences.size());
+    auto decoder = std::make_unique<AisDecoder>(AisDecoderCallbacks());
+    result.Start();
+    for (const auto& sentence : sentences) {
+      auto start = Clock::now();
+      decoder->DecodeN0183(sentence);
+      result.Add(Clock::now() - start);
+    }
+    result.Stop();
+    result.Report();
+  }
+
+  void AisDecoderVdmBench() {
+    std::vector<std::string> sentences;
+    for (const auto& sentence : m_sentences) {
+      if (sentence.find("VDM,") != std::string::npos ||
+          sentence.find("VDO,") != std::string::npos) {
+        sentences.push_back(sentence);
+      }
+    }
+    Result result("ais_decoder_vdm", sentences.size());
+    auto decoder = std::make_unique<AisDecoder>(AisDecoderCallbacks());
+    result.Start();
+    for (const auto& sentence : sentences) {
+      auto start = Clock::now();
+      decoder->DecodeVdm(sentence);
+      result.Add(Clock::now() - start);
+    }
+    result.Stop();
+    result.Report();
+  }
+
+  int m_repeat = 1;
+  std::string m_filter;
+  std::vector<std::string> m_sentences;
+  std::vector<can_frame> m_frames;
+  std::vector<N2kMessage> m_n2k_messages;
+};
+
+wxIMPLEMENT_APP_CONSOLE(CommBenchApp);
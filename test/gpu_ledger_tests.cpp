@@ -0,0 +1,96 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/gpu_ledger.h"
+
+using Kind = GpuLedger::Kind;
+
+TEST(GpuLedger, Accounting) {
+  GpuLedger ledger;
+  auto a = ledger.Register("a", Kind::kRasterTexture, 100, nullptr);
+  auto b = ledger.Register("b", Kind::kTileTexture, 50, nullptr);
+  auto c = ledger.Register("a", Kind::kVertexBuffer, 10, nullptr);
+  EXPECT_EQ(ledger.GetUsed(), 160);
+  EXPECT_EQ(ledger.GetUsed(Kind::kTileTexture), 50);
+  EXPECT_EQ(ledger.GetCount(), 3);
+
+  ledger.Resize(a, 200);
+  EXPECT_EQ(ledger.GetUsed(Kind::kRasterTexture), 200);
+
+  auto stats = ledger.GetStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].owner, "a");
+  EXPECT_EQ(stats[0].bytes, 210);
+  EXPECT_EQ(stats[0].resources, 2);
+  EXPECT_EQ(stats[0].bytes_by_kind[static_cast<size_t>(Kind::kVertexBuffer)],
+            10);
+  EXPECT_EQ(stats[1].owner, "b");
+
+  ledger.Release(b);
+  ledger.Release(b);
+  ledger.Release(0);
+  EXPECT_EQ(ledger.GetUsed(), 210);
+  ledger.Release(a);
+  ledger.Release(c);
+  EXPECT_EQ(ledger.GetUsed(), 0);
+  EXPECT_EQ(ledger.GetCount(), 0);
+}
+
+TEST(GpuLedger, EvictLeastRecentlyRendered) {
+  GpuLedger ledger;
+  std::vector<std::string> evicted;
+  auto add = [&](const std::string& name) {
+    return ledger.Register(name, Kind::kRasterTexture, 100,
+                           [&, name] { evicted.push_back(name); });
+  };
+  auto a = add("a");
+  ledger.NextFrame();
+  add("b");
+  ledger.NextFrame();
+  auto c = add("c");
+  ledger.Touch(a);  // a is now the most recently rendered
+  ledger.NextFrame();
+
+  // Nothing to do when within target.
+  EXPECT_EQ(ledger.Enforce(300), 0);
+  EXPECT_TRUE(evicted.empty());
+
+  EXPECT_EQ(ledger.Enforce(150), 200);
+  EXPECT_EQ(evicted, std::vector<std::string>({"b", "c"}));
+  EXPECT_EQ(ledger.GetUsed(), 100);
+
+  // Releasing an evicted resource is harmless.
+  ledger.Release(c);
+  EXPECT_EQ(ledger.GetUsed(), 100);
+}
+
+TEST(GpuLedger, KeepRecentFrames) {
+  GpuLedger ledger;
+  int evictions = 0;
+  auto a = ledger.Register("a", Kind::kTileTexture, 100, [&] { evictions++; });
+  ledger.Register("b", Kind::kTileTexture, 100, [&] { evictions++; });
+
+  // Resources rendered in current frame are never evicted.
+  EXPECT_EQ(ledger.Enforce(0), 0);
+  ledger.NextFrame();
+  ledger.Touch(a);
+  EXPECT_EQ(ledger.Enforce(0, 2), 0);
+  EXPECT_EQ(ledger.Enforce(0), 100);
+  EXPECT_EQ(evictions, 1);
+  ledger.NextFrame();
+  EXPECT_EQ(ledger.Enforce(0), 100);
+  EXPECT_EQ(evictions, 2);
+}
+
+TEST(GpuLedger, EvictorReleases) {
+  // Evictors are invoked without the lock held and may call the ledger.
+  GpuLedger ledger;
+  GpuLedger::Handle handle = 0;
+  handle = ledger.Register("a", Kind::kVertexBuffer, 10,
+                           [&] { ledger.Release(handle); });
+  ledger.NextFrame();
+  EXPECT_EQ(ledger.Enforce(0), 10);
+  EXPECT_EQ(ledger.GetCount(), 0);
+}
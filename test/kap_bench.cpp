@@ -0,0 +1,365 @@
+/*
+ * Decode throughput benchmark for BSB/KAP raster rows.
+ *
+ * Decodes all rows of a KAP file given on the command line, or of a
+ * synthetic chart like raster when there is none, using:
+ *
+ *   - expand_legacy: the previous run by run decoder, as reference.
+ *   - expand_serial, expand_parallel: BsbRowDecoder::ExpandRgb() in one
+ *     thread and in a WorkerPool.
+ *   - scale_rgb_box: downsampling as RENDER_HIDEF used to do it, expanding
+ *     to RGB and box filtering the RGB pixels.
+ *   - scale_fused, scale_fused_parallel: downsampling using color indices
+ *     and BsbRowDecoder::AccumulateBox().
+ *
+ * Prints one JSON object per benchmark on stdout:
+ *
+ *   {"name": "expand_serial", "pixels": 86016000, "seconds": 0.071,
+ *    "mpixels_per_sec": 1211.5, "checksum": 3724517301}
+ *
+ * Benchmarks producing the same image have the same checksum.
+ *
+ * Usage: kap-bench [--repeat n] [--factor f] [chart.kap]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "model/bsb_row_decoder.h"
+#include "model/worker_pool.h"
+
+using Clock = std::chrono::steady_clock;
+
+/** Compressed raster, rows include the line number. */
+struct Raster {
+  int width = 0;
+  int height = 0;
+  int color_bits = 0;
+  std::vector<int> palette;
+  std::vector<std::vector<uint8_t>> rows;
+};
+
+static uint32_t ReadBigEndian(const std::vector<uint8_t>& data, size_t pos) {
+  return data[pos] << 24 | data[pos + 1] << 16 | data[pos + 2] << 8 |
+         data[pos + 3];
+}
+
+/** Load raster from KAP file, using the row index at the end of file. */
+static bool LoadKap(const std::string& path, Raster& raster) {
+  std::ifstream stream(path, std::ios::binary);
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)),
+                            std::istreambuf_iterator<char>());
+  auto eof = std::find(data.begin(), data.end(), 0x1a);
+  if (eof == data.end() || eof + 2 >= data.end() || eof[1] != 0) return false;
+  std::string header(data.begin(), eof);
+
+  // Header lines, continued lines start with a space.
+  raster.palette.assign(128, 0);
+  size_t pos = 0;
+  while ((pos = header.find_first_of("\r\n", pos)) != std::string::npos) {
+    pos = header.find_first_not_of("\r\n", pos);
+    if (pos == std::string::npos) break;
+    int w, h, n, r, g, b;
+    if (header.compare(pos, 4, "BSB/") == 0) {
+      auto ra = header.find("RA=", pos);
+      if (ra != std::string::npos &&
+          sscanf(&header[ra], "RA=%d,%d", &w, &h) == 2) {
+        raster.width = w;
+        raster.height = h;
+      }
+    } else if (sscanf(&header[pos], "RGB/%d,%d,%d,%d", &n, &r, &g, &b) == 4) {
+      if (n > 0 && n < 128) raster.palette[n] = r | g << 8 | b << 16;
+    }
+  }
+  raster.color_bits = eof[2];
+  const size_t size = data.size();
+  if (raster.width <= 0 || raster.height <= 0 || raster.color_bits < 1 ||
+      raster.color_bits > 7 || size < 4) {
+    return false;
+  }
+  size_t index = ReadBigEndian(data, size - 4);
+  if (index + 4 * (raster.height + 1) > size) return false;
+  for (int y = 0; y < raster.height; y++) {
+    size_t begin = ReadBigEndian(data, index + 4 * y);
+    size_t end = ReadBigEndian(data, index + 4 * y + 4);
+    if (y == raster.height - 1) end = index;
+    if (begin > end || end > size) return false;
+    raster.rows.emplace_back(data.begin() + begin, data.begin() + end);
+  }
+  return true;
+}
+
+/** Create chart like raster: long runs, mostly repeated between rows. */
+static void Synthesize(Raster& raster) {
+  raster.width = 12000;
+  raster.height = 8000;
+  raster.color_bits = 4;
+  for (int i = 0; i < 16; i++) {
+    raster.palette.push_back(0x10000 * (i * 37 % 256) + 0x100 * (i * 91 % 256) +
+                             i * 13 % 256);
+  }
+  std::mt19937 rng(2024);
+  std::geometric_distribution<int> run(0.01);
+  std::uniform_int_distribution<int> color(1, 15);
+  std::uniform_int_distribution<int> change(0, 9);
+  std::vector<uint8_t> pixels;
+  for (int y = 0; y < raster.height; y++) {
+    if (y == 0 || change(rng) == 0) {
+      pixels.clear();
+      while (pixels.size() < static_cast<size_t>(raster.width))
+        pixels.insert(pixels.end(), run(rng) + 1, color(rng));
+      pixels.resize(raster.width);
+    }
+    std::vector<uint8_t> row;
+    if (y >= 128) row.push_back(0x80 | (y >> 7 & 0x7f));
+    row.push_back(y & 0x7f);
+    for (int x = 0; x < raster.width;) {
+      int n = 1;
+      while (x + n < raster.width && n < 1024 && pixels[x + n] == pixels[x])
+        n++;
+      // Three bits in first byte and one continuation byte.
+      unsigned count = n - 1;
+      row.push_back(0x80 | pixels[x] << 3 | count >> 7);
+      row.push_back(count & 0x7f);
+      x += n;
+    }
+    row.push_back(0);
+    raster.rows.push_back(std::move(row));
+  }
+}
+
+/** The decoder used before BsbRowDecoder. */
+static void LegacyExpand(const Raster& raster, const std::vector<uint8_t>& row,
+                         unsigned char* prgb) {
+  const int* pPalette = raster.palette.data();
+  const int nColorSize = raster.color_bits;
+  const int xl = raster.width;
+  const unsigned char* lp = row.data();
+  size_t pos = 0;
+  while (pos < row.size() && (lp[pos] & 0x80)) pos++;
+  pos++;
+  lp += pos;
+  int ix = 0;
+  int nValueShift = 7 - nColorSize;
+  unsigned char byValueMask = (((1 << nColorSize)) - 1) << nValueShift;
+  unsigned char byCountMask = (1 << (7 - nColorSize)) - 1;
+  int nPixValue = 0;
+  bool bLastPixValueValid = false;
+  unsigned char byNext;
+  while (ix < xl - 1) {
+    if (pos < row.size()) {
+      byNext = *lp++;
+      pos++;
+    } else {
+      break;
+    }
+    nPixValue = (byNext & byValueMask) >> nValueShift;
+    unsigned int nRunCount;
+    if (byNext == 0)
+      nRunCount = xl - ix;
+    else {
+      nRunCount = byNext & byCountMask;
+      while ((byNext & 0x80) != 0) {
+        if (pos < row.size()) {
+          byNext = *lp++;
+          pos++;
+        } else {
+          nRunCount = xl - ix;
+          break;
+        }
+        nRunCount = nRunCount * 128 + (byNext & 0x7f);
+      }
+      nRunCount++;
+    }
+    if (ix + nRunCount >= (unsigned int)xl) {
+      nRunCount = xl - 1 - ix;
+      bLastPixValueValid = true;
+    }
+    int rgbval = pPalette[nPixValue];
+    int count = nRunCount;
+    if (count < 16) {
+      while (count--) {
+        memcpy(prgb, &rgbval, 4);
+        prgb += 3;
+      }
+    } else if (rgbval == 0 || rgbval == 0xffffff) {
+      memset(prgb, rgbval, nRunCount * 3);
+      prgb += nRunCount * 3;
+    } else {
+      unsigned char* b = prgb;
+      for (int i = 0; i < 8; i++) {
+        memcpy(prgb, &rgbval, 4);
+        prgb += 3;
+      }
+      count -= 8;
+      int count_d8 = count >> 3;
+      for (; count_d8--; prgb += 24) memcpy(prgb, b, 24);
+      int rcount = count & 0x7;
+      while (rcount--) {
+        memcpy(prgb, &rgbval, 4);
+        prgb += 3;
+      }
+    }
+    ix += nRunCount;
+  }
+  if (ix < xl) {
+    if (!bLastPixValueValid) {
+      byNext = pos < row.size() ? *lp : 0;
+      nPixValue = (byNext & byValueMask) >> nValueShift;
+    }
+    int rgbval = pPalette[nPixValue];
+    prgb[0] = rgbval & 0xff;
+    prgb[1] = (rgbval >> 8) & 0xff;
+    prgb[2] = (rgbval >> 16) & 0xff;
+  }
+}
+
+static uint32_t Checksum(const uint8_t* data, size_t size) {
+  uint32_t sum = 2166136261u;
+  for (size_t i = 0; i < size; i++) sum = (sum ^ data[i]) * 16777619u;
+  return sum;
+}
+
+static void Report(const char* name, uint64_t pixels, double seconds,
+                   uint32_t checksum) {
+  std::printf(
+      "{\"name\": \"%s\", \"pixels\": %llu, \"seconds\": %.6f, "
+      "\"mpixels_per_sec\": %.1f, \"checksum\": %u}\n",
+      name, static_cast<unsigned long long>(pixels), seconds,
+      seconds > 0 ? pixels / seconds / 1e6 : 0, checksum);
+  std::fflush(stdout);
+}
+
+/** Run func repeat times, report best time and checksum of output. */
+static void Run(const char* name, int repeat, uint64_t pixels,
+                const std::function<void()>& func,
+                const std::vector<uint8_t>& output, size_t size) {
+  double best = 1e9;
+  for (int i = 0; i < repeat; i++) {
+    auto start = Clock::now();
+    func();
+    best = std::min(
+        best, std::chrono::duration<double>(Clock::now() - start).count());
+  }
+  Report(name, pixels, best, Checksum(output.data(), size));
+}
+
+int main(int argc, char** argv) {
+  int repeat = 3;
+  int factor = 4;
+  std::string path;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--factor") == 0 && i + 1 < argc) {
+      factor = std::max(2, std::atoi(argv[++i]));
+    } else {
+      path = argv[i];
+    }
+  }
+  Raster raster;
+  if (!path.empty() && !LoadKap(path, raster)) {
+    std::fprintf(stderr, "Cannot load KAP file %s\n", path.c_str());
+    return 1;
+  }
+  if (path.empty()) Synthesize(raster);
+
+  const int width = raster.width;
+  const int height = raster.height;
+  const size_t line = 3 * width;
+  const uint64_t pixels = uint64_t(width) * height;
+  BsbRowDecoder decoder(raster.color_bits, raster.palette.data(),
+                        raster.palette.size());
+  std::vector<size_t> starts;
+  for (const auto& row : raster.rows)
+    starts.push_back(decoder.SkipLineNumber(row.data(), row.size()));
+  WorkerPool pool;
+
+  // Legacy decoder writes four bytes per pixel, keep some slack.
+  std::vector<uint8_t> image(line * height + 4);
+  auto expand = [&](size_t begin, size_t end) {
+    for (size_t y = begin; y < end; y++) {
+      const auto& row = raster.rows[y];
+      decoder.ExpandRgb(row.data(), row.size(), starts[y], 0, 0, width,
+                        &image[y * line]);
+    }
+  };
+  Run("expand_legacy", repeat, pixels, [&] {
+    for (int y = 0; y < height; y++)
+      LegacyExpand(raster, raster.rows[y], &image[y * line]);
+  }, image, line * height);
+  Run("expand_serial", repeat, pixels, [&] {
+    expand(0, height);
+  }, image, line * height);
+  Run("expand_parallel", repeat, pixels, [&] {
+    pool.ParallelFor(height, expand);
+  }, image, line * height);
+
+  // Downsample by factor using factor x factor boxes.
+  const int targets = width / factor;
+  const int target_rows = height / factor;
+  std::vector<uint8_t> scaled(3 * targets * target_rows);
+  Run("scale_rgb_box", repeat, pixels, [&] {
+    std::vector<uint8_t> rgb(line * factor + 4);
+    for (int ty = 0; ty < target_rows; ty++) {
+      for (int k = 0; k < factor; k++) {
+        const auto& row = raster.rows[ty * factor + k];
+        decoder.ExpandRgb(row.data(), row.size(), starts[ty * factor + k], 0,
+                          0, width, &rgb[k * line]);
+      }
+      uint8_t* target = &scaled[3 * targets * ty];
+      for (int x = 0; x < targets; x++, target += 3) {
+        unsigned r = 0, g = 0, b = 0;
+        for (int k = 0; k < factor; k++) {
+          const uint8_t* p = &rgb[k * line + 3 * x * factor];
+          for (int i = 0; i < factor; i++, p += 3) {
+            r += p[0];
+            g += p[1];
+            b += p[2];
+          }
+        }
+        target[0] = r / (factor * factor);
+        target[1] = g / (factor * factor);
+        target[2] = b / (factor * factor);
+      }
+    }
+  }, scaled, scaled.size());
+  auto fused = [&](size_t begin, size_t end) {
+    std::vector<uint8_t> indices(width);
+    std::vector<uint32_t> sums(4 * targets);
+    for (size_t ty = begin; ty < end; ty++) {
+      std::fill(sums.begin(), sums.end(), 0);
+      for (int k = 0; k < factor; k++) {
+        size_t y = ty * factor + k;
+        const auto& row = raster.rows[y];
+        decoder.ExpandIndices(row.data(), row.size(), starts[y], 0, 0, width,
+                              indices.data());
+        decoder.AccumulateBox(indices.data(), width, factor, factor, targets,
+                              sums.data());
+      }
+      uint8_t* target = &scaled[3 * targets * ty];
+      for (int x = 0; x < targets; x++, target += 3) {
+        const uint32_t* sum = &sums[4 * x];
+        target[0] = sum[0] / sum[3];
+        target[1] = sum[1] / sum[3];
+        target[2] = sum[2] / sum[3];
+      }
+    }
+  };
+  Run("scale_fused", repeat, pixels, [&] {
+    fused(0, target_rows);
+  }, scaled, scaled.size());
+  Run("scale_fused_parallel", repeat, pixels, [&] {
+    pool.ParallelFor(target_rows, fused);
+  }, scaled, scaled.size());
+  return 0;
+}
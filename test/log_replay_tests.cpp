@@ -0,0 +1,252 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/comm_drv_file.h"
+#include "model/log_replay.h"
+
+using Clock = ReplayPacer::Clock;
+
+static double Seconds(Clock::duration d) {
+  return std::chrono::duration<double>(d).count();
+}
+
+TEST(LogReplay, ParseLogTime) {
+  double ts = 0;
+  EXPECT_TRUE(ParseLogTime("(1659169701.507935) can0 09FD0200#FF81", ts));
+  EXPECT_NEAR(ts, 1659169701.507935, 1e-6);
+  EXPECT_TRUE(ParseLogTime("\\s:r003669,c:1241544035*4A\\!AIVDM,1,1", ts));
+  EXPECT_EQ(ts, 1241544035);
+  EXPECT_TRUE(ParseLogTime("\\c:1241544035500*4A\\!AIVDM,1,1", ts));
+  EXPECT_NEAR(ts, 1241544035.5, 1e-6);
+  EXPECT_FALSE(ParseLogTime("$GPGLL,5013.4693,N,00346.6503,W,035258,A", ts));
+  EXPECT_FALSE(ParseLogTime("\\s:r003669*4A\\!AIVDM,1,1", ts));
+  EXPECT_FALSE(ParseLogTime("(can0) 09FD0200#FF81", ts));
+}
+
+TEST(LogReplay, ParseCandumpLine) {
+  std::string iface;
+  uint32_t id = 0;
+  std::vector<unsigned char> data;
+  ASSERT_TRUE(ParseCandumpLine("(1659169701.507935) can0 09FD0200#FF8101B8",
+                               iface, id, data));
+  EXPECT_EQ(iface, "can0");
+  EXPECT_EQ(id, 0x09FD0200u);
+  EXPECT_EQ(data, std::vector<unsigned char>({0xFF, 0x81, 0x01, 0xB8}));
+  EXPECT_TRUE(ParseCandumpLine("(1.0) vcan0 123#", iface, id, data));
+  EXPECT_TRUE(data.empty());
+  EXPECT_FALSE(ParseCandumpLine("(1.0) can0 123##0112233", iface, id, data));
+  EXPECT_FALSE(ParseCandumpLine("(1.0) can0 123#R", iface, id, data));
+  EXPECT_FALSE(ParseCandumpLine("(1.0) can0 123#001122334455667788", iface,
+                                id, data));
+  EXPECT_FALSE(ParseCandumpLine("can0 123#0011", iface, id, data));
+}
+
+TEST(LogReplay, Testdata) {
+  std::string path(TESTDATA);
+  std::ifstream f(path + "/candump-2022-07-30_102821-head.log");
+  std::string line;
+  std::string iface;
+  uint32_t id;
+  std::vector<unsigned char> data;
+  int lines = 0;
+  int frames = 0;
+  double last = 0;
+  bool monotonic = true;
+  while (std::getline(f, line)) {
+    lines += 1;
+    double ts;
+    if (ParseLogTime(line, ts)) {
+      monotonic = monotonic && ts >= last;
+      last = ts;
+    }
+    if (ParseCandumpLine(line, iface, id, data) && data.size() == 8) frames++;
+  }
+  EXPECT_GT(lines, 0);
+  EXPECT_EQ(frames, lines);
+  EXPECT_TRUE(monotonic);
+}
+
+TEST(LogReplay, Pacing) {
+  auto now = Clock::now();
+  ReplayPacer pacer(10);
+  EXPECT_EQ(pacer.Due(1000.0, now), now);
+  EXPECT_NEAR(Seconds(pacer.Due(1001.0, now) - now), 0.1, 1e-6);
+  EXPECT_NEAR(Seconds(pacer.Due(1005.0, now) - now), 0.5, 1e-6);
+
+  // Going backwards or a large gap restarts the pacing.
+  auto later = now + std::chrono::seconds(1);
+  EXPECT_EQ(pacer.Due(900.0, later), later);
+  EXPECT_NEAR(Seconds(pacer.Due(901.0, later) - later), 0.1, 1e-6);
+  EXPECT_EQ(pacer.Due(2000.0, later), later);
+
+  // A speed change restarts from next line.
+  pacer.SetSpeed(1);
+  EXPECT_EQ(pacer.Due(2001.0, now), now);
+  EXPECT_NEAR(Seconds(pacer.Due(2002.0, now) - now), 1.0, 1e-6);
+
+  pacer.SetSpeed(0);
+  EXPECT_EQ(pacer.Due(3000.0, now), now);
+  pacer.SetSpeed(1000);
+  EXPECT_EQ(pacer.GetSpeed(), ReplayPacer::kMaxSpeed);
+}
+
+/** Records the wall clock time each message is received. */
+class ReplayListener : public DriverListener {
+public:
+  void Notify(std::shared_ptr<const NavMsg> message) override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_times.push_back(Clock::now());
+    m_cv.notify_all();
+  }
+
+  void Notify(const AbstractCommDriver& driver) override {}
+
+  /** Wait until count messages are received, return false on timeout. */
+  bool WaitFor(size_t count, double timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto due = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double>(timeout));
+    return m_cv.wait_until(lock, due, [&] { return m_times.size() >= count; });
+  }
+
+  std::vector<Clock::time_point> GetTimes() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_times;
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::vector<Clock::time_point> m_times;
+};
+
+/**
+ * Write a log of count tag block sentences recorded one second apart to a
+ * temporary file, return its path.
+ */
+static std::string MakeLog(const std::string& name, int count) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream f(path);
+  for (int i = 0; i < count; i++) {
+    f << "\\c:" << 1700000000 + i
+      << "*00\\$GPGLL,5013.4693,N,00346.6503,W,035258,A\r\n";
+  }
+  return path.string();
+}
+
+/** Wait until replay is done, return false on timeout. */
+static bool WaitDone(const FileCommDriver& driver, double timeout) {
+  auto due = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(timeout));
+  while (driver.IsReplaying()) {
+    if (Clock::now() > due) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+TEST(FileReplay, Pacing) {
+  auto path = MakeLog("file_replay_pacing.log", 11);
+  ReplayListener listener;
+  FileCommDriver driver("", path, listener, 10);
+  ASSERT_TRUE(WaitDone(driver, 10));
+
+  // Lines are due 0.1 s apart, never early.
+  auto times = listener.GetTimes();
+  ASSERT_EQ(times.size(), 11);
+  for (size_t i = 1; i < times.size(); i++)
+    EXPECT_GE(Seconds(times[i] - times[0]), 0.1 * i - 0.01);
+  EXPECT_LT(Seconds(times.back() - times[0]), 5.0);
+  ReplayStats stats = driver.GetReplayStats();
+  EXPECT_EQ(stats.lines, 11);
+  EXPECT_EQ(stats.messages, 11);
+  EXPECT_GE(stats.seconds, 0.99);
+  std::remove(path.c_str());
+}
+
+TEST(FileReplay, SpeedChange) {
+  // Six seconds of log, played at real time until the first message.
+  auto path = MakeLog("file_replay_speed.log", 7);
+  ReplayListener listener;
+  FileCommDriver driver("", path, listener, 1);
+  ASSERT_TRUE(listener.WaitFor(1, 5));
+  auto start = Clock::now();
+  driver.SetSpeed(100);
+
+  // At most the line already waited for is played at the old speed, the
+  // others pacing restarts from at the new one.
+  ASSERT_TRUE(WaitDone(driver, 4));
+  EXPECT_EQ(listener.GetTimes().size(), 7);
+  EXPECT_LT(Seconds(Clock::now() - start), 2.5);
+  std::remove(path.c_str());
+}
+
+TEST(FileReplay, StopMidReplay) {
+  auto path = MakeLog("file_replay_stop.log", 100);
+  ReplayListener listener;
+  FileCommDriver driver("", path, listener, 1);
+  ASSERT_TRUE(listener.WaitFor(1, 5));
+  EXPECT_TRUE(driver.IsReplaying());
+
+  // Stop() interrupts the wait for the next line.
+  auto start = Clock::now();
+  driver.Stop();
+  EXPECT_LT(Seconds(Clock::now() - start), 0.9);
+  EXPECT_FALSE(driver.IsReplaying());
+  size_t received = listener.GetTimes().size();
+  EXPECT_LT(received, 100);
+  EXPECT_EQ(driver.GetReplayStats().messages, received);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(listener.GetTimes().size(), received);
+  std::remove(path.c_str());
+}
+
+/** Return contents of file at path, empty if missing. */
+static std::string ReadFile(const std::string& path) {
+  std::ifstream f(path);
+  std::stringstream ss;
+  ss << f.rdbuf();
+  return ss.str();
+}
+
+TEST(FileReplay, BufferedOutput) {
+  auto path =
+      (std::filesystem::temp_directory_path() / "file_replay_output.txt")
+          .string();
+  std::remove(path.c_str());
+  auto driver = std::make_unique<FileCommDriver>(path);
+  auto msg = std::make_shared<const Nmea0183Msg>(
+      "GPGLL", "$GPGLL,5013.4693,N,00346.6503,W,035258,A",
+      driver->GetAddress());
+  const std::string line = msg->to_string();
+
+  driver->SetBuffered(true);
+  ASSERT_TRUE(driver->SendMessage(msg, driver->GetAddress()));
+  ASSERT_TRUE(driver->SendMessage(msg, driver->GetAddress()));
+  EXPECT_EQ(ReadFile(path), "");
+  driver->Flush();
+  EXPECT_EQ(ReadFile(path), line + line);
+
+  // Unbuffered messages are written at once.
+  driver->SetBuffered(false);
+  ASSERT_TRUE(driver->SendMessage(msg, driver->GetAddress()));
+  EXPECT_EQ(ReadFile(path), line + line + line);
+
+  // Destroying the driver flushes buffered output.
+  driver->SetBuffered(true);
+  ASSERT_TRUE(driver->SendMessage(msg, driver->GetAddress()));
+  driver.reset();
+  EXPECT_EQ(ReadFile(path), line + line + line + line);
+  std::remove(path.c_str());
+}
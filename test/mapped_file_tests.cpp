@@ -0,0 +1,63 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "model/mapped_file.h"
+
+namespace fs = std::filesystem;
+
+static void WriteFile(const fs::path& path, const std::string& contents) {
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  stream << contents;
+}
+
+TEST(MappedFile, Basic) {
+  auto path = fs::path(CMAKE_BINARY_DIR) / "mapped_file.bin";
+  WriteFile(path, "0123456789");
+
+  MappedFile file(path.string());
+  ASSERT_TRUE(file.IsOpen());
+  EXPECT_EQ(file.Size(), 10);
+  EXPECT_EQ(std::memcmp(file.Data(), "0123456789", 10), 0);
+  EXPECT_TRUE(file.Contains(0, 10));
+  EXPECT_TRUE(file.Contains(10, 0));
+  EXPECT_FALSE(file.Contains(5, 6));
+  EXPECT_FALSE(file.Contains(11, 0));
+  file.Advise(MappedFile::Access::kRandom);
+
+  file.Close();
+  EXPECT_FALSE(file.IsOpen());
+  EXPECT_EQ(file.Size(), 0);
+
+  auto missing = fs::path(CMAKE_BINARY_DIR) / "no-such-file";
+  EXPECT_FALSE(file.Open(missing.string()));
+  WriteFile(path, "");
+  EXPECT_FALSE(file.Open(path.string()));
+  fs::remove(path);
+}
+
+#ifndef _WIN32
+TEST(MappedFile, ReplaceWhileMapped) {
+  // Replacing the file by rename must not affect an existing mapping.
+  auto path = fs::path(CMAKE_BINARY_DIR) / "mapped_file.bin";
+  auto tmp_path = fs::path(CMAKE_BINARY_DIR) / "mapped_file.bin.tmp";
+  WriteFile(path, "old contents");
+  MappedFile file(path.string());
+  ASSERT_TRUE(file.IsOpen());
+
+  WriteFile(tmp_path, "new");
+  fs::rename(tmp_path, path);
+  EXPECT_EQ(std::string(reinterpret_cast<const char*>(file.Data()),
+                        file.Size()),
+            "old contents");
+
+  MappedFile new_file(path.string());
+  ASSERT_TRUE(new_file.IsOpen());
+  EXPECT_EQ(new_file.Size(), 3);
+  fs::remove(path);
+}
+#endif
@@ -3,6 +3,7 @@
 #endif
 
 #include <stdio.h>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -219,6 +220,8 @@ class N2kRunLog : public wxAppConsole {
     FILE* f = RunRecordedBuffer();
     int i = pclose(f);
     EXPECT_TRUE(i == 0) << "Error running the canplayer command\n";
+    // Positions are delivered once per tick.
+    std::this_thread::sleep_for(4 * NavMsgBus::kDefaultTick);
     ProcessPendingEvents();
     driver->Close();
     return 0;
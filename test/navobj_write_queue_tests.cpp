@@ -0,0 +1,123 @@
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+#include "model/navobj_write_queue.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+static const char* const kInsertPoint =
+    "INSERT INTO trk_points (track_guid, latitude, longitude, point_order) "
+    "VALUES (?, ?, ?, ?)";
+
+static sqlite3* CreateDb(const fs::path& path) {
+  fs::remove(path);
+  sqlite3* db = nullptr;
+  sqlite3_open_v2(path.string().c_str(), &db,
+                  SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+  sqlite3_exec(db, R"(
+      PRAGMA journal_mode = WAL;
+      PRAGMA foreign_keys = ON;
+      CREATE TABLE tracks (guid TEXT PRIMARY KEY NOT NULL);
+      CREATE TABLE trk_points (
+          track_guid TEXT NOT NULL,
+          latitude REAL NOT NULL,
+          longitude REAL NOT NULL,
+          point_order INTEGER,
+          FOREIGN KEY (track_guid) REFERENCES tracks(guid) ON DELETE CASCADE);
+      CREATE TABLE routepoints (guid TEXT PRIMARY KEY NOT NULL, name TEXT);
+      INSERT INTO tracks (guid) VALUES ('t1');
+      INSERT INTO routepoints (guid) VALUES ('p1');
+      )",
+               nullptr, nullptr, nullptr);
+  return db;
+}
+
+static int Count(sqlite3* db, const char* sql) {
+  sqlite3_stmt* stmt;
+  int count = -1;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return -1;
+  if (sqlite3_step(stmt) == SQLITE_ROW) count = sqlite3_column_int(stmt, 0);
+  sqlite3_finalize(stmt);
+  return count;
+}
+
+static std::vector<SqlStatement> Point(const char* track, int i) {
+  return {{kInsertPoint, {track, 57.0 + i * 1e-4, 11.0, i}}};
+}
+
+TEST(NavObjWriteQueue, Batching) {
+  auto path = fs::path(CMAKE_BINARY_DIR) / "write_queue.db";
+  sqlite3* db = CreateDb(path);
+  {
+    NavObjWriteQueue queue(path.string(), 10s);
+    ASSERT_TRUE(queue.IsOpen());
+    for (int i = 0; i < 3000; i++) queue.Push(Point("t1", i));
+    queue.Flush();
+    EXPECT_EQ(Count(db, "SELECT COUNT(*) FROM trk_points"), 3000);
+    EXPECT_EQ(Count(db, "SELECT MAX(point_order) FROM trk_points"), 2999);
+    auto stats = queue.GetStats();
+    EXPECT_EQ(stats.queued, 3000);
+    EXPECT_EQ(stats.statements, 3000);
+    EXPECT_EQ(stats.pending, 0);
+    EXPECT_EQ(stats.errors, 0);
+    // Full batches are committed without waiting for the interval.
+    EXPECT_GE(stats.batches, 1);
+    EXPECT_LT(stats.batches, 100);
+
+    // Statements violating constraints fail alone.
+    queue.Push(Point("t1", 3000));
+    queue.Push(Point("no such track", 0));
+    queue.Push(Point("t1", 3001));
+    queue.Flush();
+    EXPECT_EQ(queue.GetStats().errors, 1);
+    EXPECT_EQ(Count(db, "SELECT COUNT(*) FROM trk_points"), 3002);
+
+    // Pending points are committed when the queue is destroyed.
+    for (int i = 0; i < 10; i++) queue.Push(Point("t1", 3002 + i));
+  }
+  EXPECT_EQ(Count(db, "SELECT COUNT(*) FROM trk_points"), 3012);
+  sqlite3_close_v2(db);
+  fs::remove(path);
+}
+
+TEST(NavObjWriteQueue, Interval) {
+  auto path = fs::path(CMAKE_BINARY_DIR) / "write_queue_interval.db";
+  sqlite3* db = CreateDb(path);
+  NavObjWriteQueue queue(path.string(), 50ms);
+  queue.Push(Point("t1", 0));
+  queue.Push(Point("t1", 1));
+  auto start = std::chrono::steady_clock::now();
+  while (Count(db, "SELECT COUNT(*) FROM trk_points") < 2 &&
+         std::chrono::steady_clock::now() - start < 5s) {
+    std::this_thread::sleep_for(5ms);
+  }
+  EXPECT_EQ(Count(db, "SELECT COUNT(*) FROM trk_points"), 2);
+  EXPECT_EQ(queue.GetStats().batches, 1);
+  sqlite3_close_v2(db);
+}
+
+TEST(NavObjWriteQueue, Coalesce) {
+  auto path = fs::path(CMAKE_BINARY_DIR) / "write_queue_coalesce.db";
+  sqlite3* db = CreateDb(path);
+  NavObjWriteQueue queue(path.string(), 10s);
+  const char* sql = "UPDATE routepoints SET name = ? WHERE guid = ?";
+  for (int i = 0; i < 100; i++) {
+    queue.Push({{sql, {"name" + std::to_string(i), "p1"}}}, "p1");
+  }
+  queue.Push(Point("t1", 0));
+  queue.Flush();
+  auto stats = queue.GetStats();
+  EXPECT_EQ(stats.queued, 101);
+  EXPECT_EQ(stats.coalesced, 99);
+  EXPECT_EQ(stats.statements, 2);
+  EXPECT_EQ(Count(db, "SELECT COUNT(*) FROM routepoints WHERE name = 'name99'"),
+            1);
+  sqlite3_close_v2(db);
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/packed_rtree.h"
+
+using Box = PackedRTree::Box;
+
+static std::vector<uint32_t> LinearSearch(const std::vector<Box>& boxes,
+                                          const Box& query) {
+  std::vector<uint32_t> result;
+  for (uint32_t i = 0; i < boxes.size(); i++) {
+    if (boxes[i].Intersects(query)) result.push_back(i);
+  }
+  return result;
+}
+
+static std::vector<uint32_t> TreeSearch(const PackedRTree& tree,
+                                        const Box& query) {
+  std::vector<uint32_t> result;
+  tree.Search(query, result);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+/**
+ * Object boxes resembling a dense harbour cell of about 0.2 x 0.2 degrees:
+ * many point sized boxes, elongated line boxes and some large areas.
+ */
+static std::vector<Box> MakeCell(size_t points, size_t lines, size_t areas) {
+  std::mt19937 gen(4711);
+  std::uniform_real_distribution<float> lat(59.6f, 59.8f);
+  std::uniform_real_distribution<float> lon(10.5f, 10.7f);
+  std::uniform_real_distribution<float> small(0.0f, 0.0005f);
+  std::uniform_real_distribution<float> medium(0.0f, 0.01f);
+  std::uniform_real_distribution<float> large(0.0f, 0.1f);
+  std::vector<Box> boxes;
+  auto add = [&](std::uniform_real_distribution<float>& w,
+                 std::uniform_real_distribution<float>& h) {
+    float x = lon(gen);
+    float y = lat(gen);
+    boxes.push_back({x, y, x + w(gen), y + h(gen)});
+  };
+  for (size_t i = 0; i < points; i++) add(small, small);
+  for (size_t i = 0; i < lines; i++) add(medium, small);
+  for (size_t i = 0; i < areas; i++) add(large, large);
+  return boxes;
+}
+
+TEST(PackedRTree, Empty) {
+  PackedRTree tree;
+  std::vector<uint32_t> result;
+  tree.Search({0, 0, 1, 1}, result);
+  EXPECT_TRUE(result.empty());
+  tree.Build({});
+  tree.Search({0, 0, 1, 1}, result);
+  EXPECT_TRUE(result.empty());
+  EXPECT_EQ(tree.Size(), 0);
+}
+
+TEST(PackedRTree, Basic) {
+  std::vector<Box> boxes = {{0, 0, 1, 1}, {2, 2, 3, 3}, {0.5, 0.5, 2.5, 2.5}};
+  PackedRTree tree;
+  tree.Build(boxes);
+  EXPECT_EQ(tree.Size(), 3);
+  EXPECT_EQ(TreeSearch(tree, {0.1f, 0.1f, 0.1f, 0.1f}),
+            std::vector<uint32_t>({0}));
+  EXPECT_EQ(TreeSearch(tree, {1, 1, 2, 2}),
+            std::vector<uint32_t>({0, 1, 2}));
+  EXPECT_EQ(TreeSearch(tree, {4, 4, 5, 5}), std::vector<uint32_t>());
+  tree.Clear();
+  EXPECT_EQ(TreeSearch(tree, {1, 1, 2, 2}), std::vector<uint32_t>());
+}
+
+TEST(PackedRTree, MatchesLinearSearch) {
+  auto boxes = MakeCell(3000, 800, 200);
+  PackedRTree tree;
+  tree.Build(boxes);
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> lat(59.55f, 59.85f);
+  std::uniform_real_distribution<float> lon(10.45f, 10.75f);
+  for (int i = 0; i < 500; i++) {
+    float x = lon(gen);
+    float y = lat(gen);
+    float r = i % 2 ? 0.001f : 0.02f;
+    Box query = {x - r, y - r, x + r, y + r};
+    EXPECT_EQ(TreeSearch(tree, query), LinearSearch(boxes, query));
+  }
+}
+
+TEST(PackedRTree, SaveLoad) {
+  auto boxes = MakeCell(3000, 800, 200);
+  PackedRTree tree;
+  tree.Build(boxes);
+  std::vector<uint8_t> data;
+  tree.Save(data);
+
+  PackedRTree loaded;
+  ASSERT_TRUE(loaded.Load(data.data(), data.size()));
+  EXPECT_EQ(loaded.Size(), tree.Size());
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> lat(59.55f, 59.85f);
+  std::uniform_real_distribution<float> lon(10.45f, 10.75f);
+  for (int i = 0; i < 200; i++) {
+    float x = lon(gen);
+    float y = lat(gen);
+    Box query = {x - 0.01f, y - 0.01f, x + 0.01f, y + 0.01f};
+    EXPECT_EQ(TreeSearch(loaded, query), TreeSearch(tree, query));
+  }
+
+  PackedRTree empty;
+  std::vector<uint8_t> empty_data;
+  empty.Save(empty_data);
+  EXPECT_TRUE(loaded.Load(empty_data.data(), empty_data.size()));
+  EXPECT_EQ(loaded.Size(), 0);
+}
+
+TEST(PackedRTree, LoadRejectsBadData) {
+  PackedRTree tree;
+  tree.Build(MakeCell(500, 0, 0));
+  std::vector<uint8_t> data;
+  tree.Save(data);
+
+  PackedRTree loaded;
+  EXPECT_FALSE(loaded.Load(data.data(), data.size() - 1));
+  EXPECT_FALSE(loaded.Load(data.data(), 8));
+  // The last stored reference belongs to the root, make it a cycle.
+  std::vector<uint8_t> cyclic = data;
+  uint32_t root;
+  memcpy(&root, cyclic.data() + 3 * sizeof(uint32_t), sizeof(root));
+  memcpy(cyclic.data() + cyclic.size() - sizeof(root), &root, sizeof(root));
+  EXPECT_FALSE(loaded.Load(cyclic.data(), cyclic.size()));
+  EXPECT_EQ(loaded.Size(), 0);
+  EXPECT_TRUE(loaded.Load(data.data(), data.size()));
+}
+
+TEST(PackedRTree, Nearest) {
+  auto boxes = MakeCell(2000, 0, 0);
+  PackedRTree tree;
+  tree.Build(boxes);
+  const float x = 10.6f;
+  const float y = 59.7f;
+  auto distance = [&](const Box& b) {
+    double dx = std::max({b.x_min - x, 0.0f, x - b.x_max});
+    double dy = std::max({b.y_min - y, 0.0f, y - b.y_max});
+    return dx * dx + dy * dy;
+  };
+  std::vector<uint32_t> result;
+  tree.Nearest(10, distance, result);
+  ASSERT_EQ(result.size(), 10);
+
+  std::vector<uint32_t> expected(boxes.size());
+  for (uint32_t i = 0; i < expected.size(); i++) expected[i] = i;
+  std::stable_sort(expected.begin(), expected.end(),
+                   [&](uint32_t a, uint32_t b) {
+                     return distance(boxes[a]) < distance(boxes[b]);
+                   });
+  for (size_t i = 0; i < result.size(); i++) {
+    EXPECT_EQ(distance(boxes[result[i]]), distance(boxes[expected[i]]));
+  }
+
+  result.clear();
+  tree.Nearest(5000, distance, result);
+  EXPECT_EQ(result.size(), boxes.size());
+}
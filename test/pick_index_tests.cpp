@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/pick_index.h"
+
+using Box = PickIndex::Box;
+
+/**
+ * Pick entries as built by s57chart::BuildPickIndex(), in razRules order:
+ * for each priority the area rules of both boundary lists, then the line
+ * rules. Objects are numbered by their box, area objects having an entry
+ * in each boundary list.
+ */
+struct PickCell {
+  std::vector<Box> objects;          ///< Object boxes
+  std::vector<uint32_t> entry_objs;  ///< Object of each entry
+  std::vector<bool> unindexed;       ///< Object not indexable, e.g. IDL
+};
+
+/**
+ * Line and area boxes resembling a dense harbour cell of about 0.2 x 0.2
+ * degrees, spread over the display priorities.
+ */
+static PickCell MakeCell(size_t lines, size_t areas) {
+  const int kPriorities = 10;
+  std::mt19937 gen(4711);
+  std::uniform_real_distribution<float> lat(59.6f, 59.8f);
+  std::uniform_real_distribution<float> lon(10.5f, 10.7f);
+  std::uniform_real_distribution<float> small(0.0f, 0.0005f);
+  std::uniform_real_distribution<float> medium(0.0f, 0.01f);
+  std::uniform_real_distribution<float> large(0.0f, 0.1f);
+  std::uniform_int_distribution<int> prio(0, kPriorities - 1);
+
+  PickCell cell;
+  std::vector<std::vector<uint32_t>> area_prio(kPriorities);
+  std::vector<std::vector<uint32_t>> line_prio(kPriorities);
+  auto add = [&](std::uniform_real_distribution<float>& w,
+                 std::uniform_real_distribution<float>& h,
+                 std::vector<std::vector<uint32_t>>& by_prio) {
+    float x = lon(gen);
+    float y = lat(gen);
+    by_prio[prio(gen)].push_back(cell.objects.size());
+    cell.objects.push_back({x, y, x + w(gen), y + h(gen)});
+    cell.unindexed.push_back(cell.objects.size() % 500 == 0);
+  };
+  for (size_t i = 0; i < lines; i++) add(medium, small, line_prio);
+  for (size_t i = 0; i < areas; i++) add(large, large, area_prio);
+
+  for (int i = 0; i < kPriorities; i++) {
+    for (int list = 0; list < 2; list++) {
+      cell.entry_objs.insert(cell.entry_objs.end(), area_prio[i].begin(),
+                             area_prio[i].end());
+    }
+    cell.entry_objs.insert(cell.entry_objs.end(), line_prio[i].begin(),
+                           line_prio[i].end());
+  }
+  return cell;
+}
+
+/** Index entries by their own boxes, as without a SENC spatial index. */
+static void AddBoxes(const PickCell& cell, PickIndex& index) {
+  for (uint32_t obj : cell.entry_objs) {
+    if (cell.unindexed[obj])
+      index.AddUnindexed();
+    else
+      index.AddBox(cell.objects[obj]);
+  }
+  index.Finish();
+}
+
+/** Index entries using a tree over all objects, as stored in a SENC. */
+static void AddToItems(const PickCell& cell, PickIndex& index) {
+  std::vector<Box> boxes;
+  std::vector<uint32_t> items(cell.objects.size(), UINT32_MAX);
+  for (uint32_t obj = 0; obj < cell.objects.size(); obj++) {
+    if (cell.unindexed[obj]) continue;
+    items[obj] = boxes.size();
+    boxes.push_back(cell.objects[obj]);
+  }
+  PackedRTree tree;
+  tree.Build(boxes);
+  index.SetTree(std::move(tree));
+  for (uint32_t obj : cell.entry_objs) {
+    if (items[obj] == UINT32_MAX)
+      index.AddUnindexed();
+    else
+      index.AddToItem(items[obj]);
+  }
+  index.Finish();
+}
+
+/**
+ * Entries tested by a linear walk over all entries, as done before the
+ * index, after dropping those whose box does not intersect query.
+ */
+static std::vector<uint32_t> LinearPick(const PickCell& cell,
+                                        const Box& query) {
+  std::vector<uint32_t> result;
+  for (uint32_t i = 0; i < cell.entry_objs.size(); i++) {
+    if (cell.objects[cell.entry_objs[i]].Intersects(query))
+      result.push_back(i);
+  }
+  return result;
+}
+
+/** Drop the candidates whose box does not intersect query. */
+static std::vector<uint32_t> Filter(const PickCell& cell, const Box& query,
+                                    std::vector<uint32_t> candidates) {
+  auto miss = [&](uint32_t i) {
+    return !cell.objects[cell.entry_objs[i]].Intersects(query);
+  };
+  candidates.erase(std::remove_if(candidates.begin(), candidates.end(), miss),
+                   candidates.end());
+  return candidates;
+}
+
+static std::vector<Box> MakeQueries(size_t count, float radius) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> lat(59.55f, 59.85f);
+  std::uniform_real_distribution<float> lon(10.45f, 10.75f);
+  std::vector<Box> queries;
+  for (size_t i = 0; i < count; i++) {
+    float x = lon(gen);
+    float y = lat(gen);
+    queries.push_back({x - radius, y - radius, x + radius, y + radius});
+  }
+  return queries;
+}
+
+TEST(PickIndex, Empty) {
+  PickIndex index;
+  EXPECT_TRUE(index.Search({0, 0, 1, 1}).empty());
+  index.Finish();
+  EXPECT_TRUE(index.Search({0, 0, 1, 1}).empty());
+  index.AddUnindexed();
+  index.Finish();
+  EXPECT_EQ(index.Search({0, 0, 1, 1}), std::vector<uint32_t>({0}));
+  EXPECT_EQ(index.Size(), 1);
+}
+
+TEST(PickIndex, MatchesLinearPick) {
+  auto cell = MakeCell(800, 200);
+  PickIndex built;
+  AddBoxes(cell, built);
+  PickIndex stored;
+  AddToItems(cell, stored);
+  EXPECT_FALSE(built.HasTree());
+  EXPECT_TRUE(stored.HasTree());
+  ASSERT_EQ(built.Size(), cell.entry_objs.size());
+  ASSERT_EQ(stored.Size(), cell.entry_objs.size());
+
+  for (float radius : {0.001f, 0.02f}) {
+    for (const auto& query : MakeQueries(250, radius)) {
+      auto expected = LinearPick(cell, query);
+      auto candidates = built.Search(query);
+      EXPECT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+      EXPECT_EQ(Filter(cell, query, candidates), expected);
+      candidates = stored.Search(query);
+      EXPECT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+      EXPECT_EQ(Filter(cell, query, candidates), expected);
+    }
+  }
+}
+
+TEST(PickIndex, ClearEntries) {
+  auto cell = MakeCell(100, 50);
+  PickIndex index;
+  AddToItems(cell, index);
+  index.ClearEntries();
+  EXPECT_TRUE(index.HasTree());
+  EXPECT_EQ(index.Size(), 0);
+  EXPECT_TRUE(index.Search({10.5f, 59.6f, 10.7f, 59.8f}).empty());
+
+  //  Entries added again to the kept tree, as after s57chart::UpdateLUPs()
+  index.AddToItem(0);
+  index.AddToItem(0);
+  index.AddBox(cell.objects[1]);  // unindexed with a stored tree
+  index.AddToItem(UINT32_MAX);    // no such item, unindexed
+  index.Finish();
+  EXPECT_EQ(index.Search({0, 0, 1, 1}), std::vector<uint32_t>({2, 3}));
+  EXPECT_EQ(index.Search(cell.objects[0]),
+            std::vector<uint32_t>({0, 1, 2, 3}));
+
+  index.Clear();
+  EXPECT_FALSE(index.HasTree());
+}
+
+/**
+ * Candidate selection of s57chart::GetObjRuleListAtLatLon() on a reference
+ * cell, with the index built from the rules and with a stored index, versus
+ * the linear walk over all rules it replaces. Timings are reported only.
+ */
+TEST(PickIndex, PickBenchmark) {
+  auto cell = MakeCell(10000, 2000);
+  auto queries = MakeQueries(1000, 0.0005f);
+  using Ms = std::chrono::duration<double, std::milli>;
+
+  auto start = std::chrono::steady_clock::now();
+  PickIndex built;
+  AddBoxes(cell, built);
+  Ms build_time = std::chrono::steady_clock::now() - start;
+  PickIndex stored;
+  AddToItems(cell, stored);
+
+  size_t linear_hits = 0;
+  start = std::chrono::steady_clock::now();
+  for (const auto& q : queries) linear_hits += LinearPick(cell, q).size();
+  Ms linear_time = std::chrono::steady_clock::now() - start;
+
+  auto time_picks = [&](const PickIndex& index, size_t& hits) {
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& q : queries)
+      hits += Filter(cell, q, index.Search(q)).size();
+    return Ms(std::chrono::steady_clock::now() - start);
+  };
+  size_t built_hits = 0;
+  Ms built_time = time_picks(built, built_hits);
+  size_t stored_hits = 0;
+  Ms stored_time = time_picks(stored, stored_hits);
+
+  EXPECT_EQ(built_hits, linear_hits);
+  EXPECT_EQ(stored_hits, linear_hits);
+  RecordProperty("entries", std::to_string(cell.entry_objs.size()));
+  RecordProperty("build ms", std::to_string(build_time.count()));
+  RecordProperty("linear ms/1000 picks", std::to_string(linear_time.count()));
+  RecordProperty("built index ms/1000 picks",
+                 std::to_string(built_time.count()));
+  RecordProperty("stored index ms/1000 picks",
+                 std::to_string(stored_time.count()));
+}
@@ -0,0 +1,111 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/raster_tile_cache.h"
+
+TEST(RasterTileCache, ChartIds) {
+  RasterTileCache cache;
+  uint32_t a = cache.GetChartId("a.kap", 1);
+  uint32_t b = cache.GetChartId("b.kap", 1);
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, 0);
+  EXPECT_EQ(cache.GetChartId("a.kap", 1), a);
+}
+
+TEST(RasterTileCache, ChangedChart) {
+  RasterTileCache cache;
+  uint32_t a = cache.GetChartId("a.kap", 1);
+  uint32_t b = cache.GetChartId("b.kap", 1);
+  cache.Put(a, 0, 0, std::vector<uint8_t>(100, 1));
+  cache.Put(b, 0, 0, std::vector<uint8_t>(100, 2));
+
+  EXPECT_TRUE(cache.IsCurrent(a));
+  EXPECT_TRUE(cache.IsCurrent(b));
+
+  // A new version drops the tiles of the old one.
+  uint32_t a2 = cache.GetChartId("a.kap", 2);
+  EXPECT_NE(a2, a);
+  EXPECT_NE(a2, b);
+  EXPECT_FALSE(cache.IsCurrent(a));
+  EXPECT_TRUE(cache.IsCurrent(a2));
+  EXPECT_FALSE(cache.Get(a, 0, 0));
+  EXPECT_FALSE(cache.Get(a2, 0, 0));
+  EXPECT_TRUE(cache.Get(b, 0, 0));
+  EXPECT_EQ(cache.GetUsed(), 100);
+
+  // Erasing by path drops tiles and id.
+  cache.Erase("b.kap");
+  EXPECT_FALSE(cache.Get(b, 0, 0));
+  EXPECT_FALSE(cache.IsCurrent(b));
+  EXPECT_EQ(cache.GetCount(), 0);
+  EXPECT_NE(cache.GetChartId("b.kap", 1), b);
+  cache.Erase("unknown.kap");
+}
+
+TEST(RasterTileCache, GetPut) {
+  RasterTileCache cache;
+  EXPECT_FALSE(cache.Get(1, 0, 0));
+  auto tile = cache.Put(1, 0, 0, std::vector<uint8_t>(100, 7));
+  ASSERT_TRUE(tile);
+  EXPECT_EQ(tile->size(), 100);
+  EXPECT_EQ(cache.Get(1, 0, 0), tile);
+  EXPECT_FALSE(cache.Get(1, 1, 0));
+  EXPECT_FALSE(cache.Get(1, 0, 1));
+  EXPECT_FALSE(cache.Get(2, 0, 0));
+  EXPECT_EQ(cache.GetHits(), 1);
+  EXPECT_EQ(cache.GetMisses(), 4);
+
+  // A tile added twice keeps the first one.
+  auto again = cache.Put(1, 0, 0, std::vector<uint8_t>(100, 8));
+  EXPECT_EQ(again, tile);
+  EXPECT_EQ(cache.GetUsed(), 100);
+  EXPECT_EQ(cache.GetCount(), 1);
+
+  cache.Put(2, 0, 0, std::vector<uint8_t>(50));
+  cache.Erase(1);
+  EXPECT_FALSE(cache.Get(1, 0, 0));
+  EXPECT_EQ(cache.GetUsed(), 50);
+  EXPECT_EQ((*tile)[0], 7);  // Still valid while held
+}
+
+TEST(RasterTileCache, Budget) {
+  RasterTileCache cache(300);
+  cache.Put(1, 0, 0, std::vector<uint8_t>(100));
+  cache.Put(1, 1, 0, std::vector<uint8_t>(100));
+  cache.Put(1, 2, 0, std::vector<uint8_t>(100));
+  cache.Get(1, 0, 0);  // Most recently used
+  cache.Put(1, 3, 0, std::vector<uint8_t>(100));
+  EXPECT_EQ(cache.GetUsed(), 300);
+  EXPECT_TRUE(cache.Get(1, 0, 0));
+  EXPECT_FALSE(cache.Get(1, 1, 0));
+  EXPECT_TRUE(cache.Get(1, 2, 0));
+
+  // A tile larger than budget is returned, and kept until the next one.
+  auto large = cache.Put(1, 4, 0, std::vector<uint8_t>(1000));
+  EXPECT_EQ(large->size(), 1000);
+  EXPECT_EQ(cache.GetCount(), 1);
+  cache.SetBudget(0);
+  EXPECT_EQ(cache.GetCount(), 1);
+  cache.Put(1, 5, 0, std::vector<uint8_t>(10));
+  EXPECT_EQ(cache.GetUsed(), 10);
+}
+
+TEST(RasterTileCache, Threads) {
+  RasterTileCache cache(64 * 100);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&cache, t] {
+      for (int i = 0; i < 2000; i++) {
+        int tx = (i * 7 + t) % 100;
+        auto tile = cache.Get(1, tx, 0);
+        if (!tile) tile = cache.Put(1, tx, 0, std::vector<uint8_t>(64, tx));
+        ASSERT_EQ((*tile)[63], tx);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_LE(cache.GetUsed(), 64 * 100);
+  EXPECT_EQ(cache.GetHits() + cache.GetMisses(), 8000);
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/select.h"
+#include "model/select_index.h"
+
+/** Bounding box filter as used by the linear list scan. */
+static bool InBox(const SelectItem& si, float lat, float lon, float r) {
+  float lat_min = std::min(si.m_slat, si.m_slat2);
+  float lat_max = std::max(si.m_slat, si.m_slat2);
+  float lon_min = std::min(si.m_slon, si.m_slon2);
+  float lon_max = std::max(si.m_slon, si.m_slon2);
+  return lat >= lat_min - r && lat <= lat_max + r && lon >= lon_min - r &&
+         lon <= lon_max + r;
+}
+
+/** Create n connected track segments as a random walk. */
+static std::vector<std::unique_ptr<SelectItem>> MakeTrack(size_t n,
+                                                          unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> step(-0.002f, 0.002f);
+  std::vector<std::unique_ptr<SelectItem>> items;
+  float lat = 57.0f;
+  float lon = 11.0f;
+  for (size_t i = 0; i < n; i++) {
+    auto si = std::make_unique<SelectItem>();
+    si->m_seltype = SELTYPE_TRACKSEGMENT;
+    si->m_slat = lat;
+    si->m_slon = lon;
+    lat = std::clamp(lat + step(rng), 55.0f, 59.0f);
+    lon = std::clamp(lon + step(rng), 9.0f, 13.0f);
+    si->m_slat2 = lat;
+    si->m_slon2 = lon;
+    items.push_back(std::move(si));
+  }
+  return items;
+}
+
+TEST(SelectIndex, Ordering) {
+  SelectIndex index;
+  SelectItem a, b, c;
+  for (auto* si : {&a, &b, &c}) {
+    si->m_seltype = SELTYPE_ROUTEPOINT;
+    si->m_slat = 10.0f;
+    si->m_slon = 179.999f;
+  }
+  index.Insert(&a, false);
+  index.Insert(&b, true);
+  index.Insert(&c, false);
+  auto found = index.Query(10.0f, -179.999f, 0.01f, SELTYPE_ROUTEPOINT);
+  ASSERT_EQ(found.size(), 3);
+  EXPECT_EQ(found[0], &b);
+  EXPECT_EQ(found[1], &a);
+  EXPECT_EQ(found[2], &c);
+
+  index.Remove(&b);
+  EXPECT_FALSE(index.Contains(&b));
+  a.m_slat = 20.0f;
+  index.Update(&a);
+  found = index.Query(10.0f, 179.999f, 0.01f, SELTYPE_ROUTEPOINT);
+  ASSERT_EQ(found.size(), 1);
+  EXPECT_EQ(found[0], &c);
+  EXPECT_TRUE(index.Query(10.0f, 180.0f, 0.01f, SELTYPE_TRACKSEGMENT).empty());
+}
+
+/** Compare index queries with a linear scan, return query times in ms. */
+static std::pair<double, double> CompareWithScan(size_t segments, int n) {
+  using namespace std::chrono;
+  const float kRadius = 0.001f;
+
+  auto items = MakeTrack(segments, 4711);
+  SelectIndex index;
+  for (auto& si : items) index.Insert(si.get(), false);
+
+  std::mt19937 rng(17);
+  std::uniform_real_distribution<float> lat_dist(55.0f, 59.0f);
+  std::uniform_real_distribution<float> lon_dist(9.0f, 13.0f);
+  std::vector<std::pair<float, float>> queries;
+  for (int i = 0; i < n; i++)
+    queries.emplace_back(lat_dist(rng), lon_dist(rng));
+  // Also query points known to be on the track.
+  for (int i = 0; i < n; i++) {
+    const auto& si = items[rng() % segments];
+    queries.emplace_back(si->m_slat, si->m_slon);
+  }
+
+  duration<double, std::milli> index_time(0);
+  duration<double, std::milli> scan_time(0);
+  for (const auto& q : queries) {
+    auto start = steady_clock::now();
+    auto found =
+        index.Query(q.first, q.second, kRadius, SELTYPE_TRACKSEGMENT);
+    index_time += steady_clock::now() - start;
+
+    start = steady_clock::now();
+    size_t expected = 0;
+    for (auto& si : items)
+      if (InBox(*si, q.first, q.second, kRadius)) expected += 1;
+    scan_time += steady_clock::now() - start;
+    EXPECT_EQ(found.size(), expected);
+  }
+  return {index_time.count(), scan_time.count()};
+}
+
+TEST(SelectIndex, MatchesScan) { CompareWithScan(20000, 100); }
+
+// Slow, run using --gtest_also_run_disabled_tests.
+TEST(SelectIndex, DISABLED_Benchmark1M) {
+  const int kQueries = 200;
+  auto times = CompareWithScan(1000000, kQueries);
+  RecordProperty("index_query_us",
+                 std::to_string(1000 * times.first / (2 * kQueries)));
+  RecordProperty("scan_query_us",
+                 std::to_string(1000 * times.second / (2 * kQueries)));
+}
@@ -0,0 +1,97 @@
+#include "config.h"
+
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gui_lib.h"
+#include "navutil.h"
+#include "tcmgr.h"
+
+// tcmgr.cpp is built without the rest of the gui. Stubs for the two gui
+// functions it refers to, neither used by these tests.
+int OCPNMessageBox(wxWindow*, const wxString&, const wxString&, int, int, int,
+                   int) {
+  return wxID_OK;
+}
+
+wxDateTime toUsrDateTime(const wxDateTime ts, const int, const double) {
+  return ts;
+}
+
+static const int kStep = 6 * 60;
+static const int kCount = 4 * 24 * 10;  // Four days
+
+class TideSeries : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::vector<std::string> sources = {
+        std::string(TCDATA) + "/harmonics-dwf-20210110-free.tcd"};
+    ASSERT_EQ(m_tcmgr.LoadDataSources(sources), TC_NO_ERROR);
+    ASSERT_GT(m_tcmgr.Get_max_IDX(), 0);
+  }
+
+  /** Return first station of type having offsets or not, -1 if none. */
+  int FindStation(char type, bool offsets) {
+    for (int i = 1; i <= m_tcmgr.Get_max_IDX(); i++) {
+      const IDX_entry* pIDX = m_tcmgr.GetIDX_entry(i);
+      if (pIDX->IDX_type == type && pIDX->IDX_Useable &&
+          (pIDX->have_offsets != 0) == offsets)
+        return i;
+    }
+    return -1;
+  }
+
+  /**
+   * Compare GetTideOrCurrentSeries() with GetTideOrCurrent() for each
+   * time, in station units.
+   */
+  void CheckSeries(int idx, time_t t0, double tolerance) {
+    std::vector<float> values;
+    std::vector<float> dirs;
+    ASSERT_TRUE(
+        m_tcmgr.GetTideOrCurrentSeries(t0, kStep, kCount, idx, values, dirs));
+    ASSERT_EQ(values.size(), kCount);
+    ASSERT_EQ(dirs.size(), kCount);
+    for (int i = 0; i < kCount; i++) {
+      time_t t = t0 + static_cast<time_t>(i) * kStep;
+      float value;
+      float dir;
+      ASSERT_TRUE(m_tcmgr.GetTideOrCurrent(t, idx, value, dir));
+      ASSERT_NEAR(values[i], value, tolerance) << "station " << idx
+                                               << ", t = " << t;
+      if (std::fabs(value) > tolerance) EXPECT_EQ(dirs[i], dir);
+    }
+  }
+
+  TCMgr m_tcmgr;
+};
+
+/** Mid year, where the harmonics are summed in one pass. */
+static const time_t kJune = 1749513600;  // 2025-06-10 00:00 UTC
+
+/** Across new year, where the two years are blended. */
+static const time_t kNewYear = 1735516800;  // 2024-12-30 00:00 UTC
+
+TEST_F(TideSeries, ReferenceTide) {
+  int idx = FindStation('T', false);
+  ASSERT_GT(idx, 0);
+  CheckSeries(idx, kJune, 1e-3);
+  CheckSeries(idx, kNewYear, 1e-3);
+}
+
+TEST_F(TideSeries, ReferenceCurrent) {
+  int idx = FindStation('C', false);
+  ASSERT_GT(idx, 0);
+  CheckSeries(idx, kJune, 1e-3);
+  CheckSeries(idx, kNewYear, 1e-3);
+}
+
+TEST_F(TideSeries, SecondaryTide) {
+  int idx = FindStation('t', true);
+  ASSERT_GT(idx, 0);
+  CheckSeries(idx, kJune, 1e-3);
+}
@@ -1,12 +1,14 @@
 #include "config.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <thread>
 
 #include <wx/app.h>
@@ -771,6 +773,132 @@ class NavMsgApp : public BasicTest {
   }
 };
 
+class NavMsgBatchApp : public BasicTest {
+public:
+  NavMsgBatchApp() : BasicTest() {}
+
+  void Work() {
+    auto& bus = NavMsgBus::GetInstance();
+    std::atomic<int> received(0);
+    int handle = bus.AddBatchListener(
+        [&received](const NavMsgBatch& batch) {
+          received += static_cast<int>(batch.size());
+        },
+        NavMsgDelivery::kWorker);
+    bus.ResetStats();
+    for (int i = 0; i < 100; i++) {
+      auto msg = std::make_shared<PluginMsg>("batch", std::to_string(i));
+      bus.Notify(std::move(msg));
+    }
+    std::this_thread::sleep_for(4 * NavMsgBus::kDefaultTick);
+    bus.RemoveBatchListener(handle);
+    EXPECT_EQ(received, 100);
+    auto stats = bus.GetStats();
+    EXPECT_EQ(stats.delivered, 100);
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_GT(stats.batches, 0);
+    EXPECT_LT(stats.batches, 100);
+  }
+};
+
+class NavMsgRemoveSelfApp : public BasicTest {
+public:
+  NavMsgRemoveSelfApp() : BasicTest() {}
+
+  void Work() {
+    auto& bus = NavMsgBus::GetInstance();
+    std::atomic<int> calls(0);
+    std::atomic<int> handle(0);
+    handle = bus.AddBatchListener(
+        [&](const NavMsgBatch&) {
+          calls += 1;
+          bus.RemoveBatchListener(handle);  // Must not deadlock
+        },
+        NavMsgDelivery::kWorker);
+    bus.Notify(std::make_shared<PluginMsg>("remove-self", ""));
+    std::this_thread::sleep_for(4 * NavMsgBus::kDefaultTick);
+    bus.Notify(std::make_shared<PluginMsg>("remove-self", ""));
+    std::this_thread::sleep_for(4 * NavMsgBus::kDefaultTick);
+    EXPECT_EQ(calls, 1);
+  }
+};
+
+class NavMsgConflateApp : public BasicTest {
+public:
+  NavMsgConflateApp() : BasicTest() {}
+
+  void Work() {
+    auto& bus = NavMsgBus::GetInstance();
+    std::atomic<int> received(0);
+    std::string last;
+    std::mutex last_mutex;
+    auto key = PluginMsg("conflate", "").GetKey();
+    // Hold back dispatching until all messages are queued, making them
+    // all end up in the same batch.
+    bus.SetBatchMode(true, 1h);
+    int handle = bus.AddConflatingListener(
+        {key}, 1s,
+        [&](const NavMsgBatch& batch) {
+          received += static_cast<int>(batch.size());
+          auto msg = std::static_pointer_cast<const PluginMsg>(batch.back());
+          std::lock_guard lock(last_mutex);
+          last = msg->message;
+        },
+        NavMsgDelivery::kWorker);
+    for (int i = 0; i < 50; i++) {
+      auto msg = std::make_shared<PluginMsg>("conflate", std::to_string(i));
+      bus.Notify(std::move(msg));
+      bus.Notify(std::make_shared<PluginMsg>("other", ""));
+    }
+    bus.SetBatchMode(true, NavMsgBus::kDefaultTick);
+    std::this_thread::sleep_for(4 * NavMsgBus::kDefaultTick);
+    auto stats = bus.GetConflatingStats(handle);
+    bus.RemoveBatchListener(handle);
+    bus.SetBatchMode(false);
+    EXPECT_EQ(received, 1);
+    EXPECT_EQ(stats.received, 50);
+    EXPECT_EQ(stats.delivered, 1);
+    EXPECT_EQ(stats.skipped, 49);
+    std::lock_guard lock(last_mutex);
+    EXPECT_EQ(last, "49");
+  }
+};
+
+class NavMsgConflateSourcesApp : public BasicTest {
+public:
+  NavMsgConflateSourcesApp() : BasicTest() {}
+
+  void Work() {
+    auto& bus = NavMsgBus::GetInstance();
+    std::vector<std::string> ifaces;
+    std::mutex ifaces_mutex;
+    bus.SetBatchMode(true, 1h);
+    int handle = bus.AddConflatingListener(
+        {Nmea0183Msg("XYZ").GetKey()}, 1s,
+        [&](const NavMsgBatch& batch) {
+          std::lock_guard lock(ifaces_mutex);
+          for (const auto& msg : batch) ifaces.push_back(msg->source->iface);
+        },
+        NavMsgDelivery::kWorker);
+    auto addr1 = std::make_shared<NavAddr>(NavAddr0183("conflate1"));
+    auto addr2 = std::make_shared<NavAddr>(NavAddr0183("conflate2"));
+    for (int i = 0; i < 10; i++) {
+      bus.Notify(std::make_shared<Nmea0183Msg>("GPXYZ", "", addr2));
+      bus.Notify(std::make_shared<Nmea0183Msg>("GPXYZ", "", addr1));
+    }
+    bus.SetBatchMode(true, NavMsgBus::kDefaultTick);
+    std::this_thread::sleep_for(4 * NavMsgBus::kDefaultTick);
+    auto stats = bus.GetConflatingStats(handle);
+    bus.RemoveBatchListener(handle);
+    bus.SetBatchMode(false);
+    // Latest message of each source, in arrival order.
+    EXPECT_EQ(stats.delivered, 2);
+    EXPECT_EQ(stats.skipped, 18);
+    std::lock_guard lock(ifaces_mutex);
+    EXPECT_EQ(ifaces, std::vector<std::string>({"conflate2", "conflate1"}));
+  }
+};
+
 using namespace std;
 
 #ifdef _MSC_VER
@@ -843,6 +971,8 @@ class PriorityApp : public wxAppConsole {
     auto& comm_bridge = CommBridge::GetInstance();
     auto driver = make_unique<FileCommDriver>(inputfile + ".log", path, msgbus);
     CommDriverRegistry::GetInstance().Activate(std::move(driver));
+    // Positions are delivered once per tick.
+    std::this_thread::sleep_for(4 * NavMsgBus::kDefaultTick);
     ProcessPendingEvents();
     EXPECT_NEAR(gLat, 57.6460, 0.004);
     EXPECT_NEAR(gLon, 11.7130, 0.004);
@@ -889,6 +1019,7 @@ class PriorityApp2 : public BasicTest {
         Nmea0183Msg("GPGGA", GPGGA_2, addr2));
     msgbus.Notify(m1);
     msgbus.Notify(m2);
+    std::this_thread::sleep_for(4 * NavMsgBus::kDefaultTick);
     ProcessPendingEvents();
     Position p = Position::ParseGGA("5759.097,N,01144.345,E");
     EXPECT_NEAR(gLat, p.lat, 0.0001);
@@ -975,6 +1106,8 @@ class AisVdmApp : public BasicTest {
     auto m = std::make_shared<const Nmea0183Msg>(
         Nmea0183Msg("AIVDM", AISVDM_1, addr1));
     msgbus.Notify(m);
+    // VDM is handled in batches, once per tick.
+    std::this_thread::sleep_for(4 * NavMsgBus::kDefaultTick);
     ProcessPendingEvents();
 
     auto found = g_pAIS->GetTargetList().find(MMSI);
@@ -986,6 +1119,80 @@ class AisVdmApp : public BasicTest {
   }
 };
 
+/** Run all VDM/VDO sentences through both decoder paths, compare targets. */
+class AisVdmDiffApp : public BasicTest {
+public:
+  AisVdmDiffApp() : BasicTest() {
+    AisDecoder reference{AisDecoderCallbacks()};
+    AisDecoder decoder{AisDecoderCallbacks()};
+    std::ifstream stream(std::string(TESTDATA) + "/Hakefjord.log");
+    ASSERT_TRUE(stream.good());
+    std::string line;
+    int sentences = 0;
+    while (std::getline(stream, line)) {
+      if (line.size() < 6 || line.compare(3, 2, "VD") != 0) continue;
+      sentences++;
+      AisError expected = reference.DecodeN0183(wxString(line));
+      EXPECT_EQ(decoder.DecodeVdm(line), expected);
+    }
+    EXPECT_EQ(sentences, 15912);
+
+    auto& targets = decoder.GetTargetList();
+    EXPECT_EQ(reference.GetTargetList().size(), targets.size());
+    EXPECT_GT(targets.size(), 0);
+    for (const auto& kv : reference.GetTargetList()) {
+      auto found = targets.find(kv.first);
+      EXPECT_NE(found, targets.end());
+      if (found != targets.end()) Compare(*kv.second, *found->second);
+    }
+  }
+
+private:
+  static void Compare(const AisTargetData& a, const AisTargetData& b) {
+    EXPECT_EQ(a.MID, b.MID);
+    EXPECT_EQ(a.MMSI, b.MMSI);
+    EXPECT_EQ(a.Class, b.Class);
+    EXPECT_EQ(a.NavStatus, b.NavStatus);
+    EXPECT_EQ(a.SyncState, b.SyncState);
+    EXPECT_EQ(a.SlotTO, b.SlotTO);
+    EXPECT_EQ(a.SOG, b.SOG);
+    EXPECT_EQ(a.COG, b.COG);
+    EXPECT_EQ(a.HDG, b.HDG);
+    EXPECT_EQ(a.Lat, b.Lat);
+    EXPECT_EQ(a.Lon, b.Lon);
+    EXPECT_EQ(a.ROTAIS, b.ROTAIS);
+    EXPECT_EQ(a.ROTIND, b.ROTIND);
+    EXPECT_STREQ(a.CallSign, b.CallSign);
+    EXPECT_STREQ(a.ShipName, b.ShipName);
+    EXPECT_STREQ(a.ShipNameExtension, b.ShipNameExtension);
+    EXPECT_STREQ(a.Destination, b.Destination);
+    EXPECT_EQ(a.ShipType, b.ShipType);
+    EXPECT_EQ(a.IMO, b.IMO);
+    EXPECT_EQ(a.DimA, b.DimA);
+    EXPECT_EQ(a.DimB, b.DimB);
+    EXPECT_EQ(a.DimC, b.DimC);
+    EXPECT_EQ(a.DimD, b.DimD);
+    EXPECT_EQ(a.ETA_Mo, b.ETA_Mo);
+    EXPECT_EQ(a.ETA_Day, b.ETA_Day);
+    EXPECT_EQ(a.ETA_Hr, b.ETA_Hr);
+    EXPECT_EQ(a.ETA_Min, b.ETA_Min);
+    EXPECT_EQ(a.Draft, b.Draft);
+    EXPECT_EQ(a.b_isEuroInland, b.b_isEuroInland);
+    EXPECT_EQ(a.b_positionDoubtful, b.b_positionDoubtful);
+    EXPECT_EQ(a.b_positionOnceValid, b.b_positionOnceValid);
+    EXPECT_EQ(a.b_nameValid, b.b_nameValid);
+    EXPECT_EQ(a.b_OwnShip, b.b_OwnShip);
+    EXPECT_EQ(a.b_SarAircraftPosnReport, b.b_SarAircraftPosnReport);
+    EXPECT_EQ(a.altitude, b.altitude);
+    EXPECT_EQ(a.m_utc_sec, b.m_utc_sec);
+    EXPECT_EQ(a.area_notices.size(), b.area_notices.size());
+    EXPECT_EQ(a.m_ptrack.size(), b.m_ptrack.size());
+    // Both decoders stamp reports using the wall clock.
+    EXPECT_NEAR(a.PositionReportTicks, b.PositionReportTicks, 2);
+    EXPECT_NEAR(a.StaticReportTicks, b.StaticReportTicks, 2);
+  }
+};
+
 class ObsTorture : public wxAppConsole {
 public:
   class ObsListener : public wxEvtHandler {
@@ -1248,8 +1455,18 @@ TEST(AIS, AISVDO) { AisVdoApp app; }
 
 TEST(AIS, AISVDM) { AisVdmApp app; }
 
+TEST(AIS, VdmDifferential) { AisVdmDiffApp app; }
+
 TEST(Navmsg, ActiveMessages) { NavMsgApp app; }
 
+TEST(Navmsg, BatchListener) { NavMsgBatchApp app; }
+
+TEST(Navmsg, RemoveListenerFromHandler) { NavMsgRemoveSelfApp app; }
+
+TEST(Navmsg, ConflatingListener) { NavMsgConflateApp app; }
+
+TEST(Navmsg, ConflatingSources) { NavMsgConflateSourcesApp app; }
+
 #if API_VERSION_MINOR > 18
 TEST(PluginApi, SignalK) { SignalKApp app; }
 #endif
@@ -0,0 +1,85 @@
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/tide_series_cache.h"
+
+/** Semi diurnal tide, amplitude depends on station. */
+static double Tide(int idx, double t) {
+  const double kPeriod = 12.42 * 3600;
+  return (1 + idx) * std::cos(2 * 3.14159265358979 * t / kPeriod);
+}
+
+static TideSeriesCache::Evaluator MakeEvaluator(std::atomic<int>& samples) {
+  return [&samples](time_t t0, int step, int count, int idx,
+                    std::vector<float>& values) {
+    if (idx < 0) return false;
+    values.resize(count);
+    for (int i = 0; i < count; i++) values[i] = Tide(idx, t0 + i * step);
+    samples += count;
+    return true;
+  };
+}
+
+TEST(TideSeriesCache, Interpolate) {
+  std::atomic<int> samples(0);
+  TideSeriesCache cache(MakeEvaluator(samples), 24 * 3600, 360);
+  const time_t now = 1700000000;
+  float value;
+  EXPECT_FALSE(cache.Get(1, now, value));
+  cache.WaitIdle();
+
+  // One day at each side of now, 6 minute samples.
+  EXPECT_EQ(samples, 2 * 240 + 1);
+  for (time_t t = now - 12 * 3600; t < now + 12 * 3600; t += 97) {
+    ASSERT_TRUE(cache.Get(1, t, value));
+    EXPECT_NEAR(value, Tide(1, t), 2e-3);
+  }
+  EXPECT_FALSE(cache.Get(-1, now, value));
+  cache.WaitIdle();
+  EXPECT_FALSE(cache.Get(-1, now, value));
+}
+
+TEST(TideSeriesCache, FollowQueries) {
+  std::atomic<int> samples(0);
+  TideSeriesCache cache(MakeEvaluator(samples), 24 * 3600, 360);
+  const time_t now = 1700000000;
+  float value;
+  cache.Get(2, now, value);
+  cache.WaitIdle();
+  samples = 0;
+
+  // Moving less than half a span uses existing samples.
+  EXPECT_TRUE(cache.Get(2, now + 11 * 3600, value));
+  cache.WaitIdle();
+  EXPECT_EQ(samples, 0);
+
+  // Moving further recentres the window, computing only missing samples.
+  EXPECT_TRUE(cache.Get(2, now + 13 * 3600, value));
+  cache.WaitIdle();
+  EXPECT_EQ(samples, 13 * 10);
+  EXPECT_TRUE(cache.Get(2, now + 36 * 3600, value));
+  EXPECT_NEAR(value, Tide(2, now + 36 * 3600), 5e-3);
+
+  // Far jumps drop everything.
+  samples = 0;
+  cache.SetCentre(now + 30 * 24 * 3600);
+  cache.WaitIdle();
+  EXPECT_EQ(samples, 2 * 240 + 1);
+  EXPECT_FALSE(cache.Get(2, now, value));
+}
+
+TEST(TideSeriesCache, Clear) {
+  std::atomic<int> samples(0);
+  TideSeriesCache cache(MakeEvaluator(samples), 24 * 3600, 360);
+  const time_t now = 1700000000;
+  float value;
+  for (int idx = 0; idx < 100; idx++) cache.Get(idx, now, value);
+  cache.Clear();
+  cache.WaitIdle();
+  EXPECT_FALSE(cache.Get(5, now, value));
+  cache.WaitIdle();
+  EXPECT_TRUE(cache.Get(5, now, value));
+}
@@ -0,0 +1,163 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/georef.h"
+#include "model/track_lod.h"
+
+struct LatLon {
+  double lat;
+  double lon;
+};
+
+// Random walk, partly circling at anchor.
+static std::vector<LatLon> MakeTrack(size_t count) {
+  std::mt19937 rng(11);
+  std::normal_distribution<double> turn(0, 5);
+  std::vector<LatLon> track;
+  double lat = 57.7, lon = 11.8, heading = 45;
+  for (size_t i = 0; i < count; i++) {
+    bool anchored = (i / 5000) % 4 == 3;
+    heading += anchored ? 20 + turn(rng) : turn(rng);
+    double step = anchored ? 2e-5 : 5e-5;
+    lat += step * cos(heading * DEGREE);
+    lon += step * sin(heading * DEGREE) / cos(lat * DEGREE);
+    track.push_back({lat, lon});
+  }
+  return track;
+}
+
+static void Project(const LatLon& p, double& x, double& y) {
+  const double z = WGS84_semimajor_axis_meters * mercator_k0;
+  x = z * DEGREE * p.lon;
+  y = z * log(tan(DEGREE * (45 + p.lat / 2)));
+}
+
+static double SegmentDistance(const LatLon& p, const LatLon& a,
+                              const LatLon& b) {
+  double px, py, ax, ay, bx, by;
+  Project(p, px, py);
+  Project(a, ax, ay);
+  Project(b, bx, by);
+  bx -= ax, by -= ay, px -= ax, py -= ay;
+  double length2 = bx * bx + by * by;
+  double t = length2 > 0 ? (px * bx + py * by) / length2 : 0;
+  t = std::max(0.0, std::min(1.0, t));
+  return std::hypot(px - t * bx, py - t * by);
+}
+
+static std::vector<TrackLod::Point> GetPoints(const TrackLod& lod, int level) {
+  std::vector<TrackLod::Point> points;
+  lod.Visit(
+      level, [](const TrackLod::Extent&) { return true; },
+      [&](const TrackLod::Point& p, bool first) {
+        EXPECT_EQ(first, points.empty());
+        points.push_back(p);
+      });
+  return points;
+}
+
+TEST(TrackLod, ErrorBound) {
+  auto track = MakeTrack(40000);
+  TrackLod lod;
+  for (const auto& p : track) lod.Append(p.lat, p.lon);
+  EXPECT_EQ(lod.GetCount(), track.size());
+  size_t previous = track.size();
+  for (int level = 0; level < TrackLod::kLevels; level++) {
+    auto points = GetPoints(lod, level);
+    ASSERT_GE(points.size(), 2);
+    EXPECT_EQ(points.front().index, 0);
+    EXPECT_EQ(points.back().index, track.size() - 1);
+    double max_dist = 0;
+    for (size_t i = 1; i < points.size(); i++) {
+      uint32_t a = points[i - 1].index;
+      uint32_t b = points[i].index;
+      ASSERT_LT(a, b);
+      for (uint32_t j = a; j <= b; j++) {
+        max_dist = std::max(max_dist,
+                            SegmentDistance(track[j], track[a], track[b]));
+      }
+    }
+    EXPECT_LE(max_dist, lod.GetError(level) + 1e-6);
+    EXPECT_LE(points.size(), previous);
+    previous = points.size();
+  }
+  EXPECT_LT(GetPoints(lod, 0).size(), track.size() / 4);
+  EXPECT_LT(GetPoints(lod, 4).size(), 100);
+}
+
+TEST(TrackLod, SelectLevel) {
+  TrackLod lod;
+  EXPECT_EQ(lod.SelectLevel(1.0), -1);
+  EXPECT_EQ(lod.SelectLevel(TrackLod::kTolerance), 0);
+  EXPECT_EQ(lod.SelectLevel(lod.GetError(3) + 1), 3);
+  EXPECT_EQ(lod.SelectLevel(1e12), TrackLod::kLevels - 1);
+}
+
+TEST(TrackLod, Visit) {
+  auto track = MakeTrack(10000);
+  TrackLod lod;
+  EXPECT_TRUE(GetPoints(lod, 2).empty());
+  lod.Append(track[0].lat, track[0].lon);
+  EXPECT_EQ(GetPoints(lod, 2).size(), 1);
+  for (size_t i = 1; i < track.size(); i++) {
+    lod.Append(track[i].lat, track[i].lon);
+  }
+
+  // Invisible blocks break runs, the not reduced tail is always visited.
+  int runs = 0;
+  size_t visited = 0;
+  int blocks = 0;
+  lod.Visit(
+      0, [&](const TrackLod::Extent&) { return blocks++ % 4 < 2; },
+      [&](const TrackLod::Point&, bool first) {
+        if (first) runs++;
+        visited++;
+      });
+  EXPECT_GT(runs, 1);
+  EXPECT_GE(runs, (blocks + 3) / 4);
+  EXPECT_LE(runs, (blocks + 3) / 4 + 1);
+  EXPECT_LT(visited, GetPoints(lod, 0).size());
+  visited = 0;
+  lod.Visit(
+      1, [](const TrackLod::Extent&) { return false; },
+      [&](const TrackLod::Point&, bool first) {
+        EXPECT_EQ(first, visited == 0);
+        visited++;
+      });
+  EXPECT_GT(visited, 0);
+  EXPECT_LT(visited, 2 * TrackLod::kChunk);
+}
+
+TEST(TrackLod, Serialize) {
+  auto track = MakeTrack(30000);
+  TrackLod lod;
+  TrackLod restored;
+  for (size_t i = 0; i < track.size(); i++) {
+    lod.Append(track[i].lat, track[i].lon);
+    if (i == 12345) {
+      auto blob = lod.Serialize();
+      ASSERT_TRUE(restored.Deserialize(blob.data(), blob.size()));
+      EXPECT_EQ(restored.GetCount(), 12346);
+      EXPECT_EQ(restored.Serialize(), blob);
+      blob.pop_back();
+      EXPECT_FALSE(TrackLod().Deserialize(blob.data(), blob.size()));
+    } else if (i > 12345) {
+      restored.Append(track[i].lat, track[i].lon);
+    }
+  }
+  EXPECT_EQ(restored.Serialize(), lod.Serialize());
+  for (int level = 0; level < TrackLod::kLevels; level++) {
+    auto a = GetPoints(lod, level);
+    auto b = GetPoints(restored, level);
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); i++) EXPECT_EQ(a[i].index, b[i].index);
+  }
+  TrackLod empty;
+  auto blob = empty.Serialize();
+  EXPECT_TRUE(restored.Deserialize(blob.data(), blob.size()));
+  EXPECT_EQ(restored.GetCount(), 0);
+  EXPECT_FALSE(restored.Deserialize("TLOD", 4));
+}
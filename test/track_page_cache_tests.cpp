@@ -0,0 +1,76 @@
+#include <chrono>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/track_page_cache.h"
+
+using namespace std::chrono_literals;
+using Clock = TrackPageCache::Clock;
+
+TEST(TrackPageCache, Accounting) {
+  TrackPageCache cache;
+  int a, b;
+  cache.Add(&a, 100, nullptr);
+  cache.Add(&b, 50, nullptr);
+  EXPECT_EQ(cache.GetPoints(), 150);
+  EXPECT_EQ(cache.GetCount(), 2);
+  EXPECT_TRUE(cache.Contains(&a));
+
+  // Adding again replaces the entry.
+  cache.Add(&a, 200, nullptr);
+  EXPECT_EQ(cache.GetPoints(), 250);
+  cache.Remove(&a);
+  cache.Remove(&a);
+  EXPECT_EQ(cache.GetPoints(), 50);
+  EXPECT_FALSE(cache.Contains(&a));
+}
+
+TEST(TrackPageCache, EvictLeastRecentlyUsed) {
+  TrackPageCache cache;
+  int a, b, c;
+  std::vector<int*> evicted;
+  auto t0 = Clock::now();
+  auto add = [&](int* key, Clock::time_point now) {
+    cache.Add(key, 100, [&, key] { evicted.push_back(key); }, now);
+  };
+  add(&a, t0);
+  add(&b, t0 + 1s);
+  add(&c, t0 + 2s);
+  cache.Touch(&a, t0 + 3s);
+
+  EXPECT_EQ(cache.Enforce(300, 0ms, t0 + 10s), 0);
+  EXPECT_EQ(cache.Enforce(150, 0ms, t0 + 10s), 200);
+  EXPECT_EQ(evicted, std::vector<int*>({&b, &c}));
+  EXPECT_EQ(cache.GetPoints(), 100);
+  EXPECT_TRUE(cache.Contains(&a));
+}
+
+TEST(TrackPageCache, KeepRecentAndPinned) {
+  TrackPageCache cache;
+  int a, b, c;
+  int evictions = 0;
+  auto t0 = Clock::now();
+  cache.SetPinned(&a, true);
+  cache.Add(&a, 100, [&] { evictions++; }, t0);
+  cache.Add(&b, 100, [&] { evictions++; }, t0);
+  cache.Add(&c, 100, [&] { evictions++; }, t0 + 5s);
+
+  // Tracks touched within keep are never evicted, nor are pinned ones.
+  EXPECT_EQ(cache.Enforce(0, 2s, t0 + 6s), 100);
+  EXPECT_EQ(evictions, 1);
+  EXPECT_TRUE(cache.Contains(&a));
+  EXPECT_FALSE(cache.Contains(&b));
+  cache.SetPinned(&a, false);
+  EXPECT_EQ(cache.Enforce(0, 2s, t0 + 10s), 200);
+  EXPECT_EQ(cache.GetCount(), 0);
+}
+
+TEST(TrackPageCache, EvictorRemoves) {
+  TrackPageCache cache;
+  int a;
+  cache.Add(&a, 10, [&] { cache.Remove(&a); }, Clock::now() - 1h);
+  EXPECT_EQ(cache.Enforce(0, 1s), 10);
+  EXPECT_EQ(cache.GetCount(), 0);
+  EXPECT_EQ(cache.GetPoints(), 0);
+}